@@ -10,6 +10,7 @@ using Microsoft.Extensions.Hosting;
 using Microsoft.Extensions.Logging;
 using AceAgent.Tools.CKG.Services;
 using AceAgent.Tools.CKG.Data;
+using AceAgent.Tools.CKG.Models;
 using AceAgent.Tools.CKG;
 using Microsoft.EntityFrameworkCore;
 
@@ -390,18 +391,25 @@ namespace AceAgent.CLI
                 new Argument<string>("path", "要分析的代码库路径"),
                 new Option<string[]>("--languages", "指定要分析的编程语言"),
                 new Option<string>("--output", "输出文件路径"),
-                new Option<bool>("--verbose", "启用详细输出")
+                new Option<bool>("--verbose", "启用详细输出"),
+                new Option<bool>("--stats", "输出原生解析器的性能统计")
             };
 
             var pathArg = analyzeCommand.Arguments.OfType<Argument<string>>().First();
             var languagesOpt = analyzeCommand.Options.OfType<Option<string[]>>().First(o => o.Name == "languages");
             var outputOpt = analyzeCommand.Options.OfType<Option<string>>().First(o => o.Name == "output");
             var verboseOpt = analyzeCommand.Options.OfType<Option<bool>>().First(o => o.Name == "verbose");
+            var statsOpt = analyzeCommand.Options.OfType<Option<bool>>().First(o => o.Name == "stats");
 
-            analyzeCommand.SetHandler(async (string path, string[] languages, string output, bool verbose) =>
+            analyzeCommand.SetHandler(async (string path, string[] languages, string output, bool verbose, bool stats) =>
             {
                 using var scope = host.Services.CreateScope();
                 var codeParsingService = scope.ServiceProvider.GetRequiredService<CKGService>();
+                var treeSitterService = scope.ServiceProvider.GetRequiredService<TreeSitterService>();
+                if (stats)
+                {
+                    treeSitterService.ResetNativeStats();
+                }
                 
                 // 检查路径是文件还是目录
                 if (File.Exists(path))
@@ -419,11 +427,43 @@ namespace AceAgent.CLI
                 {
                     Console.WriteLine($"错误: 路径不存在: {path}");
                 }
-            }, pathArg, languagesOpt, outputOpt, verboseOpt);
+
+                if (stats)
+                {
+                    PrintNativeStats(treeSitterService.GetNativeStats());
+                }
+            }, pathArg, languagesOpt, outputOpt, verboseOpt, statsOpt);
 
             return analyzeCommand;
         }
 
+        private static void PrintNativeStats(NativeParserStats stats)
+        {
+            Console.WriteLine();
+            Console.WriteLine("原生解析统计:");
+            Console.WriteLine($"  文件数: {stats.FilesParsed}");
+            Console.WriteLine($"  字节数: {stats.BytesParsed}");
+            Console.WriteLine($"  访问节点数: {stats.NodesVisited}");
+            Console.WriteLine($"  查询匹配数: {stats.QueryMatches}");
+            Console.WriteLine($"  提取符号数: {stats.SymbolsExtracted}");
+            Console.WriteLine($"  解析耗时: {stats.ParseTime.TotalMilliseconds:F1} ms");
+            Console.WriteLine($"  提取耗时: {stats.ExtractTime.TotalMilliseconds:F1} ms");
+            Console.WriteLine($"  序列化耗时: {stats.SerializeTime.TotalMilliseconds:F1} ms");
+            Console.WriteLine($"  最大结果块: {stats.ArenaHighWaterBytes} 字节");
+            Console.WriteLine($"  错误数: {stats.Errors}");
+            foreach (var (language, errors) in stats.ErrorsByLanguage)
+            {
+                Console.WriteLine($"    {language}: {errors}");
+            }
+            Console.WriteLine($"  超时: {stats.Timeouts}");
+            Console.WriteLine($"  取消: {stats.Cancellations}");
+            Console.WriteLine($"  按大小跳过: {stats.FilesSkipped}");
+            Console.WriteLine($"  缓存命中/未命中/淘汰: {stats.CacheHits}/{stats.CacheMisses}/{stats.CacheEvictions}");
+            Console.WriteLine($"  缓存占用: {stats.CacheEntries} 项, {stats.CacheBytes} 字节");
+            Console.WriteLine($"  磁盘缓存命中/未命中/淘汰: {stats.DiskCacheHits}/{stats.DiskCacheMisses}/{stats.DiskCacheEvictions}");
+            Console.WriteLine($"  磁盘缓存占用: {stats.DiskCacheEntries} 项, {stats.DiskCacheBytes} 字节");
+        }
+
         private static Command CreateCkgQueryCommand(IHost host)
         {
             var queryCommand = new Command("query", "查询代码知识图谱")
@@ -441,7 +481,7 @@ namespace AceAgent.CLI
             {
                 using var scope = host.Services.CreateScope();
                 var codeParsingService = scope.ServiceProvider.GetRequiredService<CKGService>();
-                    await codeParsingService.QueryKnowledgeGraphAsync(query, database, format);
+                    Console.WriteLine(await codeParsingService.QueryKnowledgeGraphAsync(query, database, format));
             }, queryArg, databaseOpt, formatOpt);
 
             return queryCommand;
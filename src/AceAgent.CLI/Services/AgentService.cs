@@ -356,7 +356,7 @@ namespace AceAgent.CLI.Services
             return new Dictionary<string, ITool>
             {
                 ["bash"] = new BashTool(),
-                ["file_edit_tool"] = new FileEditTool(),
+                ["file_edit_tool"] = new FileEditTool(ckgService),
                 ["sequentialthinking"] = new SequentialThinkingTool(),
                 ["task_done"] = new TaskDoneTool(),
                 ["web_search"] = new WebSearchTool(),
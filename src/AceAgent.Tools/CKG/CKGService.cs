@@ -1,17 +1,25 @@
 using Microsoft.Extensions.Logging;
 using Microsoft.EntityFrameworkCore;
+using System.Security.Cryptography;
+using System.Text;
 using System.Text.Json;
+using System.Text.RegularExpressions;
 using AceAgent.Tools.CKG.Data;
 using AceAgent.Tools.CKG.Models;
 using AceAgent.Tools.CKG.Services;
 
 namespace AceAgent.Tools.CKG;
 
-public class CKGService
+public class CKGService : IDisposable
 {
     private readonly TreeSitterService _treeSitterService;
     private readonly CKGDbContext _dbContext;
     private readonly ILogger<CKGService> _logger;
+
+    // Symbol indexes opened by GetSymbolIndex, by file path
+    private readonly Dictionary<string, SymbolIndex> _symbolIndexes = new();
+    // Text indexes opened by GetTextIndex, by file path
+    private readonly Dictionary<string, TextIndex> _textIndexes = new();
     
     private static readonly Dictionary<string, string> FileExtensionToLanguage = new()
     {
@@ -73,29 +81,112 @@ public class CKGService
                 _logger.LogInformation("Supported languages: {Languages}", string.Join(", ", supportedLanguages));
             }
 
-            var codeFiles = GetCodeFiles(repositoryPath, supportedLanguages);
-            
-            if (verbose)
+            var extensions = FileExtensionToLanguage
+                .Where(entry => supportedLanguages.Contains(entry.Value))
+                .Select(entry => entry.Key)
+                .ToList();
+
+            // Fingerprints from the last run let the native indexer skip files
+            // that have not changed without reading or parsing them
+            await EnsureFingerprintTableAsync();
+            var knownFiles = await _dbContext.FileFingerprints
+                .Where(f => f.ProjectPath == repositoryPath)
+                .ToListAsync();
+            var knownByPath = knownFiles.ToDictionary(f => f.FilePath);
+            var seenFiles = new HashSet<string>();
+
+            // The run rewrites the repository's symbol index, copying unchanged
+            // files' symbols from the old one; when it is missing or in an older
+            // format they must be parsed again
+            var symbolIndexPath = GetSymbolIndexPath(repositoryPath);
+            CloseSymbolIndex(symbolIndexPath);
+            bool symbolIndexReadable;
+            using (var existing = _treeSitterService.OpenSymbolIndex(symbolIndexPath))
             {
-                _logger.LogInformation("Found {FileCount} files, {CodeFileCount} are code files", 
-                    Directory.GetFiles(repositoryPath, "*", SearchOption.AllDirectories).Length,
-                    codeFiles.Count);
+                symbolIndexReadable = existing != null;
             }
+            var knownForRun = symbolIndexReadable ? knownFiles : new List<FileFingerprint>();
+
+            // The text index is rewritten the same way; unchanged files it is
+            // missing are read again natively without being parsed
+            var textIndexPath = GetTextIndexPath(repositoryPath);
+            CloseTextIndex(textIndexPath);
 
+            // The native indexer walks the tree, maps and parses files on its own
+            // thread pool and streams results back as they finish
+            var indexedFiles = 0;
             var processedFiles = 0;
-            foreach (var filePath in codeFiles)
+            var skippedFiles = 0;
+            await foreach (var file in _treeSitterService.IndexChangedFilesAsync(repositoryPath, extensions, knownForRun,
+                symbolIndexPath: symbolIndexPath, textIndexPath: textIndexPath))
             {
-                var result = await AnalyzeFileAsync(filePath, repositoryPath);
-                if (result != null && result.IsSuccess)
+                indexedFiles++;
+                var fingerprint = file.Fingerprint;
+                seenFiles.Add(fingerprint.FilePath);
+                knownByPath.TryGetValue(fingerprint.FilePath, out var known);
+
+                if (file.State == FileIndexState.Unchanged)
+                {
+                    skippedFiles++;
+                    continue;
+                }
+                if (file.State == FileIndexState.Touched)
+                {
+                    // Same contents under a new time: only the fingerprint moves
+                    skippedFiles++;
+                    SaveFingerprint(known, fingerprint);
+                    continue;
+                }
+
+                var result = file.Result!;
+                if (!result.IsSuccess)
+                {
+                    _logger.LogWarning("Parse failed for {FilePath}: {Error}", result.FilePath, result.ErrorMessage);
+                    // Forget the fingerprint so the next run tries again
+                    if (known != null)
+                    {
+                        _dbContext.FileFingerprints.Remove(known);
+                    }
+                    continue;
+                }
+
+                if (result.IsPartial)
+                {
+                    _logger.LogWarning("Parse stopped early for {FilePath}; symbols may be incomplete", result.FilePath);
+                }
+
+                ApplyProjectMetadata(result, repositoryPath, string.Empty);
+                await SaveParseResultAsync(result);
+                if (!result.IsPartial)
+                {
+                    SaveFingerprint(known, fingerprint);
+                }
+                else if (known != null)
                 {
-                    await SaveParseResultAsync(result);
-                    processedFiles++;
+                    _dbContext.FileFingerprints.Remove(known);
                 }
+                processedFiles++;
+            }
+
+            // Files fingerprinted last time that the walk no longer finds were
+            // deleted or are now ignored. Files of languages outside this run
+            // were not looked for and stay.
+            foreach (var known in knownFiles.Where(f => !seenFiles.Contains(f.FilePath) &&
+                                                        extensions.Contains(Path.GetExtension(f.FilePath).ToLowerInvariant())))
+            {
+                await RemoveFileAsync(known.FilePath);
+                _dbContext.FileFingerprints.Remove(known);
+            }
+
+            if (verbose)
+            {
+                _logger.LogInformation("Indexed {CodeFileCount} code files", indexedFiles);
             }
 
             await _dbContext.SaveChangesAsync();
             
-            _logger.LogInformation("Repository analysis completed. Processed {ProcessedFiles} files. Data saved to database.", processedFiles);
+            _logger.LogInformation("Repository analysis completed. Processed {ProcessedFiles} files, {SkippedFiles} unchanged. Data saved to database.",
+                processedFiles, skippedFiles);
             return true;
         }
         catch (Exception ex)
@@ -105,6 +196,168 @@ public class CKGService
         }
     }
 
+    /// <summary>
+    /// The symbol index written by the last <see cref="AnalyzeRepositoryAsync"/> of
+    /// <paramref name="repositoryPath"/>, mapped for lookups without the database.
+    /// Null if the repository has not been analysed. The service owns the index;
+    /// it stays open until the next analysis of the repository.
+    /// </summary>
+    public SymbolIndex? GetSymbolIndex(string repositoryPath)
+    {
+        var path = GetSymbolIndexPath(repositoryPath);
+        lock (_symbolIndexes)
+        {
+            if (!_symbolIndexes.TryGetValue(path, out var index))
+            {
+                index = _treeSitterService.OpenSymbolIndex(path);
+                if (index != null)
+                {
+                    _symbolIndexes[path] = index;
+                }
+            }
+            return index;
+        }
+    }
+
+    /// <summary>
+    /// Searches the names in <paramref name="repositoryPath"/>'s symbol index.
+    /// Without a <paramref name="mode"/>, a query ending in '*' is a prefix
+    /// search and any other query collects prefix, camel-hump, substring and
+    /// fuzzy matches, in that order, until <paramref name="limit"/> names are found.
+    /// Empty if the repository has not been analysed.
+    /// </summary>
+    public List<SymbolMatch> SearchSymbols(string repositoryPath, string query, SymbolSearchMode? mode = null, int limit = 20, int maxDistance = 2)
+    {
+        var index = GetSymbolIndex(repositoryPath);
+        if (index == null)
+        {
+            _logger.LogWarning("No symbol index for {RepositoryPath}; analyze it first", repositoryPath);
+            return new List<SymbolMatch>();
+        }
+        if (mode != null)
+        {
+            return index.Search(query, mode.Value, limit, maxDistance).ToList();
+        }
+        if (query.EndsWith('*'))
+        {
+            return index.Search(query.TrimEnd('*'), SymbolSearchMode.Prefix, limit).ToList();
+        }
+
+        var results = new List<SymbolMatch>();
+        var seen = new HashSet<string>();
+        foreach (var next in new[] { SymbolSearchMode.Prefix, SymbolSearchMode.Camel, SymbolSearchMode.Substring, SymbolSearchMode.Fuzzy })
+        {
+            foreach (var match in index.Search(query, next, limit, maxDistance))
+            {
+                if (results.Count < limit && seen.Add(match.Name))
+                {
+                    results.Add(match);
+                }
+            }
+        }
+        return results;
+    }
+
+    /// <summary>
+    /// The text index written by the last <see cref="AnalyzeRepositoryAsync"/> of
+    /// <paramref name="repositoryPath"/>; owned by the service like
+    /// <see cref="GetSymbolIndex"/>. Null if the repository has not been analysed.
+    /// </summary>
+    public TextIndex? GetTextIndex(string repositoryPath)
+    {
+        var path = GetTextIndexPath(repositoryPath);
+        lock (_textIndexes)
+        {
+            if (!_textIndexes.TryGetValue(path, out var index))
+            {
+                index = _treeSitterService.OpenTextIndex(path);
+                if (index != null)
+                {
+                    _textIndexes[path] = index;
+                }
+            }
+            return index;
+        }
+    }
+
+    /// <summary>
+    /// Finds the lines of <paramref name="repositoryPath"/>'s files that contain
+    /// <paramref name="pattern"/>, or match it as a .NET regular expression when
+    /// <paramref name="regex"/> is set. Empty if the repository has not been
+    /// analysed.
+    /// </summary>
+    public List<TextMatch> SearchText(string repositoryPath, string pattern, bool regex = false, bool ignoreCase = false, int limit = 100)
+    {
+        var index = GetTextIndex(repositoryPath);
+        if (index == null)
+        {
+            _logger.LogWarning("No text index for {RepositoryPath}; analyze it first", repositoryPath);
+            return new List<TextMatch>();
+        }
+        if (!regex)
+        {
+            return index.Search(pattern, ignoreCase, limit).ToList();
+        }
+        var options = RegexOptions.CultureInvariant | (ignoreCase ? RegexOptions.IgnoreCase : RegexOptions.None);
+        return index.SearchRegex(new Regex(pattern, options, TimeSpan.FromSeconds(1)), limit).ToList();
+    }
+
+    // Beside the database, one per repository
+    private string GetSymbolIndexPath(string repositoryPath)
+    {
+        var database = _dbContext.Database.GetDbConnection().DataSource;
+        var directory = Path.GetDirectoryName(Path.GetFullPath(string.IsNullOrEmpty(database) ? "ckg.db" : database)) ?? ".";
+        var repository = Convert.ToHexString(SHA256.HashData(Encoding.UTF8.GetBytes(Path.GetFullPath(repositoryPath))), 0, 8);
+        return Path.Combine(directory, $"ckg-{repository.ToLowerInvariant()}.ckgi");
+    }
+
+    private string GetTextIndexPath(string repositoryPath)
+    {
+        return Path.ChangeExtension(GetSymbolIndexPath(repositoryPath), ".ckgt");
+    }
+
+    private void CloseSymbolIndex(string path)
+    {
+        lock (_symbolIndexes)
+        {
+            if (_symbolIndexes.Remove(path, out var index))
+            {
+                index.Dispose();
+            }
+        }
+    }
+
+    private void CloseTextIndex(string path)
+    {
+        lock (_textIndexes)
+        {
+            if (_textIndexes.Remove(path, out var index))
+            {
+                index.Dispose();
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        lock (_symbolIndexes)
+        {
+            foreach (var index in _symbolIndexes.Values)
+            {
+                index.Dispose();
+            }
+            _symbolIndexes.Clear();
+        }
+        lock (_textIndexes)
+        {
+            foreach (var index in _textIndexes.Values)
+            {
+                index.Dispose();
+            }
+            _textIndexes.Clear();
+        }
+    }
+
     public async Task<ParseResult?> AnalyzeFileAsync(string filePath, string? projectPath = null, string? commitHash = null)
     {
         var result = await AnalyzeFileInternalAsync(filePath, projectPath, commitHash);
@@ -133,6 +386,136 @@ public class CKGService
         }
     }
 
+    /// <summary>
+    /// Brings a file's rows up to date after its text changed from
+    /// <paramref name="oldContent"/> to <paramref name="newContent"/> within
+    /// <paramref name="edit"/>. The file is reparsed incrementally and only the
+    /// symbols the edit touched are written; the rest just have their lines
+    /// shifted. Falls back to analysing the whole file when the rows cannot be
+    /// matched to the old text.
+    /// </summary>
+    public async Task<SymbolDiff?> ApplyEditAsync(string filePath, string oldContent, string newContent, TextEdit edit, string? projectPath = null,
+        string? commitHash = null)
+    {
+        try
+        {
+            var language = GetLanguageFromExtension(Path.GetExtension(filePath));
+            if (string.IsNullOrEmpty(language))
+            {
+                _logger.LogDebug("Unsupported file type: {FilePath}", filePath);
+                return null;
+            }
+
+            await _dbContext.Database.EnsureCreatedAsync();
+
+            var functions = await _dbContext.Functions.Where(f => f.FilePath == filePath).ToListAsync();
+            var classes = await _dbContext.Classes.Where(c => c.FilePath == filePath).ToListAsync();
+            if (functions.Count == 0 && classes.Count == 0)
+            {
+                // Nothing to patch: the file was never analysed
+                await AnalyzeFileAndSaveAsync(filePath, projectPath, commitHash);
+                return null;
+            }
+
+            var diff = await _treeSitterService.ApplyEditAsync(filePath, language, oldContent, newContent, edit);
+            if (!diff.IsSuccess || !ApplySymbolDiff(diff, functions, classes, projectPath, commitHash))
+            {
+                _logger.LogInformation("Incremental update not possible for {FilePath} ({Reason}), analysing it in full",
+                    filePath, diff.ErrorMessage ?? "rows out of date");
+                _treeSitterService.CloseDocument(filePath);
+                await AnalyzeFileAndSaveAsync(filePath, projectPath, commitHash);
+                return diff;
+            }
+
+            await _dbContext.SaveChangesAsync();
+            return diff;
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error applying edit to: {FilePath}", filePath);
+            return null;
+        }
+    }
+
+    // Patch a file's tracked rows with a diff. False, with nothing changed,
+    // if a removed or changed symbol has no row at its old lines.
+    private bool ApplySymbolDiff(SymbolDiff diff, List<Function> functions, List<Class> classes, string? projectPath, string? commitHash)
+    {
+        var matched = new Dictionary<CodeElement, SymbolChange>();
+        foreach (var change in diff.Changes.Where(c => c.Kind != SymbolChangeKind.Added))
+        {
+            CodeElement? row = change.IsClass
+                ? classes.FirstOrDefault(c => !matched.ContainsKey(c) && c.Name == change.Name && c.StartLine == change.OldStartLine)
+                : functions.FirstOrDefault(f => !matched.ContainsKey(f) && f.Name == change.Name &&
+                                                f.ClassName == change.ClassName && f.StartLine == change.OldStartLine);
+            if (row == null)
+            {
+                return false;
+            }
+            matched[row] = change;
+        }
+
+        var now = DateTime.UtcNow;
+        foreach (var row in functions.Concat<CodeElement>(classes))
+        {
+            if (matched.TryGetValue(row, out var change))
+            {
+                if (change.Kind == SymbolChangeKind.Removed)
+                {
+                    _dbContext.Remove(row);
+                    continue;
+                }
+                row.StartLine = change.StartLine;
+                row.EndLine = change.EndLine;
+                row.UpdatedAt = now;
+            }
+            else if (diff.LineDelta != 0 && row.EndLine > diff.EditLine)
+            {
+                if (row.StartLine > diff.EditLine)
+                {
+                    row.StartLine += diff.LineDelta;
+                }
+                row.EndLine += diff.LineDelta;
+                row.UpdatedAt = now;
+            }
+        }
+
+        // New rows inherit the file's project and commit
+        var template = (CodeElement?)functions.FirstOrDefault() ?? classes.FirstOrDefault();
+        projectPath ??= template?.ProjectPath ?? Path.GetDirectoryName(diff.FilePath) ?? "";
+        commitHash ??= template?.CommitHash ?? "";
+        foreach (var change in diff.Changes.Where(c => c.Kind == SymbolChangeKind.Added))
+        {
+            if (change.IsClass)
+            {
+                _dbContext.Classes.Add(new Class
+                {
+                    Name = change.Name,
+                    FilePath = diff.FilePath,
+                    StartLine = change.StartLine,
+                    EndLine = change.EndLine,
+                    ProjectPath = projectPath,
+                    CommitHash = commitHash
+                });
+            }
+            else
+            {
+                _dbContext.Functions.Add(new Function
+                {
+                    Name = change.Name,
+                    ClassName = change.ClassName,
+                    FilePath = diff.FilePath,
+                    StartLine = change.StartLine,
+                    EndLine = change.EndLine,
+                    ProjectPath = projectPath,
+                    CommitHash = commitHash
+                });
+            }
+        }
+
+        return true;
+    }
+
     private async Task<ParseResult?> AnalyzeFileInternalAsync(string filePath, string? projectPath = null, string? commitHash = null)
     {
         try
@@ -150,14 +533,14 @@ public class CKGService
                 return null;
             }
 
-            var sourceCode = await File.ReadAllTextAsync(filePath);
-            if (string.IsNullOrWhiteSpace(sourceCode))
+            if (new FileInfo(filePath).Length == 0)
             {
                 _logger.LogDebug("Empty file: {FilePath}", filePath);
                 return null;
             }
 
-            var result = await _treeSitterService.ParseCodeAsync(sourceCode, language, filePath);
+            // Parsed straight from the file, so large files are never loaded as a string
+            var result = await _treeSitterService.ParseFileAsync(filePath, language);
             
             if (!result.IsSuccess)
             {
@@ -166,38 +549,7 @@ public class CKGService
             }
 
             // Set additional properties
-            var normalizedProjectPath = projectPath ?? Path.GetDirectoryName(filePath) ?? "";
-            var normalizedCommitHash = commitHash ?? "";
-            
-            foreach (var func in result.Functions)
-            {
-                func.ProjectPath = normalizedProjectPath;
-                func.CommitHash = normalizedCommitHash;
-            }
-            
-            foreach (var cls in result.Classes)
-            {
-                cls.ProjectPath = normalizedProjectPath;
-                cls.CommitHash = normalizedCommitHash;
-            }
-            
-            foreach (var prop in result.Properties)
-            {
-                prop.ProjectPath = normalizedProjectPath;
-                prop.CommitHash = normalizedCommitHash;
-            }
-            
-            foreach (var field in result.Fields)
-            {
-                field.ProjectPath = normalizedProjectPath;
-                field.CommitHash = normalizedCommitHash;
-            }
-            
-            foreach (var variable in result.Variables)
-            {
-                variable.ProjectPath = normalizedProjectPath;
-                variable.CommitHash = normalizedCommitHash;
-            }
+            ApplyProjectMetadata(result, projectPath ?? Path.GetDirectoryName(filePath) ?? "", commitHash ?? "");
 
             return result;
         }
@@ -208,7 +560,44 @@ public class CKGService
         }
     }
 
-    public async Task<List<object>> ExecuteQueryAsync(string query, string? databasePath = null)
+    private static void ApplyProjectMetadata(ParseResult result, string projectPath, string commitHash)
+    {
+        foreach (var func in result.Functions)
+        {
+            func.ProjectPath = projectPath;
+            func.CommitHash = commitHash;
+        }
+        
+        foreach (var cls in result.Classes)
+        {
+            cls.ProjectPath = projectPath;
+            cls.CommitHash = commitHash;
+        }
+        
+        foreach (var prop in result.Properties)
+        {
+            prop.ProjectPath = projectPath;
+            prop.CommitHash = commitHash;
+        }
+        
+        foreach (var field in result.Fields)
+        {
+            field.ProjectPath = projectPath;
+            field.CommitHash = commitHash;
+        }
+        
+        foreach (var variable in result.Variables)
+        {
+            variable.ProjectPath = projectPath;
+            variable.CommitHash = commitHash;
+        }
+    }
+
+    /// <summary>
+    /// Symbol search (see <see cref="SearchSymbols"/>) over the repository at
+    /// <paramref name="repositoryPath"/>, by default the current directory.
+    /// </summary>
+    public async Task<List<object>> ExecuteQueryAsync(string query, string? databasePath = null, string? repositoryPath = null)
     {
         try
         {
@@ -218,11 +607,7 @@ public class CKGService
             }
 
             _logger.LogInformation("执行查询: {Query}", query);
-            
-            // TODO: Implement actual SQL query execution
-            _logger.LogInformation("查询功能正在开发中...");
-            
-            return new List<object>();
+            return SearchSymbols(repositoryPath ?? Directory.GetCurrentDirectory(), query).Cast<object>().ToList();
         }
         catch (Exception ex)
         {
@@ -286,55 +671,71 @@ public class CKGService
     private async Task SaveParseResultAsync(ParseResult result)
     {
         // Remove existing entries for this file
+        await RemoveFileAsync(result.FilePath);
+
+        // Add new entries
+        await _dbContext.Functions.AddRangeAsync(result.Functions);
+        await _dbContext.Classes.AddRangeAsync(result.Classes);
+        await _dbContext.Properties.AddRangeAsync(result.Properties);
+        await _dbContext.Fields.AddRangeAsync(result.Fields);
+        await _dbContext.Variables.AddRangeAsync(result.Variables);
+    }
+
+    // Remove every row extracted from a file
+    private async Task RemoveFileAsync(string filePath)
+    {
         var existingFunctions = await _dbContext.Functions
-            .Where(f => f.FilePath == result.FilePath)
+            .Where(f => f.FilePath == filePath)
             .ToListAsync();
         _dbContext.Functions.RemoveRange(existingFunctions);
         
         var existingClasses = await _dbContext.Classes
-            .Where(c => c.FilePath == result.FilePath)
+            .Where(c => c.FilePath == filePath)
             .ToListAsync();
         _dbContext.Classes.RemoveRange(existingClasses);
         
         var existingProperties = await _dbContext.Properties
-            .Where(p => p.FilePath == result.FilePath)
+            .Where(p => p.FilePath == filePath)
             .ToListAsync();
         _dbContext.Properties.RemoveRange(existingProperties);
         
         var existingFields = await _dbContext.Fields
-            .Where(f => f.FilePath == result.FilePath)
+            .Where(f => f.FilePath == filePath)
             .ToListAsync();
         _dbContext.Fields.RemoveRange(existingFields);
         
         var existingVariables = await _dbContext.Variables
-            .Where(v => v.FilePath == result.FilePath)
+            .Where(v => v.FilePath == filePath)
             .ToListAsync();
         _dbContext.Variables.RemoveRange(existingVariables);
-
-        // Add new entries
-        await _dbContext.Functions.AddRangeAsync(result.Functions);
-        await _dbContext.Classes.AddRangeAsync(result.Classes);
-        await _dbContext.Properties.AddRangeAsync(result.Properties);
-        await _dbContext.Fields.AddRangeAsync(result.Fields);
-        await _dbContext.Variables.AddRangeAsync(result.Variables);
     }
 
-    private List<string> GetCodeFiles(string directoryPath, List<string> supportedLanguages)
+    private void SaveFingerprint(FileFingerprint? known, FileFingerprint fingerprint)
     {
-        var allFiles = Directory.GetFiles(directoryPath, "*", SearchOption.AllDirectories);
-        return allFiles.Where(file => IsCodeFile(file, supportedLanguages)).ToList();
+        if (known == null)
+        {
+            _dbContext.FileFingerprints.Add(fingerprint);
+            return;
+        }
+        known.Size = fingerprint.Size;
+        known.ModifiedTime = fingerprint.ModifiedTime;
+        known.ContentHash = fingerprint.ContentHash;
+        known.IndexedAt = fingerprint.IndexedAt;
     }
 
-    private bool IsCodeFile(string filePath, List<string> supportedLanguages)
+    // EnsureCreated only builds a new database, so databases written before
+    // fingerprints existed get the table here
+    private async Task EnsureFingerprintTableAsync()
     {
-        var extension = Path.GetExtension(filePath).ToLowerInvariant();
-        
-        if (!FileExtensionToLanguage.TryGetValue(extension, out var language))
-        {
-            return false;
-        }
-        
-        return supportedLanguages.Contains(language);
+        await _dbContext.Database.ExecuteSqlRawAsync(
+            "CREATE TABLE IF NOT EXISTS \"FileFingerprints\" (" +
+            "\"Id\" INTEGER NOT NULL CONSTRAINT \"PK_FileFingerprints\" PRIMARY KEY AUTOINCREMENT, " +
+            "\"FilePath\" TEXT NOT NULL, \"ProjectPath\" TEXT NOT NULL, \"Size\" INTEGER NOT NULL, " +
+            "\"ModifiedTime\" INTEGER NOT NULL, \"ContentHash\" INTEGER NOT NULL, \"IndexedAt\" TEXT NOT NULL)");
+        await _dbContext.Database.ExecuteSqlRawAsync(
+            "CREATE UNIQUE INDEX IF NOT EXISTS \"IX_FileFingerprints_FilePath\" ON \"FileFingerprints\" (\"FilePath\")");
+        await _dbContext.Database.ExecuteSqlRawAsync(
+            "CREATE INDEX IF NOT EXISTS \"IX_FileFingerprints_ProjectPath\" ON \"FileFingerprints\" (\"ProjectPath\")");
     }
 
     private string? GetLanguageFromExtension(string extension)
@@ -351,10 +752,8 @@ public class CKGService
     {
         try
         {
-            _logger.LogInformation("执行查询: {Query}", query);
-            _logger.LogInformation("查询功能正在开发中...");
-            await Task.CompletedTask;
-            return "查询功能正在开发中...";
+            var matches = (await ExecuteQueryAsync(query, database)).Cast<SymbolMatch>().ToList();
+            return FormatSymbolMatches(matches, format);
         }
         catch (Exception ex)
         {
@@ -363,6 +762,66 @@ public class CKGService
         }
     }
 
+    /// <summary>
+    /// Renders search results one symbol per line as a table, csv, or json.
+    /// </summary>
+    public static string FormatSymbolMatches(IReadOnlyList<SymbolMatch> matches, string format)
+    {
+        var rows = matches.SelectMany(m => m.Symbols.Select(s => (Match: m, Symbol: s))).ToList();
+        switch (format.ToLowerInvariant())
+        {
+            case "json":
+                return JsonSerializer.Serialize(matches, new JsonSerializerOptions { WriteIndented = true });
+            case "csv":
+            {
+                var csv = new StringBuilder("name,kind,class,file,start_line,end_line,score\n");
+                foreach (var (match, symbol) in rows)
+                {
+                    csv.AppendLine(string.Join(",", CsvField(symbol.Name), symbol.Kind, CsvField(symbol.ClassName ?? ""),
+                        CsvField(symbol.FilePath), symbol.StartLine, symbol.EndLine, match.Score));
+                }
+                return csv.ToString();
+            }
+            default:
+            {
+                if (rows.Count == 0)
+                {
+                    return "未找到匹配的符号";
+                }
+                var table = new StringBuilder();
+                foreach (var (match, symbol) in rows)
+                {
+                    var name = symbol.ClassName == null ? symbol.Name : $"{symbol.ClassName}.{symbol.Name}";
+                    table.AppendLine($"{name,-40} {symbol.Kind,-8} {symbol.FilePath}:{symbol.StartLine}");
+                }
+                return table.ToString().TrimEnd();
+            }
+        }
+    }
+
+    /// <summary>
+    /// Renders text search results grep-style, one "path:line:column: text"
+    /// per line.
+    /// </summary>
+    public static string FormatTextMatches(IReadOnlyList<TextMatch> matches)
+    {
+        if (matches.Count == 0)
+        {
+            return "未找到匹配的文本";
+        }
+        var lines = new StringBuilder();
+        foreach (var match in matches)
+        {
+            lines.AppendLine($"{match.FilePath}:{match.Line}:{match.Column}: {match.LineText.Trim()}");
+        }
+        return lines.ToString().TrimEnd();
+    }
+
+    private static string CsvField(string value)
+    {
+        return value.IndexOfAny(new[] { ',', '"', '\n' }) < 0 ? value : $"\"{value.Replace("\"", "\"\"")}\"";
+    }
+
     public async Task<bool> ExportKnowledgeGraphAsync(string output, string? database, string format)
     {
         try
@@ -10,6 +10,7 @@ public class CKGDbContext : DbContext
     public DbSet<Property> Properties { get; set; }
     public DbSet<Field> Fields { get; set; }
     public DbSet<Variable> Variables { get; set; }
+    public DbSet<FileFingerprint> FileFingerprints { get; set; }
 
     public CKGDbContext(DbContextOptions<CKGDbContext> options) : base(options)
     {
@@ -121,6 +122,17 @@ public class CKGDbContext : DbContext
             entity.HasIndex(e => e.ClassName);
             entity.HasIndex(e => e.Namespace);
         });
+
+        // Configure FileFingerprint entity
+        modelBuilder.Entity<FileFingerprint>(entity =>
+        {
+            entity.HasKey(e => e.Id);
+            entity.Property(e => e.FilePath).IsRequired().HasMaxLength(1000);
+            entity.Property(e => e.ProjectPath).HasMaxLength(1000);
+            
+            entity.HasIndex(e => e.FilePath).IsUnique();
+            entity.HasIndex(e => e.ProjectPath);
+        });
     }
 
     protected override void OnConfiguring(DbContextOptionsBuilder optionsBuilder)
@@ -0,0 +1,42 @@
+namespace AceAgent.Tools.CKG.Models;
+
+/// <summary>
+/// What the last index run saw of a file, so the next run can skip it when it
+/// has not changed: its size and modification time, checked without reading
+/// the file, and a hash of its contents, checked without parsing it.
+/// </summary>
+public class FileFingerprint
+{
+    public int Id { get; set; }
+    public string FilePath { get; set; } = string.Empty;
+    public string ProjectPath { get; set; } = string.Empty;
+    public long Size { get; set; }
+    /// <summary>
+    /// Native file time; only compared for equality.
+    /// </summary>
+    public long ModifiedTime { get; set; }
+    /// <summary>
+    /// XXH64 of the raw file bytes, stored as a signed value.
+    /// </summary>
+    public long ContentHash { get; set; }
+    public DateTime IndexedAt { get; set; } = DateTime.UtcNow;
+}
+
+public enum FileIndexState
+{
+    New = 0,
+    Changed = 1,
+    Touched = 2,
+    Unchanged = 3
+}
+
+/// <summary>
+/// One file seen by an incremental index run. Only new and changed files were
+/// parsed and carry a <see cref="Result"/>.
+/// </summary>
+public class IndexedFile
+{
+    public FileFingerprint Fingerprint { get; set; } = new();
+    public FileIndexState State { get; set; }
+    public ParseResult? Result { get; set; }
+}
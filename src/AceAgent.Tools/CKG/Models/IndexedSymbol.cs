@@ -0,0 +1,52 @@
+namespace AceAgent.Tools.CKG.Models;
+
+public enum IndexedSymbolKind
+{
+    Function = 1,
+    Class = 2,
+    Property = 3,
+    Field = 4
+}
+
+/// <summary>
+/// A symbol read from a symbol index file.
+/// </summary>
+public class IndexedSymbol
+{
+    public IndexedSymbolKind Kind { get; set; }
+    public string Name { get; set; } = string.Empty;
+    public string? ClassName { get; set; }
+    public string FilePath { get; set; } = string.Empty;
+    public string Language { get; set; } = string.Empty;
+    public int StartLine { get; set; }
+    public int EndLine { get; set; }
+}
+
+/// <summary>
+/// How a symbol search matches names; every mode ignores case.
+/// </summary>
+public enum SymbolSearchMode
+{
+    /// <summary>Names starting with the query, shortest first.</summary>
+    Prefix = 0,
+    /// <summary>Names within a few edits of the query, closest first.</summary>
+    Fuzzy = 1,
+    /// <summary>Names whose camel humps start with the query's humps ("PCR", "PaCoRe"), fewest extra humps first.</summary>
+    Camel = 2,
+    /// <summary>Names containing the query anywhere, shortest first.</summary>
+    Substring = 3
+}
+
+/// <summary>
+/// A name found by a symbol search, with every symbol that has it.
+/// </summary>
+public class SymbolMatch
+{
+    public string Name { get; set; } = string.Empty;
+    public SymbolSearchMode Mode { get; set; }
+    /// <summary>
+    /// Lower is better: extra characters, edits or extra humps.
+    /// </summary>
+    public int Score { get; set; }
+    public List<IndexedSymbol> Symbols { get; set; } = new();
+}
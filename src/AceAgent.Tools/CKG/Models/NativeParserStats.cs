@@ -0,0 +1,46 @@
+namespace AceAgent.Tools.CKG.Models;
+
+/// <summary>
+/// Process-wide counters collected by the native parser since start-up or the last reset.
+/// </summary>
+public class NativeParserStats
+{
+    public ulong FilesParsed { get; set; }
+    public ulong BytesParsed { get; set; }
+    public ulong NodesVisited { get; set; }
+    public ulong QueryMatches { get; set; }
+    public ulong SymbolsExtracted { get; set; }
+    public TimeSpan ParseTime { get; set; }
+    public TimeSpan ExtractTime { get; set; }
+    public TimeSpan SerializeTime { get; set; }
+
+    /// <summary>
+    /// Size in bytes of the largest single result block built so far.
+    /// </summary>
+    public ulong ArenaHighWaterBytes { get; set; }
+
+    public ulong Errors { get; set; }
+    public Dictionary<string, ulong> ErrorsByLanguage { get; set; } = new();
+    public ulong Timeouts { get; set; }
+    public ulong Cancellations { get; set; }
+    public ulong FilesSkipped { get; set; }
+    public ulong CacheHits { get; set; }
+    public ulong CacheMisses { get; set; }
+    public ulong CacheEvictions { get; set; }
+
+    /// <summary>
+    /// Memory the tree cache currently holds, against its budget.
+    /// </summary>
+    public ulong CacheBytes { get; set; }
+    public uint CacheEntries { get; set; }
+
+    public ulong DiskCacheHits { get; set; }
+    public ulong DiskCacheMisses { get; set; }
+    public ulong DiskCacheEvictions { get; set; }
+
+    /// <summary>
+    /// Size of the on-disk parse cache, estimated from one scan of its directory.
+    /// </summary>
+    public ulong DiskCacheBytes { get; set; }
+    public uint DiskCacheEntries { get; set; }
+}
@@ -6,6 +6,10 @@ public class ParseResult
 {
     public bool IsSuccess { get; set; }
     public string? ErrorMessage { get; set; }
+    /// <summary>
+    /// The parse was stopped by its timeout or cancellation; the symbols found so far are kept.
+    /// </summary>
+    public bool IsPartial { get; set; }
     public string FilePath { get; set; } = string.Empty;
     public string Language { get; set; } = string.Empty;
     public List<Function> Functions { get; set; } = new();
@@ -0,0 +1,88 @@
+namespace AceAgent.Tools.CKG.Models;
+
+public enum SymbolChangeKind
+{
+    Added = 1,
+    Removed = 2,
+    Changed = 3
+}
+
+/// <summary>
+/// One symbol an edit added, removed, or moved other than by the edit's line delta.
+/// </summary>
+public class SymbolChange
+{
+    public SymbolChangeKind Kind { get; set; }
+    public bool IsClass { get; set; }
+    public string Name { get; set; } = string.Empty;
+    public string? ClassName { get; set; }
+    /// <summary>
+    /// Lines after the edit; 0 for removed symbols.
+    /// </summary>
+    public int StartLine { get; set; }
+    public int EndLine { get; set; }
+    /// <summary>
+    /// Lines before the edit; 0 for added symbols.
+    /// </summary>
+    public int OldStartLine { get; set; }
+    public int OldEndLine { get; set; }
+}
+
+/// <summary>
+/// Where a file's text changed, in UTF-16 offsets: characters [Start, OldEnd)
+/// of the old text became characters [Start, NewEnd) of the new text, and
+/// everything before and after is the same in both.
+/// </summary>
+public readonly record struct TextEdit(int Start, int OldEnd, int NewEnd)
+{
+    /// <summary>
+    /// This edit, widened where it would split a surrogate pair. False when
+    /// it does not fit <paramref name="oldContent"/> and <paramref name="newContent"/>.
+    /// </summary>
+    public bool TryAlign(string oldContent, string newContent, out TextEdit aligned)
+    {
+        aligned = this;
+        if (Start < 0 || Start > OldEnd || OldEnd > oldContent.Length || Start > NewEnd ||
+            NewEnd > newContent.Length || oldContent.Length - OldEnd != newContent.Length - NewEnd)
+        {
+            return false;
+        }
+        // An insertion at the end has no character at Start
+        if (Start > 0 && Start < oldContent.Length && char.IsLowSurrogate(oldContent[Start]))
+        {
+            aligned = aligned with { Start = Start - 1 };
+        }
+        if (OldEnd < oldContent.Length && char.IsLowSurrogate(oldContent[OldEnd]))
+        {
+            aligned = aligned with { OldEnd = OldEnd + 1, NewEnd = NewEnd + 1 };
+        }
+        return true;
+    }
+}
+
+/// <summary>
+/// How an edit changed a file's symbols. Symbols not listed in <see cref="Changes"/>
+/// kept their definitions: those with lines after <see cref="EditLine"/> moved by
+/// <see cref="LineDelta"/>, the rest stayed where they were.
+/// </summary>
+public class SymbolDiff
+{
+    public bool IsSuccess { get; set; }
+    public string? ErrorMessage { get; set; }
+    public string FilePath { get; set; } = string.Empty;
+    public string Language { get; set; } = string.Empty;
+    public int EditLine { get; set; }
+    public int LineDelta { get; set; }
+    public List<SymbolChange> Changes { get; set; } = new();
+
+    public static SymbolDiff Failure(string filePath, string language, string errorMessage)
+    {
+        return new SymbolDiff
+        {
+            IsSuccess = false,
+            FilePath = filePath,
+            Language = language,
+            ErrorMessage = errorMessage
+        };
+    }
+}
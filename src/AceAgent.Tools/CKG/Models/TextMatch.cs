@@ -0,0 +1,15 @@
+namespace AceAgent.Tools.CKG.Models;
+
+/// <summary>
+/// A line found by a text index search.
+/// </summary>
+public class TextMatch
+{
+    public string FilePath { get; set; } = string.Empty;
+    public int Line { get; set; }
+    /// <summary>
+    /// Where the match starts in <see cref="LineText"/>, from 1.
+    /// </summary>
+    public int Column { get; set; }
+    public string LineText { get; set; } = string.Empty;
+}
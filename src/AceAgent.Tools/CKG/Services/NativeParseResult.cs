@@ -0,0 +1,184 @@
+using System.Runtime.InteropServices;
+
+namespace AceAgent.Tools.CKG.Services;
+
+// Blittable mirrors of the structs in ckg_wrapper.h. C bools are one byte,
+// so they are declared as byte to keep the layout identical.
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeSpan
+{
+    public uint Offset;
+    public uint Length;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeFunction
+{
+    public IntPtr Name;
+    public IntPtr ReturnType;
+    public IntPtr Parameters;
+    public uint StartLine;
+    public uint EndLine;
+    public uint StartColumn;
+    public uint EndColumn;
+    public byte IsPublic;
+    public byte IsPrivate;
+    public byte IsProtected;
+    public byte IsStatic;
+    public byte IsAsync;
+    public IntPtr ParentClass;
+    public NativeSpan NameSpan;
+    public NativeSpan ParentClassSpan;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeClass
+{
+    public IntPtr Name;
+    public IntPtr NamespaceName;
+    public IntPtr BaseClass;
+    public IntPtr Interfaces;
+    public uint StartLine;
+    public uint EndLine;
+    public uint StartColumn;
+    public uint EndColumn;
+    public byte IsPublic;
+    public byte IsPrivate;
+    public byte IsProtected;
+    public byte IsStatic;
+    public byte IsAbstract;
+    public byte IsSealed;
+    public NativeSpan NameSpan;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeParseResult
+{
+    public uint FunctionCount;
+    public uint ClassCount;
+    public uint PropertyCount;
+    public uint FieldCount;
+    public uint VariableCount;
+    public IntPtr Functions;
+    public IntPtr Classes;
+    public IntPtr Properties;
+    public IntPtr Fields;
+    public IntPtr Variables;
+    public IntPtr ErrorMessage;
+    public uint Status;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeSizePolicy
+{
+    public ulong DeclarationsOnlyAbove;
+    public ulong SkipAbove;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeBatchOptions
+{
+    public uint ThreadCount;
+    public byte DisableSizeOrdering;
+    public ulong TimeoutMicros;
+    public NativeSizePolicy SizePolicy;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeIndexOptions
+{
+    public uint ThreadCount;
+    public byte DisableGitignore;
+    public ulong TimeoutMicros;
+    public NativeSizePolicy SizePolicy;
+    public IntPtr KnownFiles;
+    public uint KnownFileCount;
+    public IntPtr OnFile;
+    public IntPtr IndexPath;
+    public IntPtr TextIndexPath;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeFileFingerprint
+{
+    public IntPtr Path;
+    public ulong Size;
+    public long ModifiedTime;
+    public ulong Hash;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeIndexSymbol
+{
+    public IntPtr Name;
+    public IntPtr ParentClass;
+    public IntPtr FilePath;
+    public uint NameLength;
+    public uint ParentClassLength;
+    public uint FilePathLength;
+    public uint StartLine;
+    public uint EndLine;
+    public uint Kind;
+    public uint Language;
+    public uint Row;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeIndexMatch
+{
+    public IntPtr Name;
+    public uint NameLength;
+    public uint First;
+    public uint Count;
+    public uint Score;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeTextMatch
+{
+    public IntPtr FilePath;
+    public uint FilePathLength;
+    public uint Line;
+    public uint Column;
+    public ulong Offset;
+    public IntPtr LineText;
+    public uint LineLength;
+}
+
+[StructLayout(LayoutKind.Sequential)]
+internal unsafe struct NativeStats
+{
+    public const int MaxLanguages = 16;
+
+    public ulong FilesParsed;
+    public ulong BytesParsed;
+    public ulong NodesVisited;
+    public ulong QueryMatches;
+    public ulong SymbolsExtracted;
+    public ulong ParseNs;
+    public ulong ExtractNs;
+    public ulong SerializeNs;
+    public ulong ArenaHighWater;
+    public ulong Errors;
+    public fixed ulong ErrorsByLanguage[MaxLanguages];
+    public ulong Timeouts;
+    public ulong Cancellations;
+    public ulong FilesSkipped;
+    public ulong CacheHits;
+    public ulong CacheMisses;
+    public ulong CacheEvictions;
+    public ulong DiskCacheHits;
+    public ulong DiskCacheMisses;
+    public ulong DiskCacheEvictions;
+}
+
+// CKGParseStatus
+internal static class NativeParseStatus
+{
+    public const uint Ok = 0;
+    public const uint Error = 1;
+    public const uint TimedOut = 2;
+    public const uint Cancelled = 3;
+    public const uint Skipped = 4;
+}
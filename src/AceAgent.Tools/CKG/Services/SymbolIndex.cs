@@ -0,0 +1,156 @@
+using System.Runtime.InteropServices;
+using AceAgent.Tools.CKG.Models;
+
+namespace AceAgent.Tools.CKG.Services;
+
+/// <summary>
+/// A symbol index file mapped read-only (see <see cref="TreeSitterService.OpenSymbolIndex"/>).
+/// Lookups are binary searches over the mapping, so they need no database and
+/// cost the same however large the repository is. Safe to use from any number
+/// of threads until disposed.
+/// </summary>
+public sealed class SymbolIndex : IDisposable
+{
+    private const int ByName = 0;
+    private const int ByFile = 1;
+    private const int ByClass = 2;
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr ckg_index_open([MarshalAs(UnmanagedType.LPUTF8Str)] string path);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void ckg_index_close(IntPtr index);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void ckg_index_get_info(IntPtr index, out uint symbolCount, out uint fileCount);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern uint ckg_index_find(IntPtr index, int order, [MarshalAs(UnmanagedType.LPUTF8Str)] string key, out uint first);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool ckg_index_get(IntPtr index, int order, uint position, out NativeIndexSymbol symbol);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern uint ckg_index_search(IntPtr index, int mode, [MarshalAs(UnmanagedType.LPUTF8Str)] string query, uint maxDistance,
+        [Out] NativeIndexMatch[] matches, uint capacity);
+
+    // ckg_index_search limits (see ckg_wrapper.h)
+    public const int MaxQueryLength = 64;
+    public const int MaxDistance = 3;
+
+    private IntPtr _index;
+
+    private SymbolIndex(IntPtr index, string path)
+    {
+        _index = index;
+        Path = path;
+        ckg_index_get_info(index, out var symbolCount, out var fileCount);
+        SymbolCount = (int)symbolCount;
+        FileCount = (int)fileCount;
+    }
+
+    public string Path { get; }
+    public int SymbolCount { get; }
+    public int FileCount { get; }
+
+    // Null when the file is missing or is not an index
+    internal static SymbolIndex? Open(string path)
+    {
+        var index = ckg_index_open(path);
+        return index == IntPtr.Zero ? null : new SymbolIndex(index, path);
+    }
+
+    /// <summary>
+    /// Symbols named exactly <paramref name="name"/>, grouped by class and file.
+    /// </summary>
+    public IReadOnlyList<IndexedSymbol> FindByName(string name) => Find(ByName, name);
+
+    /// <summary>
+    /// Symbols of one file, by line. The path is matched as it was indexed.
+    /// </summary>
+    public IReadOnlyList<IndexedSymbol> FindInFile(string filePath) => Find(ByFile, filePath);
+
+    /// <summary>
+    /// Members of the classes named <paramref name="className"/>, by name.
+    /// </summary>
+    public IReadOnlyList<IndexedSymbol> FindInClass(string className) => Find(ByClass, className);
+
+    /// <summary>
+    /// The best <paramref name="limit"/> names matching <paramref name="query"/>,
+    /// best first, each with all of its symbols. <paramref name="maxDistance"/>
+    /// applies to <see cref="SymbolSearchMode.Fuzzy"/> and is capped at
+    /// <see cref="MaxDistance"/>. Queries longer than <see cref="MaxQueryLength"/>
+    /// bytes find nothing.
+    /// </summary>
+    public IReadOnlyList<SymbolMatch> Search(string query, SymbolSearchMode mode, int limit = 20, int maxDistance = 2)
+    {
+        ObjectDisposedException.ThrowIf(_index == IntPtr.Zero, this);
+        if (limit <= 0)
+        {
+            return Array.Empty<SymbolMatch>();
+        }
+
+        var matches = new NativeIndexMatch[limit];
+        var found = ckg_index_search(_index, (int)mode, query, (uint)Math.Max(maxDistance, 0), matches, (uint)limit);
+        var results = new List<SymbolMatch>((int)found);
+        for (var i = 0; i < found; i++)
+        {
+            var match = new SymbolMatch
+            {
+                Name = Marshal.PtrToStringUTF8(matches[i].Name, (int)matches[i].NameLength),
+                Mode = mode,
+                Score = (int)matches[i].Score
+            };
+            for (uint position = 0; position < matches[i].Count; position++)
+            {
+                if (ckg_index_get(_index, ByName, matches[i].First + position, out var native))
+                {
+                    match.Symbols.Add(Convert(native));
+                }
+            }
+            results.Add(match);
+        }
+        return results;
+    }
+
+    private IReadOnlyList<IndexedSymbol> Find(int order, string key)
+    {
+        ObjectDisposedException.ThrowIf(_index == IntPtr.Zero, this);
+
+        var count = ckg_index_find(_index, order, key, out var first);
+        var symbols = new List<IndexedSymbol>((int)count);
+        for (uint i = 0; i < count; i++)
+        {
+            if (ckg_index_get(_index, order, first + i, out var native))
+            {
+                symbols.Add(Convert(native));
+            }
+        }
+        return symbols;
+    }
+
+    private static IndexedSymbol Convert(in NativeIndexSymbol native)
+    {
+        var language = (int)native.Language;
+        return new IndexedSymbol
+        {
+            Kind = (IndexedSymbolKind)native.Kind,
+            Name = Marshal.PtrToStringUTF8(native.Name, (int)native.NameLength),
+            ClassName = native.ParentClassLength == 0 ? null : Marshal.PtrToStringUTF8(native.ParentClass, (int)native.ParentClassLength),
+            FilePath = Marshal.PtrToStringUTF8(native.FilePath, (int)native.FilePathLength),
+            Language = language < TreeSitterService.NativeLanguageNames.Length ? TreeSitterService.NativeLanguageNames[language] : "unknown",
+            StartLine = (int)native.StartLine,
+            EndLine = (int)native.EndLine
+        };
+    }
+
+    public void Dispose()
+    {
+        if (_index != IntPtr.Zero)
+        {
+            ckg_index_close(_index);
+            _index = IntPtr.Zero;
+        }
+    }
+}
@@ -0,0 +1,360 @@
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Text.RegularExpressions;
+using AceAgent.Tools.CKG.Models;
+
+namespace AceAgent.Tools.CKG.Services;
+
+/// <summary>
+/// A text index file mapped read-only (see <see cref="TreeSitterService.OpenTextIndex"/>).
+/// Searches look up the trigrams of a literal to find the few files that can
+/// contain it and read only those. Safe to use from any number of threads
+/// until disposed.
+/// </summary>
+public sealed class TextIndex : IDisposable
+{
+    // ckg_text_index_search flags (see ckg_wrapper.h)
+    private const uint IgnoreCaseFlag = 1;
+    private const uint FilesOnlyFlag = 2;
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr ckg_text_index_open([MarshalAs(UnmanagedType.LPUTF8Str)] string path);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void ckg_text_index_close(IntPtr index);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void ckg_text_index_get_info(IntPtr index, out uint fileCount, out uint trigramCount);
+
+    [DllImport(TreeSitterService.LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int ckg_text_index_search(IntPtr index, [MarshalAs(UnmanagedType.LPUTF8Str)] string pattern, uint flags, uint maxMatches,
+        MatchCallback callback, IntPtr userData);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private delegate bool MatchCallback(IntPtr userData, IntPtr match);
+
+    // Inline options such as (?i) or (?x:...); x makes whitespace and # special
+    private static readonly Regex InlineOptions = new(@"\(\?[imnsx-]+[:)]", RegexOptions.Compiled);
+    private static readonly Regex InlineWhitespaceOption = new(@"\(\?[imns-]*x[imnsx-]*[:)]", RegexOptions.Compiled);
+
+    private IntPtr _index;
+
+    private TextIndex(IntPtr index, string path)
+    {
+        _index = index;
+        Path = path;
+        ckg_text_index_get_info(index, out var fileCount, out var trigramCount);
+        FileCount = (int)fileCount;
+        TrigramCount = (int)trigramCount;
+    }
+
+    public string Path { get; }
+    public int FileCount { get; }
+    public int TrigramCount { get; }
+
+    // Null when the file is missing or is not an index
+    internal static TextIndex? Open(string path)
+    {
+        var index = ckg_text_index_open(path);
+        return index == IntPtr.Zero ? null : new TextIndex(index, path);
+    }
+
+    /// <summary>
+    /// The first <paramref name="limit"/> lines containing
+    /// <paramref name="literal"/>, files in path order. <paramref name="ignoreCase"/>
+    /// folds ASCII letters only.
+    /// </summary>
+    public IReadOnlyList<TextMatch> Search(string literal, bool ignoreCase = false, int limit = 100)
+    {
+        ObjectDisposedException.ThrowIf(_index == IntPtr.Zero, this);
+        if (string.IsNullOrEmpty(literal) || limit <= 0)
+        {
+            return Array.Empty<TextMatch>();
+        }
+
+        var matches = new List<TextMatch>();
+        MatchCallback callback = (_, matchPtr) =>
+        {
+            var native = Marshal.PtrToStructure<NativeTextMatch>(matchPtr);
+            // The native column counts bytes; count characters instead
+            var before = Marshal.PtrToStringUTF8(native.LineText, (int)native.Column - 1);
+            matches.Add(new TextMatch
+            {
+                FilePath = Marshal.PtrToStringUTF8(native.FilePath, (int)native.FilePathLength),
+                Line = (int)native.Line,
+                Column = before.Length + 1,
+                LineText = Marshal.PtrToStringUTF8(native.LineText, (int)native.LineLength)
+            });
+            return true;
+        };
+        ckg_text_index_search(_index, literal, ignoreCase ? IgnoreCaseFlag : 0, (uint)limit, callback, IntPtr.Zero);
+        GC.KeepAlive(callback);
+        return matches;
+    }
+
+    /// <summary>
+    /// The first <paramref name="limit"/> lines matching <paramref name="regex"/>,
+    /// files in path order. Only files containing the longest literal the
+    /// pattern requires are read, so a pattern with none (such as one with a
+    /// top-level alternation) reads every indexed file. Matches cannot span
+    /// lines.
+    /// </summary>
+    public IReadOnlyList<TextMatch> SearchRegex(Regex regex, int limit = 100)
+    {
+        ObjectDisposedException.ThrowIf(_index == IntPtr.Zero, this);
+        if (limit <= 0)
+        {
+            return Array.Empty<TextMatch>();
+        }
+
+        var literal = RequiredLiteral(regex, out var ignoreCase);
+        var files = new List<string>();
+        MatchCallback callback = (_, matchPtr) =>
+        {
+            var native = Marshal.PtrToStructure<NativeTextMatch>(matchPtr);
+            files.Add(Marshal.PtrToStringUTF8(native.FilePath, (int)native.FilePathLength));
+            return true;
+        };
+        ckg_text_index_search(_index, literal, FilesOnlyFlag | (ignoreCase ? IgnoreCaseFlag : 0), 0, callback, IntPtr.Zero);
+        GC.KeepAlive(callback);
+
+        var matches = new List<TextMatch>();
+        foreach (var file in files)
+        {
+            try
+            {
+                var number = 0;
+                foreach (var line in File.ReadLines(file))
+                {
+                    number++;
+                    var match = regex.Match(line);
+                    if (!match.Success)
+                    {
+                        continue;
+                    }
+                    matches.Add(new TextMatch { FilePath = file, Line = number, Column = match.Index + 1, LineText = line });
+                    if (matches.Count >= limit)
+                    {
+                        return matches;
+                    }
+                }
+            }
+            catch (IOException)
+            {
+                // Deleted or locked since the index was written
+            }
+            catch (UnauthorizedAccessException)
+            {
+            }
+        }
+        return matches;
+    }
+
+    /// <summary>
+    /// The longest run of characters every match of <paramref name="regex"/>
+    /// contains, or "" when none can be found. Conservative: anything not
+    /// plainly literal ends a run. <paramref name="ignoreCase"/> tells whether
+    /// the run must be searched for ignoring case.
+    /// </summary>
+    internal static string RequiredLiteral(Regex regex, out bool ignoreCase)
+    {
+        var pattern = regex.ToString();
+        var folded = (regex.Options & RegexOptions.IgnoreCase) != 0 || InlineOptions.IsMatch(pattern);
+        ignoreCase = folded;
+        if ((regex.Options & RegexOptions.IgnorePatternWhitespace) != 0 || InlineWhitespaceOption.IsMatch(pattern))
+        {
+            return string.Empty;
+        }
+
+        var best = string.Empty;
+        var run = new StringBuilder();
+        var depth = 0;
+
+        void EndRun()
+        {
+            if (run.Length > best.Length)
+            {
+                best = run.ToString();
+            }
+            run.Clear();
+        }
+
+        for (var i = 0; i < pattern.Length; i++)
+        {
+            var c = pattern[i];
+            switch (c)
+            {
+                case '\\' when i + 1 < pattern.Length:
+                    var escaped = pattern[++i];
+                    if (!char.IsLetterOrDigit(escaped))
+                    {
+                        if (depth == 0)
+                        {
+                            AddLiteral(escaped);
+                        }
+                        break;
+                    }
+                    // Classes (\d), anchors (\b), backreferences and character
+                    // codes: skip the escape's arguments too
+                    EndRun();
+                    i = SkipEscape(pattern, i);
+                    break;
+                case '[':
+                    EndRun();
+                    i = SkipClass(pattern, i);
+                    break;
+                case '(':
+                    EndRun();
+                    depth++;
+                    break;
+                case ')':
+                    EndRun();
+                    depth = Math.Max(depth - 1, 0);
+                    break;
+                case '|':
+                    if (depth == 0)
+                    {
+                        return string.Empty;
+                    }
+                    break;
+                case '*' or '?' or '{':
+                    // The quantified character may be absent
+                    if (run.Length > 0)
+                    {
+                        run.Length--;
+                    }
+                    EndRun();
+                    if (c == '{')
+                    {
+                        var close = pattern.IndexOf('}', i);
+                        i = close < 0 ? pattern.Length : close;
+                    }
+                    i = SkipLazy(pattern, i);
+                    break;
+                case '+':
+                {
+                    // At least one of the character is required, so it both
+                    // ends this run and starts the next
+                    var last = run.Length > 0 ? run[^1] : '\0';
+                    EndRun();
+                    if (last != '\0')
+                    {
+                        run.Append(last);
+                    }
+                    i = SkipLazy(pattern, i);
+                    break;
+                }
+                case '.' or '^' or '$':
+                    EndRun();
+                    break;
+                default:
+                    if (depth == 0)
+                    {
+                        AddLiteral(c);
+                    }
+                    break;
+            }
+        }
+        EndRun();
+        return best;
+
+        void AddLiteral(char literal)
+        {
+            // The native search folds ASCII letters only, and .NET also
+            // matches k, s and i to non-ASCII letters (the Kelvin sign, long s,
+            // dotted I) under some cultures
+            if (folded && (literal > 0x7F || "iIkKsS".Contains(literal)))
+            {
+                EndRun();
+                return;
+            }
+            run.Append(literal);
+        }
+    }
+
+    // Index of the last character of the escape whose letter is at `i`
+    private static int SkipEscape(string pattern, int i)
+    {
+        switch (pattern[i])
+        {
+            case 'x':
+                return Math.Min(i + 2, pattern.Length - 1);
+            case 'u':
+                return Math.Min(i + 4, pattern.Length - 1);
+            case 'c':
+                return Math.Min(i + 1, pattern.Length - 1);
+            case 'p' or 'P':
+                var brace = pattern.IndexOf('}', i);
+                return brace < 0 ? pattern.Length - 1 : brace;
+            case 'k' when i + 1 < pattern.Length && (pattern[i + 1] == '<' || pattern[i + 1] == '\''):
+                var end = pattern.IndexOfAny(new[] { '>', '\'' }, i + 2);
+                return end < 0 ? pattern.Length - 1 : end;
+            case >= '0' and <= '9':
+                while (i + 1 < pattern.Length && char.IsAsciiDigit(pattern[i + 1]))
+                {
+                    i++;
+                }
+                return i;
+            default:
+                return i;
+        }
+    }
+
+    // Index of the ']' closing the class opened at `i`, past any subtracted
+    // classes ([a-z-[aeiou]])
+    private static int SkipClass(string pattern, int i)
+    {
+        var nesting = 0;
+        while (i < pattern.Length)
+        {
+            i++;
+            if (i < pattern.Length && pattern[i] == '^')
+            {
+                i++;
+            }
+            // A leading ']' is a member, not the end
+            if (i < pattern.Length && pattern[i] == ']')
+            {
+                i++;
+            }
+            for (; i < pattern.Length; i++)
+            {
+                if (pattern[i] == '\\')
+                {
+                    i++;
+                }
+                else if (pattern[i] == '-' && i + 1 < pattern.Length && pattern[i + 1] == '[')
+                {
+                    nesting++;
+                    i++;
+                    break;
+                }
+                else if (pattern[i] == ']')
+                {
+                    if (nesting == 0)
+                    {
+                        return i;
+                    }
+                    nesting--;
+                }
+            }
+        }
+        return pattern.Length - 1;
+    }
+
+    // Steps over a lazy quantifier's '?' after the quantifier at `i`
+    private static int SkipLazy(string pattern, int i)
+    {
+        return i + 1 < pattern.Length && pattern[i + 1] == '?' ? i + 1 : i;
+    }
+
+    public void Dispose()
+    {
+        if (_index != IntPtr.Zero)
+        {
+            ckg_text_index_close(_index);
+            _index = IntPtr.Zero;
+        }
+    }
+}
@@ -1,6 +1,10 @@
 using Microsoft.Extensions.Logging;
+using System.Buffers.Binary;
+using System.Collections.Concurrent;
+using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
-using System.Text.Json;
+using System.Text;
+using System.Threading.Channels;
 using AceAgent.Tools.CKG.Models;
 using System.Reflection;
 
@@ -13,7 +17,7 @@ public class TreeSitterService : IDisposable
     private bool _disposed;
 
     // Native library imports
-    private const string LibraryName = "ckg_wrapper";
+    internal const string LibraryName = "ckg_wrapper";
     
     static TreeSitterService()
     {
@@ -120,13 +124,252 @@ public class TreeSitterService : IDisposable
         [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
         private static extern void ckg_cleanup();
 
-        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-        private static extern IntPtr ckg_parse_json(IntPtr parser, string source_code, string language, string file_path);
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe IntPtr ckg_parse_utf16(IntPtr context, int language, char* source_code, uint length, out uint size);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_free_binary(IntPtr buffer);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr ckg_context_create();
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_context_destroy(IntPtr context);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_context_set_timeout(IntPtr context, ulong timeout_micros);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_context_cancel(IntPtr context);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_context_reset_cancel(IntPtr context);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_context_set_size_policy(IntPtr context, ref NativeSizePolicy policy);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr ckg_parse_file(IntPtr context, int language, [MarshalAs(UnmanagedType.LPUTF8Str)] string path, out uint size);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int ckg_parse_batch([MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPUTF8Str)] string[] file_paths, uint count,
+            ref NativeBatchOptions options, [Out] IntPtr[] results_out);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_free_result(IntPtr result);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_get_stats(out NativeStats stats);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_reset_stats();
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_cache_set_budget(ulong budget_bytes);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_cache_get_usage(out ulong bytes, out uint entries);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int ckg_disk_cache_set_directory([MarshalAs(UnmanagedType.LPUTF8Str)] string? directory, ulong budget_bytes);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_disk_cache_clear();
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern void ckg_disk_cache_get_usage(out ulong bytes, out uint entries);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe IntPtr ckg_open_document(IntPtr context, uint file_id, int language, byte* source_code, uint length, out uint size);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe IntPtr ckg_apply_edit(IntPtr context, uint file_id, uint start_byte, uint old_end_byte, uint new_end_byte, byte* new_source, uint new_length, out uint size);
 
         [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
-        private static extern void ckg_free_json_result(IntPtr json_result);
+        private static extern void ckg_close_document(IntPtr context, uint file_id);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        private delegate bool IndexCallback(IntPtr userData, IntPtr filePath, int language, IntPtr result);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.U1)]
+        private delegate bool FileCallback(IntPtr userData, IntPtr file, int state);
+
+        [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int ckg_index_directory([MarshalAs(UnmanagedType.LPUTF8Str)] string root,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPUTF8Str)] string?[]? include_exts,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.LPUTF8Str)] string?[]? ignore_globs,
+            ref NativeIndexOptions options, IndexCallback callback, IntPtr user_data);
+
+    // ckg_parse_binary format constants (see ckg_wrapper.h)
+    private const uint BinaryMagic = 0x42474B43; // "CKGB"
+    private const ushort BinaryVersion = 2;
+    private const int BinaryHeaderSize = 40;
+
+    // ckg_apply_edit format constants (see ckg_wrapper.h)
+    private const uint EditMagic = 0x45474B43; // "CKGE"
+    private const ushort EditVersion = 1;
+    private const int EditHeaderSize = 40;
+
+    private const string SkippedMessage = "File skipped by size policy";
+
+    // Language names indexed by the native CKGLanguage enum
+    internal static readonly string[] NativeLanguageNames =
+    {
+        "c", "cpp", "csharp", "java", "javascript", "typescript", "python", "go", "rust", "lua", "php"
+    };
+
+    // Native parsing contexts. Each context owns its own parser, so parses that
+    // rent different contexts can run in parallel.
+    private readonly ConcurrentBag<IntPtr> _contextPool = new();
+    // Orders returns against Dispose draining the pool
+    private readonly object _contextPoolLock = new();
+    private readonly int _maxPooledContexts = Environment.ProcessorCount;
+
+    // Documents kept open for incremental reparsing, all in one native
+    // context, which the lock serialises
+    private sealed class OpenDocument
+    {
+        public uint Id;
+        public int Language;
+        // The text the native document holds, as the caller passed it and as
+        // UTF-8, so that an edit only encodes its replacement
+        public string Content = string.Empty;
+        public byte[] Source = Array.Empty<byte>();
+        public long LastUsed;
+    }
 
-    private IntPtr _parser;
+    private readonly object _documentLock = new();
+    private readonly Dictionary<string, OpenDocument> _documents = new();
+    private IntPtr _documentContext;
+    private uint _nextDocumentId;
+    private long _documentClock;
+
+    /// <summary>
+    /// How many edited files keep their syntax trees for incremental reparsing;
+    /// the least recently edited is closed to make room.
+    /// </summary>
+    public int MaxOpenDocuments { get; set; } = 32;
+
+    /// <summary>
+    /// Wall-time budget for parsing one file, so a pathological file cannot
+    /// stall indexing. Files that run out of time produce partial results.
+    /// <see cref="TimeSpan.Zero"/> removes the limit.
+    /// </summary>
+    public TimeSpan ParseTimeout { get; set; } = TimeSpan.FromSeconds(10);
+
+    private ulong ParseTimeoutMicros => ParseTimeout > TimeSpan.Zero ? (ulong)(ParseTimeout.Ticks / 10) : 0;
+
+    /// <summary>
+    /// Files larger than this many bytes only have their top-level and member
+    /// declarations extracted. 0 disables the limit.
+    /// </summary>
+    public long DeclarationsOnlyAboveBytes { get; set; } = 8L * 1024 * 1024;
+
+    /// <summary>
+    /// Files larger than this many bytes are not parsed at all. 0 disables the limit.
+    /// </summary>
+    public long SkipAboveBytes { get; set; } = 128L * 1024 * 1024;
+
+    private long _treeCacheBytes = 64L * 1024 * 1024;
+
+    /// <summary>
+    /// Memory budget of the native tree cache, which lets unchanged source be
+    /// re-analysed without parsing it again. The cache is shared by the whole
+    /// process; 0 turns it off.
+    /// </summary>
+    public long TreeCacheBytes
+    {
+        get => _treeCacheBytes;
+        set
+        {
+            _treeCacheBytes = Math.Max(value, 0);
+            if (_isInitialized)
+            {
+                ckg_cache_set_budget((ulong)_treeCacheBytes);
+            }
+        }
+    }
+
+    private string? _parseCacheDirectory = Path.Combine(
+        Environment.GetFolderPath(Environment.SpecialFolder.UserProfile), ".aceagent", "parse-cache");
+    private long _parseCacheBytes = 256L * 1024 * 1024;
+
+    /// <summary>
+    /// Directory of the native on-disk parse cache, which keeps the symbols of
+    /// parsed files by content hash so that other processes, databases,
+    /// branches and clones can skip parsing identical files. Shared by the
+    /// whole process; null or empty turns it off.
+    /// </summary>
+    public string? ParseCacheDirectory
+    {
+        get => _parseCacheDirectory;
+        set
+        {
+            _parseCacheDirectory = value;
+            if (_isInitialized)
+            {
+                ApplyParseCache();
+            }
+        }
+    }
+
+    /// <summary>
+    /// Size limit of the on-disk parse cache; the least recently used entries
+    /// are deleted beyond it. 0 turns the cache off.
+    /// </summary>
+    public long ParseCacheBytes
+    {
+        get => _parseCacheBytes;
+        set
+        {
+            _parseCacheBytes = Math.Max(value, 0);
+            if (_isInitialized)
+            {
+                ApplyParseCache();
+            }
+        }
+    }
+
+    private void ApplyParseCache()
+    {
+        var directory = string.IsNullOrEmpty(_parseCacheDirectory) || _parseCacheBytes == 0 ? null : _parseCacheDirectory;
+        try
+        {
+            if (directory != null)
+            {
+                Directory.CreateDirectory(directory);
+            }
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            _logger.LogWarning(ex, "Cannot create parse cache directory {Directory}", directory);
+            directory = null;
+        }
+        if (ckg_disk_cache_set_directory(directory, (ulong)_parseCacheBytes) != 0)
+        {
+            _logger.LogWarning("Parse cache disabled: cannot use {Directory}", directory);
+            ckg_disk_cache_set_directory(null, 0);
+        }
+    }
+
+    /// <summary>
+    /// Delete every entry of the on-disk parse cache.
+    /// </summary>
+    public void ClearParseCache()
+    {
+        if (_isInitialized)
+        {
+            ckg_disk_cache_clear();
+        }
+    }
+
+    private NativeSizePolicy SizePolicy => new()
+    {
+        DeclarationsOnlyAbove = (ulong)Math.Max(DeclarationsOnlyAboveBytes, 0),
+        SkipAbove = (ulong)Math.Max(SkipAboveBytes, 0)
+    };
 
     public TreeSitterService(ILogger<TreeSitterService> logger)
     {
@@ -140,10 +383,11 @@ public class TreeSitterService : IDisposable
         {
             int result = ckg_init();
             _isInitialized = result == 1;
-            _parser = IntPtr.Zero; // We don't need to store parser pointer as it's managed internally
             
             if (_isInitialized)
             {
+                ckg_cache_set_budget((ulong)_treeCacheBytes);
+                ApplyParseCache();
                 _logger.LogInformation("Tree-sitter service initialized successfully");
             }
             else
@@ -160,12 +404,16 @@ public class TreeSitterService : IDisposable
         }
     }
 
-    public async Task<ParseResult> ParseCodeAsync(string sourceCode, string language, string filePath)
+    public async Task<ParseResult> ParseCodeAsync(string sourceCode, string language, string filePath, CancellationToken cancellationToken = default)
     {
-        return await Task.Run(() => ParseCode(sourceCode, language, filePath));
+        return await Task.Run(() => ParseCode(sourceCode, language, filePath, cancellationToken), cancellationToken);
     }
 
-    public ParseResult ParseCode(string sourceCode, string language, string filePath)
+    /// <summary>
+    /// Parses source code with the native parser. Cancelling the token stops the
+    /// parse in progress, which then returns a partial result.
+    /// </summary>
+    public ParseResult ParseCode(string sourceCode, string language, string filePath, CancellationToken cancellationToken = default)
     {
         if (!_isInitialized)
         {
@@ -182,14 +430,77 @@ public class TreeSitterService : IDisposable
             return ParseResult.Failure(filePath, language, $"Unsupported language: {language}");
         }
 
+        _logger.LogInformation("Calling native parser for file: {FilePath}, language: {Language}", filePath, language);
+        _logger.LogInformation("Source code length: {Length} characters", sourceCode.Length);
+        _logger.LogInformation("Source code preview: {Preview}", sourceCode.Length > 100 ? sourceCode.Substring(0, 100) + "..." : sourceCode);
+
+        // The string is pinned and parsed as UTF-16 in place: no transcoded copy
+        return ParseWithContext(filePath, language, cancellationToken, (IntPtr context, int nativeLanguage, out uint size) =>
+        {
+            unsafe
+            {
+                fixed (char* sourcePtr = sourceCode)
+                {
+                    return ckg_parse_utf16(context, nativeLanguage, sourcePtr, (uint)sourceCode.Length, out size);
+                }
+            }
+        });
+    }
+
+    public async Task<ParseResult> ParseFileAsync(string filePath, string language, CancellationToken cancellationToken = default)
+    {
+        return await Task.Run(() => ParseFile(filePath, language, cancellationToken), cancellationToken);
+    }
+
+    /// <summary>
+    /// Parses a file without loading it as a string: the native parser maps the
+    /// file, detects UTF-8 (with or without a BOM), UTF-16 or legacy 8-bit text,
+    /// and transcodes to UTF-8 only when the file is not UTF-8 already.
+    /// </summary>
+    public ParseResult ParseFile(string filePath, string language, CancellationToken cancellationToken = default)
+    {
+        if (!_isInitialized)
+        {
+            return ParseResult.Failure(filePath, language, "Tree-sitter service not initialized");
+        }
+
+        if (!IsSupportedLanguage(language))
+        {
+            return ParseResult.Failure(filePath, language, $"Unsupported language: {language}");
+        }
+
+        return ParseWithContext(filePath, language, cancellationToken, (IntPtr context, int nativeLanguage, out uint size) =>
+            ckg_parse_file(context, nativeLanguage, filePath, out size));
+    }
+
+    private delegate IntPtr NativeBinaryParse(IntPtr context, int nativeLanguage, out uint size);
+
+    // Runs one ckg_parse_binary-format parse on a pooled context set up with the
+    // service's limits, with the token wired to native cancellation
+    private ParseResult ParseWithContext(string filePath, string language, CancellationToken cancellationToken, NativeBinaryParse parse)
+    {
+        var context = RentContext();
+        if (context == IntPtr.Zero)
+        {
+            return ParseResult.Failure(filePath, language, "Failed to create native parsing context");
+        }
+
+        var nativeLanguage = Array.IndexOf(NativeLanguageNames, language.ToLowerInvariant());
         try
         {
-            _logger.LogInformation("Calling native parser for file: {FilePath}, language: {Language}", filePath, language);
-            _logger.LogInformation("Source code length: {Length} characters", sourceCode.Length);
-            _logger.LogInformation("Source code preview: {Preview}", sourceCode.Length > 100 ? sourceCode.Substring(0, 100) + "..." : sourceCode);
-            
-            var resultPtr = ckg_parse_json(_parser, sourceCode, language, filePath);
-            
+            IntPtr resultPtr;
+            uint resultSize;
+            ckg_context_reset_cancel(context);
+            ckg_context_set_timeout(context, ParseTimeoutMicros);
+            var policy = SizePolicy;
+            ckg_context_set_size_policy(context, ref policy);
+            // Disposing the registration waits out a running callback, so the
+            // context never goes back to the pool with a cancel still arriving
+            using (cancellationToken.Register(() => ckg_context_cancel(context)))
+            {
+                resultPtr = parse(context, nativeLanguage, out resultSize);
+            }
+
             if (resultPtr == IntPtr.Zero)
             {
                 _logger.LogWarning("Native parser returned null for file: {FilePath}", filePath);
@@ -198,21 +509,14 @@ public class TreeSitterService : IDisposable
 
             try
             {
-                var jsonResult = Marshal.PtrToStringAnsi(resultPtr);
-                
-                _logger.LogInformation("Native parser returned JSON: {JsonResult}", jsonResult ?? "null");
-                
-                if (string.IsNullOrEmpty(jsonResult))
+                unsafe
                 {
-                    return ParseResult.Failure(filePath, language, "Empty result from native parser");
+                    return ConvertBinaryResult(new ReadOnlySpan<byte>((void*)resultPtr, (int)resultSize), filePath, language);
                 }
-
-                var parseResult = ConvertJsonToParseResult(jsonResult, filePath, language);
-                return parseResult;
             }
             finally
             {
-                ckg_free_json_result(resultPtr);
+                ckg_free_binary(resultPtr);
             }
         }
         catch (Exception ex)
@@ -220,95 +524,815 @@ public class TreeSitterService : IDisposable
             _logger.LogError(ex, "Error parsing code for file: {FilePath}", filePath);
             return ParseResult.Failure(filePath, language, $"Parse error: {ex.Message}");
         }
+        finally
+        {
+            ReturnContext(context);
+        }
     }
 
-    private ParseResult ConvertJsonToParseResult(string jsonResult, string filePath, string language)
+    public async Task<SymbolDiff> ApplyEditAsync(string filePath, string language, string oldContent, string newContent, TextEdit edit,
+        CancellationToken cancellationToken = default)
     {
-        try
+        return await Task.Run(() => ApplyEdit(filePath, language, oldContent, newContent, edit, cancellationToken), cancellationToken);
+    }
+
+    /// <summary>
+    /// Reparses a file incrementally after its text changed from
+    /// <paramref name="oldContent"/> to <paramref name="newContent"/> within
+    /// <paramref name="edit"/>, and reports how its symbols changed. The file's
+    /// syntax tree and text are kept between edits, so only the edited range is
+    /// encoded and parsed again. A failed diff means the file should be parsed
+    /// in full instead.
+    /// </summary>
+    public SymbolDiff ApplyEdit(string filePath, string language, string oldContent, string newContent, TextEdit edit,
+        CancellationToken cancellationToken = default)
+    {
+        if (!_isInitialized)
         {
-            var result = ParseResult.Success(filePath, language);
-            
-            // Parse JSON result from native library
-            using var document = JsonDocument.Parse(jsonResult);
-            var root = document.RootElement;
+            return SymbolDiff.Failure(filePath, language, "Tree-sitter service not initialized");
+        }
+
+        if (!IsSupportedLanguage(language))
+        {
+            return SymbolDiff.Failure(filePath, language, $"Unsupported language: {language}");
+        }
 
-            if (root.TryGetProperty("functions", out var functionsElement))
+        if (!edit.TryAlign(oldContent, newContent, out var aligned))
+        {
+            return SymbolDiff.Failure(filePath, language, "Edit does not match the content");
+        }
+        edit = aligned;
+
+        var nativeLanguage = Array.IndexOf(NativeLanguageNames, language.ToLowerInvariant());
+
+        lock (_documentLock)
+        {
+            if (_documentContext == IntPtr.Zero)
             {
-                foreach (var funcElement in functionsElement.EnumerateArray())
+                _documentContext = ckg_context_create();
+                if (_documentContext == IntPtr.Zero)
                 {
-                    var function = new Function
-                    {
-                        Name = GetStringProperty(funcElement, "name"),
-                        FilePath = filePath,
-                        StartLine = GetIntProperty(funcElement, "start_line"),
-                        EndLine = GetIntProperty(funcElement, "end_line"),
-                        ReturnType = GetStringProperty(funcElement, "return_type"),
-                        Parameters = GetStringProperty(funcElement, "parameters"),
-                        Modifiers = GetStringProperty(funcElement, "modifiers"),
-                        ClassName = GetStringProperty(funcElement, "class_name"),
-                        Namespace = GetStringProperty(funcElement, "namespace"),
-                        IsStatic = GetBoolProperty(funcElement, "is_static"),
-                        IsPublic = GetBoolProperty(funcElement, "is_public"),
-                        IsPrivate = GetBoolProperty(funcElement, "is_private"),
-                        IsProtected = GetBoolProperty(funcElement, "is_protected"),
-                        Documentation = GetStringProperty(funcElement, "documentation")
-                    };
-                    result.Functions.Add(function);
+                    return SymbolDiff.Failure(filePath, language, "Failed to create native parsing context");
                 }
             }
 
-            if (root.TryGetProperty("classes", out var classesElement))
+            try
             {
-                foreach (var classElement in classesElement.EnumerateArray())
+                ckg_context_reset_cancel(_documentContext);
+                ckg_context_set_timeout(_documentContext, ParseTimeoutMicros);
+                var policy = SizePolicy;
+                ckg_context_set_size_policy(_documentContext, ref policy);
+                using (cancellationToken.Register(() => ckg_context_cancel(_documentContext)))
                 {
-                    var cls = new Class
+                    var document = OpenDocumentLocked(filePath, nativeLanguage, oldContent);
+                    if (document == null)
+                    {
+                        return SymbolDiff.Failure(filePath, language, "Document could not be parsed in full");
+                    }
+
+                    // The new UTF-8 text is the old one with only the replacement encoded
+                    var start = Encoding.UTF8.GetByteCount(oldContent.AsSpan(0, edit.Start));
+                    var oldEnd = start + Encoding.UTF8.GetByteCount(oldContent.AsSpan(edit.Start, edit.OldEnd - edit.Start));
+                    var replacement = newContent.AsSpan(edit.Start, edit.NewEnd - edit.Start);
+                    var newEnd = start + Encoding.UTF8.GetByteCount(replacement);
+                    var newBytes = new byte[document.Source.Length - oldEnd + newEnd];
+                    document.Source.AsSpan(0, start).CopyTo(newBytes);
+                    Encoding.UTF8.GetBytes(replacement, newBytes.AsSpan(start));
+                    document.Source.AsSpan(oldEnd).CopyTo(newBytes.AsSpan(newEnd));
+
+                    IntPtr resultPtr;
+                    uint resultSize;
+                    unsafe
                     {
-                        Name = GetStringProperty(classElement, "name"),
-                        FilePath = filePath,
-                        StartLine = GetIntProperty(classElement, "start_line"),
-                        EndLine = GetIntProperty(classElement, "end_line"),
-                        Namespace = GetStringProperty(classElement, "namespace"),
-                        Modifiers = GetStringProperty(classElement, "modifiers"),
-                        BaseClass = GetStringProperty(classElement, "base_class"),
-                        Interfaces = GetStringProperty(classElement, "interfaces"),
-                        IsStatic = GetBoolProperty(classElement, "is_static"),
-                        IsAbstract = GetBoolProperty(classElement, "is_abstract"),
-                        IsSealed = GetBoolProperty(classElement, "is_sealed"),
-                        IsPublic = GetBoolProperty(classElement, "is_public"),
-                        Documentation = GetStringProperty(classElement, "documentation")
-                    };
-                    result.Classes.Add(cls);
+                        fixed (byte* source = newBytes)
+                        {
+                            resultPtr = ckg_apply_edit(_documentContext, document.Id, (uint)start, (uint)oldEnd, (uint)newEnd,
+                                source, (uint)newBytes.Length, out resultSize);
+                        }
+                    }
+
+                    if (resultPtr == IntPtr.Zero)
+                    {
+                        _documents.Remove(filePath);
+                        ckg_close_document(_documentContext, document.Id);
+                        return SymbolDiff.Failure(filePath, language, "Native incremental parsing failed");
+                    }
+
+                    try
+                    {
+                        SymbolDiff diff;
+                        unsafe
+                        {
+                            diff = ConvertEditResult(new ReadOnlySpan<byte>((void*)resultPtr, (int)resultSize), filePath, language);
+                        }
+
+                        if (diff.IsSuccess)
+                        {
+                            document.Content = newContent;
+                            document.Source = newBytes;
+                        }
+                        else
+                        {
+                            // The native side has closed the document
+                            _documents.Remove(filePath);
+                        }
+                        return diff;
+                    }
+                    finally
+                    {
+                        ckg_free_binary(resultPtr);
+                    }
                 }
             }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error reparsing edited file: {FilePath}", filePath);
+                return SymbolDiff.Failure(filePath, language, $"Parse error: {ex.Message}");
+            }
+        }
+    }
 
-            // Add similar parsing for Properties, Fields, and Variables...
-            
-            return result;
+    /// <summary>
+    /// Releases the syntax tree kept for a file's incremental reparsing.
+    /// </summary>
+    public void CloseDocument(string filePath)
+    {
+        lock (_documentLock)
+        {
+            if (_documents.Remove(filePath, out var document))
+            {
+                ckg_close_document(_documentContext, document.Id);
+            }
+        }
+    }
+
+    // The open document for a file whose text is `content`, opened (again) if
+    // it is not open with that text and language. Null if the text does not
+    // parse completely.
+    private OpenDocument? OpenDocumentLocked(string filePath, int nativeLanguage, string content)
+    {
+        // Compared in full: a hash collision would diff against the wrong text
+        if (_documents.TryGetValue(filePath, out var document) &&
+            document.Language == nativeLanguage && string.Equals(document.Content, content, StringComparison.Ordinal))
+        {
+            document.LastUsed = ++_documentClock;
+            return document;
+        }
+
+        if (document == null)
+        {
+            if (_documents.Count >= Math.Max(MaxOpenDocuments, 1))
+            {
+                var oldest = _documents.MinBy(entry => entry.Value.LastUsed);
+                _documents.Remove(oldest.Key);
+                ckg_close_document(_documentContext, oldest.Value.Id);
+            }
+            document = new OpenDocument { Id = ++_nextDocumentId };
+            _documents[filePath] = document;
+        }
+        var bytes = Encoding.UTF8.GetBytes(content);
+        document.Language = nativeLanguage;
+        document.Content = content;
+        document.Source = bytes;
+        document.LastUsed = ++_documentClock;
+
+        IntPtr resultPtr;
+        uint status = NativeParseStatus.Error;
+        unsafe
+        {
+            fixed (byte* source = bytes)
+            {
+                resultPtr = ckg_open_document(_documentContext, document.Id, nativeLanguage, source, (uint)bytes.Length, out var resultSize);
+            }
+        }
+        if (resultPtr != IntPtr.Zero)
+        {
+            unsafe
+            {
+                status = BinaryPrimitives.ReadUInt32LittleEndian(new ReadOnlySpan<byte>((void*)resultPtr, BinaryHeaderSize).Slice(8));
+            }
+            ckg_free_binary(resultPtr);
+        }
+
+        if (status != NativeParseStatus.Ok)
+        {
+            _documents.Remove(filePath);
+            return null;
+        }
+        return document;
+    }
+
+    public async Task<IReadOnlyList<ParseResult>> ParseFilesAsync(IReadOnlyList<(string FilePath, string Language)> files, int threadCount = 0)
+    {
+        return await Task.Run(() => ParseFiles(files, threadCount));
+    }
+
+    /// <summary>
+    /// Parses a set of files in a single native call. The native library reads
+    /// the files itself and spreads them across a work-stealing thread pool,
+    /// largest files first.
+    /// </summary>
+    public IReadOnlyList<ParseResult> ParseFiles(IReadOnlyList<(string FilePath, string Language)> files, int threadCount = 0)
+    {
+        var results = new List<ParseResult>(files.Count);
+        if (!_isInitialized)
+        {
+            results.AddRange(files.Select(f => ParseResult.Failure(f.FilePath, f.Language, "Tree-sitter service not initialized")));
+            return results;
+        }
+
+        if (files.Count == 0)
+        {
+            return results;
+        }
+
+        var paths = files.Select(f => f.FilePath).ToArray();
+        var nativeResults = new IntPtr[paths.Length];
+        var options = new NativeBatchOptions
+        {
+            ThreadCount = (uint)Math.Max(threadCount, 0),
+            TimeoutMicros = ParseTimeoutMicros,
+            SizePolicy = SizePolicy
+        };
+
+        try
+        {
+            var parsed = ckg_parse_batch(paths, (uint)paths.Length, ref options, nativeResults);
+            _logger.LogInformation("Native batch parsed {Parsed}/{Total} files", parsed, paths.Length);
+
+            for (var i = 0; i < files.Count; i++)
+            {
+                results.Add(ConvertNativeResult(nativeResults[i], files[i].FilePath, files[i].Language));
+            }
         }
         catch (Exception ex)
         {
-            _logger.LogError(ex, "Error converting JSON result to ParseResult");
-            return ParseResult.Failure(filePath, language, $"JSON conversion error: {ex.Message}");
+            _logger.LogError(ex, "Error parsing batch of {Count} files", files.Count);
+            results.Clear();
+            results.AddRange(files.Select(f => ParseResult.Failure(f.FilePath, f.Language, $"Parse error: {ex.Message}")));
+        }
+        finally
+        {
+            foreach (var resultPtr in nativeResults)
+            {
+                if (resultPtr != IntPtr.Zero)
+                {
+                    ckg_free_result(resultPtr);
+                }
+            }
+        }
+
+        return results;
+    }
+
+    /// <summary>
+    /// Indexes a directory tree natively and streams the results back as they
+    /// are produced. The native library walks the tree (honoring .gitignore),
+    /// memory-maps each file and parses on its own thread pool.
+    /// </summary>
+    public IAsyncEnumerable<ParseResult> IndexDirectoryAsync(
+        string rootPath,
+        IEnumerable<string> extensions,
+        IEnumerable<string>? ignoreGlobs = null,
+        int threadCount = 0,
+        CancellationToken cancellationToken = default)
+    {
+        return StreamIndexAsync<ParseResult>(
+            onItem => IndexDirectory(rootPath, extensions, ignoreGlobs, threadCount, onItem), cancellationToken);
+    }
+
+    /// <summary>
+    /// Indexes a directory tree like <see cref="IndexDirectoryAsync"/>, but only
+    /// parses files that changed since <paramref name="knownFiles"/> were taken.
+    /// Files whose size and modification time match are not read; the rest are
+    /// hashed natively and parsed only when the hash differs. Every file walked
+    /// is streamed back with its new fingerprint. With
+    /// <paramref name="symbolIndexPath"/> the run also rewrites that symbol index
+    /// (see <see cref="OpenSymbolIndex"/>), copying unparsed files' symbols from
+    /// the index already there; <paramref name="textIndexPath"/> does the same
+    /// for a text index (see <see cref="OpenTextIndex"/>).
+    /// </summary>
+    public IAsyncEnumerable<IndexedFile> IndexChangedFilesAsync(
+        string rootPath,
+        IEnumerable<string> extensions,
+        IReadOnlyCollection<FileFingerprint> knownFiles,
+        IEnumerable<string>? ignoreGlobs = null,
+        int threadCount = 0,
+        string? symbolIndexPath = null,
+        string? textIndexPath = null,
+        CancellationToken cancellationToken = default)
+    {
+        return StreamIndexAsync<IndexedFile>(
+            onItem => IndexChangedFiles(rootPath, extensions, knownFiles, ignoreGlobs, threadCount, onItem, symbolIndexPath, textIndexPath),
+            cancellationToken);
+    }
+
+    // Runs a native index on a worker thread and streams what it delivers
+    private async IAsyncEnumerable<T> StreamIndexAsync<T>(
+        Func<Func<T, bool>, int> index,
+        [EnumeratorCancellation] CancellationToken cancellationToken = default)
+    {
+        var channel = Channel.CreateBounded<T>(new BoundedChannelOptions(256)
+        {
+            SingleReader = true,
+            SingleWriter = true
+        });
+
+        var indexTask = Task.Run(() =>
+        {
+            try
+            {
+                index(item =>
+                {
+                    // Block the native worker until there is room: backpressure
+                    // keeps parsed results from piling up ahead of the consumer
+                    while (!channel.Writer.TryWrite(item))
+                    {
+                        if (!channel.Writer.WaitToWriteAsync(cancellationToken).AsTask().GetAwaiter().GetResult())
+                        {
+                            return false;
+                        }
+                    }
+                    return !cancellationToken.IsCancellationRequested;
+                });
+            }
+            finally
+            {
+                channel.Writer.TryComplete();
+            }
+        }, cancellationToken);
+
+        try
+        {
+            await foreach (var item in channel.Reader.ReadAllAsync(cancellationToken))
+            {
+                yield return item;
+            }
+        }
+        finally
+        {
+            // Stops the native walk if the consumer bailed out early
+            channel.Writer.TryComplete();
+            await indexTask;
+        }
+    }
+
+    /// <summary>
+    /// Indexes a directory tree natively, invoking <paramref name="onResult"/> for
+    /// each parsed file. Calls are serialised but arrive on native worker threads;
+    /// return false to stop. Returns the number of files delivered.
+    /// </summary>
+    public int IndexDirectory(string rootPath, IEnumerable<string> extensions, IEnumerable<string>? ignoreGlobs, int threadCount, Func<ParseResult, bool> onResult)
+    {
+        var options = new NativeIndexOptions();
+        return RunIndex(rootPath, extensions, ignoreGlobs, threadCount, ref options, onResult);
+    }
+
+    /// <summary>
+    /// Incremental form of <see cref="IndexDirectory"/> (see
+    /// <see cref="IndexChangedFilesAsync"/>): <paramref name="onFile"/> receives
+    /// every file walked, with a parse result for new and changed files.
+    /// </summary>
+    public int IndexChangedFiles(string rootPath, IEnumerable<string> extensions, IReadOnlyCollection<FileFingerprint> knownFiles,
+        IEnumerable<string>? ignoreGlobs, int threadCount, Func<IndexedFile, bool> onFile, string? symbolIndexPath = null,
+        string? textIndexPath = null)
+    {
+        if (!_isInitialized)
+        {
+            return 0;
+        }
+
+        var known = new NativeFileFingerprint[knownFiles.Count];
+        var index = 0;
+        foreach (var file in knownFiles)
+        {
+            known[index++] = new NativeFileFingerprint
+            {
+                Path = Marshal.StringToCoTaskMemUTF8(file.FilePath),
+                Size = (ulong)file.Size,
+                ModifiedTime = file.ModifiedTime,
+                Hash = unchecked((ulong)file.ContentHash)
+            };
+        }
+
+        // A new or changed file's fingerprint arrives just before its result,
+        // under the same native lock
+        IndexedFile? pending = null;
+        FileCallback fileCallback = (_, filePtr, state) =>
+        {
+            try
+            {
+                var native = Marshal.PtrToStructure<NativeFileFingerprint>(filePtr);
+                var indexed = new IndexedFile
+                {
+                    State = (FileIndexState)state,
+                    Fingerprint = new FileFingerprint
+                    {
+                        FilePath = Marshal.PtrToStringUTF8(native.Path) ?? string.Empty,
+                        ProjectPath = rootPath,
+                        Size = (long)native.Size,
+                        ModifiedTime = native.ModifiedTime,
+                        ContentHash = unchecked((long)native.Hash)
+                    }
+                };
+                if (indexed.State == FileIndexState.New || indexed.State == FileIndexState.Changed)
+                {
+                    pending = indexed;
+                    return true;
+                }
+                return onFile(indexed);
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error handling indexed file");
+                return false;
+            }
+        };
+
+        var handle = GCHandle.Alloc(known, GCHandleType.Pinned);
+        var indexPath = symbolIndexPath == null ? IntPtr.Zero : Marshal.StringToCoTaskMemUTF8(symbolIndexPath);
+        var textPath = textIndexPath == null ? IntPtr.Zero : Marshal.StringToCoTaskMemUTF8(textIndexPath);
+        try
+        {
+            var options = new NativeIndexOptions
+            {
+                KnownFiles = handle.AddrOfPinnedObject(),
+                KnownFileCount = (uint)known.Length,
+                OnFile = Marshal.GetFunctionPointerForDelegate(fileCallback),
+                IndexPath = indexPath,
+                TextIndexPath = textPath
+            };
+            var count = RunIndex(rootPath, extensions, ignoreGlobs, threadCount, ref options, result =>
+            {
+                var indexed = pending ?? new IndexedFile { Fingerprint = new FileFingerprint { FilePath = result.FilePath, ProjectPath = rootPath } };
+                pending = null;
+                indexed.Result = result;
+                return onFile(indexed);
+            });
+            GC.KeepAlive(fileCallback);
+            return count;
+        }
+        finally
+        {
+            handle.Free();
+            Marshal.FreeCoTaskMem(indexPath);
+            Marshal.FreeCoTaskMem(textPath);
+            foreach (var file in known)
+            {
+                Marshal.FreeCoTaskMem(file.Path);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Maps a symbol index written by <see cref="IndexChangedFiles"/>. Returns
+    /// null when the file is missing or is not a symbol index.
+    /// </summary>
+    public SymbolIndex? OpenSymbolIndex(string path)
+    {
+        if (!_isInitialized)
+        {
+            return null;
+        }
+        return SymbolIndex.Open(path);
+    }
+
+    /// <summary>
+    /// Maps a text index written by <see cref="IndexChangedFiles"/>. Returns
+    /// null when the file is missing or is not a text index.
+    /// </summary>
+    public TextIndex? OpenTextIndex(string path)
+    {
+        if (!_isInitialized)
+        {
+            return null;
+        }
+        return TextIndex.Open(path);
+    }
+
+    private int RunIndex(string rootPath, IEnumerable<string> extensions, IEnumerable<string>? ignoreGlobs, int threadCount,
+        ref NativeIndexOptions options, Func<ParseResult, bool> onResult)
+    {
+        if (!_isInitialized)
+        {
+            return 0;
+        }
+
+        IndexCallback callback = (_, filePathPtr, language, resultPtr) =>
+        {
+            try
+            {
+                var filePath = Marshal.PtrToStringUTF8(filePathPtr) ?? string.Empty;
+                var languageName = language >= 0 && language < NativeLanguageNames.Length ? NativeLanguageNames[language] : "unknown";
+                return onResult(ConvertNativeResult(resultPtr, filePath, languageName));
+            }
+            catch (Exception ex)
+            {
+                // Exceptions must not unwind through native frames
+                _logger.LogError(ex, "Error handling indexed file");
+                return false;
+            }
+        };
+
+        options.ThreadCount = (uint)Math.Max(threadCount, 0);
+        options.TimeoutMicros = ParseTimeoutMicros;
+        options.SizePolicy = SizePolicy;
+        var count = ckg_index_directory(rootPath, ToNullTerminated(extensions), ignoreGlobs == null ? null : ToNullTerminated(ignoreGlobs), ref options, callback, IntPtr.Zero);
+        GC.KeepAlive(callback);
+
+        if (count < 0)
+        {
+            _logger.LogWarning("Native indexer could not open directory or write the symbol index: {RootPath}", rootPath);
+            return 0;
+        }
+        return count;
+    }
+
+    private static string?[] ToNullTerminated(IEnumerable<string> values)
+    {
+        return values.Cast<string?>().Append(null).ToArray();
+    }
+
+    private static unsafe ParseResult ConvertNativeResult(IntPtr resultPtr, string filePath, string language)
+    {
+        if (resultPtr == IntPtr.Zero)
+        {
+            return ParseResult.Failure(filePath, language, "Native parsing failed");
+        }
+
+        var native = (NativeParseResult*)resultPtr;
+        if (native->ErrorMessage != IntPtr.Zero)
+        {
+            return ParseResult.Failure(filePath, language, Marshal.PtrToStringUTF8(native->ErrorMessage) ?? "Native parsing failed");
+        }
+        if (native->Status == NativeParseStatus.Skipped)
+        {
+            return ParseResult.Failure(filePath, language, SkippedMessage);
+        }
+
+        var result = ParseResult.Success(filePath, language);
+        result.IsPartial = native->Status != NativeParseStatus.Ok;
+
+        var functions = (NativeFunction*)native->Functions;
+        for (var i = 0; i < native->FunctionCount; i++)
+        {
+            result.Functions.Add(new Function
+            {
+                Name = Marshal.PtrToStringUTF8(functions[i].Name) ?? string.Empty,
+                FilePath = filePath,
+                StartLine = (int)functions[i].StartLine,
+                EndLine = (int)functions[i].EndLine,
+                ReturnType = Marshal.PtrToStringUTF8(functions[i].ReturnType) ?? string.Empty,
+                Parameters = Marshal.PtrToStringUTF8(functions[i].Parameters) ?? string.Empty,
+                ClassName = Marshal.PtrToStringUTF8(functions[i].ParentClass),
+                IsStatic = functions[i].IsStatic != 0,
+                IsPublic = functions[i].IsPublic != 0,
+                IsPrivate = functions[i].IsPrivate != 0,
+                IsProtected = functions[i].IsProtected != 0
+            });
+        }
+
+        var classes = (NativeClass*)native->Classes;
+        for (var i = 0; i < native->ClassCount; i++)
+        {
+            result.Classes.Add(new Class
+            {
+                Name = Marshal.PtrToStringUTF8(classes[i].Name) ?? string.Empty,
+                FilePath = filePath,
+                StartLine = (int)classes[i].StartLine,
+                EndLine = (int)classes[i].EndLine,
+                Namespace = Marshal.PtrToStringUTF8(classes[i].NamespaceName),
+                BaseClass = Marshal.PtrToStringUTF8(classes[i].BaseClass),
+                Interfaces = Marshal.PtrToStringUTF8(classes[i].Interfaces) ?? string.Empty,
+                IsStatic = classes[i].IsStatic != 0,
+                IsAbstract = classes[i].IsAbstract != 0,
+                IsSealed = classes[i].IsSealed != 0,
+                IsPublic = classes[i].IsPublic != 0
+            });
+        }
+
+        return result;
+    }
+
+    private IntPtr RentContext()
+    {
+        return _contextPool.TryTake(out var context) ? context : ckg_context_create();
+    }
+
+    private void ReturnContext(IntPtr context)
+    {
+        lock (_contextPoolLock)
+        {
+            if (!_disposed && _contextPool.Count < _maxPooledContexts)
+            {
+                _contextPool.Add(context);
+                return;
+            }
+        }
+
+        ckg_context_destroy(context);
+    }
+
+    // Reads a ckg_parse_binary buffer in place (layout in ckg_wrapper.h). Only
+    // the names are copied out, decoded straight from the string table.
+    private static ParseResult ConvertBinaryResult(ReadOnlySpan<byte> buffer, string filePath, string language)
+    {
+        if (buffer.Length < BinaryHeaderSize ||
+            BinaryPrimitives.ReadUInt32LittleEndian(buffer) != BinaryMagic ||
+            BinaryPrimitives.ReadUInt16LittleEndian(buffer.Slice(4)) != BinaryVersion)
+        {
+            return ParseResult.Failure(filePath, language, "Unrecognized native result format");
+        }
+
+        int headerSize = BinaryPrimitives.ReadUInt16LittleEndian(buffer.Slice(6));
+        var status = BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(8));
+        var functionCount = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(12));
+        var functionRecordSize = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(16));
+        var classCount = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(20));
+        var classRecordSize = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(24));
+        var strings = buffer.Slice(
+            (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(28)),
+            (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(32)));
+
+        if (status == NativeParseStatus.Error)
+        {
+            return ParseResult.Failure(filePath, language, Encoding.UTF8.GetString(strings));
+        }
+        if (status == NativeParseStatus.Skipped)
+        {
+            return ParseResult.Failure(filePath, language, SkippedMessage);
+        }
+
+        var result = ParseResult.Success(filePath, language);
+        result.IsPartial = status != NativeParseStatus.Ok;
+        result.Functions.Capacity = functionCount;
+        result.Classes.Capacity = classCount;
+
+        // Methods of one class share a string table entry, and so one string
+        var records = buffer.Slice(headerSize);
+        var previousClassOffset = -1;
+        string? previousClass = null;
+        for (var i = 0; i < functionCount; i++)
+        {
+            var record = records.Slice(i * functionRecordSize, functionRecordSize);
+            var classOffset = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(8));
+            var classLength = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(12));
+            string? className = null;
+            if (classLength > 0)
+            {
+                if (classOffset != previousClassOffset)
+                {
+                    previousClass = Encoding.UTF8.GetString(strings.Slice(classOffset, classLength));
+                    previousClassOffset = classOffset;
+                }
+                className = previousClass;
+            }
+
+            result.Functions.Add(new Function
+            {
+                Name = ReadBinaryString(strings, record),
+                FilePath = filePath,
+                StartLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(16)),
+                EndLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(20)),
+                ClassName = className
+            });
+        }
+
+        records = records.Slice(functionCount * functionRecordSize);
+        for (var i = 0; i < classCount; i++)
+        {
+            var record = records.Slice(i * classRecordSize, classRecordSize);
+            result.Classes.Add(new Class
+            {
+                Name = ReadBinaryString(strings, record),
+                FilePath = filePath,
+                StartLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(8)),
+                EndLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(12))
+            });
+        }
+
+        return result;
+    }
+
+    // Reads a ckg_apply_edit buffer (layout in ckg_wrapper.h)
+    private static SymbolDiff ConvertEditResult(ReadOnlySpan<byte> buffer, string filePath, string language)
+    {
+        if (buffer.Length < EditHeaderSize ||
+            BinaryPrimitives.ReadUInt32LittleEndian(buffer) != EditMagic ||
+            BinaryPrimitives.ReadUInt16LittleEndian(buffer.Slice(4)) != EditVersion)
+        {
+            return SymbolDiff.Failure(filePath, language, "Unrecognized native result format");
+        }
+
+        int headerSize = BinaryPrimitives.ReadUInt16LittleEndian(buffer.Slice(6));
+        var status = BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(8));
+        var recordCount = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(12));
+        var recordSize = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(16));
+        var strings = buffer.Slice(
+            (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(28)),
+            (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(32)));
+
+        if (status == NativeParseStatus.Error)
+        {
+            return SymbolDiff.Failure(filePath, language, Encoding.UTF8.GetString(strings));
+        }
+        if (status != NativeParseStatus.Ok)
+        {
+            return SymbolDiff.Failure(filePath, language, status == NativeParseStatus.Skipped ? SkippedMessage : "Incremental parse stopped");
         }
+
+        var diff = new SymbolDiff
+        {
+            IsSuccess = true,
+            FilePath = filePath,
+            Language = language,
+            EditLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(buffer.Slice(20)),
+            LineDelta = BinaryPrimitives.ReadInt32LittleEndian(buffer.Slice(24))
+        };
+        diff.Changes.Capacity = recordCount;
+
+        var records = buffer.Slice(headerSize);
+        for (var i = 0; i < recordCount; i++)
+        {
+            var record = records.Slice(i * recordSize, recordSize);
+            var classLength = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(16));
+            diff.Changes.Add(new SymbolChange
+            {
+                Kind = (SymbolChangeKind)record[0],
+                IsClass = record[1] == 1,
+                Name = ReadBinaryString(strings, record.Slice(4)),
+                ClassName = classLength > 0 ? ReadBinaryString(strings, record.Slice(12)) : null,
+                StartLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(20)),
+                EndLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(24)),
+                OldStartLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(28)),
+                OldEndLine = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(32))
+            });
+        }
+
+        return diff;
     }
 
-    private static string GetStringProperty(JsonElement element, string propertyName)
+    // The (offset, length) pair at the start of a record
+    private static string ReadBinaryString(ReadOnlySpan<byte> strings, ReadOnlySpan<byte> record)
     {
-        return element.TryGetProperty(propertyName, out var prop) && prop.ValueKind == JsonValueKind.String
-            ? prop.GetString() ?? string.Empty
-            : string.Empty;
+        var offset = (int)BinaryPrimitives.ReadUInt32LittleEndian(record);
+        var length = (int)BinaryPrimitives.ReadUInt32LittleEndian(record.Slice(4));
+        return Encoding.UTF8.GetString(strings.Slice(offset, length));
     }
 
-    private static int GetIntProperty(JsonElement element, string propertyName)
+    /// <summary>
+    /// Read the native parser's process-wide performance counters.
+    /// </summary>
+    public unsafe NativeParserStats GetNativeStats()
     {
-        return element.TryGetProperty(propertyName, out var prop) && prop.ValueKind == JsonValueKind.Number
-            ? prop.GetInt32()
-            : 0;
+        ckg_get_stats(out var native);
+
+        var stats = new NativeParserStats
+        {
+            FilesParsed = native.FilesParsed,
+            BytesParsed = native.BytesParsed,
+            NodesVisited = native.NodesVisited,
+            QueryMatches = native.QueryMatches,
+            SymbolsExtracted = native.SymbolsExtracted,
+            ParseTime = TimeSpan.FromTicks((long)(native.ParseNs / 100)),
+            ExtractTime = TimeSpan.FromTicks((long)(native.ExtractNs / 100)),
+            SerializeTime = TimeSpan.FromTicks((long)(native.SerializeNs / 100)),
+            ArenaHighWaterBytes = native.ArenaHighWater,
+            Errors = native.Errors,
+            Timeouts = native.Timeouts,
+            Cancellations = native.Cancellations,
+            FilesSkipped = native.FilesSkipped,
+            CacheHits = native.CacheHits,
+            CacheMisses = native.CacheMisses,
+            CacheEvictions = native.CacheEvictions,
+            DiskCacheHits = native.DiskCacheHits,
+            DiskCacheMisses = native.DiskCacheMisses,
+            DiskCacheEvictions = native.DiskCacheEvictions
+        };
+        ckg_cache_get_usage(out var cacheBytes, out var cacheEntries);
+        stats.CacheBytes = cacheBytes;
+        stats.CacheEntries = cacheEntries;
+        ckg_disk_cache_get_usage(out var diskCacheBytes, out var diskCacheEntries);
+        stats.DiskCacheBytes = diskCacheBytes;
+        stats.DiskCacheEntries = diskCacheEntries;
+        for (int i = 0; i < NativeStats.MaxLanguages; i++)
+        {
+            var errors = native.ErrorsByLanguage[i];
+            if (errors > 0)
+            {
+                var languageName = i < NativeLanguageNames.Length ? NativeLanguageNames[i] : $"language{i}";
+                stats.ErrorsByLanguage[languageName] = errors;
+            }
+        }
+        return stats;
     }
 
-    private static bool GetBoolProperty(JsonElement element, string propertyName)
+    /// <summary>
+    /// Zero the native parser's process-wide performance counters.
+    /// </summary>
+    public void ResetNativeStats()
     {
-        return element.TryGetProperty(propertyName, out var prop) && prop.ValueKind == JsonValueKind.True;
+        ckg_reset_stats();
     }
 
     private bool IsSupportedLanguage(string language)
@@ -326,6 +1350,26 @@ public class TreeSitterService : IDisposable
         {
             try
             {
+                lock (_contextPoolLock)
+                {
+                    // Contexts still rented are destroyed when they come back
+                    _disposed = true;
+                    while (_contextPool.TryTake(out var context))
+                    {
+                        ckg_context_destroy(context);
+                    }
+                }
+
+                lock (_documentLock)
+                {
+                    if (_documentContext != IntPtr.Zero)
+                    {
+                        ckg_context_destroy(_documentContext);
+                        _documentContext = IntPtr.Zero;
+                    }
+                    _documents.Clear();
+                }
+
                 ckg_cleanup();
                 _logger.LogInformation("Tree-sitter service disposed");
             }
@@ -335,7 +1379,6 @@ public class TreeSitterService : IDisposable
             }
             finally
             {
-                _parser = IntPtr.Zero;
                 _isInitialized = false;
                 _disposed = true;
             }
@@ -0,0 +1,185 @@
+// Batch parse scaling benchmark.
+//
+// Replicates the files in native/test_files into a synthetic tree under /tmp
+// (each copy repeats its source 1-16 times so file sizes vary), then parses
+// the whole tree with ckg_parse_batch at 1, 2, 4, ... N threads and reports
+// files/sec and the speedup over one thread.
+//
+// Usage: bench_batch_parse [corpus_dir] [file_count] [max_threads]
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "../wrapper/ckg_wrapper.h"
+
+#ifndef CKG_TEST_FILES_DIR
+#define CKG_TEST_FILES_DIR "../test_files"
+#endif
+
+#define MAX_CORPUS_FILES 64
+#define FILES_PER_DIR 256
+
+typedef struct {
+    char name[256];
+    char* content;
+    size_t length;
+} CorpusFile;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int load_corpus(const char* dir_path, CorpusFile* files) {
+    DIR* dir = opendir(dir_path);
+    if (!dir) {
+        return 0;
+    }
+
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL && count < MAX_CORPUS_FILES) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        FILE* file = fopen(path, "rb");
+        if (!file) {
+            continue;
+        }
+
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        files[count].content = malloc((size_t)length);
+        files[count].length = fread(files[count].content, 1, (size_t)length, file);
+        snprintf(files[count].name, sizeof(files[count].name), "%s", entry->d_name);
+        fclose(file);
+        count++;
+    }
+
+    closedir(dir);
+    return count;
+}
+
+// Build the synthetic tree and return the list of file paths
+static char** build_tree(const char* root, CorpusFile* corpus, int corpus_count, int file_count) {
+    char** paths = calloc((size_t)file_count, sizeof(char*));
+
+    for (int i = 0; i < file_count; i++) {
+        CorpusFile* source = &corpus[i % corpus_count];
+        int repeat = (i / corpus_count) % 16 + 1;
+
+        char dir_path[1024];
+        snprintf(dir_path, sizeof(dir_path), "%s/d%04d", root, i / FILES_PER_DIR);
+        if (i % FILES_PER_DIR == 0) {
+            mkdir(dir_path, 0755);
+        }
+
+        char path[1280];
+        snprintf(path, sizeof(path), "%s/%06d_%s", dir_path, i, source->name);
+        FILE* file = fopen(path, "wb");
+        for (int r = 0; r < repeat && file; r++) {
+            fwrite(source->content, 1, source->length, file);
+        }
+        if (file) {
+            fclose(file);
+        }
+        paths[i] = strdup(path);
+    }
+
+    return paths;
+}
+
+static void remove_tree(const char* root, char** paths, int file_count) {
+    for (int i = 0; i < file_count; i++) {
+        unlink(paths[i]);
+        free(paths[i]);
+    }
+    for (int d = 0; d <= (file_count - 1) / FILES_PER_DIR; d++) {
+        char dir_path[1024];
+        snprintf(dir_path, sizeof(dir_path), "%s/d%04d", root, d);
+        rmdir(dir_path);
+    }
+    rmdir(root);
+    free(paths);
+}
+
+int main(int argc, char* argv[]) {
+    const char* corpus_dir = argc > 1 ? argv[1] : CKG_TEST_FILES_DIR;
+    int file_count = argc > 2 ? atoi(argv[2]) : 20000;
+    int max_threads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (file_count <= 0 || max_threads <= 0) {
+        fprintf(stderr, "Usage: %s [corpus_dir] [file_count] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    CorpusFile corpus[MAX_CORPUS_FILES];
+    int corpus_count = load_corpus(corpus_dir, corpus);
+    if (corpus_count == 0) {
+        fprintf(stderr, "No corpus files found in %s\n", corpus_dir);
+        return 1;
+    }
+
+    char root[] = "/tmp/ckg_bench_XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char** paths = build_tree(root, corpus, corpus_count, file_count);
+
+    // The parser may log to stdout; keep that out of the timings and report
+    FILE* report = fdopen(dup(STDOUT_FILENO), "w");
+    freopen("/dev/null", "w", stdout);
+
+    ckg_init();
+    CKGParseResult** results = calloc((size_t)file_count, sizeof(CKGParseResult*));
+
+    fprintf(report, "Corpus: %s (%d files) replicated to %d files\n", corpus_dir, corpus_count, file_count);
+    fprintf(report, "%8s %12s %10s %10s %10s\n", "threads", "files/sec", "seconds", "speedup", "parsed");
+
+    double baseline = 0.0;
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > max_threads) {
+            threads = max_threads;
+        }
+
+        CKGBatchOptions options = {0};
+        options.thread_count = (uint32_t)threads;
+
+        double start = now_seconds();
+        int parsed = ckg_parse_batch((const char* const*)paths, (uint32_t)file_count, &options, results);
+        double elapsed = now_seconds() - start;
+
+        for (int i = 0; i < file_count; i++) {
+            ckg_free_result(results[i]);
+        }
+
+        double rate = file_count / elapsed;
+        if (threads == 1) {
+            baseline = rate;
+        }
+        fprintf(report, "%8d %12.0f %10.3f %9.2fx %10d\n", threads, rate, elapsed, rate / baseline, parsed);
+        fflush(report);
+
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    free(results);
+    ckg_cleanup();
+    remove_tree(root, paths, file_count);
+    for (int i = 0; i < corpus_count; i++) {
+        free(corpus[i].content);
+    }
+    fclose(report);
+    return 0;
+}
@@ -0,0 +1,337 @@
+// Tree walk benchmark: cursor-based extraction vs the old recursive walker.
+//
+// The cursor walker dispatches on TSSymbol ids through a per-language table
+// and finds names by field id; the recursive one compares node type strings
+// and scans children.
+//
+// Generates large synthetic sources (C# classes with many methods, C files
+// with many functions, long C else-if chains), parses each once and then
+// times repeated symbol extraction over the same tree with both walkers.
+// Both must produce identical classes and functions.
+//
+// The recursive walker is kept here, minus its per-node printf, purely as a
+// baseline. It is not run on the deep-nesting case because its recursion
+// depth follows the tree depth and can overflow the C stack.
+//
+// Usage: bench_walk_tree [scale] [iterations]
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tree_sitter/api.h"
+#include "../wrapper/ckg_internal.h"
+
+extern const TSLanguage *tree_sitter_c_sharp(void);
+extern const TSLanguage *tree_sitter_c(void);
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} SourceBuffer;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void append(SourceBuffer* buffer, const char* format, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        size_t available = buffer->capacity - buffer->length;
+        int written = vsnprintf(buffer->data + buffer->length, available, format, args);
+        va_end(args);
+        if (written >= 0 && (size_t)written < available) {
+            buffer->length += (size_t)written;
+            return;
+        }
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 1 << 16;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+}
+
+static SourceBuffer generate_csharp(int scale) {
+    SourceBuffer buffer = {0};
+    append(&buffer, "namespace Bench\n{\n");
+    for (int c = 0; c < scale; c++) {
+        append(&buffer, "    public class Service%d\n    {\n", c);
+        append(&buffer, "        public Service%d() { }\n", c);
+        for (int m = 0; m < 20; m++) {
+            append(&buffer, "        public int Method%d(int value)\n        {\n"
+                            "            var total = value;\n"
+                            "            for (var i = 0; i < %d; i++) { total += i * value; }\n"
+                            "            return total;\n        }\n", m, m);
+        }
+        append(&buffer, "        private class Nested%d { void Inner() { } }\n    }\n", c);
+    }
+    append(&buffer, "}\n");
+    return buffer;
+}
+
+static SourceBuffer generate_c(int scale) {
+    SourceBuffer buffer = {0};
+    for (int f = 0; f < scale * 20; f++) {
+        append(&buffer, "static int function_%d(int a, int b) {\n"
+                        "    int result = a;\n"
+                        "    while (b-- > 0) { result = result * 31 + b; }\n"
+                        "    return result;\n}\n\n", f);
+    }
+    return buffer;
+}
+
+static SourceBuffer generate_c_deep(int scale) {
+    SourceBuffer buffer = {0};
+    append(&buffer, "int classify(int x) {\n    if (x == 0) { return 0; }\n");
+    for (int i = 1; i < scale * 100; i++) {
+        append(&buffer, "    else if (x == %d) { return %d; }\n", i, i);
+    }
+    append(&buffer, "    return -1;\n}\n");
+    return buffer;
+}
+
+// --- Baseline: the old recursive walker -----------------------------------
+
+static char* get_node_text(TSNode node, const char* source_code) {
+    uint32_t start_byte = ts_node_start_byte(node);
+    uint32_t length = ts_node_end_byte(node) - start_byte;
+    char* text = malloc(length + 1);
+    if (text) {
+        memcpy(text, source_code + start_byte, length);
+        text[length] = '\0';
+    }
+    return text;
+}
+
+// The old walker's result types: names copied into fixed 256-byte buffers
+typedef struct {
+    char name[256];
+    int start_line;
+    int end_line;
+} LegacyClass;
+
+typedef struct {
+    char name[256];
+    char class_name[256];
+    int start_line;
+    int end_line;
+} LegacyFunction;
+
+typedef struct {
+    LegacyClass* classes;
+    int class_count;
+    int class_capacity;
+    LegacyFunction* functions;
+    int function_count;
+    int function_capacity;
+} LegacyData;
+
+static void legacy_add_class(LegacyData* data, const char* name, int start_line, int end_line) {
+    if (data->class_count >= data->class_capacity) {
+        data->class_capacity = data->class_capacity == 0 ? 10 : data->class_capacity * 2;
+        data->classes = realloc(data->classes, data->class_capacity * sizeof(LegacyClass));
+    }
+    LegacyClass* extracted = &data->classes[data->class_count++];
+    strncpy(extracted->name, name, 255);
+    extracted->name[255] = '\0';
+    extracted->start_line = start_line;
+    extracted->end_line = end_line;
+}
+
+static void legacy_add_function(LegacyData* data, const char* name, const char* class_name, int start_line, int end_line) {
+    if (data->function_count >= data->function_capacity) {
+        data->function_capacity = data->function_capacity == 0 ? 10 : data->function_capacity * 2;
+        data->functions = realloc(data->functions, data->function_capacity * sizeof(LegacyFunction));
+    }
+    LegacyFunction* extracted = &data->functions[data->function_count++];
+    strncpy(extracted->name, name, 255);
+    extracted->name[255] = '\0';
+    strncpy(extracted->class_name, class_name ? class_name : "", 255);
+    extracted->class_name[255] = '\0';
+    extracted->start_line = start_line;
+    extracted->end_line = end_line;
+}
+
+static void legacy_walk_tree(TSNode node, const char* source_code, LegacyData* data, const char* current_class) {
+    const char* node_type = ts_node_type(node);
+
+    if (strcmp(node_type, "class_declaration") == 0) {
+        uint32_t child_count = ts_node_child_count(node);
+        for (uint32_t i = 0; i < child_count; i++) {
+            TSNode child = ts_node_child(node, i);
+            if (strcmp(ts_node_type(child), "identifier") == 0) {
+                char* class_name = get_node_text(child, source_code);
+                if (class_name) {
+                    legacy_add_class(data, class_name, ts_node_start_point(node).row + 1, ts_node_end_point(node).row + 1);
+                    for (uint32_t j = 0; j < child_count; j++) {
+                        legacy_walk_tree(ts_node_child(node, j), source_code, data, class_name);
+                    }
+                    free(class_name);
+                    return;
+                }
+                break;
+            }
+        }
+    } else if (strcmp(node_type, "method_declaration") == 0 || strcmp(node_type, "constructor_declaration") == 0) {
+        uint32_t child_count = ts_node_child_count(node);
+        for (uint32_t i = 0; i < child_count; i++) {
+            TSNode child = ts_node_child(node, i);
+            if (strcmp(ts_node_type(child), "identifier") == 0) {
+                char* method_name = get_node_text(child, source_code);
+                if (method_name) {
+                    legacy_add_function(data, method_name, current_class, ts_node_start_point(node).row + 1, ts_node_end_point(node).row + 1);
+                    free(method_name);
+                }
+                break;
+            }
+        }
+    } else if (strcmp(node_type, "function_definition") == 0) {
+        uint32_t child_count = ts_node_child_count(node);
+        for (uint32_t i = 0; i < child_count; i++) {
+            TSNode child = ts_node_child(node, i);
+            if (strcmp(ts_node_type(child), "function_declarator") == 0) {
+                uint32_t declarator_child_count = ts_node_child_count(child);
+                for (uint32_t j = 0; j < declarator_child_count; j++) {
+                    TSNode declarator_child = ts_node_child(child, j);
+                    if (strcmp(ts_node_type(declarator_child), "identifier") == 0) {
+                        char* function_name = get_node_text(declarator_child, source_code);
+                        if (function_name) {
+                            legacy_add_function(data, function_name, current_class, ts_node_start_point(node).row + 1, ts_node_end_point(node).row + 1);
+                            free(function_name);
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    uint32_t child_count = ts_node_child_count(node);
+    for (uint32_t i = 0; i < child_count; i++) {
+        legacy_walk_tree(ts_node_child(node, i), source_code, data, current_class);
+    }
+}
+
+// --------------------------------------------------------------------------
+
+static bool same_span_text(CKGSpan span, const char* source_code, const char* text) {
+    return strlen(text) == span.length && memcmp(source_code + span.offset, text, span.length) == 0;
+}
+
+static bool same_symbols(const ParsedData* a, const LegacyData* b, const char* source_code) {
+    if (a->class_count != b->class_count || a->function_count != b->function_count) {
+        return false;
+    }
+    for (int i = 0; i < a->class_count; i++) {
+        if (!same_span_text(a->classes[i].name, source_code, b->classes[i].name) ||
+            a->classes[i].start_line != b->classes[i].start_line ||
+            a->classes[i].end_line != b->classes[i].end_line) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a->function_count; i++) {
+        if (!same_span_text(a->functions[i].name, source_code, b->functions[i].name) ||
+            !same_span_text(a->functions[i].class_name, source_code, b->functions[i].class_name) ||
+            a->functions[i].start_line != b->functions[i].start_line ||
+            a->functions[i].end_line != b->functions[i].end_line) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t tree_depth(TSNode root) {
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    uint32_t depth = 0;
+    uint32_t max_depth = 0;
+    for (;;) {
+        if (ts_tree_cursor_goto_first_child(&cursor)) {
+            if (++depth > max_depth) {
+                max_depth = depth;
+            }
+            continue;
+        }
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (depth == 0 || !ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return max_depth;
+            }
+            depth--;
+        }
+    }
+}
+
+static int run_case(const char* name, const TSLanguage* language, SourceBuffer source, int iterations, bool run_legacy) {
+    TSParser* parser = ts_parser_new();
+    ts_parser_set_language(parser, language);
+    TSTree* tree = ts_parser_parse_string(parser, NULL, source.data, (uint32_t)source.length);
+    TSNode root = ts_tree_root_node(tree);
+
+    CKGSymbolTable table;
+    ckg_symbol_table_init(&table, language);
+    ParsedData cursor_data = {0};
+    LegacyData legacy_data = {0};
+    double cursor_seconds = 0.0;
+    double legacy_seconds = 0.0;
+
+    for (int i = 0; i < iterations; i++) {
+        cursor_data.class_count = 0;
+        cursor_data.function_count = 0;
+        double start = now_seconds();
+        ckg_extract_symbols(&table, root, NULL, 0, &cursor_data);
+        cursor_seconds += now_seconds() - start;
+
+        if (run_legacy) {
+            legacy_data.class_count = 0;
+            legacy_data.function_count = 0;
+            start = now_seconds();
+            legacy_walk_tree(root, source.data, &legacy_data, NULL);
+            legacy_seconds += now_seconds() - start;
+        }
+    }
+
+    int status = 0;
+    double megabytes = (double)source.length * iterations / (1024.0 * 1024.0);
+    printf("%-12s %8.1f KB depth %6u  %5d classes %6d functions\n", name, source.length / 1024.0,
+           tree_depth(root), cursor_data.class_count, cursor_data.function_count);
+    printf("  cursor     %9.2f MB/s\n", megabytes / cursor_seconds);
+    if (run_legacy) {
+        printf("  recursive  %9.2f MB/s  (cursor %.2fx)\n", megabytes / legacy_seconds, legacy_seconds / cursor_seconds);
+        if (!same_symbols(&cursor_data, &legacy_data, source.data)) {
+            printf("  MISMATCH: walkers produced different symbols\n");
+            status = 1;
+        }
+    } else {
+        printf("  recursive  skipped (recursion depth follows tree depth)\n");
+    }
+
+    free(cursor_data.classes);
+    free(cursor_data.functions);
+    free(cursor_data.scopes);
+    free(legacy_data.classes);
+    free(legacy_data.functions);
+    ckg_symbol_table_free(&table);
+    ts_tree_delete(tree);
+    ts_parser_delete(parser);
+    free(source.data);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    int scale = argc > 1 ? atoi(argv[1]) : 200;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    if (scale <= 0 || iterations <= 0) {
+        fprintf(stderr, "Usage: %s [scale] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    status |= run_case("csharp", tree_sitter_c_sharp(), generate_csharp(scale), iterations, true);
+    status |= run_case("c", tree_sitter_c(), generate_c(scale), iterations, true);
+    status |= run_case("c-else-if", tree_sitter_c(), generate_c_deep(scale), iterations, false);
+    return status;
+}
@@ -15,7 +15,24 @@ static const char* test_programs[] = {
     "test_javascript_parser",
     "test_python_parser",
     "test_typescript_parser",
-    "test_go_parser"
+    "test_go_parser",
+    "test_json_writer",
+    "test_encoding",
+    "test_context",
+    "test_index_directory",
+    "test_trace",
+    "test_stats",
+    "test_cancellation",
+    "test_chunked_reader",
+    "test_utf16",
+    "test_registry",
+    "test_tree_cache",
+    "test_incremental_edit",
+    "test_incremental_index",
+    "test_disk_cache",
+    "test_symbol_index",
+    "test_symbol_search",
+    "test_text_index"
 };
 
 static const int num_test_programs = sizeof(test_programs) / sizeof(test_programs[0]);
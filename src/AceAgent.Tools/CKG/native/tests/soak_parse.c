@@ -0,0 +1,156 @@
+// Parse soak test.
+//
+// Parses every file in native/test_files over and over (one million parses
+// by default) through a single context, freeing each result, and samples the
+// resident set size as it goes. RSS must stay flat once warmed up: a leak of
+// even a few bytes per parse shows up as steady growth over a million runs.
+//
+// Usage: soak_parse [corpus_dir] [parse_count] [max_growth_kb]
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../wrapper/ckg_wrapper.h"
+
+#ifndef CKG_TEST_FILES_DIR
+#define CKG_TEST_FILES_DIR "../test_files"
+#endif
+
+#define MAX_CORPUS_FILES 64
+#define SAMPLE_COUNT 20
+
+typedef struct {
+    char* content;
+    CKGLanguage language;
+} CorpusFile;
+
+static int language_for(const char* name, CKGLanguage* language) {
+    const char* ext = strrchr(name, '.');
+    if (!ext) return 0;
+    if (strcmp(ext, ".c") == 0) *language = CKG_LANG_C;
+    else if (strcmp(ext, ".cpp") == 0) *language = CKG_LANG_CPP;
+    else if (strcmp(ext, ".cs") == 0) *language = CKG_LANG_CSHARP;
+    else if (strcmp(ext, ".java") == 0) *language = CKG_LANG_JAVA;
+    else if (strcmp(ext, ".js") == 0) *language = CKG_LANG_JAVASCRIPT;
+    else if (strcmp(ext, ".ts") == 0) *language = CKG_LANG_TYPESCRIPT;
+    else if (strcmp(ext, ".py") == 0) *language = CKG_LANG_PYTHON;
+    else if (strcmp(ext, ".go") == 0) *language = CKG_LANG_GO;
+    else return 0;
+    return 1;
+}
+
+static int load_corpus(const char* dir_path, CorpusFile* files) {
+    DIR* dir = opendir(dir_path);
+    if (!dir) {
+        return 0;
+    }
+
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL && count < MAX_CORPUS_FILES) {
+        if (entry->d_name[0] == '.' || !language_for(entry->d_name, &files[count].language)) {
+            continue;
+        }
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        FILE* file = fopen(path, "rb");
+        if (!file) {
+            continue;
+        }
+
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        files[count].content = malloc((size_t)length + 1);
+        size_t read = fread(files[count].content, 1, (size_t)length, file);
+        files[count].content[read] = '\0';
+        fclose(file);
+        count++;
+    }
+
+    closedir(dir);
+    return count;
+}
+
+// Resident set size in KB, or -1 where it cannot be read
+static long resident_kb(void) {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) {
+        return -1;
+    }
+    long pages = 0;
+    long resident = 0;
+    int fields = fscanf(statm, "%ld %ld", &pages, &resident);
+    fclose(statm);
+    return fields == 2 ? resident * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* corpus_dir = argc > 1 ? argv[1] : CKG_TEST_FILES_DIR;
+    long parse_count = argc > 2 ? atol(argv[2]) : 1000000;
+    long max_growth_kb = argc > 3 ? atol(argv[3]) : 1024;
+    if (parse_count < SAMPLE_COUNT) {
+        fprintf(stderr, "Usage: %s [corpus_dir] [parse_count] [max_growth_kb]\n", argv[0]);
+        return 1;
+    }
+
+    CorpusFile corpus[MAX_CORPUS_FILES];
+    int corpus_count = load_corpus(corpus_dir, corpus);
+    if (corpus_count == 0) {
+        fprintf(stderr, "No corpus files found in %s\n", corpus_dir);
+        return 1;
+    }
+
+    ckg_init();
+    CKGContext* ctx = ckg_context_create();
+    long sample_every = parse_count / SAMPLE_COUNT;
+    long baseline_kb = -1;
+    long peak_kb = 0;
+    long failures = 0;
+
+    printf("Soaking %ld parses over %d files from %s\n", parse_count, corpus_count, corpus_dir);
+    for (long i = 0; i < parse_count; i++) {
+        const CorpusFile* file = &corpus[i % corpus_count];
+        CKGParseResult* result = ckg_parse_with_context(ctx, file->language, file->content, NULL);
+        if (!result || result->error_message) {
+            failures++;
+        }
+        ckg_free_result(result);
+
+        if ((i + 1) % sample_every == 0) {
+            long rss_kb = resident_kb();
+            // The first sample is the warmed-up baseline: parser, scratch
+            // buffers and malloc arenas have reached their working size
+            if (baseline_kb < 0) {
+                baseline_kb = rss_kb;
+            }
+            if (rss_kb > peak_kb) {
+                peak_kb = rss_kb;
+            }
+            printf("%10ld parses  rss %8ld KB\n", i + 1, rss_kb);
+            fflush(stdout);
+        }
+    }
+
+    ckg_context_destroy(ctx);
+    ckg_cleanup();
+    for (int i = 0; i < corpus_count; i++) {
+        free(corpus[i].content);
+    }
+
+    int status = 0;
+    if (failures > 0) {
+        printf("FAIL: %ld parses returned errors\n", failures);
+        status = 1;
+    }
+    if (baseline_kb >= 0 && peak_kb - baseline_kb > max_growth_kb) {
+        printf("FAIL: RSS grew %ld KB (limit %ld KB)\n", peak_kb - baseline_kb, max_growth_kb);
+        status = 1;
+    } else if (baseline_kb >= 0) {
+        printf("OK: RSS growth %ld KB\n", peak_kb - baseline_kb);
+    }
+    return status;
+}
@@ -154,6 +154,128 @@ int test_c_struct_parsing() {
     TEST_PASS("C Struct Parsing");
 }
 
+typedef struct {
+    int function_count;
+    int field_count;
+    int stop_after;
+} VisitCounts;
+
+static bool count_function(void* user_data, const char* source_code, const CKGSymbol* symbol) {
+    VisitCounts* counts = (VisitCounts*)user_data;
+    printf("  Visited function: %.*s\n", (int)symbol->name.length, source_code + symbol->name.offset);
+    counts->function_count++;
+    return counts->stop_after == 0 || counts->function_count < counts->stop_after;
+}
+
+static bool count_field(void* user_data, const char* source_code, const CKGSymbol* symbol) {
+    (void)source_code;
+    (void)symbol;
+    ((VisitCounts*)user_data)->field_count++;
+    return true;
+}
+
+// 测试访问者接口
+int test_c_visitor() {
+    TEST_START("C Visitor");
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    
+    VisitCounts counts = {0};
+    CKGVisitor visitor = { NULL, count_function, count_field, &counts };
+    int status = ckg_parse_visit(ctx, CKG_LANG_C, c_function_code, (uint32_t)strlen(c_function_code), &visitor);
+    TEST_ASSERT(status == 1, "Visit should run to completion");
+    TEST_ASSERT(counts.function_count == 2, "Should visit both functions");
+    
+    // 第一个函数后停止
+    VisitCounts stopped = { .stop_after = 1 };
+    visitor.user_data = &stopped;
+    status = ckg_parse_visit(ctx, CKG_LANG_C, c_function_code, (uint32_t)strlen(c_function_code), &visitor);
+    TEST_ASSERT(status == 0, "Visit should report the early stop");
+    TEST_ASSERT(stopped.function_count == 1, "No functions should be visited after the stop");
+    
+    // 结构体成员通过on_field报告
+    VisitCounts fields = {0};
+    visitor.user_data = &fields;
+    status = ckg_parse_visit(ctx, CKG_LANG_C, c_struct_code, (uint32_t)strlen(c_struct_code), &visitor);
+    TEST_ASSERT(status == 1, "Visit should run to completion");
+    TEST_ASSERT(fields.field_count == 4, "Should visit the four struct members");
+    
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("C Visitor");
+}
+
+// 测试按文件解析时的编码识别：带BOM的UTF-8、UTF-16LE与Latin-1结果一致
+int test_c_file_encodings() {
+    TEST_START("C File Encodings");
+    
+    const char* utf8_code =
+        "// 计算两数之和\n"
+        "int add(int a, int b) {\n"
+        "    return a + b;\n"
+        "}\n"
+        "struct Point { int x; };\n";
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    uint32_t expected_size = 0;
+    uint8_t* expected = ckg_parse_binary(ctx, CKG_LANG_C, utf8_code, (uint32_t)strlen(utf8_code), &expected_size);
+    TEST_ASSERT(expected != NULL, "UTF-8 parse should produce a result");
+    
+    // 带BOM的UTF-8
+    char with_bom[256];
+    snprintf(with_bom, sizeof(with_bom), "\xEF\xBB\xBF%s", utf8_code);
+    char* temp_file = create_temp_file(with_bom, "c");
+    uint32_t size = 0;
+    uint8_t* parsed = ckg_parse_file(ctx, CKG_LANG_C, temp_file, &size);
+    TEST_ASSERT(parsed != NULL && size == expected_size && memcmp(parsed, expected, size) == 0,
+                "UTF-8 with BOM should parse like plain UTF-8");
+    ckg_free_binary(parsed);
+    cleanup_temp_file(temp_file);
+    
+    // 带BOM的UTF-16LE（Visual Studio生成的文件）；测试文本只含BMP字符
+    uint8_t utf16[512] = { 0xFF, 0xFE };
+    size_t length = 2;
+    for (const unsigned char* p = (const unsigned char*)utf8_code; *p; length += 2) {
+        uint16_t unit;
+        if (*p < 0x80) {
+            unit = *p++;
+        } else {
+            unit = (uint16_t)(((p[0] & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+            p += 3;
+        }
+        utf16[length] = (uint8_t)unit;
+        utf16[length + 1] = (uint8_t)(unit >> 8);
+    }
+    temp_file = create_temp_file("", "c");
+    FILE* file = fopen(temp_file, "wb");
+    TEST_ASSERT(file != NULL && fwrite(utf16, 1, length, file) == length, "Should write the UTF-16 file");
+    fclose(file);
+    parsed = ckg_parse_file(ctx, CKG_LANG_C, temp_file, &size);
+    TEST_ASSERT(parsed != NULL && size == expected_size && memcmp(parsed, expected, size) == 0,
+                "UTF-16LE should parse like UTF-8");
+    ckg_free_binary(parsed);
+    cleanup_temp_file(temp_file);
+    
+    // 非UTF-8文本按Latin-1读取，符号仍可提取
+    temp_file = create_temp_file("// r\xE9sum\xE9\nint add(int a, int b) { return a + b; }\n", "c");
+    parsed = ckg_parse_file(ctx, CKG_LANG_C, temp_file, &size);
+    TEST_ASSERT(parsed != NULL && parsed[8] == CKG_STATUS_OK && parsed[12] == 1,
+                "Latin-1 source should parse and yield its function");
+    ckg_free_binary(parsed);
+    cleanup_temp_file(temp_file);
+    
+    parsed = ckg_parse_file(ctx, CKG_LANG_C, "/nonexistent/file.c", &size);
+    TEST_ASSERT(parsed != NULL && parsed[8] == CKG_STATUS_ERROR, "A missing file should give an error result");
+    ckg_free_binary(parsed);
+    
+    ckg_free_binary(expected);
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("C File Encodings");
+}
+
 // 测试错误处理
 int test_c_error_handling() {
     TEST_START("C Error Handling");
@@ -188,6 +310,8 @@ int main() {
     test_c_basic_parsing();
     test_c_function_parsing();
     test_c_struct_parsing();
+    test_c_visitor();
+    test_c_file_encodings();
     test_c_error_handling();
     
     // 清理
@@ -0,0 +1,74 @@
+#include "test_framework.h"
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+// 测试取消与超时返回部分结果
+int test_cancellation_partial_results() {
+    TEST_START("Parse Cancellation");
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    
+    uint32_t length = (uint32_t)strlen(c_function_code);
+    ckg_context_cancel(ctx);
+    CKGParseResult* result = ckg_parse_spans(ctx, CKG_LANG_C, c_function_code, length);
+    TEST_ASSERT(result != NULL && result->status == CKG_STATUS_CANCELLED, "Cancelled parse should report it");
+    TEST_ASSERT(result->error_message == NULL, "A cancelled parse is partial, not an error");
+    ckg_free_result(result);
+    
+    ckg_context_reset_cancel(ctx);
+    result = ckg_parse_spans(ctx, CKG_LANG_C, c_function_code, length);
+    TEST_ASSERT(result != NULL && result->status == CKG_STATUS_OK, "Reset should allow parsing again");
+    TEST_ASSERT(result->function_count == 2, "Should find both functions after the reset");
+    ckg_free_result(result);
+    
+    // 大文件在1微秒的预算内无法完成
+    size_t function_length = strlen(c_function_code);
+    size_t repeat = 2000;
+    char* large_code = malloc(function_length * repeat + 1);
+    for (size_t i = 0; i < repeat; i++) {
+        memcpy(large_code + i * function_length, c_function_code, function_length);
+    }
+    large_code[function_length * repeat] = '\0';
+    
+    ckg_context_set_timeout(ctx, 1);
+    result = ckg_parse_spans(ctx, CKG_LANG_C, large_code, (uint32_t)(function_length * repeat));
+    TEST_ASSERT(result != NULL && result->status == CKG_STATUS_TIMED_OUT, "Parse should stop at the deadline");
+    ckg_free_result(result);
+    
+    ckg_context_set_timeout(ctx, 0);
+    result = ckg_parse_spans(ctx, CKG_LANG_C, c_function_code, length);
+    TEST_ASSERT(result != NULL && result->status == CKG_STATUS_OK, "A later parse should not resume the stopped one");
+    TEST_ASSERT(result->function_count == 2, "Should find both functions");
+    ckg_free_result(result);
+    
+    CKGStats stats;
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.cancellations == 1 && stats.timeouts == 1, "Stops should be counted");
+    
+    free(large_code);
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("Parse Cancellation");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Parse Cancellation Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_cancellation_partial_results();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
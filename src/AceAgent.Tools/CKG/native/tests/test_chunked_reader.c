@@ -0,0 +1,139 @@
+#include "test_framework.h"
+
+static const char* c_struct_code = 
+    "struct Point {\n"
+    "    int x;\n"
+    "    int y;\n"
+    "};\n"
+    "\n"
+    "typedef struct {\n"
+    "    char name[50];\n"
+    "    int age;\n"
+    "} Person;\n";
+
+static const char* read_in_pieces(void* user_data, uint32_t offset, uint32_t* length_out) {
+    const char* source = (const char*)user_data;
+    uint32_t length = (uint32_t)strlen(source);
+    uint32_t remaining = offset < length ? length - offset : 0;
+    *length_out = remaining < 7 ? remaining : 7;
+    return source + offset;
+}
+
+// 测试分块读取与整段解析结果一致，以及大小策略
+int test_chunked_reader_matches_buffer() {
+    TEST_START("Chunked Reader");
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    
+    uint32_t length = (uint32_t)strlen(c_struct_code);
+    uint32_t whole_size = 0;
+    uint32_t chunked_size = 0;
+    uint8_t* whole = ckg_parse_binary(ctx, CKG_LANG_C, c_struct_code, length, &whole_size);
+    uint8_t* chunked = ckg_parse_reader(ctx, CKG_LANG_C, length, read_in_pieces, (void*)c_struct_code, &chunked_size);
+    TEST_ASSERT(whole != NULL && chunked != NULL, "Both parses should produce a result");
+    TEST_ASSERT(whole_size == chunked_size && memcmp(whole, chunked, whole_size) == 0,
+                "Reading in pieces should give the same result as one buffer");
+    ckg_free_binary(whole);
+    ckg_free_binary(chunked);
+    
+    CKGSizePolicy policy = { 0, (uint64_t)length - 1 };
+    ckg_context_set_size_policy(ctx, &policy);
+    chunked = ckg_parse_reader(ctx, CKG_LANG_C, length, read_in_pieces, (void*)c_struct_code, &chunked_size);
+    TEST_ASSERT(chunked != NULL && chunked[8] == CKG_STATUS_SKIPPED, "Oversized source should be skipped");
+    ckg_free_binary(chunked);
+    
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("Chunked Reader");
+}
+
+static bool record_status(void* user_data, const char* file_path, CKGLanguage language, const CKGParseResult* result) {
+    (void)file_path;
+    (void)language;
+    *(uint32_t*)user_data = result ? result->status : CKG_STATUS_ERROR;
+    return true;
+}
+
+// 在新建的临时目录root中写入结构体示例，路径写入file_path
+static bool write_struct_file(char* root, char* file_path, size_t size) {
+    if (!mkdtemp(root)) {
+        return false;
+    }
+    snprintf(file_path, size, "%s/structs.c", root);
+    FILE* file = fopen(file_path, "w");
+    if (!file) {
+        return false;
+    }
+    fputs(c_struct_code, file);
+    fclose(file);
+    return true;
+}
+
+// 测试批量解析遵循大小策略，跳过的文件计入统计
+int test_chunked_reader_batch_policy() {
+    TEST_START("Size Policy In Batch");
+
+    char root[] = "/tmp/ckg_policy_XXXXXX";
+    char path[128];
+    TEST_ASSERT(write_struct_file(root, path, sizeof(path)), "Should create a source file");
+
+    ckg_reset_stats();
+    const char* paths[] = { path };
+    CKGParseResult* results[1] = { NULL };
+    CKGBatchOptions options = {0};
+    options.size_policy.skip_above = 8;
+    int parsed = ckg_parse_batch(paths, 1, &options, results);
+    TEST_ASSERT(parsed == 0, "A skipped file should not count as parsed");
+    TEST_ASSERT(results[0] != NULL && results[0]->status == CKG_STATUS_SKIPPED,
+                "The batch should skip a file above the policy's limit");
+    ckg_free_result(results[0]);
+    CKGStats stats;
+    ckg_get_stats(&stats);
+    TEST_ASSERT(stats.files_skipped == 1 && stats.files_parsed == 0, "The batch should count the skipped file");
+
+    unlink(path);
+    rmdir(root);
+
+    TEST_PASS("Size Policy In Batch");
+}
+
+// 测试目录索引遵循大小策略，跳过的文件计入统计
+int test_chunked_reader_index_policy() {
+    TEST_START("Size Policy In Index");
+
+    char root[] = "/tmp/ckg_policy_XXXXXX";
+    char path[128];
+    TEST_ASSERT(write_struct_file(root, path, sizeof(path)), "Should create a source file");
+
+    ckg_reset_stats();
+    uint32_t status = CKG_STATUS_OK;
+    CKGIndexOptions options = {0};
+    options.size_policy.skip_above = 8;
+    int count = ckg_index_directory(root, NULL, NULL, &options, record_status, &status);
+    TEST_ASSERT(count == 1 && status == CKG_STATUS_SKIPPED, "The index should skip a file above the policy's limit");
+    CKGStats stats;
+    ckg_get_stats(&stats);
+    TEST_ASSERT(stats.files_skipped == 1 && stats.files_parsed == 0, "The index should count the skipped file");
+
+    unlink(path);
+    rmdir(root);
+
+    TEST_PASS("Size Policy In Index");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Chunked Reader Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_chunked_reader_matches_buffer();
+    test_chunked_reader_batch_policy();
+    test_chunked_reader_index_policy();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
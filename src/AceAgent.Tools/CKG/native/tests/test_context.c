@@ -0,0 +1,127 @@
+#include "test_framework.h"
+#include <pthread.h>
+
+#define THREAD_COUNT 8
+#define ROUNDS 50
+
+typedef struct {
+    CKGLanguage language;
+    const char* source;
+} Sample;
+
+static const Sample samples[] = {
+    { CKG_LANG_C,
+      "int add(int a, int b) {\n"
+      "    return a + b;\n"
+      "}\n"
+      "\n"
+      "struct Point { int x; int y; };\n"
+      "void print_number(int n) {}\n" },
+    { CKG_LANG_CPP,
+      "class Shape {\n"
+      "public:\n"
+      "    virtual double area() const = 0;\n"
+      "};\n"
+      "double Circle::area() const { return 3.14 * r * r; }\n" },
+    { CKG_LANG_JAVASCRIPT,
+      "class Greeter {\n"
+      "    greet(name) { return `hi ${name}`; }\n"
+      "}\n"
+      "function main() { new Greeter().greet('x'); }\n" },
+    { CKG_LANG_PYTHON,
+      "class Parser:\n"
+      "    def parse(self, text):\n"
+      "        return text.split()\n"
+      "\n"
+      "def main():\n"
+      "    Parser().parse('a b')\n" },
+};
+
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+typedef struct {
+    uint8_t* expected[SAMPLE_COUNT];
+    uint32_t expected_size[SAMPLE_COUNT];
+} SharedExpectations;
+
+typedef struct {
+    SharedExpectations* shared;
+    int offset;
+    int mismatches;
+} Worker;
+
+static void* parse_in_own_context(void* argument) {
+    Worker* worker = (Worker*)argument;
+    CKGContext* ctx = ckg_context_create();
+    if (!ctx) {
+        worker->mismatches = -1;
+        return NULL;
+    }
+    // Each thread starts at a different sample so that languages interleave
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+            size_t s = (i + (size_t)worker->offset) % SAMPLE_COUNT;
+            uint32_t size = 0;
+            uint8_t* parsed = ckg_parse_binary(ctx, samples[s].language, samples[s].source,
+                                               (uint32_t)strlen(samples[s].source), &size);
+            if (!parsed || size != worker->shared->expected_size[s] ||
+                memcmp(parsed, worker->shared->expected[s], size) != 0) {
+                worker->mismatches++;
+            }
+            ckg_free_binary(parsed);
+        }
+    }
+    ckg_context_destroy(ctx);
+    return NULL;
+}
+
+// 测试多个线程各用一个上下文并发解析，结果与单线程一致
+int test_context_concurrent_parsing() {
+    TEST_START("Concurrent Parsing Contexts");
+
+    SharedExpectations shared = {0};
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    for (size_t s = 0; s < SAMPLE_COUNT; s++) {
+        shared.expected[s] = ckg_parse_binary(ctx, samples[s].language, samples[s].source,
+                                              (uint32_t)strlen(samples[s].source), &shared.expected_size[s]);
+        TEST_ASSERT(shared.expected[s] != NULL && shared.expected[s][8] == CKG_STATUS_OK,
+                    "Single-threaded parse should succeed");
+    }
+    ckg_context_destroy(ctx);
+
+    pthread_t threads[THREAD_COUNT];
+    Worker workers[THREAD_COUNT];
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        workers[t] = (Worker){ &shared, t, 0 };
+        TEST_ASSERT(pthread_create(&threads[t], NULL, parse_in_own_context, &workers[t]) == 0,
+                    "Should start a worker thread");
+    }
+    int mismatches = 0;
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        pthread_join(threads[t], NULL);
+        TEST_ASSERT(workers[t].mismatches >= 0, "Each worker should create its own context");
+        mismatches += workers[t].mismatches;
+    }
+    TEST_ASSERT(mismatches == 0, "Concurrent parses should match the single-threaded results");
+
+    for (size_t s = 0; s < SAMPLE_COUNT; s++) {
+        ckg_free_binary(shared.expected[s]);
+    }
+
+    TEST_PASS("Concurrent Parsing Contexts");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Parsing Context Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_context_concurrent_parsing();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
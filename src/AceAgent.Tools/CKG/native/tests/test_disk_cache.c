@@ -0,0 +1,109 @@
+#include "test_framework.h"
+#include <dirent.h>
+
+static const char* c_struct_code = 
+    "struct Point {\n"
+    "    int x;\n"
+    "    int y;\n"
+    "};\n"
+    "\n"
+    "typedef struct {\n"
+    "    char name[50];\n"
+    "    int age;\n"
+    "} Person;\n";
+
+// 删除缓存目录：其中只有两级目录（分片目录和缓存文件）
+static void remove_cache_directory(const char* directory) {
+    DIR* shards = opendir(directory);
+    if (shards) {
+        struct dirent* shard;
+        char path[512];
+        while ((shard = readdir(shards)) != NULL) {
+            if (strcmp(shard->d_name, ".") == 0 || strcmp(shard->d_name, "..") == 0) {
+                continue;
+            }
+            snprintf(path, sizeof(path), "%s/%s", directory, shard->d_name);
+            DIR* files = opendir(path);
+            if (!files) {
+                unlink(path);
+                continue;
+            }
+            struct dirent* file;
+            char file_path[1024];
+            while ((file = readdir(files)) != NULL) {
+                if (strcmp(file->d_name, ".") != 0 && strcmp(file->d_name, "..") != 0) {
+                    snprintf(file_path, sizeof(file_path), "%s/%s", path, file->d_name);
+                    unlink(file_path);
+                }
+            }
+            closedir(files);
+            rmdir(path);
+        }
+        closedir(shards);
+    }
+    rmdir(directory);
+}
+
+// 测试磁盘缓存：换一个上下文（相当于新进程）解析相同内容时直接读取缓存
+int test_disk_cache_across_contexts() {
+    TEST_START("Disk Cache");
+
+    char root[] = "/tmp/ckg_cache_XXXXXX";
+    TEST_ASSERT(mkdtemp(root) != NULL, "Should create a temporary directory");
+    char directory[128];
+    snprintf(directory, sizeof(directory), "%s/parse-cache", root);
+    TEST_ASSERT(ckg_disk_cache_set_directory(directory, 1024 * 1024) == 0, "Should create the cache directory");
+
+    uint32_t length = (uint32_t)strlen(c_struct_code);
+    uint32_t first_size = 0;
+    uint32_t second_size = 0;
+    CKGContext* ctx = ckg_context_create();
+    uint8_t* first = ckg_parse_binary(ctx, CKG_LANG_C, c_struct_code, length, &first_size);
+    ckg_context_destroy(ctx);
+    ctx = ckg_context_create();
+    uint8_t* second = ckg_parse_binary(ctx, CKG_LANG_C, c_struct_code, length, &second_size);
+    TEST_ASSERT(first != NULL && second != NULL, "Both parses should produce a result");
+    TEST_ASSERT(first_size == second_size && memcmp(first, second, first_size) == 0,
+                "A parse from the disk cache should give the same result");
+    ckg_free_binary(first);
+    ckg_free_binary(second);
+
+    CKGStats stats;
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.disk_cache_hits == 1 && stats.files_parsed == 0, "The second context should not parse");
+
+    uint64_t bytes = 0;
+    uint32_t entries = 0;
+    ckg_disk_cache_get_usage(&bytes, &entries);
+    TEST_ASSERT(entries == 1 && bytes > 0, "The cache should hold one entry");
+
+    // 清空后重新解析
+    ckg_disk_cache_clear();
+    ckg_disk_cache_get_usage(&bytes, &entries);
+    TEST_ASSERT(entries == 0 && bytes == 0, "Clearing should delete the entries");
+    CKGParseResult* result = ckg_parse_spans(ctx, CKG_LANG_C, c_struct_code, length);
+    ckg_free_result(result);
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.disk_cache_misses == 1 && stats.files_parsed == 1, "A cleared cache should miss");
+
+    ckg_disk_cache_set_directory(NULL, 0);
+    ckg_context_destroy(ctx);
+    remove_cache_directory(directory);
+    rmdir(root);
+
+    TEST_PASS("Disk Cache");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Disk Cache Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_disk_cache_across_contexts();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
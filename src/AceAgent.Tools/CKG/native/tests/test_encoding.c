@@ -0,0 +1,170 @@
+#include "test_framework.h"
+#include "../wrapper/ckg_encoding.h"
+
+// 将UTF-8测试文本编码为UTF-16字节（测试文本只含BMP字符）
+static size_t encode_utf16(const char* text, bool big_endian, uint8_t* out) {
+    size_t units = 0;
+    for (const unsigned char* p = (const unsigned char*)text; *p; units++) {
+        uint16_t unit;
+        if (*p < 0x80) {
+            unit = *p++;
+        } else if (*p < 0xE0) {
+            unit = (uint16_t)(((p[0] & 0x1F) << 6) | (p[1] & 0x3F));
+            p += 2;
+        } else {
+            unit = (uint16_t)(((p[0] & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+            p += 3;
+        }
+        out[units * 2] = (uint8_t)(big_endian ? unit >> 8 : unit);
+        out[units * 2 + 1] = (uint8_t)(big_endian ? unit : unit >> 8);
+    }
+    return units;
+}
+
+// 测试字节顺序标记与无BOM的UTF-16识别
+int test_encoding_detection() {
+    TEST_START("Encoding Detection");
+
+    size_t bom = 0;
+    TEST_ASSERT(ckg_detect_encoding((const uint8_t*)"\xEF\xBB\xBFint x;", 9, &bom) == CKG_ENCODING_UTF8 && bom == 3,
+                "UTF-8 BOM should be recognised");
+    TEST_ASSERT(ckg_detect_encoding((const uint8_t*)"\xFF\xFEi\0", 4, &bom) == CKG_ENCODING_UTF16LE && bom == 2,
+                "UTF-16LE BOM should be recognised");
+    TEST_ASSERT(ckg_detect_encoding((const uint8_t*)"\xFE\xFF\0i", 4, &bom) == CKG_ENCODING_UTF16BE && bom == 2,
+                "UTF-16BE BOM should be recognised");
+
+    uint8_t utf16[256];
+    size_t units = encode_utf16("int main() { return 0; }\n", false, utf16);
+    TEST_ASSERT(ckg_detect_encoding(utf16, units * 2, &bom) == CKG_ENCODING_UTF16LE && bom == 0,
+                "UTF-16LE without BOM should be recognised by its zero bytes");
+    units = encode_utf16("int main() { return 0; }\n", true, utf16);
+    TEST_ASSERT(ckg_detect_encoding(utf16, units * 2, &bom) == CKG_ENCODING_UTF16BE,
+                "UTF-16BE without BOM should be recognised by its zero bytes");
+    TEST_ASSERT(ckg_detect_encoding((const uint8_t*)"int x;", 6, &bom) == CKG_ENCODING_UTF8 && bom == 0,
+                "Plain text should be left to UTF-8 validation");
+
+    TEST_PASS("Encoding Detection");
+}
+
+// 测试UTF-8校验（覆盖向量化ASCII路径之后的多字节序列）
+int test_utf8_validation() {
+    TEST_START("UTF-8 Validation");
+
+    const char* valid = "int add(int a, int b) { return a + b; } // 计算两数之和 \xF0\x9F\x98\x80 é";
+    TEST_ASSERT(ckg_utf8_validate((const uint8_t*)valid, strlen(valid)), "Well-formed UTF-8 should pass");
+
+    static const char* const invalid[] = {
+        "0123456789abcdef0123456789\x80",       // Lone continuation byte after a long ASCII run
+        "abc\xC0\xAF",                          // Overlong '/'
+        "abc\xE0\x80\xAF",                      // Overlong three-byte form
+        "abc\xED\xA0\x80",                      // Encoded surrogate
+        "abc\xF4\x90\x80\x80",                  // Above U+10FFFF
+        "abc\xE4\xB8",                          // Truncated sequence
+        "caf\xE9 au lait"                       // Latin-1
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        TEST_ASSERT(!ckg_utf8_validate((const uint8_t*)invalid[i], strlen(invalid[i])), "Malformed UTF-8 should fail");
+    }
+
+    char repaired[64];
+    size_t length = ckg_utf8_repair((const uint8_t*)"a\xFF" "b\xE4\xB8\xAD", 6, repaired);
+    TEST_ASSERT(length == 8 && memcmp(repaired, "a\xEF\xBF\xBD" "b\xE4\xB8\xAD", 8) == 0,
+                "Invalid bytes should become U+FFFD and valid ones be kept");
+
+    TEST_PASS("UTF-8 Validation");
+}
+
+// 测试UTF-16转UTF-8（长ASCII段、中文、代理对与孤立代理）
+int test_utf16_transcoding() {
+    TEST_START("UTF-16 Transcoding");
+
+    const char* text = "public class Program { static void Main() { Console.WriteLine(\"你好，世界\"); } }\r\n";
+    uint8_t utf16[512];
+    char utf8[512 * CKG_UTF8_PER_UTF16_UNIT];
+    for (int big_endian = 0; big_endian <= 1; big_endian++) {
+        size_t units = encode_utf16(text, big_endian, utf16);
+        size_t length = ckg_utf16_to_utf8(utf16, units, big_endian, utf8);
+        TEST_ASSERT(length == strlen(text) && memcmp(utf8, text, length) == 0,
+                    "UTF-16 in either byte order should round-trip to the original UTF-8");
+        // 非对齐输入也应正确
+        memmove(utf16 + 1, utf16, units * 2);
+        length = ckg_utf16_to_utf8(utf16 + 1, units, big_endian, utf8);
+        TEST_ASSERT(length == strlen(text) && memcmp(utf8, text, length) == 0, "Unaligned input should convert");
+    }
+
+    const uint8_t pairs[] = { 0x3D, 0xD8, 0x00, 0xDE, 0x00, 0xD8, 'x', 0x00, 0x00, 0xDC };
+    size_t length = ckg_utf16_to_utf8(pairs, 5, false, utf8);
+    TEST_ASSERT(length == 11 && memcmp(utf8, "\xF0\x9F\x98\x80\xEF\xBF\xBDx\xEF\xBF\xBD", 11) == 0,
+                "Surrogate pairs should combine and unpaired surrogates become U+FFFD");
+
+    TEST_PASS("UTF-16 Transcoding");
+}
+
+// 测试Latin-1转UTF-8（0x80-0x9F按Windows-1252处理）
+int test_latin1_transcoding() {
+    TEST_START("Latin-1 Transcoding");
+
+    const char latin1[] = "// caf\xE9 \x80 \x93quoted\x94 0123456789abcdef\xFF";
+    char utf8[sizeof(latin1) * CKG_UTF8_PER_BYTE];
+    size_t length = ckg_latin1_to_utf8((const uint8_t*)latin1, sizeof(latin1) - 1, utf8);
+    const char expected[] = "// caf\xC3\xA9 \xE2\x82\xAC \xE2\x80\x9Cquoted\xE2\x80\x9D 0123456789abcdef\xC3\xBF";
+    TEST_ASSERT(length == sizeof(expected) - 1 && memcmp(utf8, expected, length) == 0,
+                "Latin-1 and Windows-1252 characters should convert to UTF-8");
+    TEST_ASSERT(ckg_utf8_validate((const uint8_t*)utf8, length), "Converted text should be valid UTF-8");
+
+    TEST_PASS("Latin-1 Transcoding");
+}
+
+// 测试文件内容解码：有效UTF-8原地使用，其他编码转码
+int test_decode_source() {
+    TEST_START("Decode Source");
+
+    CKGDecodedSource source;
+    const char plain[] = "int 名称;\n";
+    TEST_ASSERT(ckg_decode_source(plain, sizeof(plain) - 1, &source) == NULL, "Decoding should succeed");
+    TEST_ASSERT(source.owned == NULL && source.data == plain, "Valid UTF-8 should be used in place");
+    ckg_decoded_source_free(&source);
+
+    const char with_bom[] = "\xEF\xBB\xBFint x;\n";
+    TEST_ASSERT(ckg_decode_source(with_bom, sizeof(with_bom) - 1, &source) == NULL, "Decoding should succeed");
+    TEST_ASSERT(source.owned == NULL && source.data == with_bom + 3 && source.length == 7,
+                "The UTF-8 BOM should be skipped without a copy");
+    ckg_decoded_source_free(&source);
+
+    const char broken_bom[] = "\xEF\xBB\xBFint \xFFx;";
+    TEST_ASSERT(ckg_decode_source(broken_bom, sizeof(broken_bom) - 1, &source) == NULL, "Decoding should succeed");
+    TEST_ASSERT(source.encoding == CKG_ENCODING_UTF8 && source.length == 9 &&
+                memcmp(source.data, "int \xEF\xBF\xBDx;", 9) == 0,
+                "Invalid bytes in a BOM-marked UTF-8 file should be replaced");
+    ckg_decoded_source_free(&source);
+
+    uint8_t utf16[64] = { 0xFF, 0xFE };
+    size_t units = encode_utf16("int 名称;\n", false, utf16 + 2);
+    TEST_ASSERT(ckg_decode_source((const char*)utf16, units * 2 + 2, &source) == NULL, "Decoding should succeed");
+    TEST_ASSERT(source.encoding == CKG_ENCODING_UTF16LE && source.length == sizeof(plain) - 1 &&
+                memcmp(source.data, plain, source.length) == 0, "UTF-16 should be transcoded");
+    ckg_decoded_source_free(&source);
+
+    const char latin1[] = "char* s = \"caf\xE9\";\n";
+    TEST_ASSERT(ckg_decode_source(latin1, sizeof(latin1) - 1, &source) == NULL, "Decoding should succeed");
+    TEST_ASSERT(source.encoding == CKG_ENCODING_LATIN1 && source.length == sizeof(latin1) &&
+                ckg_utf8_validate((const uint8_t*)source.data, source.length),
+                "Text that is not UTF-8 should be read as Latin-1");
+    ckg_decoded_source_free(&source);
+
+    TEST_PASS("Decode Source");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Encoding Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    test_encoding_detection();
+    test_utf8_validation();
+    test_utf16_transcoding();
+    test_latin1_transcoding();
+    test_decode_source();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
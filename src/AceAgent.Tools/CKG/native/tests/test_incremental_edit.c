@@ -0,0 +1,101 @@
+#include "test_framework.h"
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+static uint32_t edit_u32(const uint8_t* buffer, uint32_t offset) {
+    uint32_t value;
+    memcpy(&value, buffer + offset, sizeof(value));
+    return value;
+}
+
+// 测试增量解析：编辑后只报告发生变化的符号，其余符号按行差移动
+int test_incremental_edit_changed_symbols() {
+    TEST_START("Incremental Edit");
+
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+
+    uint32_t length = (uint32_t)strlen(c_function_code);
+    uint32_t size = 0;
+    uint8_t* opened = ckg_open_document(ctx, 1, CKG_LANG_C, c_function_code, length, &size);
+    TEST_ASSERT(opened != NULL && edit_u32(opened, 8) == CKG_STATUS_OK, "Should open the document");
+    TEST_ASSERT(edit_u32(opened, 12) == 2, "The opened document should have both functions");
+    ckg_free_binary(opened);
+
+    // 重命名 print_number：旧符号被删除，新符号被添加
+    const char* old_name = "print_number";
+    const char* new_name = "show_number";
+    uint32_t start = (uint32_t)(strstr(c_function_code, old_name) - c_function_code);
+    char renamed[256];
+    snprintf(renamed, sizeof(renamed), "%.*s%s%s", (int)start, c_function_code, new_name,
+             c_function_code + start + strlen(old_name));
+    uint32_t new_length = (uint32_t)strlen(renamed);
+    uint8_t* edit = ckg_apply_edit(ctx, 1, start, start + (uint32_t)strlen(old_name), start + (uint32_t)strlen(new_name),
+                                   renamed, new_length, &size);
+    TEST_ASSERT(edit != NULL && memcmp(edit, CKG_EDIT_MAGIC, 4) == 0, "Should return an edit result");
+    TEST_ASSERT(edit_u32(edit, 8) == CKG_STATUS_OK && edit_u32(edit, 36) == size, "The edit should apply");
+    TEST_ASSERT(edit_u32(edit, 12) == 2 && edit_u32(edit, 24) == 0, "A rename should remove one symbol and add one");
+
+    uint32_t strings = edit_u32(edit, 28);
+    uint32_t record_size = edit_u32(edit, 16);
+    bool removed = false;
+    bool added = false;
+    for (uint32_t i = 0; i < 2; i++) {
+        const uint8_t* record = edit + CKG_EDIT_HEADER_SIZE + i * record_size;
+        const char* name = (const char*)edit + strings + edit_u32(record, 4);
+        uint32_t name_length = edit_u32(record, 8);
+        if (record[0] == CKG_SYMBOL_REMOVED) {
+            removed = name_length == strlen(old_name) && memcmp(name, old_name, name_length) == 0 &&
+                      edit_u32(record, 28) == 5 && edit_u32(record, 32) == 7;
+        } else if (record[0] == CKG_SYMBOL_ADDED) {
+            added = name_length == strlen(new_name) && memcmp(name, new_name, name_length) == 0 &&
+                    edit_u32(record, 20) == 5 && edit_u32(record, 24) == 7;
+        }
+    }
+    TEST_ASSERT(removed && added, "The records should carry the old and new names with their lines");
+    ckg_free_binary(edit);
+
+    // 在两个函数之间插入空行：后面的函数只是移动
+    uint32_t blank = (uint32_t)(strstr(renamed, "\n\n") - renamed) + 1;
+    char spaced[256];
+    snprintf(spaced, sizeof(spaced), "%.*s\n%s", (int)blank, renamed, renamed + blank);
+    edit = ckg_apply_edit(ctx, 1, blank, blank, blank + 1, spaced, new_length + 1, &size);
+    TEST_ASSERT(edit != NULL && edit_u32(edit, 8) == CKG_STATUS_OK, "The second edit should apply");
+    TEST_ASSERT(edit_u32(edit, 20) == 4 && (int32_t)edit_u32(edit, 24) == 1, "Lines after line 4 should move down one");
+    for (uint32_t i = 0; i < edit_u32(edit, 12); i++) {
+        TEST_ASSERT(edit[CKG_EDIT_HEADER_SIZE + i * edit_u32(edit, 16)] == CKG_SYMBOL_CHANGED,
+                    "Inserting a blank line should not add or remove symbols");
+    }
+    ckg_free_binary(edit);
+
+    // 关闭后的文档和不一致的编辑都会报错
+    ckg_close_document(ctx, 1);
+    edit = ckg_apply_edit(ctx, 1, 0, 0, 1, spaced, new_length + 1, &size);
+    TEST_ASSERT(edit != NULL && edit_u32(edit, 8) == CKG_STATUS_ERROR, "A closed document should not accept edits");
+    ckg_free_binary(edit);
+
+    ckg_context_destroy(ctx);
+
+    TEST_PASS("Incremental Edit");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Incremental Edit Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_incremental_edit_changed_symbols();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include "test_framework.h"
+#include "test_index_run.h"
+#include <utime.h>
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+// 测试增量索引：未修改的文件不读取，内容未变的文件不解析
+int test_incremental_index_fingerprints() {
+    TEST_START("Incremental Index");
+
+    char root[] = "/tmp/ckg_index_XXXXXX";
+    TEST_ASSERT(mkdtemp(root) != NULL, "Should create a temporary directory");
+    char path[128];
+    snprintf(path, sizeof(path), "%s/functions.c", root);
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT(file != NULL, "Should create a source file");
+    fputs(c_function_code, file);
+    fclose(file);
+
+    IndexRun first, second, third;
+    run_index(root, NULL, &first, NULL, NULL);
+    TEST_ASSERT(first.file_count == 1 && first.states[0] == CKG_FILE_NEW && first.parsed_count == 1,
+                "A file without a fingerprint should be parsed");
+    TEST_ASSERT(first.files[0].size == strlen(c_function_code) && first.files[0].hash != 0,
+                "The fingerprint should carry the size and content hash");
+
+    run_index(root, &first, &second, NULL, NULL);
+    TEST_ASSERT(second.file_count == 1 && second.states[0] == CKG_FILE_UNCHANGED && second.parsed_count == 0,
+                "An untouched file should not be parsed again");
+
+    // 修改时间变化但内容相同：只计算哈希
+    struct utimbuf times = { 1000000000, 1000000000 };
+    utime(path, &times);
+    run_index(root, &second, &third, NULL, NULL);
+    TEST_ASSERT(third.file_count == 1 && third.states[0] == CKG_FILE_TOUCHED && third.parsed_count == 0,
+                "A touched file with the same contents should not be parsed");
+    TEST_ASSERT(third.files[0].hash == first.files[0].hash && third.files[0].mtime != first.files[0].mtime,
+                "The new fingerprint should keep the hash and record the new time");
+    free_index_run(&second);
+
+    // 内容变化：重新解析
+    file = fopen(path, "a");
+    fputs("int extra(void) { return 1; }\n", file);
+    fclose(file);
+    run_index(root, &third, &second, NULL, NULL);
+    TEST_ASSERT(second.file_count == 1 && second.states[0] == CKG_FILE_CHANGED && second.parsed_count == 1,
+                "A file with new contents should be parsed");
+
+    free_index_run(&first);
+    free_index_run(&second);
+    free_index_run(&third);
+    unlink(path);
+    rmdir(root);
+
+    TEST_PASS("Incremental Index");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Incremental Index Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_incremental_index_fingerprints();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
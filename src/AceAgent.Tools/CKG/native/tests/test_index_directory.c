@@ -0,0 +1,154 @@
+#include "test_framework.h"
+#include <sys/stat.h>
+
+#define MAX_FILES 16
+
+typedef struct {
+    size_t root_length;
+    char* paths[MAX_FILES];
+    int count;
+    int stop_after;     // Return false after this many files; 0 = never
+} IndexedPaths;
+
+static bool collect_path(void* user_data, const char* file_path, CKGLanguage language, const CKGParseResult* result) {
+    (void)language;
+    (void)result;
+    IndexedPaths* indexed = (IndexedPaths*)user_data;
+    if (indexed->count < MAX_FILES) {
+        // Relative to the root, without the separator
+        indexed->paths[indexed->count++] = strdup(file_path + indexed->root_length + 1);
+    }
+    return indexed->stop_after == 0 || indexed->count < indexed->stop_after;
+}
+
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+// The collected paths, sorted and joined with spaces, for comparison
+static const char* joined_paths(IndexedPaths* indexed) {
+    static char joined[512];
+    joined[0] = '\0';
+    qsort(indexed->paths, (size_t)indexed->count, sizeof(char*), compare_paths);
+    for (int i = 0; i < indexed->count; i++) {
+        if (i > 0) {
+            strcat(joined, " ");
+        }
+        strcat(joined, indexed->paths[i]);
+    }
+    return joined;
+}
+
+static void free_paths(IndexedPaths* indexed) {
+    for (int i = 0; i < indexed->count; i++) {
+        free(indexed->paths[i]);
+    }
+    indexed->count = 0;
+}
+
+static int index_tree(const char* root, const char* const* include_exts, const char* const* ignore_globs,
+                      const CKGIndexOptions* options, IndexedPaths* indexed) {
+    free_paths(indexed);
+    indexed->root_length = strlen(root);
+    return ckg_index_directory(root, include_exts, ignore_globs, options, collect_path, indexed);
+}
+
+static bool write_file(const char* root, const char* relative_path, const char* content) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", root, relative_path);
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fputs(content, file);
+    fclose(file);
+    return true;
+}
+
+// 测试目录索引：.gitignore（含嵌套与取反）、忽略规则、扩展名过滤和提前停止
+int test_index_directory_walk() {
+    TEST_START("Index Directory Walk");
+
+    char root[] = "/tmp/ckg_walk_XXXXXX";
+    TEST_ASSERT(mkdtemp(root) != NULL, "Should create a temporary directory");
+    static const char* directories[] = { ".git", "build", "src", "src/deep", "vendor" };
+    char path[256];
+    for (size_t i = 0; i < sizeof(directories) / sizeof(directories[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, directories[i]);
+        TEST_ASSERT(mkdir(path, 0755) == 0, "Should create a subdirectory");
+    }
+    static const char* files[] = {
+        "main.c", "script.py", "notes.txt", ".git/hook.c", "build/out.c", "src/util.c", "src/util.h",
+        "src/table.gen.c", "src/keep.gen.c", "src/local.c", "src/deep/inner.c", "vendor/lib.c"
+    };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        TEST_ASSERT(write_file(root, files[i], "int f(void) { return 0; }\n"), "Should create a source file");
+    }
+    TEST_ASSERT(write_file(root, ".gitignore", "# build output\nbuild/\n*.gen.c\n!keep.gen.c\n"),
+                "Should create the root .gitignore");
+    TEST_ASSERT(write_file(root, "src/.gitignore", "/local.c\n"), "Should create a nested .gitignore");
+
+    IndexedPaths indexed = {0};
+    static const char* const ignore_globs[] = { "vendor/", NULL };
+    int count = index_tree(root, NULL, ignore_globs, NULL, &indexed);
+    TEST_ASSERT(count == 6, "Should deliver every file that is not ignored");
+    TEST_ASSERT(strcmp(joined_paths(&indexed),
+                       "main.c script.py src/deep/inner.c src/keep.gen.c src/util.c src/util.h") == 0,
+                "Ignored, unsupported and .git files should be skipped, negated rules kept");
+
+    // 只索引指定的扩展名
+    static const char* const c_only[] = { ".c", NULL };
+    count = index_tree(root, c_only, ignore_globs, NULL, &indexed);
+    TEST_ASSERT(count == 4 && strcmp(joined_paths(&indexed), "main.c src/deep/inner.c src/keep.gen.c src/util.c") == 0,
+                "Only the included extensions should be indexed");
+
+    // 不读取.gitignore时只应用忽略规则
+    CKGIndexOptions options = {0};
+    options.disable_gitignore = true;
+    count = index_tree(root, c_only, ignore_globs, &options, &indexed);
+    TEST_ASSERT(count == 7 && strcmp(joined_paths(&indexed),
+                                     "build/out.c main.c src/deep/inner.c src/keep.gen.c src/local.c "
+                                     "src/table.gen.c src/util.c") == 0,
+                "Without .gitignore only the ignore globs should apply, and .git stays skipped");
+
+    // 回调返回false后不再投递
+    indexed.stop_after = 2;
+    count = index_tree(root, NULL, ignore_globs, NULL, &indexed);
+    TEST_ASSERT(count == 2 && indexed.count == 2, "No files should be delivered after the callback stops");
+    indexed.stop_after = 0;
+
+    TEST_ASSERT(index_tree("/nonexistent/ckg_walk", NULL, NULL, NULL, &indexed) == -1,
+                "A missing root should fail");
+
+    free_paths(&indexed);
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/.gitignore", root);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/src/.gitignore", root);
+    unlink(path);
+    // 子目录在父目录之后创建，逆序删除
+    for (size_t i = sizeof(directories) / sizeof(directories[0]); i > 0; i--) {
+        snprintf(path, sizeof(path), "%s/%s", root, directories[i - 1]);
+        rmdir(path);
+    }
+    rmdir(root);
+
+    TEST_PASS("Index Directory Walk");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Directory Index Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_index_directory_walk();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
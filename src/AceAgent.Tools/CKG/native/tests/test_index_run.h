@@ -0,0 +1,53 @@
+#ifndef TEST_INDEX_RUN_H
+#define TEST_INDEX_RUN_H
+
+// Shared by the directory index tests: one ckg_index_directory run with its
+// fingerprints, handed to the next run as the known files
+
+#include "test_framework.h"
+
+typedef struct {
+    CKGFileFingerprint files[4];
+    CKGFileState states[4];
+    int file_count;
+    int parsed_count;
+} IndexRun;
+
+static bool record_file(void* user_data, const CKGFileFingerprint* file, CKGFileState state) {
+    IndexRun* run = (IndexRun*)user_data;
+    if (run->file_count < 4) {
+        run->files[run->file_count] = *file;
+        run->files[run->file_count].path = strdup(file->path);
+        run->states[run->file_count++] = state;
+    }
+    return true;
+}
+
+static bool count_parsed(void* user_data, const char* file_path, CKGLanguage language, const CKGParseResult* result) {
+    (void)file_path;
+    (void)language;
+    (void)result;
+    ((IndexRun*)user_data)->parsed_count++;
+    return true;
+}
+
+// 用上一次的指纹重新索引目录，可同时写出符号索引和文本索引文件
+static void run_index(const char* root, IndexRun* previous, IndexRun* run, const char* index_path,
+                      const char* text_index_path) {
+    memset(run, 0, sizeof(*run));
+    CKGIndexOptions options = {0};
+    options.known_files = previous ? previous->files : NULL;
+    options.known_file_count = previous ? (uint32_t)previous->file_count : 0;
+    options.on_file = record_file;
+    options.index_path = index_path;
+    options.text_index_path = text_index_path;
+    ckg_index_directory(root, NULL, NULL, &options, count_parsed, run);
+}
+
+static void free_index_run(IndexRun* run) {
+    for (int i = 0; i < run->file_count; i++) {
+        free((char*)run->files[i].path);
+    }
+}
+
+#endif // TEST_INDEX_RUN_H
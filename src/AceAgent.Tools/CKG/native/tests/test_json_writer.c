@@ -0,0 +1,131 @@
+#include "test_framework.h"
+#include "../wrapper/ckg_json.h"
+
+typedef struct {
+    char* data;
+    size_t length;
+    int chunks;
+    int stop_after;     // Refuse the chunk after this many; 0 = never
+} ChunkSink;
+
+static bool collect_chunk(void* user_data, const char* chunk, size_t length) {
+    ChunkSink* sink = (ChunkSink*)user_data;
+    if (sink->stop_after > 0 && sink->chunks >= sink->stop_after) {
+        return false;
+    }
+    sink->data = realloc(sink->data, sink->length + length + 1);
+    memcpy(sink->data + sink->length, chunk, length);
+    sink->length += length;
+    sink->data[sink->length] = '\0';
+    sink->chunks++;
+    return true;
+}
+
+// 测试字符串转义
+int test_json_escaping() {
+    TEST_START("JSON String Escaping");
+
+    CKGJsonWriter writer;
+    ckg_json_init(&writer, NULL, NULL);
+    const char text[] = "a\"b\\c\nd\te\x01\x1f" "\xe4\xb8\xad";
+    ckg_json_write_string(&writer, text, sizeof(text) - 1);
+    char* json = ckg_json_take(&writer);
+    ckg_json_free(&writer);
+
+    TEST_ASSERT(json != NULL, "Should produce a document");
+    TEST_ASSERT(strcmp(json, "\"a\\\"b\\\\c\\nd\\te\\u0001\\u001f\xe4\xb8\xad\"") == 0,
+                "Quotes, backslashes and control characters should be escaped, UTF-8 kept");
+    free(json);
+
+    TEST_PASS("JSON String Escaping");
+}
+
+// 测试大量写入时的增长（原实现在约40个函数后溢出）
+int test_json_growth() {
+    TEST_START("JSON Buffer Growth");
+
+    CKGJsonWriter writer;
+    ckg_json_init(&writer, NULL, NULL);
+    ckg_json_write_cstr(&writer, "[");
+    for (int i = 0; i < 100000; i++) {
+        ckg_json_write_cstr(&writer, i > 0 ? ", " : "");
+        ckg_json_write_int(&writer, i);
+    }
+    ckg_json_write_cstr(&writer, "]");
+    size_t expected_length = writer.length;
+    char* json = ckg_json_take(&writer);
+    ckg_json_free(&writer);
+
+    TEST_ASSERT(json != NULL, "Should produce a document");
+    TEST_ASSERT(strlen(json) == expected_length, "Tracked length should match the document");
+    TEST_ASSERT(strncmp(json, "[0, 1, 2", 8) == 0, "Document should start with the first values");
+    TEST_ASSERT(strcmp(json + expected_length - 6, "99999]") == 0, "Document should end with the last value");
+    free(json);
+
+    TEST_PASS("JSON Buffer Growth");
+}
+
+// 测试分块回调输出与缓冲输出一致
+int test_json_streaming() {
+    TEST_START("JSON Chunk Streaming");
+
+    CKGJsonWriter buffered;
+    CKGJsonWriter streamed;
+    ChunkSink sink = {0};
+    ckg_json_init(&buffered, NULL, NULL);
+    ckg_json_init(&streamed, collect_chunk, &sink);
+
+    char name[64];
+    for (int i = 0; i < 5000; i++) {
+        int length = snprintf(name, sizeof(name), "Namespace::Type<%d>::\"method\"", i);
+        ckg_json_write_string(&buffered, name, (size_t)length);
+        ckg_json_write_string(&streamed, name, (size_t)length);
+    }
+    TEST_ASSERT(ckg_json_flush(&streamed), "Flush should succeed");
+    TEST_ASSERT(streamed.capacity == CKG_JSON_CHUNK_SIZE, "Streaming buffer should stay at one chunk");
+    char* json = ckg_json_take(&buffered);
+
+    TEST_ASSERT(sink.chunks > 1, "Output should arrive in several chunks");
+    TEST_ASSERT(json != NULL && sink.data != NULL && strcmp(json, sink.data) == 0,
+                "Streamed output should equal buffered output");
+
+    free(json);
+    free(sink.data);
+    ckg_json_free(&buffered);
+    ckg_json_free(&streamed);
+
+    TEST_PASS("JSON Chunk Streaming");
+}
+
+// 测试回调返回false后停止输出
+int test_json_stream_stop() {
+    TEST_START("JSON Stream Stop");
+
+    CKGJsonWriter writer;
+    ChunkSink sink = { .stop_after = 1 };
+    ckg_json_init(&writer, collect_chunk, &sink);
+    for (int i = 0; i < 100000; i++) {
+        ckg_json_write_int(&writer, i);
+    }
+
+    TEST_ASSERT(!ckg_json_flush(&writer), "Flush should report the stop");
+    TEST_ASSERT(sink.chunks == 1, "No chunks should be delivered after the stop");
+
+    free(sink.data);
+    ckg_json_free(&writer);
+
+    TEST_PASS("JSON Stream Stop");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== JSON Writer Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    test_json_escaping();
+    test_json_growth();
+    test_json_streaming();
+    test_json_stream_stop();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
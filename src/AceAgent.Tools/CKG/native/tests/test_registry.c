@@ -0,0 +1,58 @@
+#include "test_framework.h"
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+// 测试语言注册表：ckg_parse_json使用显式语言参数，切换语言后结果不变
+int test_registry_languages() {
+    TEST_START("Language Registry");
+    
+    // 扩展名不可识别时按语言参数解析
+    char* json = ckg_parse_json(NULL, c_function_code, "c", "snippet.txt");
+    TEST_ASSERT(json != NULL && strstr(json, "\"add\"") != NULL, "The explicit language should be used");
+    ckg_free_json_result(json);
+    json = ckg_parse_json(NULL, c_function_code, "", "snippet.h");
+    TEST_ASSERT(json != NULL && strstr(json, "\"add\"") != NULL, "The extension should be used without a language");
+    ckg_free_json_result(json);
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    uint32_t length = (uint32_t)strlen(c_function_code);
+    uint32_t first_size = 0;
+    uint32_t again_size = 0;
+    uint8_t* first = ckg_parse_binary(ctx, CKG_LANG_C, c_function_code, length, &first_size);
+    const char* js_code = "function greet(name) { return name; }";
+    uint32_t js_size = 0;
+    uint8_t* js = ckg_parse_binary(ctx, CKG_LANG_JAVASCRIPT, js_code, (uint32_t)strlen(js_code), &js_size);
+    uint8_t* again = ckg_parse_binary(ctx, CKG_LANG_C, c_function_code, length, &again_size);
+    TEST_ASSERT(first != NULL && js != NULL && again != NULL, "All parses should produce a result");
+    TEST_ASSERT(js[8] == CKG_STATUS_OK && js[12] == 1, "JavaScript should parse in the same context");
+    TEST_ASSERT(first_size == again_size && memcmp(first, again, first_size) == 0,
+                "Switching languages should not change the C result");
+    ckg_free_binary(first);
+    ckg_free_binary(js);
+    ckg_free_binary(again);
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("Language Registry");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Language Registry Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_registry_languages();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#include "test_framework.h"
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+// 测试上下文性能统计
+int test_stats_context() {
+    TEST_START("Parse Statistics");
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    
+    uint32_t length = (uint32_t)strlen(c_function_code);
+    CKGParseResult* result = ckg_parse_spans(ctx, CKG_LANG_C, c_function_code, length);
+    TEST_ASSERT(result != NULL && result->error_message == NULL, "Parse should succeed");
+    ckg_free_result(result);
+    
+    // 不支持的语言计入该语言的错误数
+    result = ckg_parse_spans(ctx, CKG_LANG_LUA, c_function_code, length);
+    ckg_free_result(result);
+    
+    CKGStats stats;
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.files_parsed == 1, "Only the successful parse should count as a file");
+    TEST_ASSERT(stats.bytes_parsed == length, "Should count the parsed bytes");
+    TEST_ASSERT(stats.symbols_extracted >= 2, "Should count both functions");
+    TEST_ASSERT(stats.arena_high_water > 0, "Should record the result block size");
+    TEST_ASSERT(stats.errors == 1 && stats.errors_by_language[CKG_LANG_LUA] == 1,
+                "Should count the failure against its language");
+    
+    ckg_context_reset_stats(ctx);
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.files_parsed == 0 && stats.errors == 0, "Reset should clear the counters");
+    
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("Parse Statistics");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Parse Statistics Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_stats_context();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include "test_framework.h"
+#include "test_index_run.h"
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+// 测试符号索引文件：按名称、文件和类查询，未修改的文件沿用上一次的符号
+int test_symbol_index_queries() {
+    TEST_START("Symbol Index");
+
+    char root[] = "/tmp/ckg_symbols_XXXXXX";
+    TEST_ASSERT(mkdtemp(root) != NULL, "Should create a temporary directory");
+    char path[128];
+    char index_path[128];
+    snprintf(path, sizeof(path), "%s/functions.c", root);
+    snprintf(index_path, sizeof(index_path), "%s.ckgi", root);
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT(file != NULL, "Should create a source file");
+    fputs(c_function_code, file);
+    fclose(file);
+
+    IndexRun first, second;
+    run_index(root, NULL, &first, index_path, NULL);
+    CKGIndex* index = ckg_index_open(index_path);
+    TEST_ASSERT(index != NULL, "Indexing should write the symbol index");
+
+    uint32_t position = 0;
+    CKGIndexSymbol symbol;
+    TEST_ASSERT(ckg_index_find(index, CKG_INDEX_BY_NAME, "add", &position) == 1, "Should find the function by name");
+    TEST_ASSERT(ckg_index_get(index, CKG_INDEX_BY_NAME, position, &symbol), "Should read the symbol");
+    TEST_ASSERT(symbol.kind == CKG_SYMBOL_FUNCTION && symbol.start_line == 1 && strcmp(symbol.file_path, path) == 0,
+                "The symbol should carry its kind, line and file");
+    TEST_ASSERT(ckg_index_find(index, CKG_INDEX_BY_NAME, "ad", NULL) == 0, "Names should match exactly");
+
+    uint32_t count = ckg_index_find(index, CKG_INDEX_BY_FILE, path, &position);
+    TEST_ASSERT(count == 2, "Should find both functions of the file");
+    TEST_ASSERT(ckg_index_get(index, CKG_INDEX_BY_FILE, position + 1, &symbol) &&
+                strcmp(symbol.name, "print_number") == 0, "A file's symbols should be in line order");
+    ckg_index_close(index);
+
+    // 写入器：类成员按类查询
+    CKGIndexWriter* writer = ckg_index_writer_create();
+    ckg_index_writer_add(writer, "a.cs", CKG_LANG_CSHARP, CKG_SYMBOL_CLASS, "Parser", NULL, 1, 20);
+    ckg_index_writer_add(writer, "a.cs", CKG_LANG_CSHARP, CKG_SYMBOL_FUNCTION, "Run", "Parser", 3, 9);
+    ckg_index_writer_add(writer, "a.cs", CKG_LANG_CSHARP, CKG_SYMBOL_FIELD, "count", "Parser", 2, 2);
+    ckg_index_writer_add(writer, "b.cs", CKG_LANG_CSHARP, CKG_SYMBOL_FUNCTION, "Run", "Other", 5, 6);
+    char writer_path[160];
+    snprintf(writer_path, sizeof(writer_path), "%s/writer.ckgi", root);
+    TEST_ASSERT(ckg_index_writer_write(writer, writer_path) == 0, "The writer should write an index");
+    ckg_index_writer_destroy(writer);
+    index = ckg_index_open(writer_path);
+    TEST_ASSERT(index != NULL, "Should open the written index");
+    TEST_ASSERT(ckg_index_find(index, CKG_INDEX_BY_CLASS, "Parser", &position) == 2, "Should find both members");
+    TEST_ASSERT(ckg_index_get(index, CKG_INDEX_BY_CLASS, position, &symbol) && strcmp(symbol.name, "Run") == 0,
+                "Members should be in name order");
+    TEST_ASSERT(ckg_index_find(index, CKG_INDEX_BY_NAME, "Run", NULL) == 2, "Both Run methods share a name");
+    ckg_index_close(index);
+    unlink(writer_path);
+
+    // 未修改的文件不解析，符号从旧索引复制
+    run_index(root, &first, &second, index_path, NULL);
+    TEST_ASSERT(second.file_count == 1 && second.parsed_count == 0, "The unchanged file should not be parsed");
+    index = ckg_index_open(index_path);
+    TEST_ASSERT(index != NULL && ckg_index_find(index, CKG_INDEX_BY_FILE, path, NULL) == 2,
+                "The rewritten index should keep the unchanged file's symbols");
+    ckg_index_close(index);
+
+    free_index_run(&first);
+    free_index_run(&second);
+    unlink(index_path);
+    unlink(path);
+    rmdir(root);
+
+    TEST_PASS("Symbol Index");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Symbol Index Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_symbol_index_queries();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
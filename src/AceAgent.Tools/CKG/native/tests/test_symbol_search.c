@@ -0,0 +1,73 @@
+#include "test_framework.h"
+
+// 测试符号搜索：前缀、模糊和驼峰匹配按得分排序
+int test_symbol_search_ranking() {
+    TEST_START("Symbol Search");
+
+    static const char* names[] = {"ParseCodeResult", "parse_code_result", "parseConfig", "ParseCode", "getHttpServer"};
+    CKGIndexWriter* writer = ckg_index_writer_create();
+    for (int i = 0; i < 5; i++) {
+        ckg_index_writer_add(writer, "search.c", CKG_LANG_C, CKG_SYMBOL_FUNCTION, names[i], NULL, (uint32_t)i + 1,
+                             (uint32_t)i + 1);
+    }
+    ckg_index_writer_add(writer, "other.c", CKG_LANG_C, CKG_SYMBOL_FUNCTION, "ParseCode", NULL, 1, 1);
+    char path[] = "/tmp/ckg_search_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0, "Should create a temporary file");
+    close(fd);
+    TEST_ASSERT(ckg_index_writer_write(writer, path) == 0, "The writer should write an index");
+    ckg_index_writer_destroy(writer);
+    CKGIndex* index = ckg_index_open(path);
+    TEST_ASSERT(index != NULL, "Should open the written index");
+
+    // 前缀：忽略大小写，短的在前
+    CKGIndexMatch matches[8];
+    uint32_t found = ckg_index_search(index, CKG_SEARCH_PREFIX, "parse", 0, matches, 8);
+    TEST_ASSERT(found == 4, "Four names start with parse");
+    TEST_ASSERT(strcmp(matches[0].name, "ParseCode") == 0 && matches[0].count == 2 && matches[0].score == 4,
+                "The shortest name should come first with both of its symbols");
+    TEST_ASSERT(strcmp(matches[1].name, "parseConfig") == 0 && strcmp(matches[3].name, "parse_code_result") == 0,
+                "Names should be ordered by length");
+    TEST_ASSERT(ckg_index_search(index, CKG_SEARCH_PREFIX, "parse", 0, matches, 2) == 2 &&
+                strcmp(matches[1].name, "parseConfig") == 0, "Only the best names should be returned");
+
+    // 模糊：编辑距离不超过上限
+    found = ckg_index_search(index, CKG_SEARCH_FUZZY, "prseConfgi", 2, matches, 8);
+    TEST_ASSERT(found == 1 && strcmp(matches[0].name, "parseConfig") == 0 && matches[0].score == 2,
+                "A deletion and a transposition should be two edits");
+    TEST_ASSERT(ckg_index_search(index, CKG_SEARCH_FUZZY, "prseConfgi", 1, matches, 8) == 0,
+                "Names beyond the distance should not match");
+
+    // 驼峰：大写字母和分隔符开始新的一段
+    found = ckg_index_search(index, CKG_SEARCH_CAMEL, "PCR", 0, matches, 8);
+    TEST_ASSERT(found == 2 && strcmp(matches[0].name, "ParseCodeResult") == 0 &&
+                strcmp(matches[1].name, "parse_code_result") == 0, "PCR should find both spellings");
+    TEST_ASSERT(ckg_index_search(index, CKG_SEARCH_CAMEL, "pcr", 0, matches, 8) == 2,
+                "A lowercase query should be one letter per hump");
+    found = ckg_index_search(index, CKG_SEARCH_CAMEL, "PaCo", 0, matches, 8);
+    TEST_ASSERT(found == 4 && strcmp(matches[0].name, "ParseCode") == 0 && matches[0].score == 0 &&
+                matches[2].score == 1, "Names with extra humps should rank after exact hump counts");
+    TEST_ASSERT(ckg_index_search(index, CKG_SEARCH_CAMEL, "GHS", 0, matches, 8) == 1, "Should find getHttpServer");
+
+    // 子串：名称中任意位置，忽略大小写
+    found = ckg_index_search(index, CKG_SEARCH_SUBSTRING, "CODE", 0, matches, 8);
+    TEST_ASSERT(found == 3 && strcmp(matches[0].name, "ParseCode") == 0 && matches[0].score == 5 &&
+                strcmp(matches[2].name, "parse_code_result") == 0, "Names containing code should rank by length");
+    TEST_ASSERT(ckg_index_search(index, CKG_SEARCH_SUBSTRING, "pS", 0, matches, 8) == 1,
+                "Queries shorter than a trigram should check every name");
+
+    ckg_index_close(index);
+    unlink(path);
+
+    TEST_PASS("Symbol Search");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Symbol Search Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    test_symbol_search_ranking();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include "test_framework.h"
+#include "test_index_run.h"
+
+static const char* c_function_code = 
+    "int add(int a, int b) {\n"
+    "    return a + b;\n"
+    "}\n"
+    "\n"
+    "void print_number(int n) {\n"
+    "    printf(\"%d\\n\", n);\n"
+    "}\n";
+
+typedef struct {
+    int count;
+    uint32_t line;
+    uint32_t column;
+    char text[64];
+} TextHits;
+
+static bool record_text(void* user_data, const CKGTextMatch* match) {
+    TextHits* hits = (TextHits*)user_data;
+    if (hits->count++ == 0) {
+        hits->line = match->line;
+        hits->column = match->column;
+        snprintf(hits->text, sizeof(hits->text), "%.*s", (int)match->line_length, match->line_text);
+    }
+    return true;
+}
+
+static int search_text(const CKGTextIndex* index, const char* pattern, uint32_t flags, TextHits* hits) {
+    memset(hits, 0, sizeof(*hits));
+    return ckg_text_index_search(index, pattern, flags, 0, record_text, hits);
+}
+
+// 测试文本索引：三元组筛选候选文件后逐行匹配，未修改的文件沿用上一次的三元组
+int test_text_index_search() {
+    TEST_START("Text Index");
+
+    char root[] = "/tmp/ckg_text_XXXXXX";
+    TEST_ASSERT(mkdtemp(root) != NULL, "Should create a temporary directory");
+    char path[128];
+    char notes_path[128];
+    char index_path[128];
+    snprintf(path, sizeof(path), "%s/functions.c", root);
+    snprintf(notes_path, sizeof(notes_path), "%s/notes.c", root);
+    snprintf(index_path, sizeof(index_path), "%s.ckgt", root);
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT(file != NULL, "Should create a source file");
+    fputs(c_function_code, file);
+    fclose(file);
+    file = fopen(notes_path, "w");
+    TEST_ASSERT(file != NULL, "Should create a second source file");
+    fputs("// Print the NUMBER\r\n", file);
+    fclose(file);
+
+    IndexRun first, second;
+    run_index(root, NULL, &first, NULL, index_path);
+    CKGTextIndex* index = ckg_text_index_open(index_path);
+    TEST_ASSERT(index != NULL, "Indexing should write the text index");
+    uint32_t file_count = 0;
+    ckg_text_index_get_info(index, &file_count, NULL);
+    TEST_ASSERT(file_count == 2, "Both files should be indexed");
+
+    TextHits hits;
+    TEST_ASSERT(search_text(index, "print_number", 0, &hits) == 1, "Should find the literal once");
+    TEST_ASSERT(hits.line == 5 && hits.column == 6 && strcmp(hits.text, "void print_number(int n) {") == 0,
+                "A match should carry its line, column and line text");
+    TEST_ASSERT(search_text(index, "PRINT", 0, &hits) == 0, "Matching should be case sensitive by default");
+    TEST_ASSERT(search_text(index, "PRINT", CKG_TEXT_IGNORE_CASE, &hits) == 3 && hits.line == 5,
+                "Ignoring case should find every line, files in path order");
+    TEST_ASSERT(search_text(index, "print", CKG_TEXT_IGNORE_CASE | CKG_TEXT_FILES_ONLY, &hits) == 2,
+                "Files only should report each file once");
+    TEST_ASSERT(search_text(index, "NUMBER", 0, &hits) == 1 && strcmp(hits.text, "// Print the NUMBER") == 0,
+                "The line text should not include the line break");
+    TEST_ASSERT(search_text(index, "subtract", 0, &hits) == 0, "An absent literal should find nothing");
+    TEST_ASSERT(ckg_text_index_search(index, "", 0, 0, record_text, &hits) == -1,
+                "An empty pattern needs files only");
+    ckg_text_index_close(index);
+
+    // 未修改的文件不读取，三元组从旧索引复制
+    run_index(root, &first, &second, NULL, index_path);
+    TEST_ASSERT(second.file_count == 2 && second.parsed_count == 0, "Unchanged files should not be parsed");
+    index = ckg_text_index_open(index_path);
+    TEST_ASSERT(index != NULL && search_text(index, "return a + b", 0, &hits) == 1 && hits.line == 2,
+                "The rewritten index should keep the unchanged files' trigrams");
+    ckg_text_index_close(index);
+
+    free_index_run(&first);
+    free_index_run(&second);
+    unlink(index_path);
+    unlink(notes_path);
+    unlink(path);
+    rmdir(root);
+
+    TEST_PASS("Text Index");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Text Index Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_text_index_search();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
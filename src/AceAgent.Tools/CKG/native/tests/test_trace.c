@@ -0,0 +1,134 @@
+// Trace ring tests. Tracing is compiled out of the default library, so this
+// program builds the ring itself with tracing on:
+//
+//   cc -DCKG_TRACE_LEVEL=3 -Iwrapper tests/test_trace.c wrapper/ckg_trace.c -lpthread
+
+#include "test_framework.h"
+#include <pthread.h>
+#include "../wrapper/ckg_trace.h"
+
+#if CKG_TRACE_LEVEL <= 0
+#error "test_trace needs CKG_TRACE_LEVEL > 0"
+#endif
+
+// Events per thread; matches TRACE_RING_SIZE in ckg_trace.c
+#define RING_EVENTS 4096
+
+static CKGTraceEvent drained[2 * RING_EVENTS];
+
+static void emit_range(uint64_t first, uint64_t count) {
+    for (uint64_t i = first; i < first + count; i++) {
+        ckg_trace_emit(CKG_TRACE_LEVEL_INFO, CKG_TRACE_PARSE_BEGIN, i, 0);
+    }
+}
+
+// Whether `count` drained events carry consecutive arg0 values from `first`
+static bool consecutive(const CKGTraceEvent* events, uint32_t count, uint64_t first) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (events[i].arg0 != first + i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 测试记录与读取：事件按顺序读出，读取后清空
+int test_trace_drain() {
+    TEST_START("Trace Drain");
+
+    TEST_ASSERT(ckg_trace_level() == CKG_TRACE_LEVEL, "The compiled-in level should be reported");
+
+    CKG_TRACE_ERROR(CKG_TRACE_PARSE_FAILED, CKG_LANG_C, 42);
+    emit_range(0, 10);
+    uint32_t count = ckg_trace_drain(drained, 64);
+    TEST_ASSERT(count == 11, "Every recorded event should be drained");
+    TEST_ASSERT(drained[0].level == CKG_TRACE_LEVEL_ERROR && drained[0].kind == CKG_TRACE_PARSE_FAILED &&
+                drained[0].arg0 == CKG_LANG_C && drained[0].arg1 == 42, "The event should keep its level, kind and arguments");
+    TEST_ASSERT(consecutive(drained + 1, 10, 0), "Events should come out in the order they were recorded");
+    TEST_ASSERT(drained[10].timestamp_ns >= drained[0].timestamp_ns && drained[10].thread_id == drained[0].thread_id,
+                "Events of one thread share its id and have rising timestamps");
+    TEST_ASSERT(ckg_trace_drain(drained, 64) == 0, "A drained ring should be empty");
+    TEST_ASSERT(ckg_trace_drain(NULL, 64) == 0 && ckg_trace_drain(drained, 0) == 0, "No buffer should drain nothing");
+
+    TEST_PASS("Trace Drain");
+}
+
+// 测试环形缓冲区：写满后丢弃新事件，部分读取后写入位置回绕
+int test_trace_overflow_and_wraparound() {
+    TEST_START("Trace Overflow And Wraparound");
+
+    // 写满：多出的事件被丢弃，而不是覆盖未读的事件
+    emit_range(0, RING_EVENTS + 100);
+    uint32_t count = ckg_trace_drain(drained, 2 * RING_EVENTS);
+    TEST_ASSERT(count == RING_EVENTS, "A full ring should hold exactly its capacity");
+    TEST_ASSERT(consecutive(drained, count, 0), "The oldest events should be kept and new ones dropped");
+
+    // 读取一部分后继续写入，越过数组末尾回到开头
+    emit_range(0, 3000);
+    count = ckg_trace_drain(drained, 1000);
+    TEST_ASSERT(count == 1000 && consecutive(drained, count, 0), "A partial drain should take the oldest events");
+    emit_range(3000, 2000);
+    count = ckg_trace_drain(drained, 2 * RING_EVENTS);
+    TEST_ASSERT(count == 4000, "Slots freed by the partial drain should be reused");
+    TEST_ASSERT(consecutive(drained, count, 1000), "Wrapped events should stay in order");
+    TEST_ASSERT(ckg_trace_drain(drained, 64) == 0, "The ring should be empty again");
+
+    TEST_PASS("Trace Overflow And Wraparound");
+}
+
+static void* emit_on_thread(void* argument) {
+    emit_range((uint64_t)(uintptr_t)argument, 5);
+    ckg_trace_release_thread();
+    return NULL;
+}
+
+// 测试多线程：每个线程有自己的缓冲区，退出后缓冲区被复用，未读的事件保留
+int test_trace_threads() {
+    TEST_START("Trace Threads");
+
+    emit_range(0, 3);
+    pthread_t thread;
+    TEST_ASSERT(pthread_create(&thread, NULL, emit_on_thread, (void*)(uintptr_t)100) == 0, "Should start a thread");
+    pthread_join(thread, NULL);
+
+    uint32_t count = ckg_trace_drain(drained, 64);
+    TEST_ASSERT(count == 8, "Events from both threads should be drained");
+    uint32_t own_id = 0;
+    uint32_t other_id = 0;
+    uint32_t own = 0;
+    uint32_t other = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (drained[i].arg0 >= 100) {
+            TEST_ASSERT(drained[i].arg0 == 100 + other, "The thread's events should be grouped and in order");
+            other_id = drained[i].thread_id;
+            other++;
+        } else {
+            TEST_ASSERT(drained[i].arg0 == own, "This thread's events should be grouped and in order");
+            own_id = drained[i].thread_id;
+            own++;
+        }
+    }
+    TEST_ASSERT(own == 3 && other == 5 && own_id != other_id, "Each thread should record under its own id");
+
+    // 释放的缓冲区由下一个线程接手，使用新的线程编号
+    TEST_ASSERT(pthread_create(&thread, NULL, emit_on_thread, (void*)(uintptr_t)200) == 0, "Should start a thread");
+    pthread_join(thread, NULL);
+    count = ckg_trace_drain(drained, 64);
+    TEST_ASSERT(count == 5 && consecutive(drained, count, 200), "A reused ring should record the new thread's events");
+    TEST_ASSERT(drained[0].thread_id != other_id && drained[0].thread_id != own_id,
+                "A thread adopting a ring should get a new id");
+
+    TEST_PASS("Trace Threads");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Trace Ring Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    test_trace_drain();
+    test_trace_overflow_and_wraparound();
+    test_trace_threads();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+#include "test_framework.h"
+
+static const char* c_struct_code = 
+    "struct Point {\n"
+    "    int x;\n"
+    "    int y;\n"
+    "};\n"
+    "\n"
+    "typedef struct {\n"
+    "    char name[50];\n"
+    "    int age;\n"
+    "} Person;\n";
+
+// 测试树缓存：未修改的源码第二次解析命中缓存，结果一致
+int test_tree_cache_hits() {
+    TEST_START("Tree Cache");
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    ckg_cache_set_budget(1024 * 1024);
+    
+    uint32_t length = (uint32_t)strlen(c_struct_code);
+    uint32_t first_size = 0;
+    uint32_t second_size = 0;
+    uint8_t* first = ckg_parse_binary(ctx, CKG_LANG_C, c_struct_code, length, &first_size);
+    uint8_t* second = ckg_parse_binary(ctx, CKG_LANG_C, c_struct_code, length, &second_size);
+    TEST_ASSERT(first != NULL && second != NULL, "Both parses should produce a result");
+    TEST_ASSERT(first_size == second_size && memcmp(first, second, first_size) == 0,
+                "A cached parse should give the same result");
+    ckg_free_binary(first);
+    ckg_free_binary(second);
+    
+    CKGStats stats;
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.cache_misses == 1 && stats.cache_hits == 1, "The second parse should hit the cache");
+    TEST_ASSERT(stats.files_parsed == 1, "Only the first parse should run the parser");
+    
+    // 其他语言或不同内容不会命中
+    CKGParseResult* result = ckg_parse_spans(ctx, CKG_LANG_CPP, c_struct_code, length);
+    ckg_free_result(result);
+    result = ckg_parse_spans(ctx, CKG_LANG_C, c_struct_code, length - 1);
+    ckg_free_result(result);
+    ckg_context_get_stats(ctx, &stats);
+    TEST_ASSERT(stats.cache_hits == 1 && stats.cache_misses == 3, "Language and content should be part of the key");
+    
+    uint64_t bytes = 0;
+    uint32_t entries = 0;
+    ckg_cache_get_usage(&bytes, &entries);
+    TEST_ASSERT(entries == 3 && bytes > 0 && bytes <= 1024 * 1024, "The cache should stay within its budget");
+    
+    ckg_cache_set_budget(0);
+    ckg_cache_get_usage(&bytes, &entries);
+    TEST_ASSERT(entries == 0 && bytes == 0, "A zero budget should empty the cache");
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("Tree Cache");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== Tree Cache Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_tree_cache_hits();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
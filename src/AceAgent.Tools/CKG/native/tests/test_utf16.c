@@ -0,0 +1,61 @@
+#include "test_framework.h"
+
+// 测试UTF-16输入与UTF-8结果一致（含中文）
+int test_utf16_matches_utf8() {
+    TEST_START("UTF-16 Input");
+    
+    const char* utf8_code =
+        "// 计算两数之和\n"
+        "int add(int a, int b) {\n"
+        "    return a + b; // 返回结果\n"
+        "}\n"
+        "const char* 名称 = \"中文\";\n"
+        "void print_名称(void) {}\n";
+    
+    // 按UTF-8解码为UTF-16代码单元（测试文本只含BMP字符）
+    uint16_t utf16_code[256];
+    uint32_t units = 0;
+    for (const unsigned char* p = (const unsigned char*)utf8_code; *p; units++) {
+        if (*p < 0x80) {
+            utf16_code[units] = *p++;
+        } else if (*p < 0xE0) {
+            utf16_code[units] = (uint16_t)(((p[0] & 0x1F) << 6) | (p[1] & 0x3F));
+            p += 2;
+        } else {
+            utf16_code[units] = (uint16_t)(((p[0] & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+            p += 3;
+        }
+    }
+    
+    CKGContext* ctx = ckg_context_create();
+    TEST_ASSERT(ctx != NULL, "Should create a context");
+    
+    uint32_t utf8_size = 0;
+    uint32_t utf16_size = 0;
+    uint8_t* from_utf8 = ckg_parse_binary(ctx, CKG_LANG_C, utf8_code, (uint32_t)strlen(utf8_code), &utf8_size);
+    uint8_t* from_utf16 = ckg_parse_utf16(ctx, CKG_LANG_C, utf16_code, units, &utf16_size);
+    TEST_ASSERT(from_utf8 != NULL && from_utf16 != NULL, "Both parses should produce a result");
+    TEST_ASSERT(from_utf16[8] == CKG_STATUS_OK, "UTF-16 parse should succeed");
+    TEST_ASSERT(utf8_size == utf16_size && memcmp(from_utf8, from_utf16, utf8_size) == 0,
+                "UTF-16 input should give the same names and lines as UTF-8");
+    
+    ckg_free_binary(from_utf8);
+    ckg_free_binary(from_utf16);
+    ckg_context_destroy(ctx);
+    
+    TEST_PASS("UTF-16 Input");
+}
+
+int main() {
+    printf(ANSI_COLOR_BLUE "=== UTF-16 Input Tests ===" ANSI_COLOR_RESET "\n\n");
+
+    ckg_init();
+
+    test_utf16_matches_utf8();
+
+    ckg_cleanup();
+
+    TEST_SUMMARY();
+
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#ifndef CKG_ARENA_H
+#define CKG_ARENA_H
+
+// Bump allocator over a single caller-sized block. Parse results are carved
+// out of one block like this (header, arrays and every string), so building
+// a result costs one malloc and freeing it one free.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CKG_ARENA_ALIGNMENT 8
+
+typedef struct {
+    char* base;
+    size_t used;
+    size_t capacity;
+} CKGArena;
+
+// Bytes an allocation of `size` occupies, including alignment padding
+static inline size_t ckg_arena_footprint(size_t size) {
+    return (size + CKG_ARENA_ALIGNMENT - 1) & ~(size_t)(CKG_ARENA_ALIGNMENT - 1);
+}
+
+// Allocate the backing block. The first allocation from the arena returns
+// its start, which is what the owner eventually passes to free().
+static inline bool ckg_arena_init(CKGArena* arena, size_t capacity) {
+    arena->base = (char*)malloc(capacity);
+    arena->used = 0;
+    arena->capacity = arena->base ? capacity : 0;
+    return arena->base != NULL;
+}
+
+// Zeroed, aligned allocation; NULL if the block is exhausted
+static inline void* ckg_arena_alloc(CKGArena* arena, size_t size) {
+    size_t footprint = ckg_arena_footprint(size);
+    if (footprint > arena->capacity - arena->used) {
+        return NULL;
+    }
+    void* memory = arena->base + arena->used;
+    arena->used += footprint;
+    memset(memory, 0, footprint);
+    return memory;
+}
+
+// Copy `length` bytes into the arena as a NUL-terminated string (unaligned)
+static inline char* ckg_arena_strndup(CKGArena* arena, const char* text, size_t length) {
+    if (length + 1 > arena->capacity - arena->used) {
+        return NULL;
+    }
+    char* copy = arena->base + arena->used;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    arena->used += length + 1;
+    return copy;
+}
+
+static inline char* ckg_arena_strdup(CKGArena* arena, const char* text) {
+    return ckg_arena_strndup(arena, text, strlen(text));
+}
+
+#endif // CKG_ARENA_H
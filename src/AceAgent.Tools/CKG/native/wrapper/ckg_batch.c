@@ -0,0 +1,121 @@
+#define BUILDING_CKG_DLL
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+#include "ckg_pool.h"
+#include "ckg_fs.h"
+
+typedef struct {
+    const char* const* file_paths;
+    CKGParseResult** results;
+    CKGContext** contexts;
+    uint64_t timeout_micros;
+    CKGSizePolicy size_policy;
+    volatile int32_t succeeded;
+} BatchJob;
+
+typedef struct {
+    uint32_t index;
+    uint64_t size;
+} BatchEntry;
+
+static void parse_batch_file(void* user, uint32_t worker_index, uint32_t task_index) {
+    BatchJob* job = (BatchJob*)user;
+    const char* file_path = job->file_paths[task_index];
+    CKGParseResult* result = NULL;
+    
+    CKGContext* ctx = job->contexts[worker_index];
+    if (!ctx) {
+        ctx = job->contexts[worker_index] = ckg_context_create();
+        ckg_context_set_timeout(ctx, job->timeout_micros);
+        ckg_context_set_size_policy(ctx, &job->size_policy);
+    }
+    
+    int language = ckg_language_from_path(file_path);
+    if (!ctx) {
+        result = ckg_create_error_result("Failed to create parsing context");
+    } else if (language < 0) {
+        result = ckg_create_error_result("Unsupported language");
+    } else {
+        result = ckg_parse_path(ctx, (CKGLanguage)language, file_path);
+    }
+    
+    if (result && result->status == CKG_STATUS_OK) {
+        ckg_atomic_add32(&job->succeeded, 1);
+    }
+    job->results[task_index] = result;
+}
+
+static int compare_by_size_desc(const void* a, const void* b) {
+    const BatchEntry* left = (const BatchEntry*)a;
+    const BatchEntry* right = (const BatchEntry*)b;
+    if (left->size != right->size) {
+        return left->size > right->size ? -1 : 1;
+    }
+    return left->index < right->index ? -1 : (left->index > right->index);
+}
+
+// Parse many files in one call on a native work-stealing pool
+CKG_API int ckg_parse_batch(const char* const* file_paths, uint32_t count, const CKGBatchOptions* options, CKGParseResult** results_out) {
+    if (!file_paths || !results_out) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    
+    CKGBatchOptions defaults = {0};
+    if (!options) {
+        options = &defaults;
+    }
+    
+    uint32_t worker_count = ckg_pool_worker_count(options->thread_count, count);
+    uint32_t* order = NULL;
+    
+    // Schedule the largest files first so a huge file is never the last one
+    // left running on a single core
+    if (!options->disable_size_ordering) {
+        BatchEntry* entries = (BatchEntry*)malloc(count * sizeof(BatchEntry));
+        order = (uint32_t*)malloc(count * sizeof(uint32_t));
+        if (entries && order) {
+            for (uint32_t i = 0; i < count; i++) {
+                int64_t size = ckg_file_size(file_paths[i]);
+                entries[i].index = i;
+                entries[i].size = size > 0 ? (uint64_t)size : 0;
+            }
+            qsort(entries, count, sizeof(BatchEntry), compare_by_size_desc);
+            for (uint32_t i = 0; i < count; i++) {
+                order[i] = entries[i].index;
+            }
+        } else {
+            free(order);
+            order = NULL;
+        }
+        free(entries);
+    }
+    
+    BatchJob job;
+    job.file_paths = file_paths;
+    job.results = results_out;
+    job.contexts = (CKGContext**)calloc(worker_count, sizeof(CKGContext*));
+    job.timeout_micros = options->timeout_micros;
+    job.size_policy = options->size_policy;
+    job.succeeded = 0;
+    if (!job.contexts) {
+        free(order);
+        return -1;
+    }
+    
+    memset(results_out, 0, count * sizeof(CKGParseResult*));
+    ckg_pool_run(worker_count, order, count, parse_batch_file, &job);
+    
+    for (uint32_t w = 0; w < worker_count; w++) {
+        ckg_context_destroy(job.contexts[w]);
+    }
+    free(job.contexts);
+    free(order);
+    
+    return ckg_atomic_load32(&job.succeeded);
+}
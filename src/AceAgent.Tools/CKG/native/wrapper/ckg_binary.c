@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+
+// Flat binary encoding of a parse result (layout documented with
+// CKG_BINARY_VERSION in ckg_wrapper.h). Every field is written byte by byte
+// in little-endian order, so the output is identical on any host and the
+// managed reader never has to consider host byte order.
+
+static inline uint8_t* put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+}
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static uint8_t* put_header(uint8_t* out, uint32_t status, uint32_t function_count, uint32_t class_count,
+                           uint32_t string_table_size, uint32_t total_size) {
+    uint32_t string_table_offset = CKG_BINARY_HEADER_SIZE +
+                                   function_count * CKG_BINARY_FUNCTION_RECORD_SIZE +
+                                   class_count * CKG_BINARY_CLASS_RECORD_SIZE;
+    memcpy(out, CKG_BINARY_MAGIC, 4);
+    out = put_u16(out + 4, CKG_BINARY_VERSION);
+    out = put_u16(out, CKG_BINARY_HEADER_SIZE);
+    out = put_u32(out, status);
+    out = put_u32(out, function_count);
+    out = put_u32(out, CKG_BINARY_FUNCTION_RECORD_SIZE);
+    out = put_u32(out, class_count);
+    out = put_u32(out, CKG_BINARY_CLASS_RECORD_SIZE);
+    out = put_u32(out, string_table_offset);
+    out = put_u32(out, string_table_size);
+    return put_u32(out, total_size);
+}
+
+uint8_t* ckg_binary_error(const char* message, uint32_t* size_out) {
+    uint32_t length = (uint32_t)strlen(message);
+    uint32_t size = CKG_BINARY_HEADER_SIZE + length;
+    uint8_t* buffer = (uint8_t*)malloc(size);
+    if (!buffer) {
+        return NULL;
+    }
+    put_header(buffer, CKG_STATUS_ERROR, 0, 0, length, size);
+    memcpy(buffer + CKG_BINARY_HEADER_SIZE, message, length);
+    *size_out = size;
+    return buffer;
+}
+
+uint8_t* ckg_binary_build(const ParsedData* data, const char* source_code, uint32_t status, uint32_t* size_out) {
+    // Names go into the string table in record order; consecutive functions
+    // of the same class reuse one copy of the class name
+    uint64_t strings = 0;
+    CKGSpan previous_class = { 0, 0 };
+    for (int i = 0; i < data->function_count; i++) {
+        const ExtractedFunction* function = &data->functions[i];
+        strings += function->name.length;
+        if (function->class_name.length > 0 &&
+            (function->class_name.offset != previous_class.offset || function->class_name.length != previous_class.length)) {
+            strings += function->class_name.length;
+            previous_class = function->class_name;
+        }
+    }
+    for (int i = 0; i < data->class_count; i++) {
+        strings += data->classes[i].name.length;
+    }
+
+    uint64_t size = (uint64_t)CKG_BINARY_HEADER_SIZE +
+                    (uint64_t)data->function_count * CKG_BINARY_FUNCTION_RECORD_SIZE +
+                    (uint64_t)data->class_count * CKG_BINARY_CLASS_RECORD_SIZE + strings;
+    if (size > UINT32_MAX) {
+        return ckg_binary_error("Result too large", size_out);
+    }
+    uint8_t* buffer = (uint8_t*)malloc((size_t)size);
+    if (!buffer) {
+        return NULL;
+    }
+
+    uint8_t* record = put_header(buffer, status, (uint32_t)data->function_count, (uint32_t)data->class_count,
+                                 (uint32_t)strings, (uint32_t)size);
+    uint8_t* string_table = record + (size_t)data->function_count * CKG_BINARY_FUNCTION_RECORD_SIZE +
+                            (size_t)data->class_count * CKG_BINARY_CLASS_RECORD_SIZE;
+    uint32_t string_used = 0;
+
+    uint32_t class_offset = 0;
+    previous_class.offset = 0;
+    previous_class.length = 0;
+    for (int i = 0; i < data->function_count; i++) {
+        const ExtractedFunction* function = &data->functions[i];
+        record = put_u32(record, string_used);
+        record = put_u32(record, function->name.length);
+        memcpy(string_table + string_used, source_code + function->name.offset, function->name.length);
+        string_used += function->name.length;
+
+        if (function->class_name.length > 0 &&
+            (function->class_name.offset != previous_class.offset || function->class_name.length != previous_class.length)) {
+            class_offset = string_used;
+            memcpy(string_table + string_used, source_code + function->class_name.offset, function->class_name.length);
+            string_used += function->class_name.length;
+            previous_class = function->class_name;
+        }
+        record = put_u32(record, function->class_name.length > 0 ? class_offset : 0);
+        record = put_u32(record, function->class_name.length);
+        record = put_u32(record, (uint32_t)function->start_line);
+        record = put_u32(record, (uint32_t)function->end_line);
+    }
+
+    for (int i = 0; i < data->class_count; i++) {
+        const ExtractedClass* cls = &data->classes[i];
+        record = put_u32(record, string_used);
+        record = put_u32(record, cls->name.length);
+        record = put_u32(record, (uint32_t)cls->start_line);
+        record = put_u32(record, (uint32_t)cls->end_line);
+        memcpy(string_table + string_used, source_code + cls->name.offset, cls->name.length);
+        string_used += cls->name.length;
+    }
+
+    *size_out = (uint32_t)size;
+    return buffer;
+}
@@ -0,0 +1,293 @@
+#define BUILDING_CKG_DLL
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+
+// Process-wide LRU cache of parsed trees and their extracted symbols (see
+// ckg_cache_set_budget). Every context shares it under one mutex. Lookups
+// copy the symbols out, so no entry is used outside the lock and eviction
+// never races a reader. Entries are found through a chained hash table and
+// kept on a list from most to least recently used.
+
+// Tree-sitter does not report a tree's size; trees run to a few bytes of
+// nodes per byte of source, so they are charged at this rate
+#define CKG_CACHE_TREE_BYTES_PER_SOURCE_BYTE 4
+#define CKG_CACHE_MIN_BUCKETS 256
+
+typedef struct CacheEntry {
+    CKGCacheKey key;
+    TSTree* tree;
+    ExtractedFunction* functions;       // Both arrays live in the entry's block
+    ExtractedClass* classes;
+    int function_count;
+    int class_count;
+    uint64_t bytes;                     // Charged against the budget
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+    struct CacheEntry* next_in_bucket;
+} CacheEntry;
+
+static struct {
+    CKGMutex lock;
+    bool ready;
+    volatile uint64_t budget;
+    uint64_t bytes;
+    uint32_t count;
+    CacheEntry** buckets;
+    uint32_t bucket_count;              // Power of two, or 0 before the first entry
+    CacheEntry* newest;
+    CacheEntry* oldest;
+} cache;
+
+static inline bool same_key(const CKGCacheKey* a, const CKGCacheKey* b) {
+    return a->hash == b->hash && a->length == b->length && a->language == b->language && a->encoding == b->encoding;
+}
+
+static inline CacheEntry** bucket_for(const CKGCacheKey* key) {
+    return &cache.buckets[(uint32_t)(key->hash ^ (key->hash >> 32)) & (cache.bucket_count - 1)];
+}
+
+static void unlink_recency(CacheEntry* entry) {
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        cache.newest = entry->older;
+    }
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache.oldest = entry->newer;
+    }
+}
+
+static void push_newest(CacheEntry* entry) {
+    entry->newer = NULL;
+    entry->older = cache.newest;
+    if (cache.newest) {
+        cache.newest->newer = entry;
+    } else {
+        cache.oldest = entry;
+    }
+    cache.newest = entry;
+}
+
+static void remove_entry(CacheEntry* entry) {
+    CacheEntry** link = bucket_for(&entry->key);
+    while (*link != entry) {
+        link = &(*link)->next_in_bucket;
+    }
+    *link = entry->next_in_bucket;
+    unlink_recency(entry);
+    cache.bytes -= entry->bytes;
+    cache.count--;
+    ts_tree_delete(entry->tree);
+    free(entry);
+}
+
+// Evict least recently used entries until `incoming` more bytes fit.
+// Returns how many were evicted. Called with the lock held.
+static uint32_t evict_for(uint64_t incoming) {
+    uint32_t evicted = 0;
+    uint64_t budget = cache.budget;
+    while (cache.oldest && cache.bytes + incoming > budget) {
+        remove_entry(cache.oldest);
+        evicted++;
+    }
+    return evicted;
+}
+
+// Keep about one entry per bucket. Called with the lock held.
+static void grow_buckets(void) {
+    if (cache.count < cache.bucket_count) {
+        return;
+    }
+    uint32_t bucket_count = cache.bucket_count ? cache.bucket_count * 2 : CKG_CACHE_MIN_BUCKETS;
+    CacheEntry** buckets = (CacheEntry**)calloc(bucket_count, sizeof(CacheEntry*));
+    if (!buckets) {
+        return;     // Longer chains, still correct
+    }
+    CacheEntry** old_buckets = cache.buckets;
+    uint32_t old_count = cache.bucket_count;
+    cache.buckets = buckets;
+    cache.bucket_count = bucket_count;
+    for (uint32_t i = 0; i < old_count; i++) {
+        CacheEntry* entry = old_buckets[i];
+        while (entry) {
+            CacheEntry* next = entry->next_in_bucket;
+            CacheEntry** bucket = bucket_for(&entry->key);
+            entry->next_in_bucket = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(old_buckets);
+}
+
+void ckg_cache_init(void) {
+    if (!cache.ready) {
+        ckg_mutex_init(&cache.lock);
+        cache.budget = 0;
+        cache.ready = true;
+    }
+}
+
+void ckg_cache_cleanup(void) {
+    if (!cache.ready) {
+        return;
+    }
+    ckg_cache_clear();
+    free(cache.buckets);
+    cache.buckets = NULL;
+    cache.bucket_count = 0;
+    ckg_mutex_destroy(&cache.lock);
+    cache.ready = false;
+}
+
+bool ckg_cache_enabled(void) {
+    return cache.ready && ckg_atomic_load64(&cache.budget) > 0;
+}
+
+bool ckg_cache_reserve(ParsedData* data, int function_count, int class_count) {
+    if (function_count > data->function_capacity) {
+        ExtractedFunction* functions = (ExtractedFunction*)realloc(data->functions, function_count * sizeof(ExtractedFunction));
+        if (!functions) {
+            return false;
+        }
+        data->functions = functions;
+        data->function_capacity = function_count;
+    }
+    if (class_count > data->class_capacity) {
+        ExtractedClass* classes = (ExtractedClass*)realloc(data->classes, class_count * sizeof(ExtractedClass));
+        if (!classes) {
+            return false;
+        }
+        data->classes = classes;
+        data->class_capacity = class_count;
+    }
+    return true;
+}
+
+bool ckg_cache_lookup(const CKGCacheKey* key, ParsedData* data) {
+    if (!ckg_cache_enabled()) {
+        return false;
+    }
+    bool hit = false;
+    ckg_mutex_lock(&cache.lock);
+    CacheEntry* entry = cache.bucket_count ? *bucket_for(key) : NULL;
+    while (entry && !same_key(&entry->key, key)) {
+        entry = entry->next_in_bucket;
+    }
+    if (entry) {
+        hit = ckg_cache_reserve(data, entry->function_count, entry->class_count);
+    }
+    if (hit) {
+        if (entry->function_count > 0) {
+            memcpy(data->functions, entry->functions, entry->function_count * sizeof(ExtractedFunction));
+        }
+        if (entry->class_count > 0) {
+            memcpy(data->classes, entry->classes, entry->class_count * sizeof(ExtractedClass));
+        }
+        data->function_count = entry->function_count;
+        data->class_count = entry->class_count;
+        unlink_recency(entry);
+        push_newest(entry);
+    }
+    ckg_mutex_unlock(&cache.lock);
+    return hit;
+}
+
+uint32_t ckg_cache_store(const CKGCacheKey* key, TSTree* tree, const ParsedData* data) {
+    size_t functions_size = (size_t)data->function_count * sizeof(ExtractedFunction);
+    size_t classes_size = (size_t)data->class_count * sizeof(ExtractedClass);
+    uint64_t bytes = sizeof(CacheEntry) + functions_size + classes_size +
+                     (tree ? (uint64_t)key->length * CKG_CACHE_TREE_BYTES_PER_SOURCE_BYTE : 0);
+    if (!ckg_cache_enabled() || bytes > ckg_atomic_load64(&cache.budget)) {
+        ts_tree_delete(tree);
+        return 0;
+    }
+
+    CacheEntry* entry = (CacheEntry*)malloc(sizeof(CacheEntry) + functions_size + classes_size);
+    if (!entry) {
+        ts_tree_delete(tree);
+        return 0;
+    }
+    entry->key = *key;
+    entry->tree = tree;
+    entry->functions = (ExtractedFunction*)(entry + 1);
+    entry->classes = (ExtractedClass*)((char*)entry->functions + functions_size);
+    entry->function_count = data->function_count;
+    entry->class_count = data->class_count;
+    entry->bytes = bytes;
+    if (functions_size > 0) {
+        memcpy(entry->functions, data->functions, functions_size);
+    }
+    if (classes_size > 0) {
+        memcpy(entry->classes, data->classes, classes_size);
+    }
+
+    ckg_mutex_lock(&cache.lock);
+    // Another context may have stored the same source meanwhile
+    CacheEntry* existing = cache.bucket_count ? *bucket_for(key) : NULL;
+    while (existing && !same_key(&existing->key, key)) {
+        existing = existing->next_in_bucket;
+    }
+    if (existing) {
+        remove_entry(existing);
+    }
+    uint32_t evicted = evict_for(bytes);
+    cache.count++;
+    grow_buckets();
+    if (!cache.buckets) {
+        cache.count--;
+        ckg_mutex_unlock(&cache.lock);
+        ts_tree_delete(tree);
+        free(entry);
+        return evicted;
+    }
+    CacheEntry** bucket = bucket_for(key);
+    entry->next_in_bucket = *bucket;
+    *bucket = entry;
+    push_newest(entry);
+    cache.bytes += bytes;
+    ckg_mutex_unlock(&cache.lock);
+    return evicted;
+}
+
+CKG_API void ckg_cache_set_budget(uint64_t budget_bytes) {
+    if (!cache.ready) {
+        return;
+    }
+    ckg_mutex_lock(&cache.lock);
+    ckg_atomic_store64(&cache.budget, budget_bytes);
+    evict_for(0);
+    ckg_mutex_unlock(&cache.lock);
+}
+
+CKG_API void ckg_cache_clear(void) {
+    if (!cache.ready) {
+        return;
+    }
+    ckg_mutex_lock(&cache.lock);
+    while (cache.oldest) {
+        remove_entry(cache.oldest);
+    }
+    ckg_mutex_unlock(&cache.lock);
+}
+
+CKG_API void ckg_cache_get_usage(uint64_t* bytes_out, uint32_t* entries_out) {
+    uint64_t bytes = 0;
+    uint32_t entries = 0;
+    if (cache.ready) {
+        ckg_mutex_lock(&cache.lock);
+        bytes = cache.bytes;
+        entries = cache.count;
+        ckg_mutex_unlock(&cache.lock);
+    }
+    if (bytes_out) {
+        *bytes_out = bytes;
+    }
+    if (entries_out) {
+        *entries_out = entries;
+    }
+}
@@ -0,0 +1,558 @@
+#define BUILDING_CKG_DLL
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_fs.h"
+#include "ckg_hash.h"
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+
+// Persistent parse cache (see ckg_disk_cache_set_directory). Each complete
+// parse is one small file holding its extracted symbols, named after a hash
+// of everything the symbols depend on: the source text, its length,
+// language and encoding, the grammar and the wrapper's extraction. Files are
+// written under a temporary name and renamed into place, so readers in this
+// or any other process see either a whole entry or none; entries are also
+// checksummed, so a truncated or foreign file is only a miss.
+//
+// Names are stored as spans of the source like everywhere else: an entry is
+// only found for the very same text, which the caller still holds.
+//
+// The directory fans out into 256 subdirectories by the first two hex digits
+// of the name. Hits touch the file's modification time, which is what
+// eviction orders by, so the least recently used entries go first. The size
+// of the cache is tracked from this process's writes after one scan of the
+// directory, and rescanned whenever it seems to exceed the budget, which
+// also accounts for what other processes wrote.
+
+// Bump whenever extraction changes what it finds for the same tree, so that
+// entries written by older wrappers miss instead of being trusted
+#define CKG_DISK_CACHE_VERSION 1
+
+#define CKG_DISK_CACHE_MAGIC "CKGC"
+#define CKG_DISK_CACHE_HEADER_SIZE 48
+#define CKG_DISK_CACHE_FUNCTION_SIZE 36
+#define CKG_DISK_CACHE_CLASS_SIZE 24
+#define CKG_DISK_CACHE_EXTENSION ".ckgc"
+
+// Eviction stops below this share of the budget (in tenths), so that the
+// next few writes do not each trigger another scan
+#define CKG_DISK_CACHE_LOW_WATER 9
+
+// Entry layout, little-endian:
+//   0  "CKGC"              4  u32 version
+//   8  u64 source hash     16 u32 source length
+//   20 u16 language        22 u16 encoding
+//   24 u64 grammar         32 u32 function count
+//   36 u32 class count     40 u64 checksum of the records
+//   48 function records: name offset, name length, class offset, class
+//      length, start line, end line, start byte, end byte, flags (u32 each;
+//      flag 1 = explicit class)
+//   then class records: name offset, name length, start line, end line,
+//      start byte, end byte (u32 each)
+
+static struct {
+    CKGMutex lock;
+    bool ready;
+    char* directory;                    // NULL while the cache is off
+    volatile uint64_t budget;           // 0 while the cache is off
+    uint64_t bytes;                     // Estimated size of the directory
+    uint32_t count;
+    bool counted;                       // bytes and count come from a scan
+    volatile int32_t pruning;
+} disk;
+
+static inline uint8_t* put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+}
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static inline uint8_t* put_u64(uint8_t* out, uint64_t value) {
+    put_u32(out, (uint32_t)value);
+    return put_u32(out + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t* in) {
+    return (uint64_t)get_u32(in) | ((uint64_t)get_u32(in + 4) << 32);
+}
+
+// Identifies the grammar a language is parsed with: its ABI, its table
+// sizes and, for grammars generated with the version in them, its semantic
+// version. Regenerating or upgrading a grammar changes this.
+static uint64_t grammar_version(CKGLanguage language) {
+    const TSLanguage* ts_language = ckg_ts_language(language);
+    if (!ts_language) {
+        return 0;
+    }
+    uint32_t parts[5];
+    parts[0] = ts_language_abi_version(ts_language);
+    parts[1] = ts_language_state_count(ts_language);
+    parts[2] = ts_language_symbol_count(ts_language);
+    parts[3] = ts_language_field_count(ts_language);
+    parts[4] = 0;
+    const TSLanguageMetadata* metadata = ts_language_metadata(ts_language);
+    if (metadata) {
+        parts[4] = ((uint32_t)metadata->major_version << 16) | ((uint32_t)metadata->minor_version << 8) |
+                   metadata->patch_version;
+    }
+    return ckg_hash64(parts, sizeof(parts), 0);
+}
+
+// The first 40 header bytes, which the entry's name is a hash of
+static void put_key(uint8_t* out, const CKGCacheKey* key, uint64_t grammar, uint32_t function_count,
+                    uint32_t class_count) {
+    memcpy(out, CKG_DISK_CACHE_MAGIC, 4);
+    out = put_u32(out + 4, CKG_DISK_CACHE_VERSION);
+    out = put_u64(out, key->hash);
+    out = put_u32(out, key->length);
+    out = put_u16(out, key->language);
+    out = put_u16(out, key->encoding);
+    out = put_u64(out, grammar);
+    out = put_u32(out, function_count);
+    put_u32(out, class_count);
+}
+
+// Path of the entry for `key`, or NULL if the cache is off or out of
+// memory. With `temporary`, a unique name next to it to write to first.
+static char* entry_path(const CKGCacheKey* key, uint64_t grammar, bool temporary) {
+    uint8_t header[CKG_DISK_CACHE_HEADER_SIZE];
+    put_key(header, key, grammar, 0, 0);
+    uint64_t name = ckg_hash64(header, 32, 0);
+
+    static volatile int32_t sequence;
+    char* path = NULL;
+    ckg_mutex_lock(&disk.lock);
+    if (disk.directory) {
+        size_t capacity = strlen(disk.directory) + 64;
+        path = (char*)malloc(capacity);
+        if (path) {
+            int length = snprintf(path, capacity, "%s/%02x/%014llx" CKG_DISK_CACHE_EXTENSION, disk.directory,
+                                  (unsigned)(name >> 56), (unsigned long long)(name & 0xFFFFFFFFFFFFFFull));
+            if (temporary) {
+                uint64_t unique = ckg_now_ns() ^ ((uint64_t)(uint32_t)ckg_atomic_add32(&sequence, 1) << 40);
+                snprintf(path + length, capacity - (size_t)length, ".%016llx.tmp", (unsigned long long)unique);
+            }
+        }
+    }
+    ckg_mutex_unlock(&disk.lock);
+    return path;
+}
+
+void ckg_disk_cache_init(void) {
+    if (!disk.ready) {
+        ckg_mutex_init(&disk.lock);
+        disk.directory = NULL;
+        disk.budget = 0;
+        disk.ready = true;
+    }
+}
+
+void ckg_disk_cache_cleanup(void) {
+    if (!disk.ready) {
+        return;
+    }
+    free(disk.directory);
+    disk.directory = NULL;
+    disk.budget = 0;
+    ckg_mutex_destroy(&disk.lock);
+    disk.ready = false;
+}
+
+bool ckg_disk_cache_enabled(void) {
+    return disk.ready && ckg_atomic_load64(&disk.budget) > 0;
+}
+
+// Check a mapped entry against `key` and decode its records into `data`
+static bool read_entry(const CKGMappedFile* file, const CKGCacheKey* key, uint64_t grammar, ParsedData* data) {
+    const uint8_t* in = (const uint8_t*)file->data;
+    if (file->length < CKG_DISK_CACHE_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t function_count = get_u32(in + 32);
+    uint32_t class_count = get_u32(in + 36);
+    uint8_t expected[CKG_DISK_CACHE_HEADER_SIZE];
+    put_key(expected, key, grammar, function_count, class_count);
+    uint64_t records_size = (uint64_t)function_count * CKG_DISK_CACHE_FUNCTION_SIZE +
+                            (uint64_t)class_count * CKG_DISK_CACHE_CLASS_SIZE;
+    if (memcmp(in, expected, 40) != 0 || file->length != CKG_DISK_CACHE_HEADER_SIZE + records_size ||
+        function_count > INT32_MAX || class_count > INT32_MAX) {
+        return false;
+    }
+    const uint8_t* record = in + CKG_DISK_CACHE_HEADER_SIZE;
+    if (ckg_hash64(record, (size_t)records_size, 0) != get_u64(in + 40) ||
+        !ckg_cache_reserve(data, (int)function_count, (int)class_count)) {
+        return false;
+    }
+
+    uint64_t limit = key->length;
+    for (uint32_t i = 0; i < function_count; i++, record += CKG_DISK_CACHE_FUNCTION_SIZE) {
+        ExtractedFunction* function = &data->functions[i];
+        function->name.offset = get_u32(record);
+        function->name.length = get_u32(record + 4);
+        function->class_name.offset = get_u32(record + 8);
+        function->class_name.length = get_u32(record + 12);
+        function->start_line = (int)get_u32(record + 16);
+        function->end_line = (int)get_u32(record + 20);
+        function->start_byte = get_u32(record + 24);
+        function->end_byte = get_u32(record + 28);
+        function->explicit_class = (get_u32(record + 32) & 1) != 0;
+        if ((uint64_t)function->name.offset + function->name.length > limit ||
+            (uint64_t)function->class_name.offset + function->class_name.length > limit) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < class_count; i++, record += CKG_DISK_CACHE_CLASS_SIZE) {
+        ExtractedClass* class_info = &data->classes[i];
+        class_info->name.offset = get_u32(record);
+        class_info->name.length = get_u32(record + 4);
+        class_info->start_line = (int)get_u32(record + 8);
+        class_info->end_line = (int)get_u32(record + 12);
+        class_info->start_byte = get_u32(record + 16);
+        class_info->end_byte = get_u32(record + 20);
+        if ((uint64_t)class_info->name.offset + class_info->name.length > limit) {
+            return false;
+        }
+    }
+    data->function_count = (int)function_count;
+    data->class_count = (int)class_count;
+    return true;
+}
+
+bool ckg_disk_cache_lookup(const CKGCacheKey* key, ParsedData* data) {
+    if (!ckg_disk_cache_enabled()) {
+        return false;
+    }
+    uint64_t grammar = grammar_version((CKGLanguage)key->language);
+    char* path = entry_path(key, grammar, false);
+    if (!path) {
+        return false;
+    }
+    CKGMappedFile file;
+    bool hit = false;
+    if (ckg_map_file(path, &file)) {
+        hit = read_entry(&file, key, grammar, data);
+        ckg_unmap_file(&file);
+    }
+    if (hit) {
+        ckg_touch_file(path);
+    } else {
+        data->function_count = 0;
+        data->class_count = 0;
+    }
+    free(path);
+    return hit;
+}
+
+typedef struct {
+    size_t path;                        // Offset into the path pool
+    uint64_t size;
+    int64_t mtime;
+} ScannedFile;
+
+typedef struct {
+    ScannedFile* files;
+    uint32_t count;
+    uint32_t capacity;
+    char* pool;
+    size_t pool_length;
+    size_t pool_capacity;
+    uint64_t bytes;
+} Scan;
+
+static bool scan_add(Scan* scan, const char* path, uint64_t size, int64_t mtime) {
+    size_t length = strlen(path) + 1;
+    if (scan->pool_length + length > scan->pool_capacity) {
+        size_t capacity = scan->pool_capacity ? scan->pool_capacity * 2 : 4096;
+        while (capacity < scan->pool_length + length) {
+            capacity *= 2;
+        }
+        char* pool = (char*)realloc(scan->pool, capacity);
+        if (!pool) {
+            return false;
+        }
+        scan->pool = pool;
+        scan->pool_capacity = capacity;
+    }
+    if (scan->count == scan->capacity) {
+        uint32_t capacity = scan->capacity ? scan->capacity * 2 : 256;
+        ScannedFile* files = (ScannedFile*)realloc(scan->files, capacity * sizeof(ScannedFile));
+        if (!files) {
+            return false;
+        }
+        scan->files = files;
+        scan->capacity = capacity;
+    }
+    ScannedFile* file = &scan->files[scan->count++];
+    file->path = scan->pool_length;
+    file->size = size;
+    file->mtime = mtime;
+    memcpy(scan->pool + scan->pool_length, path, length);
+    scan->pool_length += length;
+    scan->bytes += size;
+    return true;
+}
+
+static inline bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
+
+// List the files in the fan-out subdirectories of `directory`. Anything
+// else in it is left alone, so pointing the cache at a directory that holds
+// other files does not delete them.
+static void scan_directory(const char* directory, Scan* scan) {
+    CKGDirIterator* iterator = ckg_dir_open(directory);
+    if (!iterator) {
+        return;
+    }
+    size_t directory_length = strlen(directory);
+    char* path = (char*)malloc(directory_length + 1024);
+    const char* name;
+    CKGEntryType type;
+    while (path && (name = ckg_dir_next(iterator, &type)) != NULL) {
+        if (type != CKG_ENTRY_DIRECTORY || !is_hex(name[0]) || !is_hex(name[1]) || name[2] != '\0') {
+            continue;
+        }
+        snprintf(path, directory_length + 1024, "%s/%s", directory, name);
+        CKGDirIterator* files = ckg_dir_open(path);
+        if (!files) {
+            continue;
+        }
+        const char* file_name;
+        CKGEntryType file_type;
+        while ((file_name = ckg_dir_next(files, &file_type)) != NULL) {
+            uint64_t size;
+            int64_t mtime;
+            if (file_type != CKG_ENTRY_FILE || strlen(file_name) > 900) {
+                continue;
+            }
+            snprintf(path, directory_length + 1024, "%s/%s/%s", directory, name, file_name);
+            if (ckg_file_stat(path, &size, &mtime) && !scan_add(scan, path, size, mtime)) {
+                break;
+            }
+        }
+        ckg_dir_close(files);
+    }
+    free(path);
+    ckg_dir_close(iterator);
+}
+
+static int compare_oldest(const void* a, const void* b) {
+    int64_t left = ((const ScannedFile*)a)->mtime;
+    int64_t right = ((const ScannedFile*)b)->mtime;
+    return left < right ? -1 : left > right ? 1 : 0;
+}
+
+// Scan the directory and, if it holds more than `limit` bytes, delete the
+// least recently used entries until it holds no more than `target`. Only
+// one thread prunes at a time; unless `wait`, the others return at once.
+// Returns how many entries were deleted.
+static uint32_t prune(uint64_t limit, uint64_t target, bool wait) {
+    while (!ckg_atomic_cas32(&disk.pruning, 0, 1)) {
+        if (!wait) {
+            return 0;
+        }
+        ckg_thread_yield();
+    }
+    char* directory = NULL;
+    ckg_mutex_lock(&disk.lock);
+    if (disk.directory) {
+        directory = strdup(disk.directory);
+    }
+    ckg_mutex_unlock(&disk.lock);
+
+    uint32_t evicted = 0;
+    Scan scan = {0};
+    if (directory) {
+        scan_directory(directory, &scan);
+    }
+    uint32_t remaining = scan.count;
+    if (scan.bytes > limit) {
+        qsort(scan.files, scan.count, sizeof(ScannedFile), compare_oldest);
+        for (uint32_t i = 0; i < scan.count && scan.bytes > target; i++) {
+            if (ckg_remove_file(scan.pool + scan.files[i].path)) {
+                scan.bytes -= scan.files[i].size;
+                remaining--;
+                evicted++;
+            }
+        }
+    }
+
+    ckg_mutex_lock(&disk.lock);
+    if (directory && disk.directory && strcmp(directory, disk.directory) == 0) {
+        disk.bytes = scan.bytes;
+        disk.count = remaining;
+        disk.counted = true;
+    }
+    ckg_mutex_unlock(&disk.lock);
+    free(scan.files);
+    free(scan.pool);
+    free(directory);
+    ckg_atomic_store32(&disk.pruning, 0);
+    return evicted;
+}
+
+static bool write_file(const char* path, const uint8_t* bytes, size_t size) {
+    FILE* file = ckg_open_file(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = fwrite(bytes, 1, size, file) == size;
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    if (!written) {
+        ckg_remove_file(path);
+    }
+    return written;
+}
+
+uint32_t ckg_disk_cache_store(const CKGCacheKey* key, const ParsedData* data) {
+    uint64_t budget = ckg_atomic_load64(&disk.budget);
+    if (!disk.ready || budget == 0) {
+        return 0;
+    }
+    size_t records_size = (size_t)data->function_count * CKG_DISK_CACHE_FUNCTION_SIZE +
+                          (size_t)data->class_count * CKG_DISK_CACHE_CLASS_SIZE;
+    size_t size = CKG_DISK_CACHE_HEADER_SIZE + records_size;
+    if (size > budget) {
+        return 0;
+    }
+    uint8_t* bytes = (uint8_t*)malloc(size);
+    if (!bytes) {
+        return 0;
+    }
+    uint64_t grammar = grammar_version((CKGLanguage)key->language);
+    put_key(bytes, key, grammar, (uint32_t)data->function_count, (uint32_t)data->class_count);
+    uint8_t* out = bytes + CKG_DISK_CACHE_HEADER_SIZE;
+    for (int i = 0; i < data->function_count; i++) {
+        const ExtractedFunction* function = &data->functions[i];
+        out = put_u32(out, function->name.offset);
+        out = put_u32(out, function->name.length);
+        out = put_u32(out, function->class_name.offset);
+        out = put_u32(out, function->class_name.length);
+        out = put_u32(out, (uint32_t)function->start_line);
+        out = put_u32(out, (uint32_t)function->end_line);
+        out = put_u32(out, function->start_byte);
+        out = put_u32(out, function->end_byte);
+        out = put_u32(out, function->explicit_class ? 1 : 0);
+    }
+    for (int i = 0; i < data->class_count; i++) {
+        const ExtractedClass* class_info = &data->classes[i];
+        out = put_u32(out, class_info->name.offset);
+        out = put_u32(out, class_info->name.length);
+        out = put_u32(out, (uint32_t)class_info->start_line);
+        out = put_u32(out, (uint32_t)class_info->end_line);
+        out = put_u32(out, class_info->start_byte);
+        out = put_u32(out, class_info->end_byte);
+    }
+    put_u64(bytes + 40, ckg_hash64(bytes + CKG_DISK_CACHE_HEADER_SIZE, records_size, 0));
+
+    char* path = entry_path(key, grammar, false);
+    char* temporary = entry_path(key, grammar, true);
+    bool stored = false;
+    if (path && temporary) {
+        if (!write_file(temporary, bytes, size)) {
+            // The first entry in this fan-out directory
+            char* slash = strrchr(temporary, '/');
+            *slash = '\0';
+            ckg_make_dir(temporary);
+            *slash = '/';
+            stored = write_file(temporary, bytes, size);
+        } else {
+            stored = true;
+        }
+        if (stored && !ckg_replace_file(temporary, path)) {
+            // Most likely another process stored the same entry meanwhile
+            ckg_remove_file(temporary);
+            stored = false;
+        }
+    }
+    free(temporary);
+    free(path);
+    free(bytes);
+    if (!stored) {
+        return 0;
+    }
+
+    ckg_mutex_lock(&disk.lock);
+    disk.bytes += size;
+    disk.count++;
+    bool over = !disk.counted || disk.bytes > budget;
+    ckg_mutex_unlock(&disk.lock);
+    return over ? prune(budget, budget / 10 * CKG_DISK_CACHE_LOW_WATER, false) : 0;
+}
+
+CKG_API int ckg_disk_cache_set_directory(const char* directory, uint64_t budget_bytes) {
+    if (!disk.ready) {
+        return -1;
+    }
+    char* copy = NULL;
+    if (directory && directory[0] && budget_bytes > 0) {
+        if (!ckg_make_dir(directory) || !(copy = strdup(directory))) {
+            return -1;
+        }
+        // Paths are joined with '/', which Windows accepts too
+        size_t length = strlen(copy);
+        while (length > 1 && (copy[length - 1] == '/' || copy[length - 1] == '\\')) {
+            copy[--length] = '\0';
+        }
+    }
+    ckg_mutex_lock(&disk.lock);
+    bool same = copy && disk.directory && strcmp(copy, disk.directory) == 0;
+    free(disk.directory);
+    disk.directory = copy;
+    ckg_atomic_store64(&disk.budget, copy ? budget_bytes : 0);
+    if (!same) {
+        disk.bytes = 0;
+        disk.count = 0;
+        disk.counted = false;
+    }
+    bool over = disk.counted && disk.bytes > budget_bytes;
+    ckg_mutex_unlock(&disk.lock);
+    if (over) {
+        prune(budget_bytes, budget_bytes, true);
+    }
+    return 0;
+}
+
+CKG_API void ckg_disk_cache_clear(void) {
+    if (disk.ready) {
+        prune(0, 0, true);
+    }
+}
+
+CKG_API void ckg_disk_cache_get_usage(uint64_t* bytes_out, uint32_t* entries_out) {
+    uint64_t bytes = 0;
+    uint32_t entries = 0;
+    if (ckg_disk_cache_enabled()) {
+        ckg_mutex_lock(&disk.lock);
+        bool counted = disk.counted;
+        ckg_mutex_unlock(&disk.lock);
+        if (!counted) {
+            prune(UINT64_MAX, UINT64_MAX, true);
+        }
+        ckg_mutex_lock(&disk.lock);
+        bytes = disk.bytes;
+        entries = disk.count;
+        ckg_mutex_unlock(&disk.lock);
+    }
+    if (bytes_out) {
+        *bytes_out = bytes;
+    }
+    if (entries_out) {
+        *entries_out = entries;
+    }
+}
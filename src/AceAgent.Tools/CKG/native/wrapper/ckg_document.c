@@ -0,0 +1,739 @@
+#define BUILDING_CKG_DLL
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+
+// Open documents and incremental reparsing.
+//
+// A document keeps its text, syntax tree and symbols. An edit is first
+// applied to the tree with ts_tree_edit, so the reparse reuses every subtree
+// the edit did not touch, and ts_tree_get_changed_ranges then reports where
+// the new tree differs structurally from the old one. Symbols are extracted
+// again only from definitions touching those ranges or the edited bytes
+// (including the classes enclosing them); every other symbol is kept and
+// moved by the edit's byte and line deltas. The result lists what changed
+// beyond that move, so its size follows the edit, not the file.
+
+typedef struct {
+    const char* data;
+    uint32_t length;
+} DocumentText;
+
+static const char* read_text(void* payload, uint32_t byte_index, TSPoint position, uint32_t* bytes_read) {
+    (void)position;
+    const DocumentText* text = (const DocumentText*)payload;
+    if (byte_index >= text->length) {
+        *bytes_read = 0;
+        return "";
+    }
+    *bytes_read = text->length - byte_index;
+    return text->data + byte_index;
+}
+
+static TSInput text_input(DocumentText* text) {
+    TSInput input = { text, read_text, TSInputEncodingUTF8, NULL };
+    return input;
+}
+
+static CKGDocument* find_document(CKGContext* ctx, uint32_t file_id) {
+    for (uint32_t i = 0; i < ctx->document_count; i++) {
+        if (ctx->documents[i].file_id == file_id) {
+            return &ctx->documents[i];
+        }
+    }
+    return NULL;
+}
+
+static CKGDocument* add_document(CKGContext* ctx) {
+    if (ctx->document_count >= ctx->document_capacity) {
+        uint32_t capacity = ctx->document_capacity == 0 ? 4 : ctx->document_capacity * 2;
+        CKGDocument* documents = (CKGDocument*)realloc(ctx->documents, capacity * sizeof(CKGDocument));
+        if (!documents) {
+            return NULL;
+        }
+        ctx->documents = documents;
+        ctx->document_capacity = capacity;
+    }
+    CKGDocument* document = &ctx->documents[ctx->document_count++];
+    memset(document, 0, sizeof(*document));
+    return document;
+}
+
+static void free_document(CKGDocument* document) {
+    if (document->tree) {
+        ts_tree_delete(document->tree);
+    }
+    free(document->source);
+    free(document->symbols.classes);
+    free(document->symbols.functions);
+}
+
+static void remove_document(CKGContext* ctx, CKGDocument* document) {
+    free_document(document);
+    *document = ctx->documents[--ctx->document_count];
+}
+
+void ckg_documents_free(CKGContext* ctx) {
+    for (uint32_t i = 0; i < ctx->document_count; i++) {
+        free_document(&ctx->documents[i]);
+    }
+    free(ctx->documents);
+    ctx->documents = NULL;
+    ctx->document_count = 0;
+    ctx->document_capacity = 0;
+}
+
+// Where `length` bytes of text starting at `point` end. Columns count bytes,
+// as Tree-sitter's do.
+static TSPoint advance_point(TSPoint point, const char* text, uint32_t length) {
+    const char* end = text + length;
+    const char* line = text;
+    const char* newline;
+    while ((newline = (const char*)memchr(line, '\n', (size_t)(end - line))) != NULL) {
+        point.row++;
+        line = newline + 1;
+    }
+    point.column = line == text ? point.column + length : (uint32_t)(end - line);
+    return point;
+}
+
+// Row and column of `byte`: from the last node boundary at or before it,
+// found by descending the tree towards it, then by scanning the text in
+// between, which is at most part of one token or gap
+static TSPoint point_at(const TSTree* tree, const char* source, uint32_t byte) {
+    TSNode node = ts_tree_root_node(tree);
+    uint32_t anchor = 0;
+    TSPoint point = { 0, 0 };
+    for (;;) {
+        // The first child ending after `byte`; the sibling before it ends at or before it
+        TSNode child = ts_node_first_child_for_byte(node, byte);
+        if (ts_node_is_null(child)) {
+            break;
+        }
+        TSNode previous = ts_node_prev_sibling(child);
+        if (!ts_node_is_null(previous) && ts_node_end_byte(previous) <= byte && ts_node_end_byte(previous) >= anchor) {
+            anchor = ts_node_end_byte(previous);
+            point = ts_node_end_point(previous);
+        }
+        if (ts_node_start_byte(child) > byte) {
+            break;
+        }
+        anchor = ts_node_start_byte(child);
+        point = ts_node_start_point(child);
+        node = child;
+    }
+    return advance_point(point, source + anchor, byte - anchor);
+}
+
+// Position in the edited text of a byte of the old text. Bytes inside the
+// replaced range map to its new end; symbols covering them are extracted
+// again anyway.
+static inline uint32_t map_byte(const TSInputEdit* edit, uint32_t byte) {
+    if (byte <= edit->start_byte) {
+        return byte;
+    }
+    if (byte >= edit->old_end_byte) {
+        return byte - edit->old_end_byte + edit->new_end_byte;
+    }
+    return edit->new_end_byte;
+}
+
+static inline CKGSpan move_span(const TSInputEdit* edit, CKGSpan span) {
+    if (span.length > 0) {
+        span.offset = map_byte(edit, span.offset);
+    }
+    return span;
+}
+
+static int compare_ranges(const void* a, const void* b) {
+    uint32_t left = ((const CKGByteRange*)a)->start_byte;
+    uint32_t right = ((const CKGByteRange*)b)->start_byte;
+    return left < right ? -1 : left > right;
+}
+
+// The ranges of the new text to extract symbols from, sorted and merged:
+// the replacement, the changed ranges, and every function whose class name
+// the edit rewrote, since those cannot simply be moved
+static CKGByteRange* affected_ranges(const CKGDocument* document, const TSInputEdit* edit, const TSRange* changed,
+                                     uint32_t changed_count, uint32_t* count_out) {
+    const ParsedData* old = &document->symbols;
+    uint32_t capacity = changed_count + 1;
+    for (int i = 0; i < old->function_count; i++) {
+        CKGSpan owner = old->functions[i].class_name;
+        if (owner.length > 0 && owner.offset <= edit->old_end_byte && edit->start_byte <= owner.offset + owner.length) {
+            capacity++;
+        }
+    }
+    CKGByteRange* ranges = (CKGByteRange*)malloc(capacity * sizeof(CKGByteRange));
+    if (!ranges) {
+        return NULL;
+    }
+
+    uint32_t count = 0;
+    ranges[count].start_byte = edit->start_byte;
+    ranges[count++].end_byte = edit->new_end_byte;
+    for (uint32_t i = 0; i < changed_count; i++) {
+        ranges[count].start_byte = changed[i].start_byte;
+        ranges[count++].end_byte = changed[i].end_byte;
+    }
+    for (int i = 0; i < old->function_count; i++) {
+        const ExtractedFunction* function = &old->functions[i];
+        CKGSpan owner = function->class_name;
+        if (owner.length > 0 && owner.offset <= edit->old_end_byte && edit->start_byte <= owner.offset + owner.length) {
+            ranges[count].start_byte = map_byte(edit, function->start_byte);
+            ranges[count++].end_byte = map_byte(edit, function->end_byte);
+        }
+    }
+
+    qsort(ranges, count, sizeof(CKGByteRange), compare_ranges);
+    uint32_t merged = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        if (ranges[i].start_byte <= ranges[merged].end_byte) {
+            if (ranges[i].end_byte > ranges[merged].end_byte) {
+                ranges[merged].end_byte = ranges[i].end_byte;
+            }
+        } else {
+            ranges[++merged] = ranges[i];
+        }
+    }
+    *count_out = merged + 1;
+    return ranges;
+}
+
+// One entry of the edit result; names are spans of `text`
+typedef struct {
+    uint8_t change;
+    uint8_t kind;
+    const char* text;
+    CKGSpan name;
+    CKGSpan class_name;
+    int start_line;
+    int end_line;
+    int old_start_line;
+    int old_end_line;
+} EditRecord;
+
+typedef struct {
+    EditRecord* records;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t old_end_line;      // Line numbers above this move by line_delta
+    int line_delta;
+} EditDiff;
+
+static bool add_record(EditDiff* diff, const EditRecord* record) {
+    if (diff->count >= diff->capacity) {
+        uint32_t capacity = diff->capacity == 0 ? 16 : diff->capacity * 2;
+        EditRecord* records = (EditRecord*)realloc(diff->records, capacity * sizeof(EditRecord));
+        if (!records) {
+            return false;
+        }
+        diff->records = records;
+        diff->capacity = capacity;
+    }
+    diff->records[diff->count++] = *record;
+    return true;
+}
+
+// The line an unlisted symbol is taken to have moved to
+static inline int moved_line(const EditDiff* diff, int line) {
+    return (uint32_t)line > diff->old_end_line ? line + diff->line_delta : line;
+}
+
+static inline bool same_text(const char* a_text, CKGSpan a, const char* b_text, CKGSpan b) {
+    return a.length == b.length && memcmp(a_text + a.offset, b_text + b.offset, a.length) == 0;
+}
+
+// Record how one symbol changed: a kept or re-extracted symbol is only
+// listed when its lines are not where the move puts them
+static bool diff_symbol(EditDiff* diff, uint8_t kind, const char* text, CKGSpan name, CKGSpan class_name,
+                        int start_line, int end_line, int old_start_line, int old_end_line) {
+    if (old_start_line > 0 && start_line == moved_line(diff, old_start_line) &&
+        end_line == moved_line(diff, old_end_line)) {
+        return true;
+    }
+    EditRecord record;
+    record.change = old_start_line == 0 ? CKG_SYMBOL_ADDED : CKG_SYMBOL_CHANGED;
+    record.kind = kind;
+    record.text = text;
+    record.name = name;
+    record.class_name = class_name;
+    record.start_line = start_line;
+    record.end_line = end_line;
+    record.old_start_line = old_start_line;
+    record.old_end_line = old_end_line;
+    return add_record(diff, &record);
+}
+
+static bool diff_removed(EditDiff* diff, uint8_t kind, const char* text, CKGSpan name, CKGSpan class_name,
+                         int old_start_line, int old_end_line) {
+    EditRecord record;
+    record.change = CKG_SYMBOL_REMOVED;
+    record.kind = kind;
+    record.text = text;
+    record.name = name;
+    record.class_name = class_name;
+    record.start_line = 0;
+    record.end_line = 0;
+    record.old_start_line = old_start_line;
+    record.old_end_line = old_end_line;
+    return add_record(diff, &record);
+}
+
+// Merge the kept classes, moved, with the freshly extracted ones in start
+// order into `merged`, recording the changes. Old classes touching
+// `ranges` were extracted again: each is paired with a fresh class of the
+// same name, or else reported removed. Returns the merged count, or -1 if
+// out of memory.
+static int merge_classes(const CKGDocument* document, const TSInputEdit* edit, const CKGByteRange* ranges,
+                         uint32_t range_count, const ParsedData* fresh, const char* source, bool* paired,
+                         ExtractedClass* merged, EditDiff* diff) {
+    const ParsedData* old = &document->symbols;
+    int line_delta = (int)edit->new_end_point.row - (int)edit->old_end_point.row;
+    int count = 0;
+    int next_fresh = 0;
+    CKGSpan none = { 0, 0 };
+    memset(paired, 0, (size_t)fresh->class_count * sizeof(bool));
+
+    for (int i = 0; i < old->class_count; i++) {
+        const ExtractedClass* cls = &old->classes[i];
+        if (ckg_ranges_touch(ranges, range_count, map_byte(edit, cls->start_byte), map_byte(edit, cls->end_byte))) {
+            int match = -1;
+            for (int j = 0; j < fresh->class_count && match < 0; j++) {
+                if (!paired[j] && same_text(document->source, cls->name, source, fresh->classes[j].name)) {
+                    match = j;
+                }
+            }
+            if (match < 0) {
+                if (!diff_removed(diff, 1, document->source, cls->name, none, cls->start_line, cls->end_line)) {
+                    return -1;
+                }
+                continue;
+            }
+            paired[match] = true;
+            const ExtractedClass* now = &fresh->classes[match];
+            if (!diff_symbol(diff, 1, source, now->name, none, now->start_line, now->end_line,
+                             cls->start_line, cls->end_line)) {
+                return -1;
+            }
+            continue;
+        }
+
+        // Untouched: entirely before the edit, or after it and moved with it
+        ExtractedClass moved = *cls;
+        if (cls->start_byte >= edit->old_end_byte) {
+            moved.start_line += line_delta;
+        }
+        if (cls->end_byte >= edit->old_end_byte) {
+            moved.end_line += line_delta;
+        }
+        moved.name = move_span(edit, cls->name);
+        moved.start_byte = map_byte(edit, cls->start_byte);
+        moved.end_byte = map_byte(edit, cls->end_byte);
+        if (!diff_symbol(diff, 1, source, moved.name, none, moved.start_line, moved.end_line,
+                         cls->start_line, cls->end_line)) {
+            return -1;
+        }
+        while (next_fresh < fresh->class_count && fresh->classes[next_fresh].start_byte < moved.start_byte) {
+            merged[count++] = fresh->classes[next_fresh++];
+        }
+        merged[count++] = moved;
+    }
+    while (next_fresh < fresh->class_count) {
+        merged[count++] = fresh->classes[next_fresh++];
+    }
+
+    for (int j = 0; j < fresh->class_count; j++) {
+        const ExtractedClass* now = &fresh->classes[j];
+        if (!paired[j] && !diff_symbol(diff, 1, source, now->name, none, now->start_line, now->end_line, 0, 0)) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+// As merge_classes, pairing functions by name and class name
+static int merge_functions(const CKGDocument* document, const TSInputEdit* edit, const CKGByteRange* ranges,
+                           uint32_t range_count, const ParsedData* fresh, const char* source, bool* paired,
+                           ExtractedFunction* merged, EditDiff* diff) {
+    const ParsedData* old = &document->symbols;
+    int line_delta = (int)edit->new_end_point.row - (int)edit->old_end_point.row;
+    int count = 0;
+    int next_fresh = 0;
+    memset(paired, 0, (size_t)fresh->function_count * sizeof(bool));
+
+    for (int i = 0; i < old->function_count; i++) {
+        const ExtractedFunction* function = &old->functions[i];
+        if (ckg_ranges_touch(ranges, range_count, map_byte(edit, function->start_byte),
+                             map_byte(edit, function->end_byte))) {
+            int match = -1;
+            for (int j = 0; j < fresh->function_count && match < 0; j++) {
+                const ExtractedFunction* candidate = &fresh->functions[j];
+                if (!paired[j] && same_text(document->source, function->name, source, candidate->name) &&
+                    same_text(document->source, function->class_name, source, candidate->class_name)) {
+                    match = j;
+                }
+            }
+            if (match < 0) {
+                if (!diff_removed(diff, 0, document->source, function->name, function->class_name,
+                                  function->start_line, function->end_line)) {
+                    return -1;
+                }
+                continue;
+            }
+            paired[match] = true;
+            const ExtractedFunction* now = &fresh->functions[match];
+            if (!diff_symbol(diff, 0, source, now->name, now->class_name, now->start_line, now->end_line,
+                             function->start_line, function->end_line)) {
+                return -1;
+            }
+            continue;
+        }
+
+        ExtractedFunction moved = *function;
+        if (function->start_byte >= edit->old_end_byte) {
+            moved.start_line += line_delta;
+        }
+        if (function->end_byte >= edit->old_end_byte) {
+            moved.end_line += line_delta;
+        }
+        moved.name = move_span(edit, function->name);
+        moved.class_name = move_span(edit, function->class_name);
+        moved.start_byte = map_byte(edit, function->start_byte);
+        moved.end_byte = map_byte(edit, function->end_byte);
+        if (!diff_symbol(diff, 0, source, moved.name, moved.class_name, moved.start_line, moved.end_line,
+                         function->start_line, function->end_line)) {
+            return -1;
+        }
+        while (next_fresh < fresh->function_count && fresh->functions[next_fresh].start_byte < moved.start_byte) {
+            merged[count++] = fresh->functions[next_fresh++];
+        }
+        merged[count++] = moved;
+    }
+    while (next_fresh < fresh->function_count) {
+        merged[count++] = fresh->functions[next_fresh++];
+    }
+
+    for (int j = 0; j < fresh->function_count; j++) {
+        const ExtractedFunction* now = &fresh->functions[j];
+        if (!paired[j] && !diff_symbol(diff, 0, source, now->name, now->class_name, now->start_line, now->end_line, 0, 0)) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+static inline uint8_t* put_u16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+}
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+// Encode `diff` in the edit format, or with a null diff just a status and
+// an optional message
+static uint8_t* build_edit_result(const EditDiff* diff, uint32_t status, const char* message, uint32_t* size_out) {
+    uint32_t record_count = diff ? diff->count : 0;
+    uint64_t strings = message ? strlen(message) : 0;
+    for (uint32_t i = 0; i < record_count; i++) {
+        strings += (uint64_t)diff->records[i].name.length + diff->records[i].class_name.length;
+    }
+    uint64_t size = (uint64_t)CKG_EDIT_HEADER_SIZE + (uint64_t)record_count * CKG_EDIT_RECORD_SIZE + strings;
+    if (size > UINT32_MAX) {
+        return build_edit_result(NULL, CKG_STATUS_ERROR, "Result too large", size_out);
+    }
+    uint8_t* buffer = (uint8_t*)malloc((size_t)size);
+    if (!buffer) {
+        return NULL;
+    }
+
+    uint32_t string_table_offset = CKG_EDIT_HEADER_SIZE + record_count * CKG_EDIT_RECORD_SIZE;
+    memcpy(buffer, CKG_EDIT_MAGIC, 4);
+    uint8_t* out = put_u16(buffer + 4, CKG_EDIT_VERSION);
+    out = put_u16(out, CKG_EDIT_HEADER_SIZE);
+    out = put_u32(out, status);
+    out = put_u32(out, record_count);
+    out = put_u32(out, CKG_EDIT_RECORD_SIZE);
+    out = put_u32(out, diff ? diff->old_end_line : 0);
+    out = put_u32(out, diff ? (uint32_t)diff->line_delta : 0);
+    out = put_u32(out, string_table_offset);
+    out = put_u32(out, (uint32_t)strings);
+    out = put_u32(out, (uint32_t)size);
+
+    uint8_t* string_table = buffer + string_table_offset;
+    uint32_t used = 0;
+    if (message) {
+        memcpy(string_table, message, strings);
+    }
+    for (uint32_t i = 0; i < record_count; i++) {
+        const EditRecord* record = &diff->records[i];
+        out[0] = record->change;
+        out[1] = record->kind;
+        out[2] = 0;
+        out[3] = 0;
+        out = put_u32(out + 4, used);
+        out = put_u32(out, record->name.length);
+        memcpy(string_table + used, record->text + record->name.offset, record->name.length);
+        used += record->name.length;
+        out = put_u32(out, record->class_name.length > 0 ? used : 0);
+        out = put_u32(out, record->class_name.length);
+        if (record->class_name.length > 0) {
+            memcpy(string_table + used, record->text + record->class_name.offset, record->class_name.length);
+            used += record->class_name.length;
+        }
+        out = put_u32(out, (uint32_t)record->start_line);
+        out = put_u32(out, (uint32_t)record->end_line);
+        out = put_u32(out, (uint32_t)record->old_start_line);
+        out = put_u32(out, (uint32_t)record->old_end_line);
+    }
+
+    *size_out = (uint32_t)size;
+    return buffer;
+}
+
+CKG_API uint8_t* ckg_open_document(CKGContext* ctx, uint32_t file_id, CKGLanguage language, const char* source_code,
+                                   uint32_t length, uint32_t* size_out) {
+    if (!ctx || !source_code || !size_out) {
+        return NULL;
+    }
+    CKGDocument* existing = find_document(ctx, file_id);
+    if (existing) {
+        remove_document(ctx, existing);
+    }
+
+    CKGStats delta = {0};
+    const TSLanguage* ts_language = ckg_ts_language(language);
+    TSParser* parser = ts_language ? ckg_language_parser(ctx, language) : NULL;
+    if (!parser) {
+        ckg_count_error(&delta, language);
+        ckg_stats_add(ctx, &delta);
+        return ckg_binary_error(ts_language ? "Failed to set language" : "Unsupported language", size_out);
+    }
+    char* source = (char*)malloc(length ? length : 1);
+    if (!source) {
+        return ckg_binary_error("Out of memory", size_out);
+    }
+    memcpy(source, source_code, length);
+
+    uint64_t start = ckg_now_ns();
+    DocumentText text = { source, length };
+    TSTree* tree = ckg_parse_tree(ctx, parser, NULL, text_input(&text), length);
+    uint64_t parsed = ckg_now_ns();
+    delta.parse_ns = parsed - start;
+    if (!tree) {
+        uint8_t* buffer;
+        if (ctx->skipped || ctx->stopped) {
+            ParsedData empty = {0};
+            buffer = ckg_binary_build(&empty, source, ckg_parse_status(ctx, &delta), size_out);
+        } else {
+            ckg_count_error(&delta, language);
+            buffer = ckg_binary_error("Failed to parse code", size_out);
+        }
+        free(source);
+        ckg_stats_add(ctx, &delta);
+        return buffer;
+    }
+
+    // A document holds every symbol, whatever the size policy, since edits
+    // only extract around the change
+    ctx->declarations_only = false;
+    ParsedData* data = &ctx->scratch;
+    data->class_count = 0;
+    data->function_count = 0;
+    data->node_count = 0;
+    data->match_count = 0;
+    ckg_extract(ctx, language, ts_language, ts_tree_root_node(tree), NULL, 0, data);
+    uint64_t extracted = ckg_now_ns();
+    delta.extract_ns = extracted - parsed;
+    delta.files_parsed = 1;
+    delta.bytes_parsed = length;
+    delta.nodes_visited = data->node_count;
+    delta.query_matches = data->match_count;
+    delta.symbols_extracted = (uint64_t)data->function_count + (uint64_t)data->class_count;
+
+    uint32_t status = ckg_parse_status(ctx, &delta);
+    CKGDocument* document = status == CKG_STATUS_OK ? add_document(ctx) : NULL;
+    if (document) {
+        document->file_id = file_id;
+        document->language = language;
+        document->tree = tree;
+        document->source = source;
+        document->length = length;
+        document->symbols.classes = (ExtractedClass*)malloc((data->class_count ? data->class_count : 1) * sizeof(ExtractedClass));
+        document->symbols.functions = (ExtractedFunction*)malloc((data->function_count ? data->function_count : 1) * sizeof(ExtractedFunction));
+        if (!document->symbols.classes || !document->symbols.functions) {
+            remove_document(ctx, document);
+            ckg_stats_add(ctx, &delta);
+            return ckg_binary_error("Out of memory", size_out);
+        }
+        if (data->class_count > 0) {
+            memcpy(document->symbols.classes, data->classes, data->class_count * sizeof(ExtractedClass));
+        }
+        if (data->function_count > 0) {
+            memcpy(document->symbols.functions, data->functions, data->function_count * sizeof(ExtractedFunction));
+        }
+        document->symbols.class_count = data->class_count;
+        document->symbols.class_capacity = data->class_count;
+        document->symbols.function_count = data->function_count;
+        document->symbols.function_capacity = data->function_count;
+    }
+
+    uint8_t* buffer = ckg_binary_build(data, source, status, size_out);
+    delta.serialize_ns = ckg_now_ns() - extracted;
+    delta.arena_high_water = buffer ? *size_out : 0;
+    if (!document) {
+        // Partial, or out of memory: nothing is kept
+        ts_tree_delete(tree);
+        free(source);
+    }
+    ckg_stats_add(ctx, &delta);
+    return buffer;
+}
+
+CKG_API uint8_t* ckg_apply_edit(CKGContext* ctx, uint32_t file_id, uint32_t start_byte, uint32_t old_end_byte,
+                                uint32_t new_end_byte, const char* new_source, uint32_t new_length, uint32_t* size_out) {
+    if (!ctx || !new_source || !size_out) {
+        return NULL;
+    }
+    CKGDocument* document = find_document(ctx, file_id);
+    if (!document) {
+        return build_edit_result(NULL, CKG_STATUS_ERROR, "Unknown document", size_out);
+    }
+    if (start_byte > old_end_byte || old_end_byte > document->length || start_byte > new_end_byte ||
+        new_end_byte > new_length || document->length - old_end_byte != new_length - new_end_byte) {
+        return build_edit_result(NULL, CKG_STATUS_ERROR, "Edit does not match the document", size_out);
+    }
+
+    CKGStats delta = {0};
+    char* source = (char*)malloc(new_length ? new_length : 1);
+    if (!source) {
+        return build_edit_result(NULL, CKG_STATUS_ERROR, "Out of memory", size_out);
+    }
+    memcpy(source, new_source, new_length);
+
+    // Only the replaced and replacement text are scanned for line breaks
+    TSInputEdit edit;
+    edit.start_byte = start_byte;
+    edit.old_end_byte = old_end_byte;
+    edit.new_end_byte = new_end_byte;
+    edit.start_point = point_at(document->tree, document->source, start_byte);
+    edit.old_end_point = advance_point(edit.start_point, document->source + start_byte, old_end_byte - start_byte);
+    edit.new_end_point = advance_point(edit.start_point, source + start_byte, new_end_byte - start_byte);
+    ts_tree_edit(document->tree, &edit);
+
+    uint64_t start = ckg_now_ns();
+    TSParser* parser = ckg_language_parser(ctx, document->language);
+    DocumentText text = { source, new_length };
+    TSTree* tree = parser ? ckg_parse_tree(ctx, parser, document->tree, text_input(&text), new_length) : NULL;
+    uint64_t parsed = ckg_now_ns();
+    delta.parse_ns = parsed - start;
+    if (!tree) {
+        // The retained tree no longer matches any text it could be used with
+        uint8_t* buffer;
+        if (ctx->skipped || ctx->stopped) {
+            buffer = build_edit_result(NULL, ckg_parse_status(ctx, &delta), NULL, size_out);
+        } else {
+            ckg_count_error(&delta, document->language);
+            buffer = build_edit_result(NULL, CKG_STATUS_ERROR, "Failed to parse code", size_out);
+        }
+        free(source);
+        remove_document(ctx, document);
+        ckg_stats_add(ctx, &delta);
+        return buffer;
+    }
+
+    uint32_t changed_count = 0;
+    TSRange* changed = ts_tree_get_changed_ranges(document->tree, tree, &changed_count);
+    uint32_t range_count = 0;
+    CKGByteRange* ranges = affected_ranges(document, &edit, changed, changed_count, &range_count);
+    free(changed);
+
+    ctx->declarations_only = false;
+    ParsedData* fresh = &ctx->scratch;
+    fresh->class_count = 0;
+    fresh->function_count = 0;
+    fresh->node_count = 0;
+    fresh->match_count = 0;
+    if (ranges) {
+        ckg_extract(ctx, document->language, ckg_ts_language(document->language), ts_tree_root_node(tree), ranges,
+                    range_count, fresh);
+    }
+    uint64_t extracted = ckg_now_ns();
+    delta.extract_ns = extracted - parsed;
+    delta.nodes_visited = fresh->node_count;
+    delta.query_matches = fresh->match_count;
+    delta.symbols_extracted = (uint64_t)fresh->function_count + (uint64_t)fresh->class_count;
+
+    EditDiff diff = {0};
+    diff.old_end_line = edit.old_end_point.row + 1;
+    diff.line_delta = (int)edit.new_end_point.row - (int)edit.old_end_point.row;
+    const ParsedData* old = &document->symbols;
+    int most = fresh->class_count > fresh->function_count ? fresh->class_count : fresh->function_count;
+    bool* paired = (bool*)malloc((size_t)(most ? most : 1) * sizeof(bool));
+    ExtractedClass* classes = (ExtractedClass*)malloc((size_t)(old->class_count + fresh->class_count + 1) * sizeof(ExtractedClass));
+    ExtractedFunction* functions = (ExtractedFunction*)malloc((size_t)(old->function_count + fresh->function_count + 1) *
+                                                              sizeof(ExtractedFunction));
+    int class_count = -1;
+    int function_count = -1;
+    if (ranges && paired && classes && functions && !ckg_should_stop(ctx)) {
+        class_count = merge_classes(document, &edit, ranges, range_count, fresh, source, paired, classes, &diff);
+        if (class_count >= 0) {
+            function_count = merge_functions(document, &edit, ranges, range_count, fresh, source, paired, functions, &diff);
+        }
+    }
+    free(paired);
+    free(ranges);
+
+    uint8_t* buffer;
+    if (function_count < 0) {
+        // Out of memory, or stopped during extraction with symbols missing
+        free(classes);
+        free(functions);
+        free(source);
+        remove_document(ctx, document);
+        ts_tree_delete(tree);
+        uint32_t status = ckg_parse_status(ctx, &delta);
+        buffer = status == CKG_STATUS_OK ? build_edit_result(NULL, CKG_STATUS_ERROR, "Out of memory", size_out)
+                                         : build_edit_result(NULL, status, NULL, size_out);
+    } else {
+        // Removed names still point into the old text, so encode before replacing it
+        buffer = build_edit_result(&diff, CKG_STATUS_OK, NULL, size_out);
+        ts_tree_delete(document->tree);
+        free(document->source);
+        free(document->symbols.classes);
+        free(document->symbols.functions);
+        document->tree = tree;
+        document->source = source;
+        document->length = new_length;
+        document->symbols.classes = classes;
+        document->symbols.class_count = class_count;
+        document->symbols.class_capacity = class_count;
+        document->symbols.functions = functions;
+        document->symbols.function_count = function_count;
+        document->symbols.function_capacity = function_count;
+    }
+    free(diff.records);
+
+    delta.serialize_ns = ckg_now_ns() - extracted;
+    delta.arena_high_water = buffer ? *size_out : 0;
+    ckg_stats_add(ctx, &delta);
+    return buffer;
+}
+
+CKG_API void ckg_close_document(CKGContext* ctx, uint32_t file_id) {
+    if (!ctx) {
+        return;
+    }
+    CKGDocument* document = find_document(ctx, file_id);
+    if (document) {
+        remove_document(ctx, document);
+    }
+}
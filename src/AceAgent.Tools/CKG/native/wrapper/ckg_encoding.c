@@ -0,0 +1,309 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_encoding.h"
+
+// SSE2 is part of every x86-64 target and NEON of every AArch64 one, so no
+// runtime dispatch is needed; other targets use the 8-byte word loops.
+// The vector paths assume a little-endian host, as both architectures are.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CKG_SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CKG_SIMD_NEON 1
+#endif
+
+// Length of the run of ASCII bytes at the start of `data`
+static size_t ascii_run(const uint8_t* data, size_t length) {
+    size_t i = 0;
+#if defined(CKG_SIMD_SSE2)
+    for (; i + 16 <= length; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(const void*)(data + i))) != 0) {
+            break;
+        }
+    }
+#elif defined(CKG_SIMD_NEON)
+    for (; i + 16 <= length; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(data + i)) >= 0x80) {
+            break;
+        }
+    }
+#else
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+#endif
+    while (i < length && data[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+static inline unsigned char* put_code_point(unsigned char* out, uint32_t code) {
+    if (code < 0x80) {
+        *out++ = (unsigned char)code;
+    } else if (code < 0x800) {
+        *out++ = (unsigned char)(0xC0 | (code >> 6));
+        *out++ = (unsigned char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *out++ = (unsigned char)(0xE0 | (code >> 12));
+        *out++ = (unsigned char)(0x80 | ((code >> 6) & 0x3F));
+        *out++ = (unsigned char)(0x80 | (code & 0x3F));
+    } else {
+        *out++ = (unsigned char)(0xF0 | (code >> 18));
+        *out++ = (unsigned char)(0x80 | ((code >> 12) & 0x3F));
+        *out++ = (unsigned char)(0x80 | ((code >> 6) & 0x3F));
+        *out++ = (unsigned char)(0x80 | (code & 0x3F));
+    }
+    return out;
+}
+
+static inline uint32_t utf16_unit(const uint8_t* in, size_t index, bool big_endian) {
+    const uint8_t* unit = in + index * 2;
+    return big_endian ? ((uint32_t)unit[0] << 8 | unit[1]) : ((uint32_t)unit[1] << 8 | unit[0]);
+}
+
+// Convert ASCII code units eight at a time while they last; returns how
+// many were converted
+static size_t utf16_ascii_block(const uint8_t* in, size_t units, bool big_endian, unsigned char* out) {
+    size_t i = 0;
+#if defined(CKG_SIMD_SSE2)
+    const __m128i high_bits = _mm_set1_epi16((short)0xFF80);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= units; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(in + i * 2));
+        if (big_endian) {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high_bits), zero)) != 0xFFFF) {
+            break;
+        }
+        _mm_storel_epi64((__m128i*)(void*)(out + i), _mm_packus_epi16(v, v));
+    }
+#elif defined(CKG_SIMD_NEON)
+    for (; i + 8 <= units; i += 8) {
+        uint8x16_t bytes = vld1q_u8(in + i * 2);
+        if (big_endian) {
+            bytes = vrev16q_u8(bytes);
+        }
+        uint16x8_t v = vreinterpretq_u16_u8(bytes);
+        if (vmaxvq_u16(v) >= 0x80) {
+            break;
+        }
+        vst1_u8(out + i, vmovn_u16(v));
+    }
+#else
+    (void)in;
+    (void)units;
+    (void)big_endian;
+    (void)out;
+#endif
+    return i;
+}
+
+size_t ckg_utf16_to_utf8(const void* input, size_t units, bool big_endian, char* output) {
+    const uint8_t* in = (const uint8_t*)input;
+    unsigned char* out = (unsigned char*)output;
+    size_t i = 0;
+    while (i < units) {
+        size_t ascii = utf16_ascii_block(in + i * 2, units - i, big_endian, out);
+        out += ascii;
+        i += ascii;
+        if (i == units) {
+            break;
+        }
+
+        uint32_t code = utf16_unit(in, i++, big_endian);
+        if (code >= 0xD800 && code <= 0xDFFF) {
+            uint32_t low = i < units ? utf16_unit(in, i, big_endian) : 0;
+            if (code <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            } else {
+                code = 0xFFFD;
+            }
+        }
+        out = put_code_point(out, code);
+    }
+    return (size_t)(out - (unsigned char*)output);
+}
+
+// Windows-1252 characters for bytes 0x80-0x9F, which Latin-1 leaves as C1
+// controls; files labelled Latin-1 almost always mean these. Bytes 1252
+// leaves undefined become U+FFFD.
+static const uint16_t windows1252_high[32] = {
+    0x20AC, 0xFFFD, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0xFFFD, 0x017D, 0xFFFD,
+    0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0xFFFD, 0x017E, 0x0178
+};
+
+size_t ckg_latin1_to_utf8(const uint8_t* input, size_t length, char* output) {
+    unsigned char* out = (unsigned char*)output;
+    size_t i = 0;
+    while (i < length) {
+        size_t ascii = ascii_run(input + i, length - i);
+        memcpy(out, input + i, ascii);
+        out += ascii;
+        i += ascii;
+        for (; i < length && input[i] >= 0x80; i++) {
+            uint32_t code = input[i] < 0xA0 ? windows1252_high[input[i] - 0x80] : input[i];
+            out = put_code_point(out, code);
+        }
+    }
+    return (size_t)(out - (unsigned char*)output);
+}
+
+// Length of the well-formed multi-byte sequence at `s`, or 0 if it is not one
+static size_t utf8_sequence_length(const uint8_t* s, size_t available) {
+    uint8_t lead = s[0];
+    if (lead < 0xC2 || lead > 0xF4) {
+        return 0;
+    }
+    if (lead < 0xE0) {
+        return available >= 2 && (s[1] & 0xC0) == 0x80 ? 2 : 0;
+    }
+    if (lead < 0xF0) {
+        if (available < 3 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 ||
+            (lead == 0xE0 && s[1] < 0xA0) ||        // Overlong
+            (lead == 0xED && s[1] >= 0xA0)) {       // Surrogate
+            return 0;
+        }
+        return 3;
+    }
+    if (available < 4 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 || (s[3] & 0xC0) != 0x80 ||
+        (lead == 0xF0 && s[1] < 0x90) ||            // Overlong
+        (lead == 0xF4 && s[1] >= 0x90)) {           // Above U+10FFFF
+        return 0;
+    }
+    return 4;
+}
+
+bool ckg_utf8_validate(const uint8_t* data, size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        i += ascii_run(data + i, length - i);
+        while (i < length && data[i] >= 0x80) {
+            size_t sequence = utf8_sequence_length(data + i, length - i);
+            if (sequence == 0) {
+                return false;
+            }
+            i += sequence;
+        }
+    }
+    return true;
+}
+
+size_t ckg_utf8_repair(const uint8_t* input, size_t length, char* output) {
+    unsigned char* out = (unsigned char*)output;
+    size_t i = 0;
+    while (i < length) {
+        size_t ascii = ascii_run(input + i, length - i);
+        memcpy(out, input + i, ascii);
+        out += ascii;
+        i += ascii;
+        while (i < length && input[i] >= 0x80) {
+            size_t sequence = utf8_sequence_length(input + i, length - i);
+            if (sequence == 0) {
+                out = put_code_point(out, 0xFFFD);
+                i++;
+                continue;
+            }
+            memcpy(out, input + i, sequence);
+            out += sequence;
+            i += sequence;
+        }
+    }
+    return (size_t)(out - (unsigned char*)output);
+}
+
+// Code units sampled when looking for UTF-16 without a byte order mark
+#define CKG_SNIFF_UNITS 256
+
+CKGEncoding ckg_detect_encoding(const uint8_t* data, size_t length, size_t* bom_length) {
+    *bom_length = 0;
+    if (length >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        *bom_length = 3;
+        return CKG_ENCODING_UTF8;
+    }
+    if (length >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+        *bom_length = 2;
+        return CKG_ENCODING_UTF16LE;
+    }
+    if (length >= 2 && data[0] == 0xFE && data[1] == 0xFF) {
+        *bom_length = 2;
+        return CKG_ENCODING_UTF16BE;
+    }
+
+    // Source text is mostly ASCII, which UTF-16 stores with one zero byte
+    // per unit; UTF-8 text has no zero bytes at all
+    size_t units = length / 2 < CKG_SNIFF_UNITS ? length / 2 : CKG_SNIFF_UNITS;
+    if (units < 2) {
+        return CKG_ENCODING_UTF8;
+    }
+    size_t even_zeros = 0;
+    size_t odd_zeros = 0;
+    for (size_t i = 0; i < units; i++) {
+        even_zeros += data[i * 2] == 0;
+        odd_zeros += data[i * 2 + 1] == 0;
+    }
+    if (even_zeros == 0 && odd_zeros * 4 >= units * 3) {
+        return CKG_ENCODING_UTF16LE;
+    }
+    if (odd_zeros == 0 && even_zeros * 4 >= units * 3) {
+        return CKG_ENCODING_UTF16BE;
+    }
+    return CKG_ENCODING_UTF8;
+}
+
+const char* ckg_decode_source(const char* data, uint64_t length, CKGDecodedSource* source) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t bom_length;
+    source->owned = NULL;
+    if (length > UINT32_MAX) {
+        return "File too large";
+    }
+    source->encoding = ckg_detect_encoding(bytes, (size_t)length, &bom_length);
+    bytes += bom_length;
+    size_t remaining = (size_t)length - bom_length;
+
+    if (source->encoding == CKG_ENCODING_UTF8 && ckg_utf8_validate(bytes, remaining)) {
+        source->data = (const char*)bytes;
+        source->length = remaining;
+        return NULL;
+    }
+    if (source->encoding == CKG_ENCODING_UTF8 && bom_length == 0) {
+        source->encoding = CKG_ENCODING_LATIN1;
+    }
+
+    // Every conversion grows text by at most CKG_UTF8_PER_BYTE per input byte
+    source->owned = (char*)malloc(remaining * CKG_UTF8_PER_BYTE + 1);
+    if (!source->owned) {
+        return "Out of memory";
+    }
+    switch (source->encoding) {
+    case CKG_ENCODING_UTF16LE:
+    case CKG_ENCODING_UTF16BE:
+        // A trailing odd byte is not a code unit and is dropped
+        source->length = ckg_utf16_to_utf8(bytes, remaining / 2, source->encoding == CKG_ENCODING_UTF16BE,
+                                           source->owned);
+        break;
+    case CKG_ENCODING_LATIN1:
+        source->length = ckg_latin1_to_utf8(bytes, remaining, source->owned);
+        break;
+    default:
+        source->length = ckg_utf8_repair(bytes, remaining, source->owned);
+        break;
+    }
+    source->data = source->owned;
+    return NULL;
+}
+
+void ckg_decoded_source_free(CKGDecodedSource* source) {
+    free(source->owned);
+    source->owned = NULL;
+}
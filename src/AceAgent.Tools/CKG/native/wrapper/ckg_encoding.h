@@ -0,0 +1,65 @@
+#ifndef CKG_ENCODING_H
+#define CKG_ENCODING_H
+
+// Text encoding detection and conversion for source that does not arrive as
+// UTF-8. Output is always well-formed UTF-8: unpaired surrogates and
+// invalid sequences become U+FFFD, so no undecodable byte reaches a grammar.
+// The ASCII runs that make up most source code are checked and copied
+// 16 bytes at a time with SSE2 or NEON where the target has them.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    CKG_ENCODING_UTF8 = 0,
+    CKG_ENCODING_UTF16LE = 1,
+    CKG_ENCODING_UTF16BE = 2,
+    CKG_ENCODING_LATIN1 = 3     // Bytes 0x80-0x9F read as Windows-1252
+} CKGEncoding;
+
+// Most UTF-8 bytes one UTF-16 code unit can become (a pair takes 4 for 2)
+#define CKG_UTF8_PER_UTF16_UNIT 3
+// Most UTF-8 bytes one Latin-1 byte or one invalid UTF-8 byte can become
+#define CKG_UTF8_PER_BYTE 3
+
+// Convert `units` UTF-16 code units, stored little-endian or big-endian, to
+// UTF-8. `input` needs no particular alignment. `output` must hold
+// units * CKG_UTF8_PER_UTF16_UNIT bytes. Returns the bytes written.
+size_t ckg_utf16_to_utf8(const void* input, size_t units, bool big_endian, char* output);
+
+// Convert Latin-1 text to UTF-8. `output` must hold length * CKG_UTF8_PER_BYTE
+// bytes. Returns the bytes written.
+size_t ckg_latin1_to_utf8(const uint8_t* input, size_t length, char* output);
+
+// True if `data` is well-formed UTF-8: no overlong forms, surrogates or
+// code points above U+10FFFF
+bool ckg_utf8_validate(const uint8_t* data, size_t length);
+
+// Copy UTF-8 text, replacing each invalid byte with U+FFFD. `output` must
+// hold length * CKG_UTF8_PER_BYTE bytes. Returns the bytes written.
+size_t ckg_utf8_repair(const uint8_t* input, size_t length, char* output);
+
+// Encoding announced by a byte order mark, with the mark's length in
+// *bom_length. Without a mark, text whose first code units are ASCII with a
+// zero high byte is taken as UTF-16; anything else reports CKG_ENCODING_UTF8
+// and still needs validating.
+CKGEncoding ckg_detect_encoding(const uint8_t* data, size_t length, size_t* bom_length);
+
+typedef struct {
+    const char* data;       // UTF-8 text without a byte order mark
+    uint64_t length;
+    char* owned;            // Transcoded copy behind `data`, or NULL when it points into the input
+    CKGEncoding encoding;   // What the input was read as
+} CKGDecodedSource;
+
+// Turn file contents into UTF-8 for parsing. Valid UTF-8 is used in place
+// (after any byte order mark); UTF-16 is transcoded; UTF-8 marked by a BOM
+// has invalid bytes replaced; other text that is not valid UTF-8 is read as
+// Latin-1. Line breaks survive every conversion, so line numbers match the
+// file. Returns NULL on success or an error message; release the source
+// with ckg_decoded_source_free.
+const char* ckg_decode_source(const char* data, uint64_t length, CKGDecodedSource* source);
+void ckg_decoded_source_free(CKGDecodedSource* source);
+
+#endif // CKG_ENCODING_H
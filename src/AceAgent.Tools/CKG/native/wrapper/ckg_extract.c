@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_trace.h"
+
+// Symbol extraction over a syntax tree.
+//
+// The tree is walked once, depth first, with a TSTreeCursor: moving to the
+// first child, next sibling or parent is O(1), whereas ts_node_child(node, i)
+// rescans the parent's children on every call. Enclosing classes are kept on
+// an explicit stack, so neither the walk nor the class context uses the C
+// stack and arbitrarily deep trees are safe.
+//
+// Node types are resolved to TSSymbol ids once per language, so dispatch is
+// a table lookup and a switch rather than string comparisons, and names are
+// reached through field ids instead of scanning children.
+
+static const struct {
+    const char* name;
+    CKGNodeKind kind;
+} node_kind_names[] = {
+    { "class_declaration", CKG_NODE_CLASS },
+    { "method_declaration", CKG_NODE_METHOD },
+    { "constructor_declaration", CKG_NODE_METHOD },
+    { "function_definition", CKG_NODE_FUNCTION },
+    { "function_declarator", CKG_NODE_FUNCTION_DECLARATOR },
+    { "identifier", CKG_NODE_IDENTIFIER },
+};
+
+// Resolve the node types and fields the walker dispatches on
+bool ckg_symbol_table_init(CKGSymbolTable* table, const TSLanguage* language) {
+    table->symbol_count = ts_language_symbol_count(language);
+    table->node_kinds = (uint8_t*)calloc(table->symbol_count ? table->symbol_count : 1, sizeof(uint8_t));
+    if (!table->node_kinds) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(node_kind_names) / sizeof(node_kind_names[0]); i++) {
+        const char* name = node_kind_names[i].name;
+        TSSymbol symbol = ts_language_symbol_for_name(language, name, (uint32_t)strlen(name), true);
+        if (symbol != 0 && symbol < table->symbol_count) {
+            table->node_kinds[symbol] = (uint8_t)node_kind_names[i].kind;
+        }
+    }
+    table->name_field = ts_language_field_id_for_name(language, "name", 4);
+    table->declarator_field = ts_language_field_id_for_name(language, "declarator", 10);
+    return true;
+}
+
+void ckg_symbol_table_free(CKGSymbolTable* table) {
+    free(table->node_kinds);
+    memset(table, 0, sizeof(*table));
+}
+
+static inline CKGNodeKind node_kind(const CKGSymbolTable* table, TSNode node) {
+    TSSymbol symbol = ts_node_symbol(node);
+    return symbol < table->symbol_count ? (CKGNodeKind)table->node_kinds[symbol] : CKG_NODE_OTHER;
+}
+
+// Child in the given field if it is of the expected kind
+static bool field_child(const CKGSymbolTable* table, TSNode node, TSFieldId field, CKGNodeKind kind, TSNode* child) {
+    if (field == 0) {
+        return false;
+    }
+    *child = ts_node_child_by_field_id(node, field);
+    return !ts_node_is_null(*child) && node_kind(table, *child) == kind;
+}
+
+// Innermost enclosing class, or an empty span
+static inline CKGSpan current_class(const ParsedData* data) {
+    if (data->scope_count > 0) {
+        return data->scopes[data->scope_count - 1].name;
+    }
+    CKGSpan none = { 0, 0 };
+    return none;
+}
+
+// Add class to parsed data
+static void add_class(ParsedData* data, TSNode name_node, TSNode node) {
+    if (data->class_count >= data->class_capacity) {
+        int capacity = data->class_capacity == 0 ? 10 : data->class_capacity * 2;
+        ExtractedClass* classes = (ExtractedClass*)realloc(data->classes, capacity * sizeof(ExtractedClass));
+        if (!classes) {
+            return;
+        }
+        data->classes = classes;
+        data->class_capacity = capacity;
+    }
+
+    ExtractedClass* extracted = &data->classes[data->class_count++];
+    extracted->name = ckg_node_span(name_node);
+    extracted->start_line = (int)ts_node_start_point(node).row + 1;
+    extracted->end_line = (int)ts_node_end_point(node).row + 1;
+    extracted->start_byte = ts_node_start_byte(node);
+    extracted->end_byte = ts_node_end_byte(node);
+}
+
+// Add function to parsed data
+static void add_function(ParsedData* data, TSNode name_node, TSNode node) {
+    if (data->function_count >= data->function_capacity) {
+        int capacity = data->function_capacity == 0 ? 10 : data->function_capacity * 2;
+        ExtractedFunction* functions = (ExtractedFunction*)realloc(data->functions, capacity * sizeof(ExtractedFunction));
+        if (!functions) {
+            return;
+        }
+        data->functions = functions;
+        data->function_capacity = capacity;
+    }
+
+    ExtractedFunction* extracted = &data->functions[data->function_count++];
+    extracted->name = ckg_node_span(name_node);
+    extracted->class_name = current_class(data);
+    extracted->explicit_class = false;
+    extracted->start_line = (int)ts_node_start_point(node).row + 1;
+    extracted->end_line = (int)ts_node_end_point(node).row + 1;
+    extracted->start_byte = ts_node_start_byte(node);
+    extracted->end_byte = ts_node_end_byte(node);
+}
+
+static void push_scope(ParsedData* data, TSNode name_node, uint32_t depth) {
+    if (data->scope_count >= data->scope_capacity) {
+        int capacity = data->scope_capacity == 0 ? 8 : data->scope_capacity * 2;
+        ClassScope* scopes = (ClassScope*)realloc(data->scopes, capacity * sizeof(ClassScope));
+        if (!scopes) {
+            return;
+        }
+        data->scopes = scopes;
+        data->scope_capacity = capacity;
+    }
+
+    ClassScope* scope = &data->scopes[data->scope_count++];
+    scope->name = ckg_node_span(name_node);
+    scope->depth = depth;
+}
+
+// Walk the tree under `root`. Symbols are appended to `data`, or, with a
+// visitor, reported to it instead. With `ranges`, nodes touching none of
+// them are stepped over with their subtrees. Returns false if the visitor
+// stopped the walk.
+static bool walk_symbols(const CKGSymbolTable* table, TSNode root, const CKGByteRange* ranges, uint32_t range_count,
+                         ParsedData* data, const char* source_code, const CKGVisitor* visitor) {
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    uint32_t depth = 0;
+    bool keep_going = true;
+    data->scope_count = 0;
+
+    for (;;) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        TSNode name_node;
+        bool enter = true;
+        data->node_count++;
+
+        CKG_TRACE_DEBUG(CKG_TRACE_NODE, ts_node_symbol(node), ts_node_start_byte(node));
+
+        if (ranges) {
+            uint32_t start_byte = ts_node_start_byte(node);
+            if (range_count == 0 || start_byte > ranges[range_count - 1].end_byte) {
+                // Nodes come in start order: nothing further can touch a range
+                ts_tree_cursor_delete(&cursor);
+                return true;
+            }
+            enter = ckg_ranges_touch(ranges, range_count, start_byte, ts_node_end_byte(node));
+        }
+
+        switch (enter ? node_kind(table, node) : CKG_NODE_OTHER) {
+            case CKG_NODE_CLASS:
+                // Children of the class are extracted with it as their context
+                if (field_child(table, node, table->name_field, CKG_NODE_IDENTIFIER, &name_node)) {
+                    if (visitor) {
+                        keep_going = ckg_visit(visitor->on_class, visitor, source_code, ckg_node_span(name_node),
+                                               current_class(data), node);
+                    } else {
+                        add_class(data, name_node, node);
+                    }
+                    push_scope(data, name_node, depth);
+                }
+                break;
+            case CKG_NODE_METHOD:
+                if (field_child(table, node, table->name_field, CKG_NODE_IDENTIFIER, &name_node)) {
+                    if (visitor) {
+                        keep_going = ckg_visit(visitor->on_function, visitor, source_code, ckg_node_span(name_node),
+                                               current_class(data), node);
+                    } else {
+                        add_function(data, name_node, node);
+                    }
+                }
+                break;
+            case CKG_NODE_FUNCTION: {
+                // C language function definition: the name sits in the declarator
+                TSNode declarator;
+                if (field_child(table, node, table->declarator_field, CKG_NODE_FUNCTION_DECLARATOR, &declarator) &&
+                    field_child(table, declarator, table->declarator_field, CKG_NODE_IDENTIFIER, &name_node)) {
+                    if (visitor) {
+                        keep_going = ckg_visit(visitor->on_function, visitor, source_code, ckg_node_span(name_node),
+                                               current_class(data), node);
+                    } else {
+                        add_function(data, name_node, node);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (!keep_going) {
+            ts_tree_cursor_delete(&cursor);
+            return false;
+        }
+
+        if (enter && ts_tree_cursor_goto_first_child(&cursor)) {
+            depth++;
+            continue;
+        }
+
+        // The current node's subtree is done: close its class scope, then
+        // move to the next sibling, climbing until one exists
+        for (;;) {
+            if (data->scope_count > 0 && data->scopes[data->scope_count - 1].depth == depth) {
+                data->scope_count--;
+            }
+            if (ts_tree_cursor_goto_next_sibling(&cursor)) {
+                break;
+            }
+            if (depth == 0 || !ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return true;
+            }
+            depth--;
+        }
+    }
+}
+
+// Extract classes and functions from the tree under `root` into `data`
+void ckg_extract_symbols(const CKGSymbolTable* table, TSNode root, const CKGByteRange* ranges, uint32_t range_count,
+                         ParsedData* data) {
+    walk_symbols(table, root, ranges, range_count, data, NULL, NULL);
+}
+
+bool ckg_visit_symbols(const CKGSymbolTable* table, TSNode root, ParsedData* data, const char* source_code,
+                       const CKGVisitor* visitor) {
+    return walk_symbols(table, root, NULL, 0, data, source_code, visitor);
+}
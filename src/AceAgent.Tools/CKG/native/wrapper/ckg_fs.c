@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_fs.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <io.h>
+
+// UTF-8 path to a malloc'd UTF-16 string for the wide Win32 calls; the ANSI
+// ones would read it in the system code page. NULL if it is not valid UTF-8.
+static wchar_t* widen(const char* path) {
+    int length = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path, -1, NULL, 0);
+    if (length <= 0) {
+        return NULL;
+    }
+    wchar_t* wide = (wchar_t*)malloc((size_t)length * sizeof(wchar_t));
+    if (wide && MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, path, -1, wide, length) != length) {
+        free(wide);
+        return NULL;
+    }
+    return wide;
+}
+
+bool ckg_map_file(const char* path, CKGMappedFile* file) {
+    memset(file, 0, sizeof(*file));
+    file->data = "";
+
+    wchar_t* wide = widen(path);
+    if (!wide) {
+        return false;
+    }
+    HANDLE handle = CreateFileW(wide, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    free(wide);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(handle);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    const char* data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file->data = data;
+    file->length = (uint64_t)size.QuadPart;
+    file->file_handle = handle;
+    file->mapping_handle = mapping;
+    file->mapped = true;
+    return true;
+}
+
+void ckg_unmap_file(CKGMappedFile* file) {
+    if (file->mapped) {
+        UnmapViewOfFile(file->data);
+        CloseHandle((HANDLE)file->mapping_handle);
+        CloseHandle((HANDLE)file->file_handle);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+struct CKGDirIterator {
+    HANDLE handle;
+    WIN32_FIND_DATAW data;
+    bool pending;
+    char name[MAX_PATH * 3];    // UTF-8 of data.cFileName
+};
+
+CKGDirIterator* ckg_dir_open(const char* path) {
+    char pattern[MAX_PATH * 3];
+    snprintf(pattern, sizeof(pattern), "%s\\*", path);
+    wchar_t* wide = widen(pattern);
+    if (!wide) {
+        return NULL;
+    }
+
+    CKGDirIterator* iterator = (CKGDirIterator*)calloc(1, sizeof(CKGDirIterator));
+    if (!iterator) {
+        free(wide);
+        return NULL;
+    }
+
+    iterator->handle = FindFirstFileExW(wide, FindExInfoBasic, &iterator->data,
+                                        FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    free(wide);
+    if (iterator->handle == INVALID_HANDLE_VALUE) {
+        free(iterator);
+        return NULL;
+    }
+    iterator->pending = true;
+    return iterator;
+}
+
+const char* ckg_dir_next(CKGDirIterator* iterator, CKGEntryType* type) {
+    for (;;) {
+        if (!iterator->pending && !FindNextFileW(iterator->handle, &iterator->data)) {
+            return NULL;
+        }
+        iterator->pending = false;
+
+        const wchar_t* wide = iterator->data.cFileName;
+        if (wcscmp(wide, L".") == 0 || wcscmp(wide, L"..") == 0) {
+            continue;
+        }
+        if (WideCharToMultiByte(CP_UTF8, 0, wide, -1, iterator->name, (int)sizeof(iterator->name), NULL, NULL) <= 0) {
+            continue;
+        }
+        const char* name = iterator->name;
+
+        DWORD attributes = iterator->data.dwFileAttributes;
+        if (attributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+            *type = CKG_ENTRY_OTHER;
+        } else if (attributes & FILE_ATTRIBUTE_DIRECTORY) {
+            *type = CKG_ENTRY_DIRECTORY;
+        } else {
+            *type = CKG_ENTRY_FILE;
+        }
+        return name;
+    }
+}
+
+void ckg_dir_close(CKGDirIterator* iterator) {
+    if (iterator) {
+        FindClose(iterator->handle);
+        free(iterator);
+    }
+}
+
+static bool get_attributes(const char* path, WIN32_FILE_ATTRIBUTE_DATA* data) {
+    wchar_t* wide = widen(path);
+    if (!wide) {
+        return false;
+    }
+    BOOL found = GetFileAttributesExW(wide, GetFileExInfoStandard, data);
+    free(wide);
+    return found != 0;
+}
+
+int64_t ckg_file_size(const char* path) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!get_attributes(path, &data)) {
+        return -1;
+    }
+    return ((int64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+}
+
+bool ckg_file_stat(const char* path, uint64_t* size, int64_t* mtime) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!get_attributes(path, &data)) {
+        return false;
+    }
+    *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    *mtime = (int64_t)(((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+bool ckg_make_dir(const char* path) {
+    wchar_t* wide = widen(path);
+    if (!wide) {
+        return false;
+    }
+    bool made = CreateDirectoryW(wide, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+    free(wide);
+    return made;
+}
+
+bool ckg_replace_file(const char* from, const char* to) {
+    wchar_t* wide_from = widen(from);
+    wchar_t* wide_to = widen(to);
+    bool moved = wide_from && wide_to && MoveFileExW(wide_from, wide_to, MOVEFILE_REPLACE_EXISTING) != 0;
+    free(wide_from);
+    free(wide_to);
+    return moved;
+}
+
+bool ckg_remove_file(const char* path) {
+    wchar_t* wide = widen(path);
+    bool removed = wide && DeleteFileW(wide) != 0;
+    free(wide);
+    return removed;
+}
+
+FILE* ckg_open_file(const char* path, const char* mode) {
+    wchar_t wide_mode[8];
+    if (MultiByteToWideChar(CP_UTF8, 0, mode, -1, wide_mode, 8) <= 0) {
+        return NULL;
+    }
+    wchar_t* wide = widen(path);
+    if (!wide) {
+        return NULL;
+    }
+    FILE* file = _wfopen(wide, wide_mode);
+    free(wide);
+    return file;
+}
+
+bool ckg_touch_file(const char* path) {
+    wchar_t* wide = widen(path);
+    if (!wide) {
+        return false;
+    }
+    HANDLE handle = CreateFileW(wide, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    free(wide);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    BOOL touched = SetFileTime(handle, NULL, NULL, &now);
+    CloseHandle(handle);
+    return touched != 0;
+}
+
+int64_t ckg_fd_size(int fd) {
+    LARGE_INTEGER size;
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size)) {
+        return -1;
+    }
+    return (int64_t)size.QuadPart;
+}
+
+int64_t ckg_read_at(int fd, uint64_t offset, char* buffer, uint32_t capacity) {
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    // The offset in OVERLAPPED makes the read positional
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD read = 0;
+    if (!ReadFile(handle, buffer, capacity, &read, &overlapped)) {
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    }
+    return (int64_t)read;
+}
+
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool ckg_map_file(const char* path, CKGMappedFile* file) {
+    memset(file, 0, sizeof(*file));
+    file->data = "";
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+#endif
+
+    file->data = (const char*)data;
+    file->length = (uint64_t)info.st_size;
+    file->mapped = true;
+    return true;
+}
+
+void ckg_unmap_file(CKGMappedFile* file) {
+    if (file->mapped) {
+        munmap((void*)file->data, (size_t)file->length);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+struct CKGDirIterator {
+    DIR* dir;
+};
+
+CKGDirIterator* ckg_dir_open(const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return NULL;
+    }
+
+    CKGDirIterator* iterator = (CKGDirIterator*)malloc(sizeof(CKGDirIterator));
+    if (!iterator) {
+        closedir(dir);
+        return NULL;
+    }
+    iterator->dir = dir;
+    return iterator;
+}
+
+const char* ckg_dir_next(CKGDirIterator* iterator, CKGEntryType* type) {
+    struct dirent* entry;
+    while ((entry = readdir(iterator->dir)) != NULL) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        // readdir is backed by getdents; d_type avoids a stat per entry on
+        // file systems that fill it in
+        unsigned char d_type = entry->d_type;
+        if (d_type == DT_UNKNOWN) {
+            struct stat info;
+            if (fstatat(dirfd(iterator->dir), name, &info, AT_SYMLINK_NOFOLLOW) == 0) {
+                d_type = S_ISDIR(info.st_mode) ? DT_DIR : S_ISREG(info.st_mode) ? DT_REG : DT_LNK;
+            }
+        }
+
+        *type = d_type == DT_DIR ? CKG_ENTRY_DIRECTORY : d_type == DT_REG ? CKG_ENTRY_FILE : CKG_ENTRY_OTHER;
+        return name;
+    }
+    return NULL;
+}
+
+void ckg_dir_close(CKGDirIterator* iterator) {
+    if (iterator) {
+        closedir(iterator->dir);
+        free(iterator);
+    }
+}
+
+int64_t ckg_file_size(const char* path) {
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return -1;
+    }
+    return (int64_t)info.st_size;
+}
+
+bool ckg_file_stat(const char* path, uint64_t* size, int64_t* mtime) {
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return false;
+    }
+    *size = (uint64_t)info.st_size;
+#ifdef __APPLE__
+    *mtime = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    *mtime = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+bool ckg_make_dir(const char* path) {
+    return mkdir(path, 0777) == 0 || errno == EEXIST;
+}
+
+bool ckg_replace_file(const char* from, const char* to) {
+    return rename(from, to) == 0;
+}
+
+bool ckg_remove_file(const char* path) {
+    return remove(path) == 0;
+}
+
+FILE* ckg_open_file(const char* path, const char* mode) {
+    return fopen(path, mode);
+}
+
+bool ckg_touch_file(const char* path) {
+    return utimensat(AT_FDCWD, path, NULL, 0) == 0;
+}
+
+int64_t ckg_fd_size(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return -1;
+    }
+    return (int64_t)info.st_size;
+}
+
+int64_t ckg_read_at(int fd, uint64_t offset, char* buffer, uint32_t capacity) {
+    ssize_t read;
+    do {
+        read = pread(fd, buffer, capacity, (off_t)offset);
+    } while (read < 0 && errno == EINTR);
+    return (int64_t)read;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef CKG_FS_H
+#define CKG_FS_H
+
+// File system helpers: read-only file mappings and a minimal directory
+// iterator that reports entry types without a stat per entry where the
+// platform allows it (d_type on POSIX, FindFirstFile data on Windows).
+// Paths are UTF-8 on every platform; Windows converts them for the wide APIs.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct {
+    const char* data;   // Mapped bytes; never NULL ("" for empty files)
+    uint64_t length;
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#endif
+    bool mapped;
+} CKGMappedFile;
+
+// Map a file read-only. Returns false if the file cannot be opened.
+bool ckg_map_file(const char* path, CKGMappedFile* file);
+void ckg_unmap_file(CKGMappedFile* file);
+
+typedef enum {
+    CKG_ENTRY_OTHER = 0,
+    CKG_ENTRY_FILE = 1,
+    CKG_ENTRY_DIRECTORY = 2
+} CKGEntryType;
+
+typedef struct CKGDirIterator CKGDirIterator;
+
+CKGDirIterator* ckg_dir_open(const char* path);
+// Returns the next entry name (excluding "." and ".."), or NULL at the end.
+// The name is valid until the next call.
+const char* ckg_dir_next(CKGDirIterator* iterator, CKGEntryType* type);
+void ckg_dir_close(CKGDirIterator* iterator);
+
+// Size of a file, or -1 if it cannot be stat'ed
+int64_t ckg_file_size(const char* path);
+
+// Size and last-write time of a file; false if it cannot be stat'ed. The
+// time is in the platform's finest unit (nanoseconds since 1970 on POSIX,
+// 100 ns FILETIME ticks on Windows) and only meant to be compared.
+bool ckg_file_stat(const char* path, uint64_t* size, int64_t* mtime);
+
+// Create a directory; true if it exists afterwards. Parents must exist.
+bool ckg_make_dir(const char* path);
+// Move `from` over `to`, replacing any file already there
+bool ckg_replace_file(const char* from, const char* to);
+bool ckg_remove_file(const char* path);
+// fopen for a UTF-8 path
+FILE* ckg_open_file(const char* path, const char* mode);
+// Set a file's last-write time to now
+bool ckg_touch_file(const char* path);
+
+// Positioned reads from an open C runtime file descriptor. The descriptor's
+// file position is left alone on POSIX but may move on Windows. ckg_read_at
+// returns the bytes read (0 at the end of the file) or -1 on error.
+int64_t ckg_fd_size(int fd);
+int64_t ckg_read_at(int fd, uint64_t offset, char* buffer, uint32_t capacity);
+
+#endif // CKG_FS_H
@@ -0,0 +1,14 @@
+#ifndef CKG_HASH_H
+#define CKG_HASH_H
+
+// Fast non-cryptographic hashing of source text, for cache keys and change
+// detection. Not suitable where an adversary picks the input.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 64-bit hash of `length` bytes (the XXH64 algorithm, so values match other
+// XXH64 implementations for the same seed)
+uint64_t ckg_hash64(const void* data, size_t length, uint64_t seed);
+
+#endif // CKG_HASH_H
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_fs.h"
+#include "ckg_ignore.h"
+
+static bool match_class(const char** pattern_ptr, char c) {
+    const char* p = *pattern_ptr + 1;   // Skip '['
+    bool negate = false;
+    bool matched = false;
+
+    if (*p == '!' || *p == '^') {
+        negate = true;
+        p++;
+    }
+
+    // A ']' right after the opening bracket is a literal
+    const char* first = p;
+    while (*p && (*p != ']' || p == first)) {
+        char low = *p;
+        if (low == '\\' && p[1]) {
+            low = *++p;
+        }
+        if (p[1] == '-' && p[2] && p[2] != ']') {
+            char high = p[2];
+            if (c >= low && c <= high) {
+                matched = true;
+            }
+            p += 3;
+        } else {
+            if (c == low) {
+                matched = true;
+            }
+            p++;
+        }
+    }
+
+    if (*p == ']') {
+        p++;
+    }
+    *pattern_ptr = p;
+    return matched != negate;
+}
+
+bool ckg_glob_match(const char* pattern, const char* text) {
+    const char* p = pattern;
+    const char* t = text;
+
+    while (*p) {
+        if (p[0] == '*' && p[1] == '*') {
+            // "**" spans directories when it is a whole path segment
+            bool segment_start = p == pattern || p[-1] == '/';
+            const char* rest = p + 2;
+            if (segment_start && (*rest == '/' || *rest == '\0')) {
+                if (*rest == '\0') {
+                    return true;
+                }
+                rest++;   // "**/" also matches zero directories
+                for (const char* s = t;; s++) {
+                    if ((s == t || s[-1] == '/') && ckg_glob_match(rest, s)) {
+                        return true;
+                    }
+                    if (*s == '\0') {
+                        return false;
+                    }
+                }
+            }
+            p++;   // Otherwise treat as a single '*'
+        }
+
+        if (*p == '*') {
+            p++;
+            for (const char* s = t;; s++) {
+                if (ckg_glob_match(p, s)) {
+                    return true;
+                }
+                if (*s == '\0' || *s == '/') {
+                    return false;
+                }
+            }
+        }
+
+        if (*t == '\0') {
+            return false;
+        }
+
+        if (*p == '?') {
+            if (*t == '/') {
+                return false;
+            }
+            p++;
+            t++;
+        } else if (*p == '[') {
+            if (*t == '/' || !match_class(&p, *t)) {
+                return false;
+            }
+            t++;
+        } else {
+            if (*p == '\\' && p[1]) {
+                p++;
+            }
+            if (*p != *t) {
+                return false;
+            }
+            p++;
+            t++;
+        }
+    }
+
+    return *t == '\0';
+}
+
+void ckg_ignore_add(CKGIgnoreList* list, const char* base, const char* line) {
+    size_t length = strlen(line);
+
+    // Trim line endings and unescaped trailing spaces
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r' ||
+                          (line[length - 1] == ' ' && (length < 2 || line[length - 2] != '\\')))) {
+        length--;
+    }
+    if (length == 0 || line[0] == '#') {
+        return;
+    }
+
+    CKGIgnoreRule rule = {0};
+    if (line[0] == '!') {
+        rule.negate = true;
+        line++;
+        length--;
+    } else if (line[0] == '\\' && (line[1] == '!' || line[1] == '#')) {
+        line++;
+        length--;
+    }
+    if (length > 0 && line[length - 1] == '/') {
+        rule.dir_only = true;
+        length--;
+    }
+    if (length > 0 && line[0] == '/') {
+        rule.anchored = true;
+        line++;
+        length--;
+    }
+    if (length == 0) {
+        return;
+    }
+    if (memchr(line, '/', length)) {
+        rule.anchored = true;
+    }
+
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity == 0 ? 16 : list->capacity * 2;
+        CKGIgnoreRule* rules = (CKGIgnoreRule*)realloc(list->rules, capacity * sizeof(CKGIgnoreRule));
+        if (!rules) {
+            return;
+        }
+        list->rules = rules;
+        list->capacity = capacity;
+    }
+
+    rule.pattern = (char*)malloc(length + 1);
+    rule.base = strdup(base ? base : "");
+    if (!rule.pattern || !rule.base) {
+        free(rule.pattern);
+        free(rule.base);
+        return;
+    }
+    memcpy(rule.pattern, line, length);
+    rule.pattern[length] = '\0';
+    list->rules[list->count++] = rule;
+}
+
+bool ckg_ignore_load(CKGIgnoreList* list, const char* base, const char* file_path) {
+    FILE* file = ckg_open_file(file_path, "r");
+    if (!file) {
+        return false;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        ckg_ignore_add(list, base, line);
+    }
+    fclose(file);
+    return true;
+}
+
+void ckg_ignore_truncate(CKGIgnoreList* list, uint32_t count) {
+    while (list->count > count) {
+        list->count--;
+        free(list->rules[list->count].pattern);
+        free(list->rules[list->count].base);
+    }
+}
+
+void ckg_ignore_free(CKGIgnoreList* list) {
+    ckg_ignore_truncate(list, 0);
+    free(list->rules);
+    list->rules = NULL;
+    list->capacity = 0;
+}
+
+bool ckg_ignore_match(const CKGIgnoreList* list, const char* relative_path, bool is_dir) {
+    const char* slash = strrchr(relative_path, '/');
+    const char* name = slash ? slash + 1 : relative_path;
+
+    // Walk backwards so the last matching rule decides
+    for (uint32_t i = list->count; i-- > 0;) {
+        const CKGIgnoreRule* rule = &list->rules[i];
+        if (rule->dir_only && !is_dir) {
+            continue;
+        }
+
+        const char* subject = relative_path;
+        size_t base_length = strlen(rule->base);
+        if (base_length > 0) {
+            if (strncmp(relative_path, rule->base, base_length) != 0 || relative_path[base_length] != '/') {
+                continue;
+            }
+            subject = relative_path + base_length + 1;
+        }
+
+        if (ckg_glob_match(rule->pattern, rule->anchored ? subject : name)) {
+            return !rule->negate;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,40 @@
+#ifndef CKG_IGNORE_H
+#define CKG_IGNORE_H
+
+// .gitignore-style path filtering used by the directory indexer.
+// Supports comments, blank lines, "!" negation, trailing "/" for
+// directory-only rules, anchored patterns (any "/" before the end), and
+// the "*", "?", "[...]" and "**" wildcards. The last matching rule wins.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    char* pattern;
+    char* base;         // Directory of the defining .gitignore, relative to the root ("" = root)
+    bool negate;
+    bool dir_only;
+    bool anchored;
+} CKGIgnoreRule;
+
+typedef struct {
+    CKGIgnoreRule* rules;
+    uint32_t count;
+    uint32_t capacity;
+} CKGIgnoreList;
+
+// Add one pattern line; `base` is the relative directory it applies to
+void ckg_ignore_add(CKGIgnoreList* list, const char* base, const char* line);
+// Load every pattern from an ignore file; returns false if it cannot be read
+bool ckg_ignore_load(CKGIgnoreList* list, const char* base, const char* file_path);
+// Drop rules added after `count`, used when the walker leaves a directory
+void ckg_ignore_truncate(CKGIgnoreList* list, uint32_t count);
+void ckg_ignore_free(CKGIgnoreList* list);
+
+// `relative_path` uses "/" separators and is relative to the walk root
+bool ckg_ignore_match(const CKGIgnoreList* list, const char* relative_path, bool is_dir);
+
+// Glob match where "*" and "?" do not cross "/" but "**" does
+bool ckg_glob_match(const char* pattern, const char* text);
+
+#endif // CKG_IGNORE_H
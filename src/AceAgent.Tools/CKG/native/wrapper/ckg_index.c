@@ -0,0 +1,490 @@
+#define BUILDING_CKG_DLL
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+#include "ckg_pool.h"
+#include "ckg_fs.h"
+#include "ckg_ignore.h"
+#include "ckg_hash.h"
+
+typedef struct {
+    char* path;
+    uint64_t size;
+    int64_t mtime;
+    int language;
+    const CKGFileFingerprint* known;    // From the previous run, or NULL
+} IndexEntry;
+
+// Known fingerprints by path: open addressing over indices + 1 (0 = empty)
+typedef struct {
+    const CKGFileFingerprint* files;
+    uint32_t* slots;
+    uint32_t mask;
+} KnownFiles;
+
+typedef struct {
+    IndexEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+    const char* const* include_exts;
+    CKGIgnoreList ignore;
+    bool use_gitignore;
+    bool fingerprint;                   // Stat modification times for on_file
+    KnownFiles known;
+} IndexWalk;
+
+typedef struct {
+    IndexEntry* entries;
+    CKGContext** contexts;
+    uint64_t timeout_micros;
+    CKGSizePolicy size_policy;
+    CKGIndexCallback callback;
+    CKGFileCallback on_file;
+    void* user_data;
+    CKGMutex callback_lock;
+    volatile int32_t stopped;
+    volatile int32_t delivered;
+    CKGIndexWriter* writer;             // With options->index_path
+    const CKGIndex* previous;           // The index at index_path before this run
+    CKGTextWriter* text_writer;         // With options->text_index_path
+    const CKGTextIndex* text_previous;  // The text index there before this run
+    CKGTrigramSet* trigram_sets;        // Per worker, with text_writer
+} IndexJob;
+
+static bool has_included_extension(const char* name, const char* const* include_exts) {
+    const char* ext = strrchr(name, '.');
+    if (!ext) {
+        return false;
+    }
+    for (; *include_exts; include_exts++) {
+        const char* a = ext;
+        const char* b = *include_exts;
+        while (*a && *b && (*a | 0x20) == (*b | 0x20)) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t path_hash(const char* path) {
+    return ckg_hash64(path, strlen(path), 0);
+}
+
+static bool known_files_init(KnownFiles* known, const CKGFileFingerprint* files, uint32_t count) {
+    memset(known, 0, sizeof(*known));
+    if (!files || count == 0) {
+        return true;
+    }
+    uint32_t capacity = 16;
+    while (capacity < count * 2 && capacity < (1u << 31)) {
+        capacity *= 2;
+    }
+    known->slots = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    if (!known->slots) {
+        return false;
+    }
+    known->files = files;
+    known->mask = capacity - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!files[i].path) {
+            continue;
+        }
+        uint32_t slot = (uint32_t)path_hash(files[i].path) & known->mask;
+        while (known->slots[slot]) {
+            slot = (slot + 1) & known->mask;
+        }
+        known->slots[slot] = i + 1;
+    }
+    return true;
+}
+
+static const CKGFileFingerprint* known_files_find(const KnownFiles* known, const char* path) {
+    if (!known->slots) {
+        return NULL;
+    }
+    uint32_t slot = (uint32_t)path_hash(path) & known->mask;
+    for (; known->slots[slot]; slot = (slot + 1) & known->mask) {
+        const CKGFileFingerprint* file = &known->files[known->slots[slot] - 1];
+        if (strcmp(file->path, path) == 0) {
+            return file;
+        }
+    }
+    return NULL;
+}
+
+static void add_entry(IndexWalk* walk, char* path, int language) {
+    if (walk->count == walk->capacity) {
+        uint32_t capacity = walk->capacity == 0 ? 1024 : walk->capacity * 2;
+        IndexEntry* entries = (IndexEntry*)realloc(walk->entries, capacity * sizeof(IndexEntry));
+        if (!entries) {
+            free(path);
+            return;
+        }
+        walk->entries = entries;
+        walk->capacity = capacity;
+    }
+
+    IndexEntry* entry = &walk->entries[walk->count++];
+    entry->path = path;
+    entry->size = 0;
+    entry->mtime = 0;
+    entry->language = language;
+    entry->known = NULL;
+    if (walk->fingerprint) {
+        ckg_file_stat(path, &entry->size, &entry->mtime);
+        entry->known = known_files_find(&walk->known, path);
+    } else {
+        int64_t size = ckg_file_size(path);
+        entry->size = size > 0 ? (uint64_t)size : 0;
+    }
+}
+
+static char* join_path(const char* dir, const char* name) {
+    size_t dir_length = strlen(dir);
+    size_t name_length = strlen(name);
+    char* path = (char*)malloc(dir_length + name_length + 2);
+    if (path) {
+        memcpy(path, dir, dir_length);
+        path[dir_length] = '/';
+        memcpy(path + dir_length + 1, name, name_length + 1);
+    }
+    return path;
+}
+
+// Recursive walk; recursion depth equals directory depth
+static void walk_directory(IndexWalk* walk, const char* dir_path, const char* relative_dir) {
+    uint32_t rule_mark = walk->ignore.count;
+
+    if (walk->use_gitignore) {
+        char* gitignore_path = join_path(dir_path, ".gitignore");
+        if (gitignore_path) {
+            ckg_ignore_load(&walk->ignore, relative_dir, gitignore_path);
+            free(gitignore_path);
+        }
+    }
+
+    CKGDirIterator* iterator = ckg_dir_open(dir_path);
+    if (iterator) {
+        CKGEntryType type;
+        const char* name;
+        while ((name = ckg_dir_next(iterator, &type)) != NULL) {
+            if (type == CKG_ENTRY_OTHER || strcmp(name, ".git") == 0) {
+                continue;
+            }
+
+            bool is_dir = type == CKG_ENTRY_DIRECTORY;
+            if (!is_dir) {
+                if (walk->include_exts ? !has_included_extension(name, walk->include_exts)
+                                       : ckg_language_from_path(name) < 0) {
+                    continue;
+                }
+            }
+
+            char* relative_path = relative_dir[0] ? join_path(relative_dir, name) : strdup(name);
+            if (!relative_path) {
+                continue;
+            }
+            if (ckg_ignore_match(&walk->ignore, relative_path, is_dir)) {
+                free(relative_path);
+                continue;
+            }
+
+            char* path = join_path(dir_path, name);
+            if (path) {
+                if (is_dir) {
+                    walk_directory(walk, path, relative_path);
+                    free(path);
+                } else {
+                    add_entry(walk, path, ckg_language_from_path(name));
+                }
+            }
+            free(relative_path);
+        }
+        ckg_dir_close(iterator);
+    }
+
+    ckg_ignore_truncate(&walk->ignore, rule_mark);
+}
+
+// Parse an entry's file, or its bytes when they are already mapped
+static CKGParseResult* parse_entry(IndexJob* job, uint32_t worker_index, const IndexEntry* entry, const char* data,
+                                   uint64_t length) {
+    CKGContext* ctx = job->contexts[worker_index];
+    if (!ctx) {
+        ctx = job->contexts[worker_index] = ckg_context_create();
+        ckg_context_set_timeout(ctx, job->timeout_micros);
+        ckg_context_set_size_policy(ctx, &job->size_policy);
+    }
+
+    if (!ctx) {
+        return ckg_create_error_result("Failed to create parsing context");
+    }
+    if (entry->language < 0) {
+        return ckg_create_error_result("Unsupported language");
+    }
+    return data ? ckg_parse_file_bytes(ctx, (CKGLanguage)entry->language, data, length)
+                : ckg_parse_path(ctx, (CKGLanguage)entry->language, entry->path);
+}
+
+// Deliver a file one at a time so callers need no locking of their own: its
+// fingerprint when fingerprinting, then its parse result if it was parsed.
+// `text` holds its trigrams when its bytes were read.
+static void deliver(IndexJob* job, const IndexEntry* entry, const CKGFileFingerprint* fingerprint, CKGFileState state,
+                    CKGParseResult* result, const CKGTrigramSet* text) {
+    ckg_mutex_lock(&job->callback_lock);
+    if (!ckg_atomic_load32(&job->stopped)) {
+        ckg_atomic_add32(&job->delivered, 1);
+        bool keep_going = true;
+        if (fingerprint) {
+            keep_going = job->on_file(job->user_data, fingerprint, state);
+        }
+        if (keep_going && result) {
+            keep_going = job->callback(job->user_data, entry->path, (CKGLanguage)entry->language, result);
+        }
+        // Files that were not parsed, or failed to, keep their old symbols
+        if (job->writer) {
+            if (result && !result->error_message) {
+                ckg_index_writer_add_result(job->writer, entry->path, (CKGLanguage)entry->language, result);
+            } else {
+                ckg_index_writer_add_file(job->writer, job->previous, entry->path);
+            }
+        }
+        if (job->text_writer) {
+            if (text) {
+                ckg_text_writer_add(job->text_writer, entry->path, text->trigrams, text->count);
+            } else {
+                ckg_text_writer_add_file(job->text_writer, job->text_previous, entry->path);
+            }
+        }
+        if (!keep_going) {
+            ckg_atomic_add32(&job->stopped, 1);
+        }
+    }
+    ckg_mutex_unlock(&job->callback_lock);
+
+    ckg_free_result(result);
+}
+
+// Collect a mapped file's trigrams for the text index; NULL without one, or
+// if out of memory, in which case the file keeps its old trigrams
+static const CKGTrigramSet* file_trigrams(IndexJob* job, uint32_t worker_index, const CKGMappedFile* file) {
+    if (!job->text_writer) {
+        return NULL;
+    }
+    CKGTrigramSet* set = &job->trigram_sets[worker_index];
+    return ckg_trigram_extract(set, file->data, file->length) ? set : NULL;
+}
+
+static void index_file(void* user, uint32_t worker_index, uint32_t task_index) {
+    IndexJob* job = (IndexJob*)user;
+    if (ckg_atomic_load32(&job->stopped)) {
+        return;
+    }
+
+    IndexEntry* entry = &job->entries[task_index];
+    CKGMappedFile file;
+    if (!job->on_file) {
+        if (!job->text_writer) {
+            deliver(job, entry, NULL, CKG_FILE_NEW, parse_entry(job, worker_index, entry, NULL, 0), NULL);
+            return;
+        }
+        // The text index needs the bytes as well, so map the file for both
+        if (!ckg_map_file(entry->path, &file)) {
+            deliver(job, entry, NULL, CKG_FILE_NEW, ckg_create_error_result("Failed to read file"), NULL);
+            return;
+        }
+        const CKGTrigramSet* text = file_trigrams(job, worker_index, &file);
+        CKGParseResult* result = parse_entry(job, worker_index, entry, file.data, file.length);
+        ckg_unmap_file(&file);
+        deliver(job, entry, NULL, CKG_FILE_NEW, result, text);
+        return;
+    }
+
+    // Same size and time as last run: trust it without reading a byte,
+    // unless the text index has yet to see it
+    const CKGFileFingerprint* known = entry->known;
+    CKGFileFingerprint fingerprint = { entry->path, entry->size, entry->mtime, 0 };
+    bool unchanged = known && known->size == entry->size && known->mtime == entry->mtime;
+    if (unchanged) {
+        fingerprint.hash = known->hash;
+        if (!job->text_writer || ckg_text_index_has_file(job->text_previous, entry->path)) {
+            deliver(job, entry, &fingerprint, CKG_FILE_UNCHANGED, NULL, NULL);
+            return;
+        }
+    }
+
+    // Otherwise hash the mapped bytes, and parse them only if the hash moved
+    CKGFileState state = unchanged ? CKG_FILE_UNCHANGED : known ? CKG_FILE_CHANGED : CKG_FILE_NEW;
+    CKGParseResult* result = NULL;
+    const CKGTrigramSet* text = NULL;
+    if (ckg_map_file(entry->path, &file)) {
+        if (!unchanged) {
+            fingerprint.size = file.length;
+            fingerprint.hash = ckg_hash64(file.data, (size_t)file.length, 0);
+            if (known && known->hash == fingerprint.hash && known->size == fingerprint.size) {
+                state = CKG_FILE_TOUCHED;
+            } else {
+                result = parse_entry(job, worker_index, entry, file.data, file.length);
+            }
+        }
+        text = file_trigrams(job, worker_index, &file);
+        ckg_unmap_file(&file);
+    } else if (!unchanged) {
+        result = ckg_create_error_result("Failed to read file");
+    }
+    deliver(job, entry, &fingerprint, state, result, text);
+}
+
+// Copy the symbols of indexed files this run did not look for, because
+// their extension is not among `include_exts`
+static void carry_other_files(CKGIndexWriter* writer, const CKGIndex* previous, const char* const* include_exts) {
+    uint32_t symbol_count = 0;
+    ckg_index_get_info(previous, &symbol_count, NULL);
+    const char* carried = NULL;
+    for (uint32_t position = 0; position < symbol_count; position++) {
+        CKGIndexSymbol symbol;
+        if (!ckg_index_get(previous, CKG_INDEX_BY_FILE, position, &symbol) || symbol.file_path == carried) {
+            continue;
+        }
+        // Positions run file by file, so each file is seen once
+        carried = symbol.file_path;
+        const char* name = strrchr(symbol.file_path, '/');
+        if (!has_included_extension(name ? name + 1 : symbol.file_path, include_exts)) {
+            ckg_index_writer_add_file(writer, previous, symbol.file_path);
+        }
+    }
+}
+
+// The same for the text index
+static void carry_other_text(CKGTextWriter* writer, const CKGTextIndex* previous, const char* const* include_exts) {
+    const char* path;
+    for (uint32_t file = 0; (path = ckg_text_index_path(previous, file)) != NULL; file++) {
+        const char* name = strrchr(path, '/');
+        if (!has_included_extension(name ? name + 1 : path, include_exts)) {
+            ckg_text_writer_add_file(writer, previous, path);
+        }
+    }
+}
+
+static int compare_entries_by_size_desc(const void* a, const void* b) {
+    const IndexEntry* left = (const IndexEntry*)a;
+    const IndexEntry* right = (const IndexEntry*)b;
+    return left->size < right->size ? 1 : (left->size > right->size ? -1 : 0);
+}
+
+// Walk a directory tree, parse every matching file on a native thread pool,
+// and stream results back through the callback
+CKG_API int ckg_index_directory(const char* root, const char* const* include_exts, const char* const* ignore_globs,
+                                const CKGIndexOptions* options, CKGIndexCallback callback, void* user_data) {
+    if (!root || !callback) {
+        return -1;
+    }
+
+    CKGDirIterator* probe = ckg_dir_open(root);
+    if (!probe) {
+        return -1;
+    }
+    ckg_dir_close(probe);
+
+    CKGIndexOptions defaults = {0};
+    if (!options) {
+        options = &defaults;
+    }
+
+    IndexWalk walk;
+    memset(&walk, 0, sizeof(walk));
+    walk.include_exts = include_exts;
+    walk.use_gitignore = !options->disable_gitignore;
+    walk.fingerprint = options->on_file != NULL;
+    if (walk.fingerprint && !known_files_init(&walk.known, options->known_files, options->known_file_count)) {
+        return -1;
+    }
+    for (const char* const* glob = ignore_globs; glob && *glob; glob++) {
+        ckg_ignore_add(&walk.ignore, "", *glob);
+    }
+
+    // Strip trailing separators so joined paths stay canonical
+    char* root_path = strdup(root);
+    if (!root_path) {
+        ckg_ignore_free(&walk.ignore);
+        free(walk.known.slots);
+        return -1;
+    }
+    size_t root_length = strlen(root_path);
+    while (root_length > 1 && (root_path[root_length - 1] == '/' || root_path[root_length - 1] == '\\')) {
+        root_path[--root_length] = '\0';
+    }
+
+    walk_directory(&walk, root_path, "");
+    ckg_ignore_free(&walk.ignore);
+    free(root_path);
+    free(walk.known.slots);
+
+    // Largest files first so no big file starts last
+    qsort(walk.entries, walk.count, sizeof(IndexEntry), compare_entries_by_size_desc);
+
+    IndexJob job;
+    uint32_t worker_count = ckg_pool_worker_count(options->thread_count, walk.count);
+    job.entries = walk.entries;
+    job.contexts = (CKGContext**)calloc(worker_count, sizeof(CKGContext*));
+    job.timeout_micros = options->timeout_micros;
+    job.size_policy = options->size_policy;
+    job.callback = callback;
+    job.on_file = options->on_file;
+    job.user_data = user_data;
+    job.stopped = 0;
+    job.delivered = 0;
+    job.writer = options->index_path ? ckg_index_writer_create() : NULL;
+    job.previous = job.writer ? ckg_index_open(options->index_path) : NULL;
+    job.text_writer = options->text_index_path ? ckg_text_writer_create() : NULL;
+    job.text_previous = job.text_writer ? ckg_text_index_open(options->text_index_path) : NULL;
+    job.trigram_sets = job.text_writer ? (CKGTrigramSet*)calloc(worker_count, sizeof(CKGTrigramSet)) : NULL;
+    ckg_mutex_init(&job.callback_lock);
+
+    bool indexed = (!options->index_path || job.writer) && (!options->text_index_path || job.trigram_sets);
+    if (job.contexts && indexed) {
+        ckg_pool_run(worker_count, NULL, walk.count, index_file, &job);
+        for (uint32_t w = 0; w < worker_count; w++) {
+            ckg_context_destroy(job.contexts[w]);
+        }
+    }
+    free(job.contexts);
+    for (uint32_t w = 0; job.trigram_sets && w < worker_count; w++) {
+        ckg_trigram_set_free(&job.trigram_sets[w]);
+    }
+    free(job.trigram_sets);
+    ckg_mutex_destroy(&job.callback_lock);
+
+    // A stopped run leaves the old indexes in place
+    if (indexed && !ckg_atomic_load32(&job.stopped)) {
+        if (job.writer) {
+            if (include_exts) {
+                carry_other_files(job.writer, job.previous, include_exts);
+            }
+            indexed = ckg_index_writer_write(job.writer, options->index_path) == 0;
+        }
+        if (job.text_writer) {
+            if (include_exts) {
+                carry_other_text(job.text_writer, job.text_previous, include_exts);
+            }
+            indexed = ckg_text_writer_write(job.text_writer, options->text_index_path) == 0 && indexed;
+        }
+    }
+    ckg_index_close((CKGIndex*)job.previous);
+    ckg_index_writer_destroy(job.writer);
+    ckg_text_index_close((CKGTextIndex*)job.text_previous);
+    ckg_text_writer_destroy(job.text_writer);
+
+    for (uint32_t i = 0; i < walk.count; i++) {
+        free(walk.entries[i].path);
+    }
+    free(walk.entries);
+
+    return indexed ? ckg_atomic_load32(&job.delivered) : -1;
+}
@@ -0,0 +1,408 @@
+#ifndef CKG_INTERNAL_H
+#define CKG_INTERNAL_H
+
+// Declarations shared between the wrapper's translation units. Nothing in
+// here is part of the exported API.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tree_sitter/api.h"
+#include "ckg_wrapper.h"
+
+// Number of CKGLanguage values
+#define CKG_LANGUAGE_COUNT (CKG_LANG_PHP + 1)
+
+// Internal structures for parsing. Names are spans of the source buffer and
+// are only copied out when a result is built.
+typedef struct {
+    CKGSpan name;
+    int start_line;
+    int end_line;
+    uint32_t start_byte;
+    uint32_t end_byte;
+} ExtractedClass;
+
+typedef struct {
+    CKGSpan name;
+    CKGSpan class_name;     // Zero length when there is no class
+    int start_line;
+    int end_line;
+    uint32_t start_byte;
+    uint32_t end_byte;
+    bool explicit_class;    // class_name came from the query, not nesting
+} ExtractedFunction;
+
+// Enclosing class during extraction: its name, the cursor depth of its
+// declaration node (walker) and where it ends (query visitor)
+typedef struct {
+    CKGSpan name;
+    uint32_t depth;
+    uint32_t end_byte;
+} ClassScope;
+
+typedef struct {
+    ExtractedClass* classes;
+    int class_count;
+    int class_capacity;
+    ExtractedFunction* functions;
+    int function_count;
+    int function_capacity;
+    ClassScope* scopes;
+    int scope_count;
+    int scope_capacity;
+    int* open_classes;      // Class indices, used by query extraction
+    int open_class_capacity;
+    uint32_t node_count;    // Nodes the walker stepped over, for stats
+    uint32_t match_count;   // Query matches, for stats
+} ParsedData;
+
+// Bytes from start_byte to end_byte inclusive. Extraction limited to a set
+// of ranges only reports symbols whose definitions touch one of them.
+typedef struct {
+    uint32_t start_byte;
+    uint32_t end_byte;
+} CKGByteRange;
+
+// Whether [start_byte, end_byte] touches any of `count` ranges sorted by start
+static inline bool ckg_ranges_touch(const CKGByteRange* ranges, uint32_t count, uint32_t start_byte, uint32_t end_byte) {
+    for (uint32_t i = 0; i < count && ranges[i].start_byte <= end_byte; i++) {
+        if (start_byte <= ranges[i].end_byte) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A source kept open for incremental reparsing (see ckg_document.c): its
+// text and syntax tree, and the symbols extracted from them, which edits
+// keep up to date
+typedef struct {
+    uint32_t file_id;
+    CKGLanguage language;
+    TSTree* tree;
+    char* source;
+    uint32_t length;
+    ParsedData symbols;     // Spans of `source`
+} CKGDocument;
+
+// Node kinds the cursor walker dispatches on
+typedef enum {
+    CKG_NODE_OTHER = 0,
+    CKG_NODE_CLASS,
+    CKG_NODE_METHOD,
+    CKG_NODE_FUNCTION,
+    CKG_NODE_FUNCTION_DECLARATOR,
+    CKG_NODE_IDENTIFIER
+} CKGNodeKind;
+
+// Per-language dispatch table for the cursor walker: node kinds indexed by
+// TSSymbol, and the field ids names are found under. Built lazily per
+// context, since symbol ids differ between grammars.
+typedef struct {
+    uint8_t* node_kinds;
+    uint32_t symbol_count;
+    TSFieldId name_field;
+    TSFieldId declarator_field;
+} CKGSymbolTable;
+
+// Parsing context: one Tree-sitter parser plus scratch buffers that are
+// reused across parses. A context must only be used by one thread at a time,
+// but any number of contexts can parse concurrently.
+struct CKGContext {
+    // One parser per language, created with its language set the first time
+    // the context parses that language, so switching languages costs nothing
+    TSParser* parsers[CKG_LANGUAGE_COUNT];
+    TSQueryCursor* query_cursor;
+    CKGSymbolTable symbol_tables[CKG_LANGUAGE_COUNT];
+    ParsedData scratch;
+    CKGStats stats;
+    uint64_t timeout_micros;        // Budget for each parse; 0 = none
+    uint64_t deadline_ns;           // ckg_now_ns() limit of the current parse; 0 = none
+    volatile int32_t cancelled;     // Set by ckg_context_cancel from any thread
+    bool stopped;                   // The current parse hit the deadline or was cancelled
+    CKGSizePolicy size_policy;
+    bool skipped;                   // The size policy kept the current source from parsing
+    bool declarations_only;         // The size policy limits the current extraction's depth
+    CKGDocument* documents;         // Open documents, by file id
+    uint32_t document_count;
+    uint32_t document_capacity;
+};
+
+// Span of the source covered by a node
+static inline CKGSpan ckg_node_span(TSNode node) {
+    CKGSpan span;
+    span.offset = ts_node_start_byte(node);
+    span.length = ts_node_end_byte(node) - span.offset;
+    return span;
+}
+
+// Progress check for Tree-sitter's parse and query callbacks: true once the
+// current parse is past its deadline or the context has been cancelled,
+// which also sets ctx->stopped
+bool ckg_should_stop(CKGContext* ctx);
+
+// Build the language registry (see ckg_registry.c); ckg_init does this.
+// Until then every lookup fails.
+bool ckg_registry_init(void);
+
+// Resolve a CKG language from a file path's extension, or from a language
+// name such as "csharp" or "c#"; returns -1 if it is not recognised.
+int ckg_language_from_path(const char* file_path);
+int ckg_language_from_name(const char* name);
+
+// Parse `length` bytes of source (no NUL terminator required). With
+// `copy_names` false the result carries spans only (see ckg_parse_spans).
+CKGParseResult* ckg_parse_source(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length, bool copy_names);
+
+// The context's parser for `language`, created and set to the language on
+// first use. NULL if the language has no grammar or it cannot be loaded.
+TSParser* ckg_language_parser(CKGContext* ctx, CKGLanguage language);
+
+// Parse with the context's size policy applied and its deadline and
+// cancellation flag checked as Tree-sitter makes progress. Starts the
+// deadline that extraction then runs under. An edited `old_tree` makes the
+// parse incremental. Returns NULL on failure or when skipped or stopped
+// (ctx->skipped and ctx->stopped tell which).
+TSTree* ckg_parse_tree(CKGContext* ctx, TSParser* parser, const TSTree* old_tree, TSInput input, uint32_t length);
+
+// Status of a parse that did not fail, and its count in the stats
+uint32_t ckg_parse_status(CKGContext* ctx, CKGStats* delta);
+
+// Count a failed parse against its language
+void ckg_count_error(CKGStats* delta, CKGLanguage language);
+
+// Extract symbols from the tree under `root` into an empty `data` with the
+// language's query, or the cursor walker if it has none. With `ranges`,
+// only definitions touching one of them are extracted, along with the
+// classes enclosing those; NULL extracts the whole tree.
+void ckg_extract(CKGContext* ctx, CKGLanguage language, const TSLanguage* ts_language, TSNode root,
+                 const CKGByteRange* ranges, uint32_t range_count, ParsedData* data);
+
+// Release a context's open documents (see ckg_document.c)
+void ckg_documents_free(CKGContext* ctx);
+
+// Map, decode and parse a file as ckg_parse_file does, into a result with
+// copied names. Errors, including unreadable files, come back as error results.
+CKGParseResult* ckg_parse_path(CKGContext* ctx, CKGLanguage language, const char* path);
+
+// Decode and parse the raw bytes of a file already in memory (typically
+// mapped) as ckg_parse_path does
+CKGParseResult* ckg_parse_file_bytes(CKGContext* ctx, CKGLanguage language, const char* data, uint64_t length);
+
+// Tree-sitter grammar for a CKG language, or NULL if none is linked
+const TSLanguage* ckg_ts_language(CKGLanguage language);
+
+// Build / release a walker dispatch table for a grammar
+bool ckg_symbol_table_init(CKGSymbolTable* table, const TSLanguage* language);
+void ckg_symbol_table_free(CKGSymbolTable* table);
+
+// Extract classes and functions from the tree under `root` into `data` with
+// the cursor walker, appending to whatever it already holds. With `ranges`,
+// subtrees that touch none of them are not entered.
+void ckg_extract_symbols(const CKGSymbolTable* table, TSNode root, const CKGByteRange* ranges, uint32_t range_count,
+                         ParsedData* data);
+
+// Report symbols under `root` to `visitor` with the cursor walker, using
+// data's scope stack. Returns false if a callback stopped the traversal.
+bool ckg_visit_symbols(const CKGSymbolTable* table, TSNode root, ParsedData* data, const char* source_code,
+                       const CKGVisitor* visitor);
+
+// Compile / release the per-language extraction queries (see ckg_query.c)
+void ckg_queries_init(void);
+void ckg_queries_cleanup(void);
+
+// Extract classes and functions with the language's compiled query into an
+// empty `data`, limited to definitions touching `ranges` unless it is NULL.
+// Returns false if the language has no usable query, in which case the
+// caller falls back to ckg_extract_symbols.
+bool ckg_query_extract(CKGContext* ctx, CKGLanguage language, TSNode root, const CKGByteRange* ranges,
+                       uint32_t range_count, ParsedData* data);
+
+// Report symbols under `root` to `visitor` as the language's query matches
+// them. Returns 1 when done, 0 when a callback stopped it, or -1 if the
+// language has no usable query (the caller then uses ckg_visit_symbols).
+int ckg_query_visit(CKGContext* ctx, CKGLanguage language, TSNode root, ParsedData* data, const char* source_code,
+                    const CKGVisitor* visitor);
+
+// Call a visitor callback for a symbol defined by `node`; true when the
+// callback is absent or asks to continue
+static inline bool ckg_visit(CKGSymbolCallback callback, const CKGVisitor* visitor, const char* source_code,
+                             CKGSpan name, CKGSpan parent_class, TSNode node) {
+    if (!callback) {
+        return true;
+    }
+    CKGSymbol symbol;
+    symbol.name = name;
+    symbol.parent_class = parent_class;
+    symbol.start_line = ts_node_start_point(node).row + 1;
+    symbol.end_line = ts_node_end_point(node).row + 1;
+    return callback(visitor->user_data, source_code, &symbol);
+}
+
+// Identifies source text in the tree cache (see ckg_cache.c). Two sources
+// with the same key are taken to be the same text.
+typedef struct {
+    uint64_t hash;          // ckg_hash64 of the source bytes
+    uint32_t length;        // In bytes
+    uint16_t language;      // CKGLanguage
+    uint16_t encoding;      // TSInputEncoding the bytes were parsed as
+} CKGCacheKey;
+
+// Set up / tear down the process-wide tree cache; ckg_init and ckg_cleanup
+// call these, and until then the cache is off
+void ckg_cache_init(void);
+void ckg_cache_cleanup(void);
+bool ckg_cache_enabled(void);
+
+// Make room for `function_count` functions and `class_count` classes in
+// data's arrays
+bool ckg_cache_reserve(ParsedData* data, int function_count, int class_count);
+
+// Copy the symbols cached for `key` into `data`, growing its arrays as
+// needed, and mark the entry most recently used. False on a miss.
+bool ckg_cache_lookup(const CKGCacheKey* key, ParsedData* data);
+
+// Cache a complete parse: takes ownership of `tree` (deleting it if it is
+// not kept) and copies the symbols in `data`. `tree` may be NULL when only
+// the symbols are known. Returns how many entries were evicted to make room.
+uint32_t ckg_cache_store(const CKGCacheKey* key, TSTree* tree, const ParsedData* data);
+
+// Set up / tear down the persistent parse cache (see ckg_disk_cache.c),
+// which is off until given a directory
+void ckg_disk_cache_init(void);
+void ckg_disk_cache_cleanup(void);
+bool ckg_disk_cache_enabled(void);
+
+// Read the symbols stored for `key` into `data`, growing its arrays as
+// needed. False on a miss, including unreadable or damaged entries.
+bool ckg_disk_cache_lookup(const CKGCacheKey* key, ParsedData* data);
+
+// Store the symbols of a complete parse. Returns how many entries were
+// evicted to keep the directory within its budget.
+uint32_t ckg_disk_cache_store(const CKGCacheKey* key, const ParsedData* data);
+
+// Trigram posting lists (see ckg_trigram.c), used by text indexes and the
+// name section of symbol indexes. Records of the trigram table are
+// CKG_TRIGRAM_RECORD_SIZE bytes: trigram, document count, postings offset
+// (uint64), sorted by trigram.
+#define CKG_TRIGRAM_RECORD_SIZE 16
+
+// The mapped tables of one set of posting lists
+typedef struct {
+    const uint8_t* table;
+    uint32_t trigram_count;
+    const uint8_t* postings;
+    uint64_t postings_size;
+} CKGTrigramIndex;
+
+// Scratch for collecting a text's distinct trigrams; zero-initialise it,
+// reuse it across texts on one thread and release it with
+// ckg_trigram_set_free
+typedef struct {
+    uint64_t* seen;                 // One bit per trigram, clear between calls
+    uint32_t* trigrams;
+    uint32_t count;
+    uint32_t capacity;
+} CKGTrigramSet;
+
+void ckg_trigram_set_free(CKGTrigramSet* set);
+
+// Collect the distinct trigrams of `length` bytes, sorted, into
+// set->trigrams and set->count. False if out of memory.
+bool ckg_trigram_extract(CKGTrigramSet* set, const char* text, uint64_t length);
+
+// Supplies the sorted, distinct trigrams of a document, the same on every
+// call; the array only needs to stay valid until the next call. Return
+// false to fail the build.
+typedef bool (*CKGTrigramSource)(void* user_data, uint32_t document, const uint32_t** trigrams_out, uint32_t* count_out);
+
+// Posting lists built by ckg_trigram_build, in malloc'd buffers
+typedef struct {
+    uint8_t* table;
+    uint32_t trigram_count;
+    uint8_t* postings;
+    uint64_t postings_size;
+} CKGTrigramPostings;
+
+// Build the posting lists of documents 0 to document_count - 1, each listed
+// as values[document] (which must increase with the document) or as its
+// number when `values` is NULL. Each document's trigrams are requested
+// three times. False if out of memory or the source failed.
+bool ckg_trigram_build(uint32_t document_count, const uint32_t* values, CKGTrigramSource source, void* user_data,
+                       CKGTrigramPostings* postings);
+
+// The values listed under every trigram of `text` (case folded), ascending,
+// in a malloc'd array (NULL when there are none). Texts shorter than a
+// trigram rule nothing out: *all_out is set instead and nothing is
+// returned. False if out of memory or the lists are damaged.
+bool ckg_trigram_candidates(const CKGTrigramIndex* index, const char* text, uint64_t length, uint32_t** candidates_out,
+                            uint32_t* count_out, bool* all_out);
+
+// The tables of an open symbol index that searches read (see
+// ckg_symbol_index.c), pointing into its mapping
+typedef struct {
+    const uint8_t* symbols;
+    uint32_t symbol_count;
+    const char* strings;
+    uint64_t string_size;
+    const uint8_t* name_trie;
+    uint32_t name_node_count;
+    const uint8_t* hump_trie;
+    uint32_t hump_node_count;
+    const uint8_t* humps;
+    uint32_t hump_count;
+    CKGTrigramIndex name_trigrams;  // Values are the first row of each distinct name
+} CKGIndexTables;
+
+void ckg_index_tables(const CKGIndex* index, CKGIndexTables* tables);
+
+// A key of a symbol index trie: a span of the string pool and the values
+// it maps to
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t value_first;
+    uint32_t value_count;
+} CKGTrieKey;
+
+// Lay out the radix trie over `keys` (see ckg_symbol_search.c), which must
+// be non-empty, distinct and sorted bytewise with values in the same
+// order. Returns *node_count_out records of CKG_INDEX_TRIE_NODE_SIZE bytes
+// in a malloc'd buffer, or NULL if out of memory.
+uint8_t* ckg_trie_build(const char* pool, const CKGTrieKey* keys, uint32_t count, uint32_t* node_count_out);
+
+// Write the hump key of a name (see CKG_INDEX_VERSION) to `key`, at most
+// `capacity` bytes, and return its length
+uint32_t ckg_hump_key(const char* name, uint32_t length, char* key, uint32_t capacity);
+
+// Collects the trigrams of files and writes them as a text index (see
+// ckg_text_index.c). ckg_text_writer_add_file copies a file's trigrams from
+// an existing index and returns false if it has none. Once an add runs out
+// of memory the writer stays failed and writes nothing; ckg_text_writer_write
+// replaces `path` atomically and returns 0 on success, -1 on failure.
+typedef struct CKGTextWriter CKGTextWriter;
+
+CKGTextWriter* ckg_text_writer_create(void);
+void ckg_text_writer_destroy(CKGTextWriter* writer);
+bool ckg_text_writer_add(CKGTextWriter* writer, const char* path, const uint32_t* trigrams, uint32_t count);
+bool ckg_text_writer_add_file(CKGTextWriter* writer, const CKGTextIndex* index, const char* path);
+int ckg_text_writer_write(CKGTextWriter* writer, const char* path);
+
+// Whether an open text index has `path`, and the path of its file number
+// `file` (NULL past the end)
+bool ckg_text_index_has_file(const CKGTextIndex* index, const char* path);
+const char* ckg_text_index_path(const CKGTextIndex* index, uint32_t file);
+
+// Add one operation's counters to the context and the process-wide totals
+// (see ckg_stats.c). arena_high_water is merged as a maximum.
+void ckg_stats_add(CKGContext* ctx, const CKGStats* delta);
+
+// Allocate a result carrying only an error message
+CKGParseResult* ckg_create_error_result(const char* message);
+
+// Encode extracted symbols with their CKGParseStatus, or an error, in the
+// ckg_parse_binary format (see ckg_binary.c). NULL if out of memory.
+uint8_t* ckg_binary_build(const ParsedData* data, const char* source_code, uint32_t status, uint32_t* size_out);
+uint8_t* ckg_binary_error(const char* message, uint32_t* size_out);
+
+#endif // CKG_INTERNAL_H
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_json.h"
+
+void ckg_json_init(CKGJsonWriter* writer, CKGJsonChunkCallback callback, void* user_data) {
+    memset(writer, 0, sizeof(*writer));
+    writer->callback = callback;
+    writer->user_data = user_data;
+}
+
+static bool send_chunk(CKGJsonWriter* writer) {
+    if (writer->length > 0 && !writer->callback(writer->user_data, writer->data, writer->length)) {
+        writer->failed = true;
+    }
+    writer->length = 0;
+    return !writer->failed;
+}
+
+// Make room for `needed` more bytes plus a terminator
+static bool reserve(CKGJsonWriter* writer, size_t needed) {
+    if (writer->failed) {
+        return false;
+    }
+    if (needed < writer->capacity - writer->length) {
+        return true;
+    }
+    if (writer->callback) {
+        // Streaming: drain the fixed-size buffer first; only a single write
+        // larger than a chunk grows it
+        if (!send_chunk(writer)) {
+            return false;
+        }
+        if (needed < writer->capacity) {
+            return true;
+        }
+    }
+
+    size_t capacity = writer->capacity ? writer->capacity : (writer->callback ? CKG_JSON_CHUNK_SIZE : 4096);
+    while (needed >= capacity - writer->length) {
+        capacity *= 2;
+    }
+    char* data = (char*)realloc(writer->data, capacity);
+    if (!data) {
+        writer->failed = true;
+        return false;
+    }
+    writer->data = data;
+    writer->capacity = capacity;
+    return true;
+}
+
+void ckg_json_write(CKGJsonWriter* writer, const char* text, size_t length) {
+    if (!reserve(writer, length)) {
+        return;
+    }
+    memcpy(writer->data + writer->length, text, length);
+    writer->length += length;
+}
+
+void ckg_json_write_cstr(CKGJsonWriter* writer, const char* text) {
+    ckg_json_write(writer, text, strlen(text));
+}
+
+void ckg_json_write_string(CKGJsonWriter* writer, const char* text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+
+    // Worst case every byte becomes \u00XX; reserving it up front keeps the
+    // loop free of capacity checks
+    if (!reserve(writer, length * 6 + 2)) {
+        return;
+    }
+    char* out = writer->data + writer->length;
+    *out++ = '"';
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            *out++ = (char)c;
+            continue;
+        }
+        *out++ = '\\';
+        switch (c) {
+            case '"':  *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '\b': *out++ = 'b'; break;
+            case '\f': *out++ = 'f'; break;
+            case '\n': *out++ = 'n'; break;
+            case '\r': *out++ = 'r'; break;
+            case '\t': *out++ = 't'; break;
+            default:
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = hex[c >> 4];
+                *out++ = hex[c & 0xF];
+                break;
+        }
+    }
+    *out++ = '"';
+    writer->length = (size_t)(out - writer->data);
+}
+
+void ckg_json_write_int(CKGJsonWriter* writer, int64_t value) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%lld", (long long)value);
+    ckg_json_write(writer, digits, (size_t)length);
+}
+
+bool ckg_json_flush(CKGJsonWriter* writer) {
+    if (writer->failed) {
+        return false;
+    }
+    return writer->callback ? send_chunk(writer) : true;
+}
+
+char* ckg_json_take(CKGJsonWriter* writer) {
+    if (writer->callback || !reserve(writer, 0)) {
+        return NULL;
+    }
+    char* document = writer->data;
+    document[writer->length] = '\0';
+    writer->data = NULL;
+    writer->length = 0;
+    writer->capacity = 0;
+    return document;
+}
+
+void ckg_json_free(CKGJsonWriter* writer) {
+    free(writer->data);
+    writer->data = NULL;
+    writer->length = 0;
+    writer->capacity = 0;
+}
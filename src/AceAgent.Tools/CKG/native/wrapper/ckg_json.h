@@ -0,0 +1,51 @@
+#ifndef CKG_JSON_H
+#define CKG_JSON_H
+
+// Append-only JSON output buffer. Appends track the length, so writing n
+// bytes costs O(n) overall: the buffer grows geometrically and nothing is
+// rescanned. With a chunk callback the buffer instead stays at a fixed size
+// and is handed to the callback each time it fills, so output of any length
+// is produced in bounded memory.
+//
+// Errors are sticky: after an allocation failure or a callback returning
+// false every further write is ignored and the failure is reported when
+// the document is taken or flushed.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ckg_wrapper.h"
+
+#define CKG_JSON_CHUNK_SIZE 16384
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    CKGJsonChunkCallback callback;  // NULL: accumulate the whole document
+    void* user_data;
+    bool failed;
+} CKGJsonWriter;
+
+void ckg_json_init(CKGJsonWriter* writer, CKGJsonChunkCallback callback, void* user_data);
+
+// Raw bytes, copied as is
+void ckg_json_write(CKGJsonWriter* writer, const char* text, size_t length);
+void ckg_json_write_cstr(CKGJsonWriter* writer, const char* text);
+// A quoted JSON string with quotes, backslashes and control characters escaped
+void ckg_json_write_string(CKGJsonWriter* writer, const char* text, size_t length);
+void ckg_json_write_int(CKGJsonWriter* writer, int64_t value);
+
+// Hand any buffered output to the callback. Returns false if the writer
+// has failed.
+bool ckg_json_flush(CKGJsonWriter* writer);
+
+// Accumulating writers only: the NUL-terminated document, which the caller
+// frees with free(), or NULL if the writer has failed. The writer no longer
+// owns the buffer afterwards.
+char* ckg_json_take(CKGJsonWriter* writer);
+
+// Release whatever buffer the writer still owns
+void ckg_json_free(CKGJsonWriter* writer);
+
+#endif // CKG_JSON_H
@@ -0,0 +1,179 @@
+#ifndef CKG_PLATFORM_H
+#define CKG_PLATFORM_H
+
+// Thin portability layer over the native threading primitives, atomics and
+// clock used by the wrapper (Win32 on Windows, pthreads everywhere else).
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+typedef HANDLE CKGThread;
+typedef CRITICAL_SECTION CKGMutex;
+
+typedef DWORD (WINAPI *CKGThreadProc)(LPVOID);
+#define CKG_THREAD_RETURN DWORD WINAPI
+#define CKG_THREAD_RESULT 0
+
+static inline bool ckg_thread_start(CKGThread* thread, CKGThreadProc proc, void* arg) {
+    *thread = CreateThread(NULL, 0, proc, arg, 0, NULL);
+    return *thread != NULL;
+}
+
+static inline void ckg_thread_join(CKGThread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+static inline void ckg_mutex_init(CKGMutex* mutex) { InitializeCriticalSection(mutex); }
+static inline void ckg_mutex_destroy(CKGMutex* mutex) { DeleteCriticalSection(mutex); }
+static inline void ckg_mutex_lock(CKGMutex* mutex) { EnterCriticalSection(mutex); }
+static inline void ckg_mutex_unlock(CKGMutex* mutex) { LeaveCriticalSection(mutex); }
+
+static inline void ckg_thread_yield(void) { SwitchToThread(); }
+
+static inline uint32_t ckg_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
+
+static inline int32_t ckg_atomic_add32(volatile int32_t* value, int32_t delta) {
+    return (int32_t)InterlockedExchangeAdd((volatile LONG*)value, delta) + delta;
+}
+
+static inline int32_t ckg_atomic_load32(volatile int32_t* value) {
+    return (int32_t)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+}
+
+static inline uint64_t ckg_atomic_load64(volatile uint64_t* value) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)value, 0, 0);
+}
+
+static inline void ckg_atomic_store64(volatile uint64_t* value, uint64_t desired) {
+    InterlockedExchange64((volatile LONG64*)value, (LONG64)desired);
+}
+
+static inline uint64_t ckg_atomic_add64(volatile uint64_t* value, uint64_t delta) {
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)value, (LONG64)delta) + delta;
+}
+
+static inline bool ckg_atomic_cas64(volatile uint64_t* value, uint64_t expected, uint64_t desired) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)value, (LONG64)desired, (LONG64)expected) == expected;
+}
+
+static inline bool ckg_atomic_cas32(volatile int32_t* value, int32_t expected, int32_t desired) {
+    return InterlockedCompareExchange((volatile LONG*)value, desired, expected) == expected;
+}
+
+static inline bool ckg_atomic_cas_ptr(void* volatile* value, void* expected, void* desired) {
+    return InterlockedCompareExchangePointer(value, desired, expected) == expected;
+}
+
+static inline void* ckg_atomic_load_ptr(void* volatile* value) {
+    return InterlockedCompareExchangePointer(value, NULL, NULL);
+}
+
+static inline void ckg_atomic_store32(volatile int32_t* value, int32_t desired) {
+    InterlockedExchange((volatile LONG*)value, desired);
+}
+
+#define CKG_THREAD_LOCAL __declspec(thread)
+
+static inline uint64_t ckg_now_ns(void) {
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+}
+
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef pthread_t CKGThread;
+typedef pthread_mutex_t CKGMutex;
+
+typedef void* (*CKGThreadProc)(void*);
+#define CKG_THREAD_RETURN void*
+#define CKG_THREAD_RESULT NULL
+
+static inline bool ckg_thread_start(CKGThread* thread, CKGThreadProc proc, void* arg) {
+    return pthread_create(thread, NULL, proc, arg) == 0;
+}
+
+static inline void ckg_thread_join(CKGThread thread) {
+    pthread_join(thread, NULL);
+}
+
+static inline void ckg_mutex_init(CKGMutex* mutex) { pthread_mutex_init(mutex, NULL); }
+static inline void ckg_mutex_destroy(CKGMutex* mutex) { pthread_mutex_destroy(mutex); }
+static inline void ckg_mutex_lock(CKGMutex* mutex) { pthread_mutex_lock(mutex); }
+static inline void ckg_mutex_unlock(CKGMutex* mutex) { pthread_mutex_unlock(mutex); }
+
+static inline void ckg_thread_yield(void) { sched_yield(); }
+
+static inline uint32_t ckg_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+}
+
+static inline int32_t ckg_atomic_add32(volatile int32_t* value, int32_t delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+
+static inline int32_t ckg_atomic_load32(volatile int32_t* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline uint64_t ckg_atomic_load64(volatile uint64_t* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void ckg_atomic_store64(volatile uint64_t* value, uint64_t desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+static inline uint64_t ckg_atomic_add64(volatile uint64_t* value, uint64_t delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+
+static inline bool ckg_atomic_cas64(volatile uint64_t* value, uint64_t expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline bool ckg_atomic_cas32(volatile int32_t* value, int32_t expected, int32_t desired) {
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline bool ckg_atomic_cas_ptr(void* volatile* value, void* expected, void* desired) {
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline void* ckg_atomic_load_ptr(void* volatile* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void ckg_atomic_store32(volatile int32_t* value, int32_t desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+#define CKG_THREAD_LOCAL __thread
+
+static inline uint64_t ckg_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+#endif
+
+#endif // CKG_PLATFORM_H
@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include "ckg_platform.h"
+#include "ckg_pool.h"
+#include "ckg_trace.h"
+
+// Each worker owns a deque seeded up front with a round-robin share of the
+// tasks. Owners pop from the head, so the highest-priority tasks start first;
+// idle workers steal from the tail of a victim's deque.
+typedef struct {
+    CKGMutex lock;
+    uint32_t* items;
+    uint32_t head;
+    uint32_t tail;
+} WorkDeque;
+
+typedef struct {
+    WorkDeque* deques;
+    uint32_t worker_count;
+    CKGPoolTaskFn fn;
+    void* user;
+} WorkPool;
+
+typedef struct {
+    WorkPool* pool;
+    uint32_t index;
+} WorkerArg;
+
+static bool deque_pop(WorkDeque* deque, uint32_t* task) {
+    bool found = false;
+    ckg_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *task = deque->items[deque->head++];
+        found = true;
+    }
+    ckg_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool deque_steal(WorkDeque* deque, uint32_t* task) {
+    bool found = false;
+    ckg_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        *task = deque->items[--deque->tail];
+        found = true;
+    }
+    ckg_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static void worker_loop(WorkPool* pool, uint32_t index) {
+    WorkDeque* own = &pool->deques[index];
+    uint32_t task;
+
+    for (;;) {
+        if (deque_pop(own, &task)) {
+            pool->fn(pool->user, index, task);
+            continue;
+        }
+
+        // Nothing is ever pushed after start, so a full sweep that finds
+        // no work means the pool is drained.
+        bool stolen = false;
+        for (uint32_t i = 1; i < pool->worker_count && !stolen; i++) {
+            WorkDeque* victim = &pool->deques[(index + i) % pool->worker_count];
+            stolen = deque_steal(victim, &task);
+        }
+        if (!stolen) {
+            return;
+        }
+        pool->fn(pool->user, index, task);
+    }
+}
+
+static CKG_THREAD_RETURN worker_main(void* arg) {
+    WorkerArg* worker = (WorkerArg*)arg;
+    worker_loop(worker->pool, worker->index);
+    ckg_trace_release_thread();
+    return CKG_THREAD_RESULT;
+}
+
+uint32_t ckg_pool_worker_count(uint32_t thread_count, uint32_t task_count) {
+    uint32_t count = thread_count > 0 ? thread_count : ckg_cpu_count();
+    if (count > task_count) {
+        count = task_count;
+    }
+    return count > 0 ? count : 1;
+}
+
+void ckg_pool_run(uint32_t thread_count, const uint32_t* order, uint32_t task_count,
+                  CKGPoolTaskFn fn, void* user) {
+    if (task_count == 0 || !fn) {
+        return;
+    }
+
+    uint32_t worker_count = ckg_pool_worker_count(thread_count, task_count);
+    uint32_t per_worker = (task_count + worker_count - 1) / worker_count;
+
+    WorkPool pool;
+    pool.worker_count = worker_count;
+    pool.fn = fn;
+    pool.user = user;
+    pool.deques = (WorkDeque*)calloc(worker_count, sizeof(WorkDeque));
+    uint32_t* storage = (uint32_t*)malloc((size_t)worker_count * per_worker * sizeof(uint32_t));
+    WorkerArg* args = (WorkerArg*)malloc(worker_count * sizeof(WorkerArg));
+    CKGThread* threads = (CKGThread*)malloc(worker_count * sizeof(CKGThread));
+    bool* started = (bool*)calloc(worker_count, sizeof(bool));
+
+    if (!pool.deques || !storage || !args || !threads || !started) {
+        // Out of memory: run everything on the calling thread
+        for (uint32_t i = 0; i < task_count; i++) {
+            fn(user, 0, order ? order[i] : i);
+        }
+        free(pool.deques);
+        free(storage);
+        free(args);
+        free(threads);
+        free(started);
+        return;
+    }
+
+    for (uint32_t w = 0; w < worker_count; w++) {
+        ckg_mutex_init(&pool.deques[w].lock);
+        pool.deques[w].items = storage + (size_t)w * per_worker;
+    }
+    for (uint32_t i = 0; i < task_count; i++) {
+        WorkDeque* deque = &pool.deques[i % worker_count];
+        deque->items[deque->tail++] = order ? order[i] : i;
+    }
+
+    for (uint32_t w = 1; w < worker_count; w++) {
+        args[w].pool = &pool;
+        args[w].index = w;
+        started[w] = ckg_thread_start(&threads[w], worker_main, &args[w]);
+    }
+
+    // Workers that failed to start simply leave their deque to be stolen
+    worker_loop(&pool, 0);
+
+    for (uint32_t w = 1; w < worker_count; w++) {
+        if (started[w]) {
+            ckg_thread_join(threads[w]);
+        }
+    }
+    for (uint32_t w = 0; w < worker_count; w++) {
+        ckg_mutex_destroy(&pool.deques[w].lock);
+    }
+
+    free(pool.deques);
+    free(storage);
+    free(args);
+    free(threads);
+    free(started);
+}
@@ -0,0 +1,19 @@
+#ifndef CKG_POOL_H
+#define CKG_POOL_H
+
+#include <stdint.h>
+
+// Task callback: runs task `task_index` on worker `worker_index`.
+// Worker indices are dense in [0, thread_count) so callers can keep
+// per-worker state (such as a CKGContext) in a plain array.
+typedef void (*CKGPoolTaskFn)(void* user, uint32_t worker_index, uint32_t task_index);
+
+// Run task_count tasks on a work-stealing pool of thread_count workers
+// (0 selects one worker per CPU). `order` lists task indices in priority
+// order and may be NULL for natural order. The calling thread acts as
+// worker 0; the call returns once every task has finished.
+uint32_t ckg_pool_worker_count(uint32_t thread_count, uint32_t task_count);
+void ckg_pool_run(uint32_t thread_count, const uint32_t* order, uint32_t task_count,
+                  CKGPoolTaskFn fn, void* user);
+
+#endif // CKG_POOL_H
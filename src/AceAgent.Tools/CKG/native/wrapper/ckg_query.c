@@ -0,0 +1,471 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_trace.h"
+
+// Query-based symbol extraction.
+//
+// Each language's extraction rules live in queries/<language>.scm and are
+// embedded into the library at build time. ckg_init compiles them once into
+// TSQuery objects that are shared read-only by every context; each context
+// runs them with its own TSQueryCursor.
+//
+// Capture names the extractor understands:
+//   @class.definition / @class.name        - a class-like type
+//   @function.definition / @function.name  - a function or method
+//   @function.class                        - explicit owner of a function,
+//                                            for owners that do not enclose it
+//   @field.definition / @field.name        - a member variable (visitors only)
+// Functions without @function.class belong to the innermost class whose
+// definition encloses them.
+
+// Generated from queries/*.scm
+extern const char ckg_query_c[];
+extern const char ckg_query_cpp[];
+extern const char ckg_query_csharp[];
+extern const char ckg_query_java[];
+extern const char ckg_query_javascript[];
+extern const char ckg_query_typescript[];
+extern const char ckg_query_python[];
+extern const char ckg_query_go[];
+
+typedef enum {
+    CAPTURE_IGNORED = 0,
+    CAPTURE_CLASS_DEFINITION,
+    CAPTURE_CLASS_NAME,
+    CAPTURE_FUNCTION_DEFINITION,
+    CAPTURE_FUNCTION_NAME,
+    CAPTURE_FUNCTION_CLASS,
+    CAPTURE_FIELD_DEFINITION,
+    CAPTURE_FIELD_NAME
+} CaptureRole;
+
+typedef struct {
+    TSQuery* query;
+    uint8_t* capture_roles;   // Indexed by capture id
+} LanguageQuery;
+
+static LanguageQuery language_queries[CKG_LANGUAGE_COUNT];
+
+static const char* query_source(CKGLanguage language) {
+    switch (language) {
+        case CKG_LANG_C:          return ckg_query_c;
+        case CKG_LANG_CPP:        return ckg_query_cpp;
+        case CKG_LANG_CSHARP:     return ckg_query_csharp;
+        case CKG_LANG_JAVA:       return ckg_query_java;
+        case CKG_LANG_JAVASCRIPT: return ckg_query_javascript;
+        case CKG_LANG_TYPESCRIPT: return ckg_query_typescript;
+        case CKG_LANG_PYTHON:     return ckg_query_python;
+        case CKG_LANG_GO:         return ckg_query_go;
+        default:                  return NULL;
+    }
+}
+
+static CaptureRole capture_role(const char* name, uint32_t length) {
+    static const struct {
+        const char* name;
+        CaptureRole role;
+    } roles[] = {
+        { "class.definition", CAPTURE_CLASS_DEFINITION },
+        { "class.name", CAPTURE_CLASS_NAME },
+        { "function.definition", CAPTURE_FUNCTION_DEFINITION },
+        { "function.name", CAPTURE_FUNCTION_NAME },
+        { "function.class", CAPTURE_FUNCTION_CLASS },
+        { "field.definition", CAPTURE_FIELD_DEFINITION },
+        { "field.name", CAPTURE_FIELD_NAME },
+    };
+
+    for (size_t i = 0; i < sizeof(roles) / sizeof(roles[0]); i++) {
+        if (strlen(roles[i].name) == length && memcmp(roles[i].name, name, length) == 0) {
+            return roles[i].role;
+        }
+    }
+    return CAPTURE_IGNORED;
+}
+
+// Compile every language's query. A language whose query does not compile
+// against the linked grammar keeps using the cursor walker.
+void ckg_queries_init(void) {
+    for (int language = 0; language < CKG_LANGUAGE_COUNT; language++) {
+        const char* source = query_source((CKGLanguage)language);
+        const TSLanguage* ts_language = ckg_ts_language((CKGLanguage)language);
+        if (!source || !ts_language || language_queries[language].query) {
+            continue;
+        }
+
+        uint32_t error_offset = 0;
+        TSQueryError error_type = TSQueryErrorNone;
+        TSQuery* query = ts_query_new(ts_language, source, (uint32_t)strlen(source), &error_offset, &error_type);
+        if (!query) {
+            fprintf(stderr, "ckg: extraction query for language %d failed to compile (error %d at offset %u)\n",
+                    language, (int)error_type, error_offset);
+            CKG_TRACE_ERROR(CKG_TRACE_QUERY_FAILED, language, error_offset);
+            continue;
+        }
+
+        uint32_t capture_count = ts_query_capture_count(query);
+        uint8_t* roles = (uint8_t*)calloc(capture_count ? capture_count : 1, sizeof(uint8_t));
+        if (!roles) {
+            ts_query_delete(query);
+            continue;
+        }
+        for (uint32_t i = 0; i < capture_count; i++) {
+            uint32_t length = 0;
+            const char* name = ts_query_capture_name_for_id(query, i, &length);
+            roles[i] = (uint8_t)capture_role(name, length);
+        }
+
+        language_queries[language].query = query;
+        language_queries[language].capture_roles = roles;
+    }
+}
+
+void ckg_queries_cleanup(void) {
+    for (int language = 0; language < CKG_LANGUAGE_COUNT; language++) {
+        if (language_queries[language].query) {
+            ts_query_delete(language_queries[language].query);
+        }
+        free(language_queries[language].capture_roles);
+        language_queries[language].query = NULL;
+        language_queries[language].capture_roles = NULL;
+    }
+}
+
+// Matches arrive almost in document order, so entries are kept sorted by
+// start byte (outer definitions first on ties) with an insertion step that
+// rarely moves anything. Returns the
+// slot for the new entry, or -1 if the definition was already recorded by
+// another pattern.
+static int insert_position_class(ParsedData* data, uint32_t start_byte, uint32_t end_byte) {
+    if (data->class_count >= data->class_capacity) {
+        int capacity = data->class_capacity == 0 ? 10 : data->class_capacity * 2;
+        ExtractedClass* classes = (ExtractedClass*)realloc(data->classes, capacity * sizeof(ExtractedClass));
+        if (!classes) {
+            return -1;
+        }
+        data->classes = classes;
+        data->class_capacity = capacity;
+    }
+
+    int position = data->class_count;
+    while (position > 0 && (data->classes[position - 1].start_byte > start_byte ||
+                            (data->classes[position - 1].start_byte == start_byte && data->classes[position - 1].end_byte < end_byte))) {
+        position--;
+    }
+    if (position > 0 && data->classes[position - 1].start_byte == start_byte &&
+        data->classes[position - 1].end_byte == end_byte) {
+        return -1;
+    }
+    memmove(&data->classes[position + 1], &data->classes[position],
+            (size_t)(data->class_count - position) * sizeof(ExtractedClass));
+    data->class_count++;
+    return position;
+}
+
+static int insert_position_function(ParsedData* data, uint32_t start_byte, uint32_t end_byte) {
+    if (data->function_count >= data->function_capacity) {
+        int capacity = data->function_capacity == 0 ? 10 : data->function_capacity * 2;
+        ExtractedFunction* functions = (ExtractedFunction*)realloc(data->functions, capacity * sizeof(ExtractedFunction));
+        if (!functions) {
+            return -1;
+        }
+        data->functions = functions;
+        data->function_capacity = capacity;
+    }
+
+    int position = data->function_count;
+    while (position > 0 && (data->functions[position - 1].start_byte > start_byte ||
+                            (data->functions[position - 1].start_byte == start_byte && data->functions[position - 1].end_byte < end_byte))) {
+        position--;
+    }
+    if (position > 0 && data->functions[position - 1].start_byte == start_byte &&
+        data->functions[position - 1].end_byte == end_byte) {
+        return -1;
+    }
+    memmove(&data->functions[position + 1], &data->functions[position],
+            (size_t)(data->function_count - position) * sizeof(ExtractedFunction));
+    data->function_count++;
+    return position;
+}
+
+// Give each function without an explicit owner the innermost class whose
+// definition encloses it. Both arrays are sorted by start byte and class
+// ranges nest, so one merge pass with a stack of open classes suffices.
+static void assign_enclosing_classes(ParsedData* data) {
+    int open_count = 0;
+    int next_class = 0;
+
+    for (int f = 0; f < data->function_count; f++) {
+        ExtractedFunction* function = &data->functions[f];
+
+        while (next_class < data->class_count && data->classes[next_class].start_byte <= function->start_byte) {
+            ExtractedClass* opening = &data->classes[next_class];
+            while (open_count > 0 && data->classes[data->open_classes[open_count - 1]].end_byte <= opening->start_byte) {
+                open_count--;
+            }
+            if (open_count >= data->open_class_capacity) {
+                int capacity = data->open_class_capacity == 0 ? 8 : data->open_class_capacity * 2;
+                int* open_classes = (int*)realloc(data->open_classes, capacity * sizeof(int));
+                if (!open_classes) {
+                    return;
+                }
+                data->open_classes = open_classes;
+                data->open_class_capacity = capacity;
+            }
+            data->open_classes[open_count++] = next_class++;
+        }
+
+        if (function->explicit_class) {
+            continue;
+        }
+        while (open_count > 0 && data->classes[data->open_classes[open_count - 1]].end_byte <= function->start_byte) {
+            open_count--;
+        }
+
+        function->class_name.offset = 0;
+        function->class_name.length = 0;
+        for (int i = open_count - 1; i >= 0; i--) {
+            const ExtractedClass* candidate = &data->classes[data->open_classes[i]];
+            if (candidate->end_byte >= function->end_byte) {
+                function->class_name = candidate->name;
+                break;
+            }
+        }
+    }
+}
+
+// The definition node, name node, explicit owner and kind captured by one
+// match. Returns false for matches missing a definition or name.
+typedef struct {
+    TSNode definition;
+    TSNode name;
+    TSNode owner;
+    CaptureRole kind;
+} MatchedSymbol;
+
+static bool read_match(const LanguageQuery* language_query, const TSQueryMatch* match, MatchedSymbol* symbol) {
+    memset(symbol, 0, sizeof(*symbol));
+    for (uint16_t i = 0; i < match->capture_count; i++) {
+        const TSQueryCapture* capture = &match->captures[i];
+        CaptureRole role = (CaptureRole)language_query->capture_roles[capture->index];
+        switch (role) {
+            case CAPTURE_CLASS_DEFINITION:
+            case CAPTURE_FUNCTION_DEFINITION:
+            case CAPTURE_FIELD_DEFINITION:
+                symbol->definition = capture->node;
+                symbol->kind = role;
+                break;
+            case CAPTURE_CLASS_NAME:
+            case CAPTURE_FUNCTION_NAME:
+            case CAPTURE_FIELD_NAME:
+                if (ts_node_is_null(symbol->name)) {
+                    symbol->name = capture->node;
+                }
+                break;
+            case CAPTURE_FUNCTION_CLASS:
+                if (ts_node_is_null(symbol->owner)) {
+                    symbol->owner = capture->node;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return !ts_node_is_null(symbol->definition) && !ts_node_is_null(symbol->name);
+}
+
+static bool query_progress(TSQueryCursorState* state) {
+    return ckg_should_stop((CKGContext*)state->payload);
+}
+
+// Start the language's query on `root` with the context's cursor, for
+// matches overlapping the given bytes. The parse's deadline and
+// cancellation also end the query; matches found until then are kept.
+static const LanguageQuery* exec_query(CKGContext* ctx, CKGLanguage language, TSNode root, uint32_t start_byte,
+                                       uint32_t end_byte) {
+    if (language < 0 || language >= CKG_LANGUAGE_COUNT || !language_queries[language].query) {
+        return NULL;
+    }
+    if (!ctx->query_cursor) {
+        ctx->query_cursor = ts_query_cursor_new();
+        if (!ctx->query_cursor) {
+            return NULL;
+        }
+    }
+
+    // Declarations-only extraction stops matching below the member level
+    ts_query_cursor_set_byte_range(ctx->query_cursor, start_byte, end_byte);
+    ts_query_cursor_set_max_start_depth(ctx->query_cursor, ctx->declarations_only ? CKG_DECLARATIONS_MAX_DEPTH : UINT32_MAX);
+    TSQueryCursorOptions options = { ctx, query_progress };
+    ts_query_cursor_exec_with_options(ctx->query_cursor, language_queries[language].query, root, &options);
+    return &language_queries[language];
+}
+
+// Record the definitions the running query matches, or with `ranges` only
+// those touching one of them
+static void collect_matches(CKGContext* ctx, const LanguageQuery* language_query, const CKGByteRange* ranges,
+                            uint32_t range_count, ParsedData* data) {
+    TSQueryMatch match;
+    MatchedSymbol symbol;
+    while (ts_query_cursor_next_match(ctx->query_cursor, &match)) {
+        data->match_count++;
+        // Fields are only reported to visitors
+        if (!read_match(language_query, &match, &symbol) || symbol.kind == CAPTURE_FIELD_DEFINITION) {
+            continue;
+        }
+
+        uint32_t start_byte = ts_node_start_byte(symbol.definition);
+        uint32_t end_byte = ts_node_end_byte(symbol.definition);
+        if (ranges && !ckg_ranges_touch(ranges, range_count, start_byte, end_byte)) {
+            continue;
+        }
+        int start_line = (int)ts_node_start_point(symbol.definition).row + 1;
+        int end_line = (int)ts_node_end_point(symbol.definition).row + 1;
+
+        if (symbol.kind == CAPTURE_CLASS_DEFINITION) {
+            int position = insert_position_class(data, start_byte, end_byte);
+            if (position < 0) {
+                continue;
+            }
+            ExtractedClass* extracted = &data->classes[position];
+            extracted->name = ckg_node_span(symbol.name);
+            extracted->start_line = start_line;
+            extracted->end_line = end_line;
+            extracted->start_byte = start_byte;
+            extracted->end_byte = end_byte;
+        } else {
+            int position = insert_position_function(data, start_byte, end_byte);
+            if (position < 0) {
+                continue;
+            }
+            ExtractedFunction* extracted = &data->functions[position];
+            extracted->name = ckg_node_span(symbol.name);
+            extracted->explicit_class = !ts_node_is_null(symbol.owner);
+            if (extracted->explicit_class) {
+                extracted->class_name = ckg_node_span(symbol.owner);
+            } else {
+                extracted->class_name.offset = 0;
+                extracted->class_name.length = 0;
+            }
+            extracted->start_line = start_line;
+            extracted->end_line = end_line;
+            extracted->start_byte = start_byte;
+            extracted->end_byte = end_byte;
+        }
+    }
+}
+
+bool ckg_query_extract(CKGContext* ctx, CKGLanguage language, TSNode root, const CKGByteRange* ranges,
+                       uint32_t range_count, ParsedData* data) {
+    if (!ranges) {
+        const LanguageQuery* language_query = exec_query(ctx, language, root, 0, UINT32_MAX);
+        if (!language_query) {
+            return false;
+        }
+        collect_matches(ctx, language_query, NULL, 0, data);
+        assign_enclosing_classes(data);
+        return true;
+    }
+
+    // Tree-sitter returns the matches overlapping the cursor's byte range,
+    // enclosing definitions included. Each range is widened by a byte on
+    // either side so that definitions merely touching it come back too, and
+    // collect_matches applies the exact test. A definition found for two
+    // ranges is recorded once.
+    if (language < 0 || language >= CKG_LANGUAGE_COUNT || !language_queries[language].query) {
+        return false;
+    }
+    for (uint32_t i = 0; i < range_count; i++) {
+        uint32_t start_byte = ranges[i].start_byte > 0 ? ranges[i].start_byte - 1 : 0;
+        uint32_t end_byte = ranges[i].end_byte < UINT32_MAX ? ranges[i].end_byte + 1 : UINT32_MAX;
+        const LanguageQuery* language_query = exec_query(ctx, language, root, start_byte, end_byte);
+        if (!language_query) {
+            break;
+        }
+        collect_matches(ctx, language_query, ranges, range_count, data);
+    }
+    assign_enclosing_classes(data);
+    return true;
+}
+
+// Visiting reports each match as it arrives. Matches come in document order
+// (a class before anything inside it), so the enclosing class of a symbol is
+// the innermost class still open on a stack of class end bytes.
+int ckg_query_visit(CKGContext* ctx, CKGLanguage language, TSNode root, ParsedData* data, const char* source_code,
+                    const CKGVisitor* visitor) {
+    const LanguageQuery* language_query = exec_query(ctx, language, root, 0, UINT32_MAX);
+    if (!language_query) {
+        return -1;
+    }
+
+    data->scope_count = 0;
+    uint32_t previous_start = UINT32_MAX;
+    uint32_t previous_end = UINT32_MAX;
+    CaptureRole previous_kind = CAPTURE_IGNORED;
+
+    TSQueryMatch match;
+    MatchedSymbol symbol;
+    while (ts_query_cursor_next_match(ctx->query_cursor, &match)) {
+        data->match_count++;
+        if (!read_match(language_query, &match, &symbol)) {
+            continue;
+        }
+
+        // Several patterns can match one definition; report it once
+        uint32_t start_byte = ts_node_start_byte(symbol.definition);
+        uint32_t end_byte = ts_node_end_byte(symbol.definition);
+        if (symbol.kind == previous_kind && start_byte == previous_start && end_byte == previous_end &&
+            symbol.kind != CAPTURE_FIELD_DEFINITION) {
+            continue;
+        }
+        previous_kind = symbol.kind;
+        previous_start = start_byte;
+        previous_end = end_byte;
+
+        while (data->scope_count > 0 && data->scopes[data->scope_count - 1].end_byte <= start_byte) {
+            data->scope_count--;
+        }
+        CKGSpan parent_class = { 0, 0 };
+        if (!ts_node_is_null(symbol.owner)) {
+            parent_class = ckg_node_span(symbol.owner);
+        } else if (data->scope_count > 0 && data->scopes[data->scope_count - 1].end_byte >= end_byte) {
+            parent_class = data->scopes[data->scope_count - 1].name;
+        }
+
+        bool keep_going = true;
+        switch (symbol.kind) {
+            case CAPTURE_CLASS_DEFINITION:
+                keep_going = ckg_visit(visitor->on_class, visitor, source_code, ckg_node_span(symbol.name),
+                                       parent_class, symbol.definition);
+                if (data->scope_count >= data->scope_capacity) {
+                    int capacity = data->scope_capacity == 0 ? 8 : data->scope_capacity * 2;
+                    ClassScope* scopes = (ClassScope*)realloc(data->scopes, capacity * sizeof(ClassScope));
+                    if (!scopes) {
+                        break;
+                    }
+                    data->scopes = scopes;
+                    data->scope_capacity = capacity;
+                }
+                data->scopes[data->scope_count].name = ckg_node_span(symbol.name);
+                data->scopes[data->scope_count].depth = 0;
+                data->scopes[data->scope_count].end_byte = end_byte;
+                data->scope_count++;
+                break;
+            case CAPTURE_FUNCTION_DEFINITION:
+                keep_going = ckg_visit(visitor->on_function, visitor, source_code, ckg_node_span(symbol.name),
+                                       parent_class, symbol.definition);
+                break;
+            case CAPTURE_FIELD_DEFINITION:
+                keep_going = ckg_visit(visitor->on_field, visitor, source_code, ckg_node_span(symbol.name),
+                                       parent_class, symbol.definition);
+                break;
+            default:
+                break;
+        }
+        if (!keep_going) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,130 @@
+#include <string.h>
+#include "ckg_internal.h"
+
+// Language registry: file extensions and language names resolve through
+// small hash tables whose seed ckg_registry_init picks so that no two keys
+// share a slot. A lookup is then one hash of a short key and one compare,
+// whatever the number of languages. Keys match case-insensitively.
+
+#define CKG_REGISTRY_SLOTS 64           // Power of two, well above the key count
+#define CKG_REGISTRY_KEY_MAX 15
+#define CKG_REGISTRY_MAX_SEEDS 65536
+
+typedef struct {
+    const char* key;
+    CKGLanguage language;
+} RegistryKey;
+
+typedef struct {
+    char key[CKG_REGISTRY_KEY_MAX + 1];     // Lowercase; empty = free slot
+    int8_t language;
+} RegistrySlot;
+
+typedef struct {
+    uint32_t seed;
+    RegistrySlot slots[CKG_REGISTRY_SLOTS];
+} RegistryTable;
+
+// Extensions without the dot
+static const RegistryKey extension_keys[] = {
+    { "c", CKG_LANG_C },            { "h", CKG_LANG_C },
+    { "cpp", CKG_LANG_CPP },        { "cc", CKG_LANG_CPP },
+    { "cxx", CKG_LANG_CPP },        { "hpp", CKG_LANG_CPP },
+    { "cs", CKG_LANG_CSHARP },      { "java", CKG_LANG_JAVA },
+    { "js", CKG_LANG_JAVASCRIPT },  { "jsx", CKG_LANG_JAVASCRIPT },
+    { "ts", CKG_LANG_TYPESCRIPT },  { "tsx", CKG_LANG_TYPESCRIPT },
+    { "py", CKG_LANG_PYTHON },      { "go", CKG_LANG_GO }
+};
+
+// Names the callers of ckg_parse_json pass, with common aliases
+static const RegistryKey name_keys[] = {
+    { "c", CKG_LANG_C },                    { "cpp", CKG_LANG_CPP },
+    { "c++", CKG_LANG_CPP },                { "csharp", CKG_LANG_CSHARP },
+    { "c#", CKG_LANG_CSHARP },              { "cs", CKG_LANG_CSHARP },
+    { "java", CKG_LANG_JAVA },              { "javascript", CKG_LANG_JAVASCRIPT },
+    { "js", CKG_LANG_JAVASCRIPT },          { "typescript", CKG_LANG_TYPESCRIPT },
+    { "ts", CKG_LANG_TYPESCRIPT },          { "python", CKG_LANG_PYTHON },
+    { "py", CKG_LANG_PYTHON },              { "go", CKG_LANG_GO },
+    { "golang", CKG_LANG_GO }
+};
+
+static RegistryTable extension_table;
+static RegistryTable name_table;
+static bool registry_ready = false;
+
+static inline char lower_ascii(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c + ('a' - 'A')) : c;
+}
+
+// FNV-1a over the lowercased key, perturbed by the seed
+static uint32_t hash_key(const char* key, size_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)lower_ascii(key[i])) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+static bool build_table(RegistryTable* table, const RegistryKey* keys, size_t count) {
+    for (uint32_t seed = 0; seed < CKG_REGISTRY_MAX_SEEDS; seed++) {
+        memset(table->slots, 0, sizeof(table->slots));
+        size_t placed = 0;
+        for (; placed < count; placed++) {
+            size_t length = strlen(keys[placed].key);
+            RegistrySlot* slot = &table->slots[hash_key(keys[placed].key, length, seed) & (CKG_REGISTRY_SLOTS - 1)];
+            if (slot->key[0] != '\0') {
+                break;
+            }
+            for (size_t i = 0; i < length; i++) {
+                slot->key[i] = lower_ascii(keys[placed].key[i]);
+            }
+            slot->language = (int8_t)keys[placed].language;
+        }
+        if (placed == count) {
+            table->seed = seed;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int lookup(const RegistryTable* table, const char* key, size_t length) {
+    if (!registry_ready || length == 0 || length > CKG_REGISTRY_KEY_MAX) {
+        return -1;
+    }
+    const RegistrySlot* slot = &table->slots[hash_key(key, length, table->seed) & (CKG_REGISTRY_SLOTS - 1)];
+    for (size_t i = 0; i < length; i++) {
+        if (slot->key[i] != lower_ascii(key[i])) {
+            return -1;
+        }
+    }
+    return slot->key[length] == '\0' ? slot->language : -1;
+}
+
+bool ckg_registry_init(void) {
+    if (!registry_ready) {
+        registry_ready = build_table(&extension_table, extension_keys, sizeof(extension_keys) / sizeof(extension_keys[0])) &&
+                         build_table(&name_table, name_keys, sizeof(name_keys) / sizeof(name_keys[0]));
+    }
+    return registry_ready;
+}
+
+int ckg_language_from_path(const char* file_path) {
+    if (!file_path) {
+        return -1;
+    }
+    // Scan back to the last dot of the file name, not of a directory
+    const char* end = file_path + strlen(file_path);
+    const char* p = end;
+    while (p > file_path && p[-1] != '.' && p[-1] != '/' && p[-1] != '\\') {
+        p--;
+    }
+    if (p == file_path || p[-1] != '.') {
+        return -1;
+    }
+    return lookup(&extension_table, p, (size_t)(end - p));
+}
+
+int ckg_language_from_name(const char* name) {
+    return name ? lookup(&name_table, name, strlen(name)) : -1;
+}
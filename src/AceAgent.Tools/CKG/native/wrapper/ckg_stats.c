@@ -0,0 +1,126 @@
+#define BUILDING_CKG_DLL
+#include <string.h>
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+
+// Contexts are single-threaded, so their counters are plain fields. The
+// process-wide totals are updated with atomics once per operation, which is
+// a handful of uncontended adds per file.
+
+// CKGStats is made only of uint64_t counters, so the totals can be read and
+// cleared as an array
+static CKGStats global_stats;
+
+static void atomic_max64(volatile uint64_t* value, uint64_t candidate) {
+    uint64_t current = ckg_atomic_load64(value);
+    while (candidate > current && !ckg_atomic_cas64(value, current, candidate)) {
+        current = ckg_atomic_load64(value);
+    }
+}
+
+static void add_counters(CKGStats* total, const CKGStats* delta) {
+    total->files_parsed += delta->files_parsed;
+    total->bytes_parsed += delta->bytes_parsed;
+    total->nodes_visited += delta->nodes_visited;
+    total->query_matches += delta->query_matches;
+    total->symbols_extracted += delta->symbols_extracted;
+    total->parse_ns += delta->parse_ns;
+    total->extract_ns += delta->extract_ns;
+    total->serialize_ns += delta->serialize_ns;
+    if (delta->arena_high_water > total->arena_high_water) {
+        total->arena_high_water = delta->arena_high_water;
+    }
+    total->errors += delta->errors;
+    for (int i = 0; i < CKG_STATS_MAX_LANGUAGES; i++) {
+        total->errors_by_language[i] += delta->errors_by_language[i];
+    }
+    total->timeouts += delta->timeouts;
+    total->cancellations += delta->cancellations;
+    total->files_skipped += delta->files_skipped;
+    total->cache_hits += delta->cache_hits;
+    total->cache_misses += delta->cache_misses;
+    total->cache_evictions += delta->cache_evictions;
+    total->disk_cache_hits += delta->disk_cache_hits;
+    total->disk_cache_misses += delta->disk_cache_misses;
+    total->disk_cache_evictions += delta->disk_cache_evictions;
+}
+
+void ckg_stats_add(CKGContext* ctx, const CKGStats* delta) {
+    add_counters(&ctx->stats, delta);
+
+    CKGStats* total = &global_stats;
+    ckg_atomic_add64(&total->files_parsed, delta->files_parsed);
+    ckg_atomic_add64(&total->bytes_parsed, delta->bytes_parsed);
+    ckg_atomic_add64(&total->nodes_visited, delta->nodes_visited);
+    ckg_atomic_add64(&total->query_matches, delta->query_matches);
+    ckg_atomic_add64(&total->symbols_extracted, delta->symbols_extracted);
+    ckg_atomic_add64(&total->parse_ns, delta->parse_ns);
+    ckg_atomic_add64(&total->extract_ns, delta->extract_ns);
+    ckg_atomic_add64(&total->serialize_ns, delta->serialize_ns);
+    atomic_max64(&total->arena_high_water, delta->arena_high_water);
+    if (delta->errors > 0) {
+        ckg_atomic_add64(&total->errors, delta->errors);
+        for (int i = 0; i < CKG_STATS_MAX_LANGUAGES; i++) {
+            if (delta->errors_by_language[i] > 0) {
+                ckg_atomic_add64(&total->errors_by_language[i], delta->errors_by_language[i]);
+            }
+        }
+    }
+    if (delta->timeouts > 0) {
+        ckg_atomic_add64(&total->timeouts, delta->timeouts);
+    }
+    if (delta->cancellations > 0) {
+        ckg_atomic_add64(&total->cancellations, delta->cancellations);
+    }
+    if (delta->files_skipped > 0) {
+        ckg_atomic_add64(&total->files_skipped, delta->files_skipped);
+    }
+    if (delta->cache_hits > 0) {
+        ckg_atomic_add64(&total->cache_hits, delta->cache_hits);
+    }
+    if (delta->cache_misses > 0) {
+        ckg_atomic_add64(&total->cache_misses, delta->cache_misses);
+    }
+    if (delta->cache_evictions > 0) {
+        ckg_atomic_add64(&total->cache_evictions, delta->cache_evictions);
+    }
+    if (delta->disk_cache_hits > 0) {
+        ckg_atomic_add64(&total->disk_cache_hits, delta->disk_cache_hits);
+    }
+    if (delta->disk_cache_misses > 0) {
+        ckg_atomic_add64(&total->disk_cache_misses, delta->disk_cache_misses);
+    }
+    if (delta->disk_cache_evictions > 0) {
+        ckg_atomic_add64(&total->disk_cache_evictions, delta->disk_cache_evictions);
+    }
+}
+
+CKG_API void ckg_get_stats(CKGStats* stats) {
+    if (!stats) {
+        return;
+    }
+    const uint64_t* source = (const uint64_t*)&global_stats;
+    uint64_t* target = (uint64_t*)stats;
+    for (size_t i = 0; i < sizeof(CKGStats) / sizeof(uint64_t); i++) {
+        target[i] = ckg_atomic_load64((volatile uint64_t*)&source[i]);
+    }
+}
+
+CKG_API void ckg_reset_stats(void) {
+    uint64_t* counters = (uint64_t*)&global_stats;
+    for (size_t i = 0; i < sizeof(CKGStats) / sizeof(uint64_t); i++) {
+        ckg_atomic_store64(&counters[i], 0);
+    }
+}
+
+CKG_API void ckg_context_get_stats(CKGContext* ctx, CKGStats* stats) {
+    if (ctx && stats) {
+        *stats = ctx->stats;
+    }
+}
+
+CKG_API void ckg_context_reset_stats(CKGContext* ctx) {
+    if (ctx) {
+        memset(&ctx->stats, 0, sizeof(ctx->stats));
+    }
+}
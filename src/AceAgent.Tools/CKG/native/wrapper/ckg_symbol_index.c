@@ -0,0 +1,1040 @@
+#define BUILDING_CKG_DLL
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_fs.h"
+#include "ckg_hash.h"
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+
+// Symbol index files (layout documented with CKG_INDEX_VERSION in
+// ckg_wrapper.h). The writer collects symbols with their strings interned
+// in one pool, sorts them once and writes every table in its final order;
+// the reader maps the file and answers lookups by binary search over the
+// mapped tables, reading only the pages a search touches. The name tries
+// are laid out and searched by ckg_symbol_search.c. Every field is
+// little-endian and read byte by byte, which compilers turn into plain
+// loads on little-endian hosts.
+
+typedef struct {
+    uint32_t name;                  // Pool offsets; 0 is the empty string
+    uint32_t name_length;
+    uint32_t parent_class;
+    uint32_t parent_class_length;
+    uint32_t file;                  // Index into the writer's files
+    uint32_t start_line;
+    uint32_t end_line;
+    uint8_t kind;
+    uint8_t language;
+} PendingSymbol;
+
+typedef struct {
+    uint32_t path;
+    uint32_t path_length;
+    uint32_t symbol_count;
+    uint32_t rank;                  // Position in path order once sorted
+} PendingFile;
+
+// A distinct name's hump key, while the hump table is sorted
+typedef struct {
+    uint32_t key;
+    uint32_t key_length;
+    uint32_t name;                  // Index into the distinct names
+    uint32_t name_length;
+} PendingHump;
+
+struct CKGIndexWriter {
+    char* pool;                     // NUL-terminated strings
+    uint64_t pool_length;
+    uint64_t pool_capacity;
+    uint32_t* string_slots;         // Open addressing over pool offsets + 1
+    uint32_t string_mask;
+    uint32_t string_count;
+    PendingSymbol* symbols;
+    uint32_t symbol_count;
+    uint32_t symbol_capacity;
+    PendingFile* files;
+    uint32_t file_count;
+    uint32_t file_capacity;
+    uint32_t* file_slots;           // Open addressing over file indices + 1, by path
+    uint32_t file_mask;
+    PendingHump* humps;             // Only while writing
+    bool failed;                    // Out of memory or past the format's limits
+};
+
+struct CKGIndex {
+    CKGMappedFile file;
+    const uint8_t* symbols;
+    const uint8_t* files;
+    const uint8_t* by_file;
+    const uint8_t* by_class;
+    const uint8_t* name_trie;
+    const uint8_t* hump_trie;
+    const uint8_t* humps;
+    CKGTrigramIndex name_trigrams;
+    const char* strings;
+    uint64_t string_size;
+    uint32_t symbol_count;
+    uint32_t file_count;
+    uint32_t class_member_count;
+    uint32_t name_node_count;
+    uint32_t hump_node_count;
+    uint32_t hump_count;
+};
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static inline uint8_t* put_u64(uint8_t* out, uint64_t value) {
+    put_u32(out, (uint32_t)value);
+    return put_u32(out + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t* in) {
+    return (uint64_t)get_u32(in) | ((uint64_t)get_u32(in + 4) << 32);
+}
+
+// Byte-wise order of two strings, the order every table is sorted in
+static inline int compare_bytes(const char* a, uint32_t a_length, const char* b, uint32_t b_length) {
+    int order = memcmp(a, b, a_length < b_length ? a_length : b_length);
+    if (order != 0) {
+        return order;
+    }
+    return a_length < b_length ? -1 : a_length > b_length ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+
+static bool grow_slots(uint32_t** slots, uint32_t* mask, uint32_t count) {
+    if (*slots && count * 2 < *mask + 1) {
+        return true;
+    }
+    uint32_t capacity = *slots ? (*mask + 1) * 2 : 1024;
+    if (capacity == 0) {
+        return false;
+    }
+    uint32_t* grown = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    if (!grown) {
+        return false;
+    }
+    free(*slots);
+    *slots = grown;
+    *mask = capacity - 1;
+    return true;
+}
+
+static void rehash_strings(CKGIndexWriter* writer) {
+    for (uint64_t offset = 1; offset < writer->pool_length;) {
+        size_t length = strlen(writer->pool + offset);
+        uint32_t slot = (uint32_t)ckg_hash64(writer->pool + offset, length, 0) & writer->string_mask;
+        while (writer->string_slots[slot]) {
+            slot = (slot + 1) & writer->string_mask;
+        }
+        writer->string_slots[slot] = (uint32_t)offset + 1;
+        offset += length + 1;
+    }
+}
+
+// Pool offset of `text`, adding it the first time; 0 (the empty string) on
+// failure, which also marks the writer failed
+static uint32_t intern(CKGIndexWriter* writer, const char* text, uint32_t* length_out) {
+    size_t length = text ? strlen(text) : 0;
+    *length_out = (uint32_t)length;
+    if (length == 0 || writer->failed) {
+        *length_out = 0;
+        return 0;
+    }
+    if (!writer->string_slots || writer->string_count * 2 >= writer->string_mask + 1) {
+        if (!grow_slots(&writer->string_slots, &writer->string_mask, writer->string_count + 1)) {
+            writer->failed = true;
+            return 0;
+        }
+        rehash_strings(writer);
+    }
+    uint64_t hash = ckg_hash64(text, length, 0);
+    uint32_t slot = (uint32_t)hash & writer->string_mask;
+    for (; writer->string_slots[slot]; slot = (slot + 1) & writer->string_mask) {
+        uint32_t offset = writer->string_slots[slot] - 1;
+        if (memcmp(writer->pool + offset, text, length + 1) == 0) {
+            return offset;
+        }
+    }
+
+    // Offsets are 32-bit in the file
+    if (writer->pool_length + length + 1 > UINT32_MAX || length >= UINT32_MAX) {
+        writer->failed = true;
+        return 0;
+    }
+    if (writer->pool_length + length + 1 > writer->pool_capacity) {
+        uint64_t capacity = writer->pool_capacity * 2;
+        while (capacity < writer->pool_length + length + 1) {
+            capacity *= 2;
+        }
+        char* pool = (char*)realloc(writer->pool, (size_t)capacity);
+        if (!pool) {
+            writer->failed = true;
+            return 0;
+        }
+        writer->pool = pool;
+        writer->pool_capacity = capacity;
+    }
+    uint32_t offset = (uint32_t)writer->pool_length;
+    memcpy(writer->pool + offset, text, length + 1);
+    writer->pool_length += length + 1;
+    writer->string_slots[slot] = offset + 1;
+    writer->string_count++;
+    return offset;
+}
+
+// Index of the file at pool offset `path`, adding it the first time
+static bool find_file(CKGIndexWriter* writer, uint32_t path, uint32_t path_length, uint32_t* file_out) {
+    if (!writer->file_slots || writer->file_count * 2 >= writer->file_mask + 1) {
+        if (!grow_slots(&writer->file_slots, &writer->file_mask, writer->file_count + 1)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < writer->file_count; i++) {
+            uint32_t slot = (uint32_t)ckg_hash64(&writer->files[i].path, sizeof(uint32_t), 0) & writer->file_mask;
+            while (writer->file_slots[slot]) {
+                slot = (slot + 1) & writer->file_mask;
+            }
+            writer->file_slots[slot] = i + 1;
+        }
+    }
+    // Paths are interned, so equal paths have equal offsets
+    uint32_t slot = (uint32_t)ckg_hash64(&path, sizeof(uint32_t), 0) & writer->file_mask;
+    for (; writer->file_slots[slot]; slot = (slot + 1) & writer->file_mask) {
+        uint32_t file = writer->file_slots[slot] - 1;
+        if (writer->files[file].path == path) {
+            *file_out = file;
+            return true;
+        }
+    }
+    if (writer->file_count == writer->file_capacity) {
+        uint32_t capacity = writer->file_capacity ? writer->file_capacity * 2 : 256;
+        PendingFile* files = (PendingFile*)realloc(writer->files, capacity * sizeof(PendingFile));
+        if (!files) {
+            return false;
+        }
+        writer->files = files;
+        writer->file_capacity = capacity;
+    }
+    PendingFile* file = &writer->files[writer->file_count];
+    file->path = path;
+    file->path_length = path_length;
+    file->symbol_count = 0;
+    file->rank = 0;
+    writer->file_slots[slot] = writer->file_count + 1;
+    *file_out = writer->file_count++;
+    return true;
+}
+
+CKG_API CKGIndexWriter* ckg_index_writer_create(void) {
+    CKGIndexWriter* writer = (CKGIndexWriter*)calloc(1, sizeof(CKGIndexWriter));
+    if (!writer) {
+        return NULL;
+    }
+    writer->pool_capacity = 64 * 1024;
+    writer->pool = (char*)malloc((size_t)writer->pool_capacity);
+    if (!writer->pool) {
+        free(writer);
+        return NULL;
+    }
+    writer->pool[0] = '\0';
+    writer->pool_length = 1;
+    return writer;
+}
+
+CKG_API void ckg_index_writer_destroy(CKGIndexWriter* writer) {
+    if (!writer) {
+        return;
+    }
+    free(writer->pool);
+    free(writer->string_slots);
+    free(writer->symbols);
+    free(writer->files);
+    free(writer->file_slots);
+    free(writer);
+}
+
+CKG_API bool ckg_index_writer_add(CKGIndexWriter* writer, const char* file_path, CKGLanguage language, CKGSymbolKind kind,
+                                  const char* name, const char* parent_class, uint32_t start_line, uint32_t end_line) {
+    if (!writer || !file_path || !file_path[0] || !name || !name[0] || writer->failed) {
+        return false;
+    }
+    PendingSymbol symbol;
+    uint32_t path_length;
+    uint32_t path = intern(writer, file_path, &path_length);
+    symbol.name = intern(writer, name, &symbol.name_length);
+    symbol.parent_class = intern(writer, parent_class, &symbol.parent_class_length);
+    if (writer->failed || !find_file(writer, path, path_length, &symbol.file) || writer->symbol_count == UINT32_MAX) {
+        writer->failed = true;
+        return false;
+    }
+    symbol.start_line = start_line;
+    symbol.end_line = end_line;
+    symbol.kind = (uint8_t)kind;
+    symbol.language = (uint8_t)language;
+
+    if (writer->symbol_count == writer->symbol_capacity) {
+        uint32_t capacity = writer->symbol_capacity ? writer->symbol_capacity * 2 : 1024;
+        PendingSymbol* symbols = (PendingSymbol*)realloc(writer->symbols, (size_t)capacity * sizeof(PendingSymbol));
+        if (!symbols) {
+            writer->failed = true;
+            return false;
+        }
+        writer->symbols = symbols;
+        writer->symbol_capacity = capacity;
+    }
+    writer->symbols[writer->symbol_count++] = symbol;
+    writer->files[symbol.file].symbol_count++;
+    return true;
+}
+
+CKG_API bool ckg_index_writer_add_result(CKGIndexWriter* writer, const char* file_path, CKGLanguage language,
+                                         const CKGParseResult* result) {
+    if (!writer || !result) {
+        return false;
+    }
+    bool added = true;
+    for (uint32_t i = 0; i < result->class_count; i++) {
+        const CKGClass* class_info = &result->classes[i];
+        added &= ckg_index_writer_add(writer, file_path, language, CKG_SYMBOL_CLASS, class_info->name, NULL,
+                                      class_info->start_line, class_info->end_line);
+    }
+    for (uint32_t i = 0; i < result->function_count; i++) {
+        const CKGFunction* function = &result->functions[i];
+        added &= ckg_index_writer_add(writer, file_path, language, CKG_SYMBOL_FUNCTION, function->name,
+                                      function->parent_class, function->start_line, function->end_line);
+    }
+    for (uint32_t i = 0; i < result->property_count; i++) {
+        const CKGProperty* property = &result->properties[i];
+        added &= ckg_index_writer_add(writer, file_path, language, CKG_SYMBOL_PROPERTY, property->name,
+                                      property->parent_class, property->start_line, property->end_line);
+    }
+    for (uint32_t i = 0; i < result->field_count; i++) {
+        const CKGField* field = &result->fields[i];
+        added &= ckg_index_writer_add(writer, file_path, language, CKG_SYMBOL_FIELD, field->name, field->parent_class,
+                                      field->start_line, field->end_line);
+    }
+    return added && !writer->failed;
+}
+
+CKG_API bool ckg_index_writer_add_file(CKGIndexWriter* writer, const CKGIndex* index, const char* file_path) {
+    if (!writer || !index || !file_path) {
+        return false;
+    }
+    uint32_t first = 0;
+    uint32_t count = ckg_index_find(index, CKG_INDEX_BY_FILE, file_path, &first);
+    bool added = true;
+    for (uint32_t i = first; i < first + count; i++) {
+        CKGIndexSymbol symbol;
+        if (ckg_index_get(index, CKG_INDEX_BY_FILE, i, &symbol)) {
+            added &= ckg_index_writer_add(writer, file_path, (CKGLanguage)symbol.language, (CKGSymbolKind)symbol.kind,
+                                          symbol.name, symbol.parent_class, symbol.start_line, symbol.end_line);
+        }
+    }
+    return added && !writer->failed;
+}
+
+// Stable merge sort of `ids` by `compare`, which qsort cannot do with context
+typedef int (*CompareIds)(const CKGIndexWriter* writer, uint32_t a, uint32_t b);
+
+static bool sort_ids(const CKGIndexWriter* writer, uint32_t* ids, uint32_t count, CompareIds compare) {
+    uint32_t* buffer = (uint32_t*)malloc((size_t)(count ? count : 1) * sizeof(uint32_t));
+    if (!buffer) {
+        return false;
+    }
+    uint32_t* from = ids;
+    uint32_t* to = buffer;
+    for (uint64_t width = 1; width < count; width *= 2) {
+        for (uint64_t start = 0; start < count; start += 2 * width) {
+            uint64_t middle = start + width < count ? start + width : count;
+            uint64_t end = start + 2 * width < count ? start + 2 * width : count;
+            uint64_t left = start;
+            uint64_t right = middle;
+            for (uint64_t out = start; out < end; out++) {
+                if (left < middle && (right >= end || compare(writer, from[left], from[right]) <= 0)) {
+                    to[out] = from[left++];
+                } else {
+                    to[out] = from[right++];
+                }
+            }
+        }
+        uint32_t* swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != ids) {
+        memcpy(ids, from, (size_t)count * sizeof(uint32_t));
+    }
+    free(buffer);
+    return true;
+}
+
+static int compare_paths(const CKGIndexWriter* writer, uint32_t a, uint32_t b) {
+    const PendingFile* left = &writer->files[a];
+    const PendingFile* right = &writer->files[b];
+    return compare_bytes(writer->pool + left->path, left->path_length, writer->pool + right->path, right->path_length);
+}
+
+// Name, then class, then file path order, then line
+static int compare_names(const CKGIndexWriter* writer, uint32_t a, uint32_t b) {
+    const PendingSymbol* left = &writer->symbols[a];
+    const PendingSymbol* right = &writer->symbols[b];
+    int order = compare_bytes(writer->pool + left->name, left->name_length, writer->pool + right->name,
+                              right->name_length);
+    if (order == 0) {
+        order = compare_bytes(writer->pool + left->parent_class, left->parent_class_length,
+                              writer->pool + right->parent_class, right->parent_class_length);
+    }
+    if (order == 0) {
+        uint32_t left_rank = writer->files[left->file].rank;
+        uint32_t right_rank = writer->files[right->file].rank;
+        order = left_rank < right_rank ? -1 : left_rank > right_rank ? 1 : 0;
+    }
+    if (order == 0) {
+        order = left->start_line < right->start_line ? -1 : left->start_line > right->start_line ? 1 : 0;
+    }
+    return order;
+}
+
+// Applied to positions in name order, so ties keep that order
+static int compare_lines(const CKGIndexWriter* writer, uint32_t a, uint32_t b) {
+    const PendingSymbol* left = &writer->symbols[a];
+    const PendingSymbol* right = &writer->symbols[b];
+    return left->start_line < right->start_line ? -1 : left->start_line > right->start_line ? 1 : 0;
+}
+
+static int compare_classes(const CKGIndexWriter* writer, uint32_t a, uint32_t b) {
+    const PendingSymbol* left = &writer->symbols[a];
+    const PendingSymbol* right = &writer->symbols[b];
+    return compare_bytes(writer->pool + left->parent_class, left->parent_class_length,
+                         writer->pool + right->parent_class, right->parent_class_length);
+}
+
+// Hump key, then name length, then name
+static int compare_humps(const CKGIndexWriter* writer, uint32_t a, uint32_t b) {
+    const PendingHump* left = &writer->humps[a];
+    const PendingHump* right = &writer->humps[b];
+    int order = compare_bytes(writer->pool + left->key, left->key_length, writer->pool + right->key,
+                              right->key_length);
+    if (order == 0) {
+        order = left->name_length < right->name_length ? -1 : left->name_length > right->name_length ? 1 : 0;
+    }
+    if (order == 0) {
+        order = left->name < right->name ? -1 : left->name > right->name ? 1 : 0;
+    }
+    return order;
+}
+
+// Tries over the distinct names (in `order`, the symbol table's order) and
+// their hump keys, the hump table and the names' trigram lists. Hump keys
+// are added to the pool.
+typedef struct {
+    uint8_t* name_trie;
+    uint32_t name_node_count;
+    uint8_t* hump_trie;
+    uint32_t hump_node_count;
+    uint32_t* humps;                // Pairs of first row and symbol count
+    uint32_t hump_count;
+    CKGTrigramPostings trigrams;
+} NameTries;
+
+// Distinct names as trigram documents
+typedef struct {
+    const char* pool;
+    const CKGTrieKey* names;
+    CKGTrigramSet set;
+} NameTrigrams;
+
+static bool name_trigrams(void* user_data, uint32_t document, const uint32_t** trigrams_out, uint32_t* count_out) {
+    NameTrigrams* source = (NameTrigrams*)user_data;
+    const CKGTrieKey* name = &source->names[document];
+    if (!ckg_trigram_extract(&source->set, source->pool + name->offset, name->length)) {
+        return false;
+    }
+    *trigrams_out = source->set.trigrams;
+    *count_out = source->set.count;
+    return true;
+}
+
+static bool build_tries(CKGIndexWriter* writer, const uint32_t* order, NameTries* tries) {
+    uint32_t symbol_count = writer->symbol_count;
+    CKGTrieKey* names = (CKGTrieKey*)malloc((size_t)(symbol_count ? symbol_count : 1) * sizeof(CKGTrieKey));
+    if (!names) {
+        return false;
+    }
+    // Names are interned, so a name's rows are one run of equal offsets
+    uint32_t name_count = 0;
+    for (uint32_t i = 0; i < symbol_count; i++) {
+        const PendingSymbol* symbol = &writer->symbols[order[i]];
+        if (name_count > 0 && names[name_count - 1].offset == symbol->name) {
+            names[name_count - 1].value_count++;
+        } else {
+            names[name_count++] = (CKGTrieKey){symbol->name, symbol->name_length, i, 1};
+        }
+    }
+
+    writer->humps = (PendingHump*)malloc((size_t)(name_count ? name_count : 1) * sizeof(PendingHump));
+    uint32_t* hump_order = (uint32_t*)malloc((size_t)(name_count ? name_count : 1) * sizeof(uint32_t));
+    CKGTrieKey* keys = (CKGTrieKey*)malloc((size_t)(name_count ? name_count : 1) * sizeof(CKGTrieKey));
+    bool ok = writer->humps && hump_order && keys;
+    uint32_t hump_count = 0;
+    for (uint32_t i = 0; ok && i < name_count; i++) {
+        char key[256];
+        uint32_t key_length = ckg_hump_key(writer->pool + names[i].offset, names[i].length, key, sizeof(key) - 1);
+        key[key_length] = '\0';
+        uint32_t offset = intern(writer, key, &key_length);
+        if (key_length > 0) {
+            writer->humps[hump_count] = (PendingHump){offset, key_length, i, names[i].length};
+            hump_order[hump_count] = hump_count;
+            hump_count++;
+        }
+        ok = !writer->failed;
+    }
+    ok = ok && sort_ids(writer, hump_order, hump_count, compare_humps);
+
+    // Keys are interned too, so each key's entries are one run
+    uint32_t key_count = 0;
+    if (ok) {
+        tries->humps = (uint32_t*)malloc((size_t)(hump_count ? hump_count : 1) * 2 * sizeof(uint32_t));
+        ok = tries->humps != NULL;
+    }
+    for (uint32_t i = 0; ok && i < hump_count; i++) {
+        const PendingHump* hump = &writer->humps[hump_order[i]];
+        tries->humps[2 * i] = names[hump->name].value_first;
+        tries->humps[2 * i + 1] = names[hump->name].value_count;
+        if (key_count > 0 && keys[key_count - 1].offset == hump->key) {
+            keys[key_count - 1].value_count++;
+        } else {
+            keys[key_count++] = (CKGTrieKey){hump->key, hump->key_length, i, 1};
+        }
+    }
+    tries->hump_count = hump_count;
+    if (ok) {
+        tries->name_trie = ckg_trie_build(writer->pool, names, name_count, &tries->name_node_count);
+        tries->hump_trie = ckg_trie_build(writer->pool, keys, key_count, &tries->hump_node_count);
+        ok = tries->name_trie && tries->hump_trie;
+    }
+
+    // Names are listed by their first row, which rises with the name
+    uint32_t* firsts = ok ? (uint32_t*)malloc((size_t)(name_count ? name_count : 1) * sizeof(uint32_t)) : NULL;
+    ok = ok && firsts;
+    if (ok) {
+        NameTrigrams source = {writer->pool, names, {0}};
+        for (uint32_t i = 0; i < name_count; i++) {
+            firsts[i] = names[i].value_first;
+        }
+        ok = ckg_trigram_build(name_count, firsts, name_trigrams, &source, &tries->trigrams);
+        ckg_trigram_set_free(&source.set);
+    }
+
+    free(firsts);
+    free(keys);
+    free(hump_order);
+    free(writer->humps);
+    writer->humps = NULL;
+    free(names);
+    return ok;
+}
+
+// Buffered little-endian output
+typedef struct {
+    FILE* file;
+    uint8_t buffer[64 * 1024];
+    size_t length;
+    uint64_t written;
+    bool failed;
+} Output;
+
+static void output_flush(Output* output) {
+    if (output->length > 0 && fwrite(output->buffer, 1, output->length, output->file) != output->length) {
+        output->failed = true;
+    }
+    output->written += output->length;
+    output->length = 0;
+}
+
+static inline uint8_t* output_reserve(Output* output, size_t size) {
+    if (output->length + size > sizeof(output->buffer)) {
+        output_flush(output);
+    }
+    uint8_t* out = output->buffer + output->length;
+    output->length += size;
+    return out;
+}
+
+static void output_u32(Output* output, uint32_t value) {
+    put_u32(output_reserve(output, 4), value);
+}
+
+static void output_bytes(Output* output, const void* bytes, uint64_t size) {
+    output_flush(output);
+    if (size > 0 && fwrite(bytes, 1, (size_t)size, output->file) != size) {
+        output->failed = true;
+    }
+    output->written += size;
+}
+
+static void output_align(Output* output) {
+    while ((output->written + output->length) % 8 != 0) {
+        *output_reserve(output, 1) = 0;
+    }
+}
+
+static uint64_t output_offset(const Output* output) {
+    return output->written + output->length;
+}
+
+static bool write_tables(CKGIndexWriter* writer, FILE* file) {
+    uint32_t symbol_count = writer->symbol_count;
+    uint32_t file_count = writer->file_count;
+    uint32_t* file_order = (uint32_t*)malloc((size_t)(file_count ? file_count : 1) * sizeof(uint32_t));
+    uint32_t* order = (uint32_t*)malloc((size_t)(symbol_count ? symbol_count : 1) * sizeof(uint32_t));
+    uint32_t* position = (uint32_t*)malloc((size_t)(symbol_count ? symbol_count : 1) * sizeof(uint32_t));
+    uint32_t* by_file = (uint32_t*)malloc((size_t)(symbol_count ? symbol_count : 1) * sizeof(uint32_t));
+    uint32_t* first_of_file = (uint32_t*)calloc(file_count ? file_count : 1, sizeof(uint32_t));
+    Output* output = (Output*)malloc(sizeof(Output));
+    bool ok = file_order && order && position && by_file && first_of_file && output;
+
+    // Files by path; symbols refer to them by rank
+    for (uint32_t i = 0; ok && i < file_count; i++) {
+        file_order[i] = i;
+    }
+    ok = ok && sort_ids(writer, file_order, file_count, compare_paths);
+    for (uint32_t i = 0; ok && i < file_count; i++) {
+        writer->files[file_order[i]].rank = i;
+    }
+
+    // The symbol table in name order; `position` maps a pending symbol to
+    // its row in it
+    for (uint32_t i = 0; ok && i < symbol_count; i++) {
+        order[i] = i;
+    }
+    ok = ok && sort_ids(writer, order, symbol_count, compare_names);
+    for (uint32_t i = 0; ok && i < symbol_count; i++) {
+        position[order[i]] = i;
+    }
+
+    // Per-file ranges of rows by line: bucket by file rank, then sort each
+    // bucket by line
+    uint32_t class_member_count = 0;
+    if (ok) {
+        uint32_t start = 0;
+        for (uint32_t rank = 0; rank < file_count; rank++) {
+            first_of_file[rank] = start;
+            start += writer->files[file_order[rank]].symbol_count;
+        }
+        uint32_t* fill = (uint32_t*)malloc((size_t)(file_count ? file_count : 1) * sizeof(uint32_t));
+        ok = fill != NULL;
+        if (ok) {
+            memcpy(fill, first_of_file, (size_t)file_count * sizeof(uint32_t));
+            for (uint32_t i = 0; i < symbol_count; i++) {
+                const PendingSymbol* symbol = &writer->symbols[order[i]];
+                by_file[fill[writer->files[symbol->file].rank]++] = order[i];
+                if (symbol->parent_class_length > 0) {
+                    class_member_count++;
+                }
+            }
+            free(fill);
+        }
+        for (uint32_t rank = 0; ok && rank < file_count; rank++) {
+            uint32_t count = writer->files[file_order[rank]].symbol_count;
+            ok = sort_ids(writer, by_file + first_of_file[rank], count, compare_lines);
+        }
+    }
+
+    // Class members, in name order within each class
+    uint32_t* by_class = ok ? (uint32_t*)malloc((size_t)(class_member_count ? class_member_count : 1) * sizeof(uint32_t)) : NULL;
+    ok = ok && by_class;
+    if (ok) {
+        uint32_t member = 0;
+        for (uint32_t i = 0; i < symbol_count; i++) {
+            if (writer->symbols[order[i]].parent_class_length > 0) {
+                by_class[member++] = order[i];
+            }
+        }
+        ok = sort_ids(writer, by_class, class_member_count, compare_classes);
+    }
+
+    NameTries tries = {0};
+    ok = ok && build_tries(writer, order, &tries);
+
+    if (ok) {
+        output->file = file;
+        output->length = 0;
+        output->written = 0;
+        output->failed = false;
+
+        uint64_t symbols_offset = CKG_INDEX_HEADER_SIZE;
+        uint64_t files_offset = symbols_offset + (uint64_t)symbol_count * CKG_INDEX_SYMBOL_RECORD_SIZE;
+        uint64_t by_file_offset = files_offset + (uint64_t)file_count * CKG_INDEX_FILE_RECORD_SIZE;
+        uint64_t by_class_offset = by_file_offset + (uint64_t)symbol_count * 4;
+        uint64_t name_trie_offset = (by_class_offset + (uint64_t)class_member_count * 4 + 7) & ~(uint64_t)7;
+        uint64_t hump_trie_offset = name_trie_offset + (uint64_t)tries.name_node_count * CKG_INDEX_TRIE_NODE_SIZE;
+        uint64_t humps_offset = hump_trie_offset + (uint64_t)tries.hump_node_count * CKG_INDEX_TRIE_NODE_SIZE;
+        uint64_t name_trigrams_offset = humps_offset + (uint64_t)tries.hump_count * CKG_INDEX_HUMP_RECORD_SIZE;
+        uint64_t name_postings_offset = name_trigrams_offset + (uint64_t)tries.trigrams.trigram_count * CKG_TRIGRAM_RECORD_SIZE;
+        uint64_t strings_offset = name_postings_offset + tries.trigrams.postings_size;
+
+        uint8_t* header = output_reserve(output, CKG_INDEX_HEADER_SIZE);
+        memset(header, 0, CKG_INDEX_HEADER_SIZE);
+        memcpy(header, CKG_INDEX_MAGIC, 4);
+        put_u32(header + 4, CKG_INDEX_VERSION);
+        put_u32(header + 8, symbol_count);
+        put_u32(header + 12, file_count);
+        put_u32(header + 16, class_member_count);
+        put_u64(header + 24, writer->pool_length);
+        put_u64(header + 32, symbols_offset);
+        put_u64(header + 40, files_offset);
+        put_u64(header + 48, by_file_offset);
+        put_u64(header + 56, by_class_offset);
+        put_u64(header + 64, strings_offset);
+        put_u32(header + 72, tries.name_node_count);
+        put_u32(header + 76, tries.hump_node_count);
+        put_u32(header + 80, tries.hump_count);
+        put_u64(header + 88, name_trie_offset);
+        put_u64(header + 96, hump_trie_offset);
+        put_u64(header + 104, humps_offset);
+        put_u32(header + 112, tries.trigrams.trigram_count);
+        put_u64(header + 120, name_trigrams_offset);
+        put_u64(header + 128, name_postings_offset);
+        put_u64(header + 136, tries.trigrams.postings_size);
+
+        for (uint32_t i = 0; i < symbol_count; i++) {
+            const PendingSymbol* symbol = &writer->symbols[order[i]];
+            uint8_t* out = output_reserve(output, CKG_INDEX_SYMBOL_RECORD_SIZE);
+            out = put_u32(out, symbol->name);
+            out = put_u32(out, symbol->name_length);
+            out = put_u32(out, symbol->parent_class);
+            out = put_u32(out, symbol->parent_class_length);
+            out = put_u32(out, writer->files[symbol->file].rank);
+            out = put_u32(out, symbol->start_line);
+            out = put_u32(out, symbol->end_line);
+            out[0] = symbol->kind;
+            out[1] = symbol->language;
+            out[2] = 0;
+            out[3] = 0;
+        }
+        for (uint32_t rank = 0; rank < file_count; rank++) {
+            const PendingFile* pending = &writer->files[file_order[rank]];
+            uint8_t* out = output_reserve(output, CKG_INDEX_FILE_RECORD_SIZE);
+            out = put_u32(out, pending->path);
+            out = put_u32(out, pending->path_length);
+            out = put_u32(out, first_of_file[rank]);
+            put_u32(out, pending->symbol_count);
+        }
+        for (uint32_t i = 0; i < symbol_count; i++) {
+            output_u32(output, position[by_file[i]]);
+        }
+        for (uint32_t i = 0; i < class_member_count; i++) {
+            output_u32(output, position[by_class[i]]);
+        }
+        output_align(output);
+        ok = output_offset(output) == name_trie_offset;
+        output_bytes(output, tries.name_trie, (uint64_t)tries.name_node_count * CKG_INDEX_TRIE_NODE_SIZE);
+        output_bytes(output, tries.hump_trie, (uint64_t)tries.hump_node_count * CKG_INDEX_TRIE_NODE_SIZE);
+        for (uint32_t i = 0; i < 2 * tries.hump_count; i++) {
+            output_u32(output, tries.humps[i]);
+        }
+        output_bytes(output, tries.trigrams.table, (uint64_t)tries.trigrams.trigram_count * CKG_TRIGRAM_RECORD_SIZE);
+        output_bytes(output, tries.trigrams.postings, tries.trigrams.postings_size);
+        ok = ok && output_offset(output) == strings_offset;
+        output_bytes(output, writer->pool, writer->pool_length);
+        output_flush(output);
+        ok = ok && !output->failed;
+    }
+
+    free(tries.name_trie);
+    free(tries.hump_trie);
+    free(tries.humps);
+    free(tries.trigrams.table);
+    free(tries.trigrams.postings);
+    free(by_class);
+    free(output);
+    free(first_of_file);
+    free(by_file);
+    free(position);
+    free(order);
+    free(file_order);
+    return ok;
+}
+
+CKG_API int ckg_index_writer_write(CKGIndexWriter* writer, const char* path) {
+    if (!writer || !path || writer->failed) {
+        return -1;
+    }
+    // Written next to the target and renamed over it, so readers that have
+    // the old index mapped keep a consistent file
+    size_t length = strlen(path);
+    char* temporary = (char*)malloc(length + 32);
+    if (!temporary) {
+        return -1;
+    }
+    snprintf(temporary, length + 32, "%s.%016llx.tmp", path, (unsigned long long)ckg_now_ns());
+    FILE* file = ckg_open_file(temporary, "wb");
+    if (!file) {
+        free(temporary);
+        return -1;
+    }
+    bool written = write_tables(writer, file);
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    if (!written || !ckg_replace_file(temporary, path)) {
+        ckg_remove_file(temporary);
+        free(temporary);
+        return -1;
+    }
+    free(temporary);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+
+CKG_API CKGIndex* ckg_index_open(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+    CKGIndex* index = (CKGIndex*)calloc(1, sizeof(CKGIndex));
+    if (!index) {
+        return NULL;
+    }
+    if (!ckg_map_file(path, &index->file)) {
+        free(index);
+        return NULL;
+    }
+
+    // Only the header is checked here; records are checked as they are read,
+    // so opening costs the same for any size of index
+    const uint8_t* data = (const uint8_t*)index->file.data;
+    uint64_t size = index->file.length;
+    bool valid = size >= CKG_INDEX_HEADER_SIZE && memcmp(data, CKG_INDEX_MAGIC, 4) == 0 &&
+                 get_u32(data + 4) == CKG_INDEX_VERSION;
+    if (valid) {
+        index->symbol_count = get_u32(data + 8);
+        index->file_count = get_u32(data + 12);
+        index->class_member_count = get_u32(data + 16);
+        index->string_size = get_u64(data + 24);
+        uint64_t symbols = get_u64(data + 32);
+        uint64_t files = get_u64(data + 40);
+        uint64_t by_file = get_u64(data + 48);
+        uint64_t by_class = get_u64(data + 56);
+        uint64_t strings = get_u64(data + 64);
+        index->name_node_count = get_u32(data + 72);
+        index->hump_node_count = get_u32(data + 76);
+        index->hump_count = get_u32(data + 80);
+        uint64_t name_trie = get_u64(data + 88);
+        uint64_t hump_trie = get_u64(data + 96);
+        uint64_t humps = get_u64(data + 104);
+        index->name_trigrams.trigram_count = get_u32(data + 112);
+        uint64_t name_trigrams = get_u64(data + 120);
+        uint64_t name_postings = get_u64(data + 128);
+        index->name_trigrams.postings_size = get_u64(data + 136);
+        valid = symbols >= CKG_INDEX_HEADER_SIZE && symbols <= size &&
+                (size - symbols) / CKG_INDEX_SYMBOL_RECORD_SIZE >= index->symbol_count &&
+                files <= size && (size - files) / CKG_INDEX_FILE_RECORD_SIZE >= index->file_count &&
+                by_file <= size && (size - by_file) / 4 >= index->symbol_count &&
+                by_class <= size && (size - by_class) / 4 >= index->class_member_count &&
+                name_trie <= size && (size - name_trie) / CKG_INDEX_TRIE_NODE_SIZE >= index->name_node_count &&
+                hump_trie <= size && (size - hump_trie) / CKG_INDEX_TRIE_NODE_SIZE >= index->hump_node_count &&
+                humps <= size && (size - humps) / CKG_INDEX_HUMP_RECORD_SIZE >= index->hump_count &&
+                name_trigrams <= size &&
+                (size - name_trigrams) / CKG_TRIGRAM_RECORD_SIZE >= index->name_trigrams.trigram_count &&
+                name_postings <= size && size - name_postings >= index->name_trigrams.postings_size &&
+                strings <= size && size - strings >= index->string_size && index->string_size > 0 &&
+                data[strings + index->string_size - 1] == '\0';
+        if (valid) {
+            index->symbols = data + symbols;
+            index->files = data + files;
+            index->by_file = data + by_file;
+            index->by_class = data + by_class;
+            index->name_trie = data + name_trie;
+            index->hump_trie = data + hump_trie;
+            index->humps = data + humps;
+            index->name_trigrams.table = data + name_trigrams;
+            index->name_trigrams.postings = data + name_postings;
+            index->strings = (const char*)data + strings;
+        }
+    }
+    if (!valid) {
+        ckg_unmap_file(&index->file);
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+CKG_API void ckg_index_close(CKGIndex* index) {
+    if (index) {
+        ckg_unmap_file(&index->file);
+        free(index);
+    }
+}
+
+CKG_API void ckg_index_get_info(const CKGIndex* index, uint32_t* symbol_count_out, uint32_t* file_count_out) {
+    if (symbol_count_out) {
+        *symbol_count_out = index ? index->symbol_count : 0;
+    }
+    if (file_count_out) {
+        *file_count_out = index ? index->file_count : 0;
+    }
+}
+
+void ckg_index_tables(const CKGIndex* index, CKGIndexTables* tables) {
+    tables->symbols = index->symbols;
+    tables->symbol_count = index->symbol_count;
+    tables->strings = index->strings;
+    tables->string_size = index->string_size;
+    tables->name_trie = index->name_trie;
+    tables->name_node_count = index->name_node_count;
+    tables->hump_trie = index->hump_trie;
+    tables->hump_node_count = index->hump_node_count;
+    tables->humps = index->humps;
+    tables->hump_count = index->hump_count;
+    tables->name_trigrams = index->name_trigrams;
+}
+
+// A string of the pool; false if the record points outside it
+static inline bool string_at(const CKGIndex* index, uint32_t offset, uint32_t length, const char** text) {
+    if ((uint64_t)offset + length >= index->string_size) {
+        return false;
+    }
+    *text = index->strings + offset;
+    return true;
+}
+
+static inline const uint8_t* symbol_record(const CKGIndex* index, uint32_t row) {
+    return index->symbols + (uint64_t)row * CKG_INDEX_SYMBOL_RECORD_SIZE;
+}
+
+// Row of the symbol table an ordered position refers to, or UINT32_MAX
+static inline uint32_t row_at(const CKGIndex* index, CKGIndexOrder order, uint32_t position) {
+    uint32_t row = UINT32_MAX;
+    if (order == CKG_INDEX_BY_NAME) {
+        row = position;
+    } else if (order == CKG_INDEX_BY_FILE && position < index->symbol_count) {
+        row = get_u32(index->by_file + (uint64_t)position * 4);
+    } else if (order == CKG_INDEX_BY_CLASS && position < index->class_member_count) {
+        row = get_u32(index->by_class + (uint64_t)position * 4);
+    }
+    return row < index->symbol_count ? row : UINT32_MAX;
+}
+
+// The key a position is sorted by in `order`: name, file path or class
+static bool key_at(const CKGIndex* index, CKGIndexOrder order, uint32_t position, const char** key,
+                   uint32_t* key_length) {
+    if (order == CKG_INDEX_BY_FILE) {
+        const uint8_t* file = index->files + (uint64_t)position * CKG_INDEX_FILE_RECORD_SIZE;
+        *key_length = get_u32(file + 4);
+        return string_at(index, get_u32(file), *key_length, key);
+    }
+    uint32_t row = row_at(index, order, position);
+    if (row == UINT32_MAX) {
+        return false;
+    }
+    const uint8_t* record = symbol_record(index, row);
+    uint32_t field = order == CKG_INDEX_BY_CLASS ? 8 : 0;
+    *key_length = get_u32(record + field + 4);
+    return string_at(index, get_u32(record + field), *key_length, key);
+}
+
+CKG_API uint32_t ckg_index_find(const CKGIndex* index, CKGIndexOrder order, const char* key, uint32_t* first_out) {
+    if (first_out) {
+        *first_out = 0;
+    }
+    if (!index || !key || order > CKG_INDEX_BY_CLASS) {
+        return 0;
+    }
+    uint32_t key_length = (uint32_t)strlen(key);
+    uint32_t count = order == CKG_INDEX_BY_NAME   ? index->symbol_count
+                     : order == CKG_INDEX_BY_FILE ? index->file_count
+                                                  : index->class_member_count;
+
+    // Lower bound, then upper bound from there; unreadable records sort
+    // first so a damaged file gives wrong answers rather than crashes
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        const char* text;
+        uint32_t length;
+        if (!key_at(index, order, middle, &text, &length) || compare_bytes(text, length, key, key_length) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    uint32_t first = low;
+    high = count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        const char* text;
+        uint32_t length;
+        if (key_at(index, order, middle, &text, &length) && compare_bytes(text, length, key, key_length) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == first) {
+        return 0;
+    }
+
+    // Files map to their range of the by-file table
+    if (order == CKG_INDEX_BY_FILE) {
+        const uint8_t* file = index->files + (uint64_t)first * CKG_INDEX_FILE_RECORD_SIZE;
+        uint32_t start = get_u32(file + 8);
+        uint32_t symbols = get_u32(file + 12);
+        if (start > index->symbol_count || symbols > index->symbol_count - start) {
+            return 0;
+        }
+        first = start;
+        low = start + symbols;
+    }
+    if (first_out) {
+        *first_out = first;
+    }
+    return low - first;
+}
+
+CKG_API bool ckg_index_get(const CKGIndex* index, CKGIndexOrder order, uint32_t position, CKGIndexSymbol* symbol) {
+    if (!index || !symbol) {
+        return false;
+    }
+    uint32_t row = row_at(index, order, position);
+    if (row == UINT32_MAX) {
+        return false;
+    }
+    const uint8_t* record = symbol_record(index, row);
+    uint32_t file = get_u32(record + 16);
+    if (file >= index->file_count) {
+        return false;
+    }
+    const uint8_t* file_record = index->files + (uint64_t)file * CKG_INDEX_FILE_RECORD_SIZE;
+    symbol->name_length = get_u32(record + 4);
+    symbol->parent_class_length = get_u32(record + 12);
+    symbol->file_path_length = get_u32(file_record + 4);
+    if (!string_at(index, get_u32(record), symbol->name_length, &symbol->name) ||
+        !string_at(index, get_u32(record + 8), symbol->parent_class_length, &symbol->parent_class) ||
+        !string_at(index, get_u32(file_record), symbol->file_path_length, &symbol->file_path)) {
+        return false;
+    }
+    symbol->start_line = get_u32(record + 20);
+    symbol->end_line = get_u32(record + 24);
+    symbol->kind = record[28];
+    symbol->language = record[29];
+    symbol->row = row;
+    return true;
+}
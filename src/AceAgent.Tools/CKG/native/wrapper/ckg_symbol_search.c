@@ -0,0 +1,698 @@
+#define BUILDING_CKG_DLL
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+
+// Name tries of symbol index files (layout documented with
+// CKG_INDEX_VERSION in ckg_wrapper.h) and the searches over them. The tries
+// are radix tries whose edge labels are spans of the index's string pool,
+// so they add a fixed-size record per node and no text. Prefix and camel
+// searches walk them best first, shortest completion first, and stop once
+// the requested number of names is found; fuzzy searches walk them depth
+// first with one edit-distance row per character, pruning every subtree
+// that is already too far from the query. Substring searches check the
+// names the trigram lists leave (see ckg_trigram.c).
+
+typedef struct {
+    uint32_t label;                 // Pool offset of the edge from the parent
+    uint32_t label_length;
+    uint32_t first_child;
+    uint32_t value_first;
+    uint32_t value_count;
+    uint32_t child_count;
+} TrieNode;
+
+typedef struct {
+    const uint8_t* nodes;
+    uint32_t node_count;
+    const char* strings;
+    uint64_t string_size;
+} Trie;
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static inline uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static inline unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? (unsigned char)(c + 32) : c;
+}
+
+static inline bool is_upper(unsigned char c) {
+    return c >= 'A' && c <= 'Z';
+}
+
+// Letters, digits and any non-ASCII byte, so UTF-8 names stay in one hump
+static inline bool is_word(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || is_upper(c) || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+// Start offsets of the camel humps of `text`: the first word character,
+// each uppercase letter and each word character after a separator
+static uint32_t split_humps(const char* text, uint32_t length, uint32_t* starts, uint32_t capacity) {
+    uint32_t count = 0;
+    bool after_separator = true;
+    for (uint32_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (!is_word(c)) {
+            after_separator = true;
+            continue;
+        }
+        if (after_separator || is_upper(c)) {
+            if (count == capacity) {
+                return count;
+            }
+            starts[count++] = i;
+        }
+        after_separator = false;
+    }
+    return count;
+}
+
+uint32_t ckg_hump_key(const char* name, uint32_t length, char* key, uint32_t capacity) {
+    uint32_t starts[256];
+    uint32_t count = split_humps(name, length, starts, capacity < 256 ? capacity : 256);
+    for (uint32_t i = 0; i < count; i++) {
+        unsigned char c = (unsigned char)name[starts[i]];
+        key[i] = (char)(c >= 'a' && c <= 'z' ? c - 32 : c);
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Building
+
+typedef struct {
+    uint32_t node;
+    uint32_t first;                 // Keys [first, end) share the node's path
+    uint32_t end;
+    uint32_t depth;                 // Length of that path
+} BuildTask;
+
+uint8_t* ckg_trie_build(const char* pool, const CKGTrieKey* keys, uint32_t count, uint32_t* node_count_out) {
+    *node_count_out = 0;
+    // Every node but the root either ends a key or branches, so there are
+    // at most two per key
+    if (count > (UINT32_MAX - 1) / 2) {
+        return NULL;
+    }
+    uint32_t capacity = 2 * count + 1;
+    uint8_t* nodes = (uint8_t*)calloc(capacity, CKG_INDEX_TRIE_NODE_SIZE);
+    uint32_t task_capacity = 64;
+    BuildTask* tasks = (BuildTask*)malloc(task_capacity * sizeof(BuildTask));
+    if (!nodes || !tasks) {
+        free(nodes);
+        free(tasks);
+        return NULL;
+    }
+
+    uint32_t node_count = 1;
+    uint32_t task_count = 1;
+    tasks[0] = (BuildTask){0, 0, count, 0};
+    while (task_count > 0) {
+        BuildTask task = tasks[--task_count];
+        uint8_t* node = nodes + (uint64_t)task.node * CKG_INDEX_TRIE_NODE_SIZE;
+        uint32_t next = task.first;
+        // Values follow key order, so the first key below a node holds the
+        // first value of its subtree
+        if (task.first < task.end) {
+            put_u32(node + 12, keys[task.first].value_first);
+            if (keys[task.first].length == task.depth) {
+                put_u32(node + 16, keys[task.first].value_count);
+                next++;
+            }
+        }
+
+        // One child per distinct next byte, labelled with the keys' common
+        // prefix from there
+        uint32_t child_count = 0;
+        for (uint32_t i = next; i < task.end; child_count++) {
+            unsigned char byte = (unsigned char)pool[keys[i].offset + task.depth];
+            while (i < task.end && (unsigned char)pool[keys[i].offset + task.depth] == byte) {
+                i++;
+            }
+        }
+        put_u32(node + 8, child_count > 0 ? node_count : 0);
+        node[20] = (uint8_t)child_count;
+        node[21] = (uint8_t)(child_count >> 8);
+        if (task_count + child_count > task_capacity) {
+            while (task_count + child_count > task_capacity) {
+                task_capacity *= 2;
+            }
+            BuildTask* grown = (BuildTask*)realloc(tasks, task_capacity * sizeof(BuildTask));
+            if (!grown) {
+                free(nodes);
+                free(tasks);
+                return NULL;
+            }
+            tasks = grown;
+        }
+        for (uint32_t i = next; i < task.end;) {
+            const CKGTrieKey* first = &keys[i];
+            unsigned char byte = (unsigned char)pool[first->offset + task.depth];
+            uint32_t end = i + 1;
+            while (end < task.end && (unsigned char)pool[keys[end].offset + task.depth] == byte) {
+                end++;
+            }
+            const CKGTrieKey* last = &keys[end - 1];
+            uint32_t shared = first->length < last->length ? first->length : last->length;
+            uint32_t depth = task.depth + 1;
+            while (depth < shared && pool[first->offset + depth] == pool[last->offset + depth]) {
+                depth++;
+            }
+            uint8_t* child = nodes + (uint64_t)node_count * CKG_INDEX_TRIE_NODE_SIZE;
+            put_u32(child, first->offset + task.depth);
+            put_u32(child + 4, depth - task.depth);
+            tasks[task_count++] = (BuildTask){node_count++, i, end, depth};
+            i = end;
+        }
+    }
+
+    free(tasks);
+    *node_count_out = node_count;
+    return nodes;
+}
+
+// ---------------------------------------------------------------------------
+// Searching
+
+// Read a node; false if it or its children point outside the trie. Children
+// always come after their parent, so a damaged file cannot loop a walk.
+static bool read_node(const Trie* trie, uint32_t id, TrieNode* node) {
+    if (id >= trie->node_count) {
+        return false;
+    }
+    const uint8_t* record = trie->nodes + (uint64_t)id * CKG_INDEX_TRIE_NODE_SIZE;
+    node->label = get_u32(record);
+    node->label_length = get_u32(record + 4);
+    node->first_child = get_u32(record + 8);
+    node->value_first = get_u32(record + 12);
+    node->value_count = get_u32(record + 16);
+    node->child_count = (uint32_t)record[20] | ((uint32_t)record[21] << 8);
+    if ((uint64_t)node->label + node->label_length >= trie->string_size) {
+        return false;
+    }
+    return node->child_count == 0 ||
+           (node->first_child > id && (uint64_t)node->first_child + node->child_count <= trie->node_count);
+}
+
+// The child of `parent` whose label starts with `byte`, by binary search
+static bool find_child(const Trie* trie, const TrieNode* parent, unsigned char byte, uint32_t* child_out,
+                       TrieNode* child) {
+    uint32_t low = parent->first_child;
+    uint32_t high = parent->first_child + parent->child_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (!read_node(trie, middle, child) || child->label_length == 0) {
+            return false;
+        }
+        unsigned char first = (unsigned char)trie->strings[child->label];
+        if (first == byte) {
+            *child_out = middle;
+            return true;
+        }
+        if (first < byte) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    uint32_t score;
+    uint32_t length;
+    uint32_t row;
+    uint32_t count;
+} Candidate;
+
+// The best names so far, kept sorted
+typedef struct {
+    Candidate* items;
+    uint32_t count;
+    uint32_t capacity;
+} Best;
+
+static inline bool better(const Candidate* a, const Candidate* b) {
+    if (a->score != b->score) {
+        return a->score < b->score;
+    }
+    if (a->length != b->length) {
+        return a->length < b->length;
+    }
+    return a->row < b->row;
+}
+
+static inline bool best_full(const Best* best) {
+    return best->count == best->capacity;
+}
+
+static void best_offer(Best* best, Candidate candidate) {
+    if (best_full(best) && !better(&candidate, &best->items[best->count - 1])) {
+        return;
+    }
+    uint32_t i = best_full(best) ? best->count - 1 : best->count++;
+    while (i > 0 && better(&candidate, &best->items[i - 1])) {
+        best->items[i] = best->items[i - 1];
+        i--;
+    }
+    best->items[i] = candidate;
+}
+
+// Trie nodes waiting to be expanded, smallest depth (then first value) first
+typedef struct {
+    uint32_t depth;
+    uint32_t value;
+    uint32_t node;
+} Pending;
+
+typedef struct {
+    Pending* items;
+    uint32_t count;
+    uint32_t capacity;
+    bool failed;
+} Queue;
+
+static inline bool pending_before(const Pending* a, const Pending* b) {
+    return a->depth != b->depth ? a->depth < b->depth : a->value < b->value;
+}
+
+static void queue_push(Queue* queue, Pending item) {
+    if (queue->count == queue->capacity) {
+        uint32_t capacity = queue->capacity ? queue->capacity * 2 : 64;
+        Pending* items = (Pending*)realloc(queue->items, capacity * sizeof(Pending));
+        if (!items) {
+            queue->failed = true;
+            return;
+        }
+        queue->items = items;
+        queue->capacity = capacity;
+    }
+    uint32_t i = queue->count++;
+    while (i > 0 && pending_before(&item, &queue->items[(i - 1) / 2])) {
+        queue->items[i] = queue->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    queue->items[i] = item;
+}
+
+static Pending queue_pop(Queue* queue) {
+    Pending top = queue->items[0];
+    Pending last = queue->items[--queue->count];
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= queue->count) {
+            break;
+        }
+        if (child + 1 < queue->count && pending_before(&queue->items[child + 1], &queue->items[child])) {
+            child++;
+        }
+        if (!pending_before(&queue->items[child], &last)) {
+            break;
+        }
+        queue->items[i] = queue->items[child];
+        i = child;
+    }
+    if (queue->count > 0) {
+        queue->items[i] = last;
+    }
+    return top;
+}
+
+// Nodes where the path first spells all of `query` (or its case variants
+// when `fold_case`), queued at the depth their labels end
+static void queue_matches(const Trie* trie, const unsigned char* query, uint32_t query_length, bool fold_case,
+                          Queue* queue) {
+    TrieNode root;
+    if (!read_node(trie, 0, &root)) {
+        return;
+    }
+    if (query_length == 0) {
+        queue_push(queue, (Pending){0, root.value_first, 0});
+        return;
+    }
+
+    // Case variants branch, so this is a walk rather than a single descent
+    typedef struct {
+        uint32_t node;
+        uint32_t depth;
+    } Step;
+    Step stack[CKG_INDEX_MAX_QUERY * 2];
+    uint32_t stack_count = 0;
+    stack[stack_count++] = (Step){0, 0};
+    while (stack_count > 0 && !queue->failed) {
+        Step step = stack[--stack_count];
+        TrieNode parent;
+        if (!read_node(trie, step.node, &parent)) {
+            continue;
+        }
+        unsigned char wanted = query[step.depth];
+        unsigned char variants[2] = {wanted, wanted};
+        if (fold_case && wanted >= 'a' && wanted <= 'z') {
+            variants[1] = (unsigned char)(wanted - 32);
+        }
+        for (int v = 0; v < (variants[1] != variants[0] ? 2 : 1); v++) {
+            uint32_t id;
+            TrieNode child;
+            if (!find_child(trie, &parent, variants[v], &id, &child)) {
+                continue;
+            }
+            uint32_t remaining = query_length - step.depth;
+            uint32_t compared = child.label_length < remaining ? child.label_length : remaining;
+            const unsigned char* label = (const unsigned char*)trie->strings + child.label;
+            bool matched = true;
+            for (uint32_t i = 1; i < compared && matched; i++) {
+                matched = fold_case ? fold(label[i]) == query[step.depth + i] : label[i] == query[step.depth + i];
+            }
+            if (!matched) {
+                continue;
+            }
+            uint32_t depth = step.depth + child.label_length;
+            if (depth >= query_length) {
+                queue_push(queue, (Pending){depth, child.value_first, id});
+            } else if (stack_count < sizeof(stack) / sizeof(stack[0])) {
+                stack[stack_count++] = (Step){id, depth};
+            }
+        }
+    }
+}
+
+static inline bool symbol_name(const CKGIndexTables* tables, uint32_t row, const char** name, uint32_t* length) {
+    if (row >= tables->symbol_count) {
+        return false;
+    }
+    const uint8_t* record = tables->symbols + (uint64_t)row * CKG_INDEX_SYMBOL_RECORD_SIZE;
+    uint32_t offset = get_u32(record);
+    *length = get_u32(record + 4);
+    if ((uint64_t)offset + *length >= tables->string_size) {
+        return false;
+    }
+    *name = tables->strings + offset;
+    return true;
+}
+
+// Names whose humps start with the query's humps
+typedef struct {
+    const char* query;
+    uint32_t starts[CKG_INDEX_MAX_QUERY];
+    uint32_t lengths[CKG_INDEX_MAX_QUERY];
+    uint32_t count;
+} CamelQuery;
+
+static bool camel_matches(const CamelQuery* camel, const char* name, uint32_t length) {
+    uint32_t starts[CKG_INDEX_MAX_QUERY + 1];
+    uint32_t count = split_humps(name, length, starts, CKG_INDEX_MAX_QUERY + 1);
+    if (count < camel->count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < camel->count; i++) {
+        uint32_t end = i + 1 < count ? starts[i + 1] : length;
+        if (camel->lengths[i] > end - starts[i]) {
+            return false;
+        }
+        for (uint32_t j = 0; j < camel->lengths[i]; j++) {
+            if (fold((unsigned char)name[starts[i] + j]) != fold((unsigned char)camel->query[camel->starts[i] + j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Best-first expansion of the queued nodes. A node's score is its depth
+// less `base`; prefix search (`in_order`) finds names in final order and
+// stops as soon as it has enough.
+static void expand(const Trie* trie, const CKGIndexTables* tables, Queue* queue, uint32_t base, bool in_order,
+                   const CamelQuery* camel, Best* best) {
+    uint32_t visits = 0;
+    while (queue->count > 0 && !queue->failed && visits++ < trie->node_count) {
+        Pending pending = queue_pop(queue);
+        uint32_t score = pending.depth - base;
+        if (best_full(best) && (in_order || score > best->items[best->count - 1].score)) {
+            break;
+        }
+        TrieNode node;
+        if (!read_node(trie, pending.node, &node)) {
+            continue;
+        }
+        if (node.value_count > 0 && !camel) {
+            best_offer(best, (Candidate){score, pending.depth, node.value_first, node.value_count});
+        }
+        for (uint32_t i = 0; camel && i < node.value_count; i++) {
+            uint64_t entry = (uint64_t)node.value_first + i;
+            if (entry >= tables->hump_count) {
+                break;
+            }
+            const uint8_t* record = tables->humps + entry * CKG_INDEX_HUMP_RECORD_SIZE;
+            uint32_t row = get_u32(record);
+            const char* name;
+            uint32_t length;
+            if (symbol_name(tables, row, &name, &length) && camel_matches(camel, name, length)) {
+                best_offer(best, (Candidate){score, length, row, get_u32(record + 4)});
+            }
+        }
+        for (uint32_t i = 0; i < node.child_count; i++) {
+            TrieNode child;
+            uint32_t id = node.first_child + i;
+            if (read_node(trie, id, &child)) {
+                queue_push(queue, (Pending){pending.depth + child.label_length, child.value_first, id});
+            }
+        }
+    }
+}
+
+// Depth-first walk with one row of the (restricted Damerau) edit distance
+// per character of the path
+typedef struct {
+    const Trie* trie;
+    unsigned char query[CKG_INDEX_MAX_QUERY];
+    uint32_t query_length;
+    uint32_t max_distance;
+    unsigned char path[CKG_INDEX_MAX_QUERY + CKG_INDEX_MAX_DISTANCE + 1];
+    uint8_t rows[CKG_INDEX_MAX_QUERY + CKG_INDEX_MAX_DISTANCE + 1][CKG_INDEX_MAX_QUERY + 1];
+    uint32_t visits;
+    Best* best;
+} Fuzzy;
+
+static inline uint32_t fuzzy_limit(const Fuzzy* fuzzy) {
+    uint32_t limit = fuzzy->max_distance;
+    if (best_full(fuzzy->best) && fuzzy->best->items[fuzzy->best->count - 1].score < limit) {
+        limit = fuzzy->best->items[fuzzy->best->count - 1].score;
+    }
+    return limit;
+}
+
+static void fuzzy_visit(Fuzzy* fuzzy, uint32_t id, uint32_t depth) {
+    TrieNode node;
+    if (fuzzy->visits++ >= fuzzy->trie->node_count || !read_node(fuzzy->trie, id, &node) ||
+        (id != 0 && node.label_length == 0)) {
+        return;
+    }
+    uint32_t columns = fuzzy->query_length;
+    const unsigned char* label = (const unsigned char*)fuzzy->trie->strings + node.label;
+    for (uint32_t i = 0; i < node.label_length; i++) {
+        uint32_t limit = fuzzy_limit(fuzzy);
+        uint32_t row = depth + i + 1;
+        if (row > columns + limit) {
+            return;
+        }
+        unsigned char c = fold(label[i]);
+        fuzzy->path[row - 1] = c;
+        const uint8_t* above = fuzzy->rows[row - 1];
+        uint8_t* current = fuzzy->rows[row];
+        current[0] = (uint8_t)row;
+        uint8_t smallest = current[0];
+        for (uint32_t j = 1; j <= columns; j++) {
+            uint8_t cost = above[j - 1] + (fuzzy->query[j - 1] != c);
+            if (above[j] + 1 < cost) {
+                cost = above[j] + 1;
+            }
+            if (current[j - 1] + 1 < cost) {
+                cost = current[j - 1] + 1;
+            }
+            if (row > 1 && j > 1 && fuzzy->query[j - 1] == fuzzy->path[row - 2] && fuzzy->query[j - 2] == c &&
+                fuzzy->rows[row - 2][j - 2] + 1 < cost) {
+                cost = fuzzy->rows[row - 2][j - 2] + 1;
+            }
+            current[j] = cost;
+            if (cost < smallest) {
+                smallest = cost;
+            }
+        }
+        if (smallest > limit) {
+            return;
+        }
+    }
+
+    uint32_t end = depth + node.label_length;
+    if (node.value_count > 0 && fuzzy->rows[end][columns] <= fuzzy_limit(fuzzy)) {
+        best_offer(fuzzy->best, (Candidate){fuzzy->rows[end][columns], end, node.value_first, node.value_count});
+    }
+    for (uint32_t i = 0; i < node.child_count; i++) {
+        fuzzy_visit(fuzzy, node.first_child + i, end);
+    }
+}
+
+// Whether `name` contains the lowercase `query`, ignoring ASCII case
+static bool contains_folded(const char* name, uint32_t length, const unsigned char* query, uint32_t query_length) {
+    for (uint32_t start = 0; start + query_length <= length; start++) {
+        uint32_t i = 0;
+        while (i < query_length && fold((unsigned char)name[start + i]) == query[i]) {
+            i++;
+        }
+        if (i == query_length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Offer a name, given by its first row, if it contains the query; its
+// symbols are the run of rows sharing its (interned) name
+static void substring_offer(const CKGIndexTables* tables, uint32_t row, const unsigned char* query, uint32_t query_length,
+                            Best* best) {
+    const char* name;
+    uint32_t length;
+    if (!symbol_name(tables, row, &name, &length) || length < query_length) {
+        return;
+    }
+    // The score is known before the name is scanned
+    Candidate candidate = {length - query_length, length, row, 0};
+    if ((best_full(best) && !better(&candidate, &best->items[best->count - 1])) ||
+        !contains_folded(name, length, query, query_length)) {
+        return;
+    }
+    uint32_t offset = get_u32(tables->symbols + (uint64_t)row * CKG_INDEX_SYMBOL_RECORD_SIZE);
+    candidate.count = 1;
+    while (row + candidate.count < tables->symbol_count &&
+           get_u32(tables->symbols + (uint64_t)(row + candidate.count) * CKG_INDEX_SYMBOL_RECORD_SIZE) == offset) {
+        candidate.count++;
+    }
+    best_offer(best, candidate);
+}
+
+static void substring_search(const CKGIndexTables* tables, const unsigned char* query, uint32_t query_length,
+                             Best* best) {
+    uint32_t* rows = NULL;
+    uint32_t count = 0;
+    bool all = false;
+    if (!ckg_trigram_candidates(&tables->name_trigrams, (const char*)query, query_length, &rows, &count, &all)) {
+        return;
+    }
+    if (all) {
+        // Too short to filter: every distinct name, each at its first row
+        uint32_t previous = 0;
+        for (uint32_t row = 0; row < tables->symbol_count; row++) {
+            uint32_t offset = get_u32(tables->symbols + (uint64_t)row * CKG_INDEX_SYMBOL_RECORD_SIZE);
+            if (row == 0 || offset != previous) {
+                substring_offer(tables, row, query, query_length, best);
+            }
+            previous = offset;
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        substring_offer(tables, rows[i], query, query_length, best);
+    }
+    free(rows);
+}
+
+CKG_API uint32_t ckg_index_search(const CKGIndex* index, CKGSearchMode mode, const char* query, uint32_t max_distance,
+                                  CKGIndexMatch* matches, uint32_t capacity) {
+    if (!index || !query || !matches || capacity == 0 || mode > CKG_SEARCH_SUBSTRING) {
+        return 0;
+    }
+    size_t query_length = strlen(query);
+    if (query_length > CKG_INDEX_MAX_QUERY) {
+        return 0;
+    }
+    CKGIndexTables tables;
+    ckg_index_tables(index, &tables);
+    Best best = {(Candidate*)malloc((size_t)capacity * sizeof(Candidate)), 0, capacity};
+    if (!best.items) {
+        return 0;
+    }
+
+    unsigned char folded[CKG_INDEX_MAX_QUERY];
+    for (size_t i = 0; i < query_length; i++) {
+        folded[i] = fold((unsigned char)query[i]);
+    }
+    Queue queue = {0};
+    if (mode == CKG_SEARCH_PREFIX) {
+        Trie trie = {tables.name_trie, tables.name_node_count, tables.strings, tables.string_size};
+        queue_matches(&trie, folded, (uint32_t)query_length, true, &queue);
+        expand(&trie, &tables, &queue, (uint32_t)query_length, true, NULL, &best);
+    } else if (mode == CKG_SEARCH_FUZZY) {
+        Fuzzy* fuzzy = (Fuzzy*)malloc(sizeof(Fuzzy));
+        Trie trie = {tables.name_trie, tables.name_node_count, tables.strings, tables.string_size};
+        if (fuzzy) {
+            fuzzy->trie = &trie;
+            memcpy(fuzzy->query, folded, query_length);
+            fuzzy->query_length = (uint32_t)query_length;
+            fuzzy->max_distance = max_distance < CKG_INDEX_MAX_DISTANCE ? max_distance : CKG_INDEX_MAX_DISTANCE;
+            fuzzy->visits = 0;
+            fuzzy->best = &best;
+            for (uint32_t j = 0; j <= fuzzy->query_length; j++) {
+                fuzzy->rows[0][j] = (uint8_t)j;
+            }
+            fuzzy_visit(fuzzy, 0, 0);
+            free(fuzzy);
+        }
+    } else if (mode == CKG_SEARCH_SUBSTRING) {
+        substring_search(&tables, folded, (uint32_t)query_length, &best);
+    } else {
+        // All-lowercase queries without separators are one letter per hump
+        CamelQuery camel;
+        camel.query = query;
+        bool spelled = true;
+        for (size_t i = 0; i < query_length && spelled; i++) {
+            unsigned char c = (unsigned char)query[i];
+            spelled = is_word(c) && !is_upper(c);
+        }
+        if (spelled) {
+            for (uint32_t i = 0; i < (uint32_t)query_length; i++) {
+                camel.starts[i] = i;
+            }
+            camel.count = (uint32_t)query_length;
+        } else {
+            camel.count = split_humps(query, (uint32_t)query_length, camel.starts, CKG_INDEX_MAX_QUERY);
+        }
+        unsigned char initials[CKG_INDEX_MAX_QUERY];
+        for (uint32_t i = 0; i < camel.count; i++) {
+            uint32_t end = i + 1 < camel.count ? camel.starts[i + 1] : (uint32_t)query_length;
+            while (end > camel.starts[i] && !is_word((unsigned char)query[end - 1])) {
+                end--;
+            }
+            camel.lengths[i] = end - camel.starts[i];
+            unsigned char c = (unsigned char)query[camel.starts[i]];
+            initials[i] = (unsigned char)(c >= 'a' && c <= 'z' ? c - 32 : c);
+        }
+        if (camel.count > 0) {
+            Trie trie = {tables.hump_trie, tables.hump_node_count, tables.strings, tables.string_size};
+            queue_matches(&trie, initials, camel.count, false, &queue);
+            expand(&trie, &tables, &queue, camel.count, false, &camel, &best);
+        }
+    }
+    free(queue.items);
+
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < best.count; i++) {
+        CKGIndexMatch* match = &matches[found];
+        if (symbol_name(&tables, best.items[i].row, &match->name, &match->name_length)) {
+            match->first = best.items[i].row;
+            match->count = best.items[i].count;
+            match->score = best.items[i].score;
+            found++;
+        }
+    }
+    free(best.items);
+    return found;
+}
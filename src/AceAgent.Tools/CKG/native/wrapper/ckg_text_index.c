@@ -0,0 +1,740 @@
+#define BUILDING_CKG_DLL
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_fs.h"
+#include "ckg_internal.h"
+#include "ckg_platform.h"
+
+// Text index files (layout documented with CKG_TEXT_INDEX_VERSION in
+// ckg_wrapper.h). The writer keeps each file's sorted trigrams, as the
+// indexing workers collected them, and at write time sorts the files by
+// path and turns the lists around into one posting list per trigram (see
+// ckg_trigram.c). Searches narrow the files down with the posting lists and
+// confirm each candidate by scanning its mapped bytes.
+
+// SSE2 is part of every x86-64 target and NEON of every AArch64 one, so no
+// runtime dispatch is needed; other targets use the scalar scan.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CKG_SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CKG_SIMD_NEON 1
+#endif
+
+typedef struct {
+    char* path;
+    uint32_t path_length;
+    uint32_t trigram_count;
+    uint64_t trigrams;              // Offset into the writer's trigrams
+} PendingFile;
+
+struct CKGTextWriter {
+    PendingFile* files;
+    uint32_t file_count;
+    uint32_t file_capacity;
+    uint32_t* trigrams;             // Every file's sorted trigrams, back to back
+    uint64_t trigram_count;
+    uint64_t trigram_capacity;
+    bool failed;                    // Out of memory
+};
+
+struct CKGTextIndex {
+    CKGMappedFile file;
+    const uint8_t* files;
+    const uint8_t* forward;
+    uint64_t forward_size;
+    const char* strings;
+    uint64_t string_size;
+    uint32_t file_count;
+    CKGTrigramIndex trigrams;
+};
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static inline uint8_t* put_u64(uint8_t* out, uint64_t value) {
+    put_u32(out, (uint32_t)value);
+    return put_u32(out + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t* in) {
+    return (uint64_t)get_u32(in) | ((uint64_t)get_u32(in + 4) << 32);
+}
+
+static inline uint8_t* put_varint(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static inline bool get_varint(const uint8_t* data, uint64_t* position, uint64_t end, uint32_t* value) {
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        if (*position >= end) {
+            return false;
+        }
+        uint8_t byte = data[(*position)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? (unsigned char)(c + 32) : c;
+}
+
+// Byte-wise order of two strings, the order the file table is sorted in
+static inline int compare_bytes(const char* a, uint32_t a_length, const char* b, uint32_t b_length) {
+    int order = memcmp(a, b, a_length < b_length ? a_length : b_length);
+    if (order != 0) {
+        return order;
+    }
+    return a_length < b_length ? -1 : a_length > b_length ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+
+CKGTextWriter* ckg_text_writer_create(void) {
+    return (CKGTextWriter*)calloc(1, sizeof(CKGTextWriter));
+}
+
+void ckg_text_writer_destroy(CKGTextWriter* writer) {
+    if (!writer) {
+        return;
+    }
+    for (uint32_t i = 0; i < writer->file_count; i++) {
+        free(writer->files[i].path);
+    }
+    free(writer->files);
+    free(writer->trigrams);
+    free(writer);
+}
+
+// Append a file with room for `count` trigrams, which the caller fills in
+static uint32_t* add_pending(CKGTextWriter* writer, const char* path, uint32_t count) {
+    if (writer->failed) {
+        return NULL;
+    }
+    if (writer->file_count == writer->file_capacity) {
+        uint32_t capacity = writer->file_capacity ? writer->file_capacity * 2 : 256;
+        PendingFile* files = (PendingFile*)realloc(writer->files, (size_t)capacity * sizeof(PendingFile));
+        if (!files) {
+            writer->failed = true;
+            return NULL;
+        }
+        writer->files = files;
+        writer->file_capacity = capacity;
+    }
+    if (writer->trigram_count + count > writer->trigram_capacity) {
+        uint64_t capacity = writer->trigram_capacity ? writer->trigram_capacity : 4096;
+        while (capacity < writer->trigram_count + count) {
+            capacity *= 2;
+        }
+        uint32_t* trigrams = (uint32_t*)realloc(writer->trigrams, (size_t)capacity * sizeof(uint32_t));
+        if (!trigrams) {
+            writer->failed = true;
+            return NULL;
+        }
+        writer->trigrams = trigrams;
+        writer->trigram_capacity = capacity;
+    }
+    size_t path_length = strlen(path);
+    char* copy = path_length < UINT32_MAX ? (char*)malloc(path_length + 1) : NULL;
+    if (!copy) {
+        writer->failed = true;
+        return NULL;
+    }
+    memcpy(copy, path, path_length + 1);
+
+    PendingFile* file = &writer->files[writer->file_count++];
+    file->path = copy;
+    file->path_length = (uint32_t)path_length;
+    file->trigram_count = count;
+    file->trigrams = writer->trigram_count;
+    writer->trigram_count += count;
+    return writer->trigrams + file->trigrams;
+}
+
+bool ckg_text_writer_add(CKGTextWriter* writer, const char* path, const uint32_t* trigrams, uint32_t count) {
+    if (!writer || !path) {
+        return false;
+    }
+    uint32_t* out = add_pending(writer, path, count);
+    if (!out) {
+        return false;
+    }
+    if (count > 0) {
+        memcpy(out, trigrams, (size_t)count * sizeof(uint32_t));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Reader helpers
+
+static bool file_path_at(const CKGTextIndex* index, uint32_t file, const char** path, uint32_t* length) {
+    if (file >= index->file_count) {
+        return false;
+    }
+    const uint8_t* record = index->files + (uint64_t)file * CKG_TEXT_INDEX_FILE_RECORD_SIZE;
+    uint32_t offset = get_u32(record);
+    *length = get_u32(record + 4);
+    if ((uint64_t)offset + *length >= index->string_size) {
+        return false;
+    }
+    *path = index->strings + offset;
+    return true;
+}
+
+// Number of the file at `path`, or -1
+static int64_t find_file(const CKGTextIndex* index, const char* path) {
+    size_t path_length = strlen(path);
+    uint32_t low = 0;
+    uint32_t high = index->file_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        const char* found;
+        uint32_t found_length;
+        if (!file_path_at(index, middle, &found, &found_length)) {
+            return -1;
+        }
+        int order = compare_bytes(found, found_length, path, (uint32_t)path_length);
+        if (order == 0) {
+            return middle;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return -1;
+}
+
+bool ckg_text_index_has_file(const CKGTextIndex* index, const char* path) {
+    return index && path && find_file(index, path) >= 0;
+}
+
+const char* ckg_text_index_path(const CKGTextIndex* index, uint32_t file) {
+    const char* path;
+    uint32_t length;
+    return index && file_path_at(index, file, &path, &length) ? path : NULL;
+}
+
+bool ckg_text_writer_add_file(CKGTextWriter* writer, const CKGTextIndex* index, const char* path) {
+    if (!writer || !index || !path) {
+        return false;
+    }
+    int64_t file = find_file(index, path);
+    if (file < 0) {
+        return false;
+    }
+    const uint8_t* record = index->files + (uint64_t)file * CKG_TEXT_INDEX_FILE_RECORD_SIZE;
+    uint64_t position = get_u64(record + 8);
+    uint32_t count = get_u32(record + 16);
+    if (position > index->forward_size || count > index->forward_size - position) {
+        return false;
+    }
+    uint32_t* out = add_pending(writer, path, count);
+    if (!out) {
+        return false;
+    }
+    uint32_t trigram = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t delta;
+        if (!get_varint(index->forward, &position, index->forward_size, &delta)) {
+            // Damaged: keep the file without trigrams rather than wrong ones
+            writer->trigram_count -= count;
+            writer->files[writer->file_count - 1].trigram_count = 0;
+            return false;
+        }
+        trigram = i ? trigram + delta : delta;
+        out[i] = trigram;
+    }
+    return true;
+}
+
+
+static inline uint32_t varint_length(uint32_t value) {
+    uint32_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static int compare_pending(const void* a, const void* b) {
+    const PendingFile* left = (const PendingFile*)a;
+    const PendingFile* right = (const PendingFile*)b;
+    int order = compare_bytes(left->path, left->path_length, right->path, right->path_length);
+    if (order != 0) {
+        return order;
+    }
+    // Of two files with one path, the first added is kept
+    return left->trigrams < right->trigrams ? -1 : left->trigrams > right->trigrams ? 1 : 0;
+}
+
+// The kept files in path order, numbered as the posting lists list them
+typedef struct {
+    const CKGTextWriter* writer;
+    const uint32_t* order;
+} FileTrigrams;
+
+static bool file_trigrams(void* user_data, uint32_t document, const uint32_t** trigrams_out, uint32_t* count_out) {
+    const FileTrigrams* files = (const FileTrigrams*)user_data;
+    const PendingFile* file = &files->writer->files[files->order[document]];
+    *trigrams_out = files->writer->trigrams + file->trigrams;
+    *count_out = file->trigram_count;
+    return true;
+}
+
+static void write_bytes(FILE* file, const void* bytes, uint64_t size, bool* ok) {
+    if (*ok && size > 0 && fwrite(bytes, 1, (size_t)size, file) != size) {
+        *ok = false;
+    }
+}
+
+static bool write_tables(CKGTextWriter* writer, FILE* file) {
+    qsort(writer->files, writer->file_count, sizeof(PendingFile), compare_pending);
+    uint32_t* order = (uint32_t*)malloc((size_t)(writer->file_count ? writer->file_count : 1) * sizeof(uint32_t));
+    if (!order) {
+        return false;
+    }
+    uint32_t file_count = 0;
+    uint64_t string_size = 1;
+    uint64_t forward_size = 0;
+    uint32_t longest = 0;
+    for (uint32_t i = 0; i < writer->file_count; i++) {
+        const PendingFile* pending = &writer->files[i];
+        if (file_count > 0) {
+            const PendingFile* kept = &writer->files[order[file_count - 1]];
+            if (compare_bytes(kept->path, kept->path_length, pending->path, pending->path_length) == 0) {
+                continue;
+            }
+        }
+        order[file_count++] = i;
+        string_size += (uint64_t)pending->path_length + 1;
+        const uint32_t* trigrams = writer->trigrams + pending->trigrams;
+        for (uint32_t t = 0; t < pending->trigram_count; t++) {
+            forward_size += varint_length(t ? trigrams[t] - trigrams[t - 1] : trigrams[t]);
+        }
+        if (pending->trigram_count > longest) {
+            longest = pending->trigram_count;
+        }
+    }
+
+    FileTrigrams source = {writer, order};
+    CKGTrigramPostings postings;
+    uint8_t* scratch = (uint8_t*)malloc((size_t)longest * 5 + 1);
+    bool ok = scratch && string_size <= UINT32_MAX &&
+              ckg_trigram_build(file_count, NULL, file_trigrams, &source, &postings);
+    if (!ok) {
+        free(scratch);
+        free(order);
+        return false;
+    }
+
+    uint64_t files_offset = CKG_TEXT_INDEX_HEADER_SIZE;
+    uint64_t trigrams_offset = files_offset + (uint64_t)file_count * CKG_TEXT_INDEX_FILE_RECORD_SIZE;
+    uint64_t postings_offset = trigrams_offset + (uint64_t)postings.trigram_count * CKG_TRIGRAM_RECORD_SIZE;
+    uint64_t forward_offset = postings_offset + postings.postings_size;
+    uint64_t strings_offset = forward_offset + forward_size;
+
+    uint8_t header[CKG_TEXT_INDEX_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, CKG_TEXT_INDEX_MAGIC, 4);
+    put_u32(header + 4, CKG_TEXT_INDEX_VERSION);
+    put_u32(header + 8, file_count);
+    put_u32(header + 12, postings.trigram_count);
+    put_u64(header + 16, files_offset);
+    put_u64(header + 24, trigrams_offset);
+    put_u64(header + 32, postings_offset);
+    put_u64(header + 40, postings.postings_size);
+    put_u64(header + 48, forward_offset);
+    put_u64(header + 56, forward_size);
+    put_u64(header + 64, strings_offset);
+    put_u64(header + 72, string_size);
+    write_bytes(file, header, sizeof(header), &ok);
+
+    uint32_t path_offset = 1;
+    uint64_t forward = 0;
+    for (uint32_t i = 0; i < file_count; i++) {
+        const PendingFile* pending = &writer->files[order[i]];
+        const uint32_t* trigrams = writer->trigrams + pending->trigrams;
+        uint8_t record[CKG_TEXT_INDEX_FILE_RECORD_SIZE];
+        uint8_t* out = put_u32(record, path_offset);
+        out = put_u32(out, pending->path_length);
+        out = put_u64(out, forward);
+        out = put_u32(out, pending->trigram_count);
+        put_u32(out, 0);
+        write_bytes(file, record, sizeof(record), &ok);
+        path_offset += pending->path_length + 1;
+        for (uint32_t t = 0; t < pending->trigram_count; t++) {
+            forward += varint_length(t ? trigrams[t] - trigrams[t - 1] : trigrams[t]);
+        }
+    }
+    write_bytes(file, postings.table, (uint64_t)postings.trigram_count * CKG_TRIGRAM_RECORD_SIZE, &ok);
+    write_bytes(file, postings.postings, postings.postings_size, &ok);
+    for (uint32_t i = 0; i < file_count; i++) {
+        const PendingFile* pending = &writer->files[order[i]];
+        const uint32_t* trigrams = writer->trigrams + pending->trigrams;
+        uint8_t* out = scratch;
+        for (uint32_t t = 0; t < pending->trigram_count; t++) {
+            out = put_varint(out, t ? trigrams[t] - trigrams[t - 1] : trigrams[t]);
+        }
+        write_bytes(file, scratch, (uint64_t)(out - scratch), &ok);
+    }
+    write_bytes(file, "", 1, &ok);
+    for (uint32_t i = 0; i < file_count; i++) {
+        const PendingFile* pending = &writer->files[order[i]];
+        write_bytes(file, pending->path, (uint64_t)pending->path_length + 1, &ok);
+    }
+
+    free(postings.table);
+    free(postings.postings);
+    free(scratch);
+    free(order);
+    return ok;
+}
+
+int ckg_text_writer_write(CKGTextWriter* writer, const char* path) {
+    if (!writer || !path || writer->failed) {
+        return -1;
+    }
+    // Written next to the target and renamed over it, so readers that have
+    // the old index mapped keep a consistent file
+    size_t length = strlen(path);
+    char* temporary = (char*)malloc(length + 32);
+    if (!temporary) {
+        return -1;
+    }
+    snprintf(temporary, length + 32, "%s.%016llx.tmp", path, (unsigned long long)ckg_now_ns());
+    FILE* file = ckg_open_file(temporary, "wb");
+    if (!file) {
+        free(temporary);
+        return -1;
+    }
+    bool written = write_tables(writer, file);
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    if (!written || !ckg_replace_file(temporary, path)) {
+        ckg_remove_file(temporary);
+        free(temporary);
+        return -1;
+    }
+    free(temporary);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+
+CKG_API CKGTextIndex* ckg_text_index_open(const char* path) {
+    if (!path) {
+        return NULL;
+    }
+    CKGTextIndex* index = (CKGTextIndex*)calloc(1, sizeof(CKGTextIndex));
+    if (!index) {
+        return NULL;
+    }
+    if (!ckg_map_file(path, &index->file)) {
+        free(index);
+        return NULL;
+    }
+
+    // Only the header is checked here; records are checked as they are read
+    const uint8_t* data = (const uint8_t*)index->file.data;
+    uint64_t size = index->file.length;
+    bool valid = size >= CKG_TEXT_INDEX_HEADER_SIZE && memcmp(data, CKG_TEXT_INDEX_MAGIC, 4) == 0 &&
+                 get_u32(data + 4) == CKG_TEXT_INDEX_VERSION;
+    if (valid) {
+        index->file_count = get_u32(data + 8);
+        index->trigrams.trigram_count = get_u32(data + 12);
+        uint64_t files = get_u64(data + 16);
+        uint64_t table = get_u64(data + 24);
+        uint64_t postings = get_u64(data + 32);
+        index->trigrams.postings_size = get_u64(data + 40);
+        uint64_t forward = get_u64(data + 48);
+        index->forward_size = get_u64(data + 56);
+        uint64_t strings = get_u64(data + 64);
+        index->string_size = get_u64(data + 72);
+        valid = files >= CKG_TEXT_INDEX_HEADER_SIZE && files <= size &&
+                (size - files) / CKG_TEXT_INDEX_FILE_RECORD_SIZE >= index->file_count &&
+                table <= size && (size - table) / CKG_TRIGRAM_RECORD_SIZE >= index->trigrams.trigram_count &&
+                postings <= size && size - postings >= index->trigrams.postings_size &&
+                forward <= size && size - forward >= index->forward_size &&
+                strings <= size && size - strings >= index->string_size && index->string_size > 0 &&
+                data[strings + index->string_size - 1] == '\0';
+        if (valid) {
+            index->files = data + files;
+            index->trigrams.table = data + table;
+            index->trigrams.postings = data + postings;
+            index->forward = data + forward;
+            index->strings = (const char*)data + strings;
+        }
+    }
+    if (!valid) {
+        ckg_unmap_file(&index->file);
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+CKG_API void ckg_text_index_close(CKGTextIndex* index) {
+    if (index) {
+        ckg_unmap_file(&index->file);
+        free(index);
+    }
+}
+
+CKG_API void ckg_text_index_get_info(const CKGTextIndex* index, uint32_t* file_count_out, uint32_t* trigram_count_out) {
+    if (file_count_out) {
+        *file_count_out = index ? index->file_count : 0;
+    }
+    if (trigram_count_out) {
+        *trigram_count_out = index ? index->trigrams.trigram_count : 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Search
+
+static inline uint32_t lowest_bit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(mask);
+#else
+    uint32_t bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+static inline bool same_bytes(const uint8_t* text, const uint8_t* needle, size_t length, bool fold_case) {
+    if (!fold_case) {
+        return memcmp(text, needle, length) == 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (fold(text[i]) != needle[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(CKG_SIMD_SSE2)
+static inline __m128i fold16(__m128i v) {
+    // Signed compares leave bytes from 0x80 up, which are negative, alone
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#elif defined(CKG_SIMD_NEON)
+static inline uint8x16_t fold16(uint8x16_t v) {
+    uint8x16_t upper = vcleq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8('Z' - 'A'));
+    return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+}
+#endif
+
+// First occurrence of `needle` (at least one byte) in `text`, or NULL.
+// With fold_case the needle is lowercase already and ASCII letters of the
+// text are compared lowercased. The vector loops test 16 positions at once
+// for the needle's first and last byte, and compare the rest only where
+// both match, which on source text is rarely more than once per block.
+static const uint8_t* find_bytes(const uint8_t* text, size_t length, const uint8_t* needle, size_t needle_length,
+                                 bool fold_case) {
+    if (needle_length > length) {
+        return NULL;
+    }
+    size_t last = needle_length - 1;
+    size_t i = 0;
+#if defined(CKG_SIMD_SSE2)
+    const __m128i first_byte = _mm_set1_epi8((char)needle[0]);
+    const __m128i last_byte = _mm_set1_epi8((char)needle[last]);
+    for (; i + last + 16 <= length; i += 16) {
+        __m128i head = _mm_loadu_si128((const __m128i*)(const void*)(text + i));
+        __m128i tail = _mm_loadu_si128((const __m128i*)(const void*)(text + i + last));
+        if (fold_case) {
+            head = fold16(head);
+            tail = fold16(tail);
+        }
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first_byte), _mm_cmpeq_epi8(tail, last_byte)));
+        while (mask) {
+            size_t at = i + lowest_bit(mask);
+            if (last < 2 || same_bytes(text + at + 1, needle + 1, last - 1, fold_case)) {
+                return text + at;
+            }
+            mask &= mask - 1;
+        }
+    }
+#elif defined(CKG_SIMD_NEON)
+    const uint8x16_t first_byte = vdupq_n_u8(needle[0]);
+    const uint8x16_t last_byte = vdupq_n_u8(needle[last]);
+    for (; i + last + 16 <= length; i += 16) {
+        uint8x16_t head = vld1q_u8(text + i);
+        uint8x16_t tail = vld1q_u8(text + i + last);
+        if (fold_case) {
+            head = fold16(head);
+            tail = fold16(tail);
+        }
+        uint8x16_t hits = vandq_u8(vceqq_u8(head, first_byte), vceqq_u8(tail, last_byte));
+        // Four bits per position
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        while (mask) {
+            uint32_t bit = lowest_bit(mask);
+            size_t at = i + bit / 4;
+            if (last < 2 || same_bytes(text + at + 1, needle + 1, last - 1, fold_case)) {
+                return text + at;
+            }
+            mask &= ~(0xFULL << (bit & ~3u));
+        }
+    }
+#endif
+    for (; i + last < length; i++) {
+        uint8_t head = fold_case ? fold(text[i]) : text[i];
+        uint8_t tail = fold_case ? fold(text[i + last]) : text[i + last];
+        if (head == needle[0] && tail == needle[last] &&
+            (last < 2 || same_bytes(text + i + 1, needle + 1, last - 1, fold_case))) {
+            return text + i;
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    const uint8_t* needle;
+    size_t needle_length;
+    bool fold_case;
+    bool files_only;
+    uint32_t max_matches;
+    CKGTextMatchCallback callback;
+    void* user_data;
+    uint32_t reported;
+    bool stopped;
+} TextSearch;
+
+// Report the pattern's occurrences in one mapped file, a line at a time
+static void search_file(TextSearch* search, const char* path, uint32_t path_length, const uint8_t* data,
+                        uint64_t length) {
+    const uint8_t* end = data + length;
+    const uint8_t* position = data;
+    const uint8_t* counted = data;
+    const uint8_t* line_start = data;
+    uint32_t line = 1;
+    while (!search->stopped && position < end) {
+        const uint8_t* hit = find_bytes(position, (size_t)(end - position), search->needle, search->needle_length,
+                                        search->fold_case);
+        if (!hit) {
+            break;
+        }
+        for (const uint8_t* newline; (newline = (const uint8_t*)memchr(counted, '\n', (size_t)(hit - counted))) != NULL;
+             counted = newline + 1) {
+            line++;
+            line_start = newline + 1;
+        }
+        counted = hit;
+        const uint8_t* line_end = (const uint8_t*)memchr(hit, '\n', (size_t)(end - hit));
+        if (!line_end) {
+            line_end = end;
+        }
+        const uint8_t* text_end = line_end > line_start && line_end[-1] == '\r' ? line_end - 1 : line_end;
+
+        CKGTextMatch match;
+        match.file_path = path;
+        match.file_path_length = path_length;
+        match.line = line;
+        match.column = (uint32_t)(hit - line_start) + 1;
+        match.offset = (uint64_t)(hit - data);
+        match.line_text = (const char*)line_start;
+        match.line_length = text_end > line_start ? (uint32_t)(text_end - line_start) : 0;
+        search->reported++;
+        if (!search->callback(search->user_data, &match) ||
+            (search->max_matches && search->reported == search->max_matches)) {
+            search->stopped = true;
+        }
+        if (search->files_only) {
+            break;
+        }
+        // On to the next line; a pattern starting with a line break still
+        // moves past its own
+        position = line_end > hit ? line_end + 1 : hit + 1;
+    }
+}
+
+CKG_API int ckg_text_index_search(const CKGTextIndex* index, const char* pattern, uint32_t flags, uint32_t max_matches,
+                                  CKGTextMatchCallback callback, void* user_data) {
+    if (!index || !pattern || !callback) {
+        return -1;
+    }
+    size_t pattern_length = strlen(pattern);
+    bool files_only = (flags & CKG_TEXT_FILES_ONLY) != 0;
+    if (pattern_length == 0 && !files_only) {
+        return -1;
+    }
+
+    uint32_t* candidates = NULL;
+    uint32_t candidate_count = 0;
+    bool all = false;
+    if (!ckg_trigram_candidates(&index->trigrams, pattern, pattern_length, &candidates, &candidate_count, &all)) {
+        return -1;
+    }
+    uint8_t* needle = (uint8_t*)malloc(pattern_length + 1);
+    if (!needle) {
+        free(candidates);
+        return -1;
+    }
+    bool fold_case = (flags & CKG_TEXT_IGNORE_CASE) != 0;
+    for (size_t i = 0; i < pattern_length; i++) {
+        needle[i] = fold_case ? fold((unsigned char)pattern[i]) : (uint8_t)pattern[i];
+    }
+
+    TextSearch search = {needle, pattern_length, fold_case, files_only, max_matches, callback, user_data, 0, false};
+    uint32_t count = all ? index->file_count : candidate_count;
+    for (uint32_t i = 0; i < count && !search.stopped; i++) {
+        const char* path;
+        uint32_t path_length;
+        if (!file_path_at(index, all ? i : candidates[i], &path, &path_length)) {
+            continue;
+        }
+        if (pattern_length == 0) {
+            CKGTextMatch match = {path, path_length, 0, 0, 0, NULL, 0};
+            search.reported++;
+            search.stopped = !callback(user_data, &match) || (max_matches && search.reported == max_matches);
+            continue;
+        }
+        // Files that have gone since the index was written are skipped
+        CKGMappedFile file;
+        if (ckg_map_file(path, &file)) {
+            search_file(&search, path, path_length, (const uint8_t*)file.data, file.length);
+            ckg_unmap_file(&file);
+        }
+    }
+
+    free(needle);
+    free(candidates);
+    return (int)search.reported;
+}
@@ -0,0 +1,102 @@
+#define BUILDING_CKG_DLL
+#include <stdlib.h>
+#include "ckg_platform.h"
+#include "ckg_trace.h"
+
+// One single-producer ring per thread: only the owning thread advances head
+// and only the drainer advances tail, so neither side needs a lock. Rings
+// are linked into a global list when created and live for the rest of the
+// process; a ring released by an exiting thread is adopted by the next new
+// one, so the list is bounded by the peak number of tracing threads.
+
+#define TRACE_RING_SIZE 4096    // Events per thread; a power of two
+
+typedef struct TraceRing {
+    CKGTraceEvent events[TRACE_RING_SIZE];
+    volatile uint64_t head;     // Next slot the owner writes
+    volatile uint64_t tail;     // Next slot the drainer reads
+    volatile int32_t owned;
+    uint32_t thread_id;
+    struct TraceRing* next;
+} TraceRing;
+
+static void* volatile trace_rings;
+static volatile int32_t trace_thread_ids;
+static volatile int32_t trace_draining;
+static CKG_THREAD_LOCAL TraceRing* thread_ring;
+
+static TraceRing* acquire_ring(void) {
+    for (TraceRing* ring = (TraceRing*)ckg_atomic_load_ptr(&trace_rings); ring; ring = ring->next) {
+        if (ckg_atomic_load32(&ring->owned) == 0 && ckg_atomic_cas32(&ring->owned, 0, 1)) {
+            ring->thread_id = (uint32_t)ckg_atomic_add32(&trace_thread_ids, 1);
+            return ring;
+        }
+    }
+
+    TraceRing* ring = (TraceRing*)calloc(1, sizeof(TraceRing));
+    if (!ring) {
+        return NULL;
+    }
+    ring->owned = 1;
+    ring->thread_id = (uint32_t)ckg_atomic_add32(&trace_thread_ids, 1);
+    do {
+        ring->next = (TraceRing*)ckg_atomic_load_ptr(&trace_rings);
+    } while (!ckg_atomic_cas_ptr(&trace_rings, ring->next, ring));
+    return ring;
+}
+
+void ckg_trace_emit(int level, CKGTraceEventKind kind, uint64_t arg0, uint64_t arg1) {
+    TraceRing* ring = thread_ring;
+    if (!ring) {
+        ring = thread_ring = acquire_ring();
+        if (!ring) {
+            return;
+        }
+    }
+
+    uint64_t head = ring->head;
+    if (head - ckg_atomic_load64(&ring->tail) >= TRACE_RING_SIZE) {
+        return;
+    }
+    CKGTraceEvent* event = &ring->events[head & (TRACE_RING_SIZE - 1)];
+    event->timestamp_ns = ckg_now_ns();
+    event->arg0 = arg0;
+    event->arg1 = arg1;
+    event->thread_id = ring->thread_id;
+    event->level = (uint16_t)level;
+    event->kind = (uint16_t)kind;
+    // Publish the event only after it is fully written
+    ckg_atomic_store64(&ring->head, head + 1);
+}
+
+void ckg_trace_release_thread(void) {
+    if (thread_ring) {
+        ckg_atomic_store32(&thread_ring->owned, 0);
+        thread_ring = NULL;
+    }
+}
+
+CKG_API uint32_t ckg_trace_drain(CKGTraceEvent* events, uint32_t capacity) {
+    if (!events || capacity == 0 || !ckg_atomic_cas32(&trace_draining, 0, 1)) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    for (TraceRing* ring = (TraceRing*)ckg_atomic_load_ptr(&trace_rings); ring && count < capacity; ring = ring->next) {
+        uint64_t tail = ring->tail;
+        uint64_t head = ckg_atomic_load64(&ring->head);
+        while (tail < head && count < capacity) {
+            events[count++] = ring->events[tail & (TRACE_RING_SIZE - 1)];
+            tail++;
+        }
+        // Free the slots only after they have been copied
+        ckg_atomic_store64(&ring->tail, tail);
+    }
+
+    ckg_atomic_store32(&trace_draining, 0);
+    return count;
+}
+
+CKG_API int ckg_trace_level(void) {
+    return CKG_TRACE_LEVEL;
+}
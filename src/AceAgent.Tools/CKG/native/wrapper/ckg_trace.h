@@ -0,0 +1,48 @@
+#ifndef CKG_TRACE_H
+#define CKG_TRACE_H
+
+// Compile-time leveled tracing. The CKG_TRACE_* macros expand to nothing
+// unless their level is compiled in (CKG_TRACE_LEVEL, set by CMake, default
+// 0), so disabled events cost nothing, not even argument evaluation. Enabled
+// events are written without locks into a ring buffer owned by the emitting
+// thread and collected with ckg_trace_drain; a full ring drops new events
+// rather than blocking the parser.
+
+#include <stdint.h>
+#include "ckg_wrapper.h"
+
+#ifndef CKG_TRACE_LEVEL
+#define CKG_TRACE_LEVEL 0
+#endif
+
+#define CKG_TRACE_LEVEL_ERROR 1
+#define CKG_TRACE_LEVEL_INFO  2
+#define CKG_TRACE_LEVEL_DEBUG 3     // Per-node events
+
+// One macro per level; levels above CKG_TRACE_LEVEL are removed by the
+// preprocessor
+#if CKG_TRACE_LEVEL >= CKG_TRACE_LEVEL_ERROR
+#define CKG_TRACE_ERROR(kind, arg0, arg1) ckg_trace_emit(CKG_TRACE_LEVEL_ERROR, (kind), (uint64_t)(arg0), (uint64_t)(arg1))
+#else
+#define CKG_TRACE_ERROR(kind, arg0, arg1) ((void)0)
+#endif
+
+#if CKG_TRACE_LEVEL >= CKG_TRACE_LEVEL_INFO
+#define CKG_TRACE_INFO(kind, arg0, arg1) ckg_trace_emit(CKG_TRACE_LEVEL_INFO, (kind), (uint64_t)(arg0), (uint64_t)(arg1))
+#else
+#define CKG_TRACE_INFO(kind, arg0, arg1) ((void)0)
+#endif
+
+#if CKG_TRACE_LEVEL >= CKG_TRACE_LEVEL_DEBUG
+#define CKG_TRACE_DEBUG(kind, arg0, arg1) ckg_trace_emit(CKG_TRACE_LEVEL_DEBUG, (kind), (uint64_t)(arg0), (uint64_t)(arg1))
+#else
+#define CKG_TRACE_DEBUG(kind, arg0, arg1) ((void)0)
+#endif
+
+void ckg_trace_emit(int level, CKGTraceEventKind kind, uint64_t arg0, uint64_t arg1);
+
+// Hand the calling thread's ring back for reuse by a later thread. Called
+// by pool workers before they exit; undrained events are kept.
+void ckg_trace_release_thread(void);
+
+#endif // CKG_TRACE_H
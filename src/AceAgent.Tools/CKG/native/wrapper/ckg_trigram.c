@@ -0,0 +1,397 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ckg_internal.h"
+
+// Trigram posting lists. A trigram is three consecutive bytes with ASCII
+// letters lowercased, packed into 24 bits, and a document (a file, a name)
+// is listed under every trigram it contains, so text can only occur in the
+// documents listed under all of its trigrams. Each list holds ascending
+// values as LEB128 deltas, a byte or two per document in practice. Sets of
+// trigrams are collected in a bitmap over all 2^24 of them, which makes
+// deduplication one bit test per byte of text and lets the builder number
+// the trigrams that occur densely without hashing.
+
+#define TRIGRAM_SPACE (1u << 24)
+#define BITMAP_WORDS (TRIGRAM_SPACE / 64)
+
+// Past this many trigrams a text's set is read back from the bitmap in
+// order, which is cheaper than sorting it
+#define SCAN_THRESHOLD 16384
+
+static inline uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static inline uint8_t* put_u64(uint8_t* out, uint64_t value) {
+    put_u32(out, (uint32_t)value);
+    return put_u32(out + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint32_t get_u32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t* in) {
+    return (uint64_t)get_u32(in) | ((uint64_t)get_u32(in + 4) << 32);
+}
+
+static inline uint32_t fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? (uint32_t)c + 32 : c;
+}
+
+static inline uint32_t bit_count(uint64_t word) {
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (uint32_t)((word * 0x0101010101010101ULL) >> 56);
+}
+
+static inline uint32_t varint_length(uint32_t value) {
+    uint32_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+static inline uint8_t* put_varint(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+// Read a varint at *position, which must stay below `end`; false if damaged
+static inline bool get_varint(const uint8_t* data, uint64_t* position, uint64_t end, uint32_t* value) {
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        if (*position >= end) {
+            return false;
+        }
+        uint8_t byte = data[(*position)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t left = *(const uint32_t*)a;
+    uint32_t right = *(const uint32_t*)b;
+    return left < right ? -1 : left > right ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Collecting
+
+void ckg_trigram_set_free(CKGTrigramSet* set) {
+    free(set->seen);
+    free(set->trigrams);
+    memset(set, 0, sizeof(*set));
+}
+
+bool ckg_trigram_extract(CKGTrigramSet* set, const char* text, uint64_t length) {
+    set->count = 0;
+    if (length < 3) {
+        return true;
+    }
+    if (!set->seen) {
+        set->seen = (uint64_t*)calloc(BITMAP_WORDS, sizeof(uint64_t));
+        if (!set->seen) {
+            return false;
+        }
+    }
+
+    const unsigned char* bytes = (const unsigned char*)text;
+    uint32_t trigram = (fold(bytes[0]) << 8) | fold(bytes[1]);
+    uint32_t count = 0;
+    bool ok = true;
+    for (uint64_t i = 2; i < length; i++) {
+        trigram = ((trigram << 8) | fold(bytes[i])) & (TRIGRAM_SPACE - 1);
+        uint64_t* word = &set->seen[trigram >> 6];
+        uint64_t bit = 1ULL << (trigram & 63);
+        if (*word & bit) {
+            continue;
+        }
+        if (count == set->capacity) {
+            uint32_t capacity = set->capacity ? set->capacity * 2 : 1024;
+            uint32_t* trigrams = (uint32_t*)realloc(set->trigrams, (size_t)capacity * sizeof(uint32_t));
+            if (!trigrams) {
+                ok = false;
+                break;
+            }
+            set->trigrams = trigrams;
+            set->capacity = capacity;
+        }
+        *word |= bit;
+        set->trigrams[count++] = trigram;
+    }
+
+    // Leave the bitmap clear for the next text
+    if (ok && count > SCAN_THRESHOLD) {
+        uint32_t found = 0;
+        for (uint32_t w = 0; w < BITMAP_WORDS; w++) {
+            uint64_t word = set->seen[w];
+            set->seen[w] = 0;
+            for (uint32_t b = 0; word; b++, word >>= 1) {
+                if (word & 1) {
+                    set->trigrams[found++] = w * 64 + b;
+                }
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            set->seen[set->trigrams[i] >> 6] = 0;
+        }
+        qsort(set->trigrams, count, sizeof(uint32_t), compare_u32);
+    }
+    set->count = ok ? count : 0;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Building
+
+// Dense number of a trigram among those present
+static inline uint32_t dense_id(const uint64_t* present, const uint32_t* rank, uint32_t trigram) {
+    uint64_t below = present[trigram >> 6] & ((1ULL << (trigram & 63)) - 1);
+    return rank[trigram >> 6] + bit_count(below);
+}
+
+bool ckg_trigram_build(uint32_t document_count, const uint32_t* values, CKGTrigramSource source, void* user_data,
+                       CKGTrigramPostings* postings) {
+    memset(postings, 0, sizeof(*postings));
+    uint64_t* present = (uint64_t*)calloc(BITMAP_WORDS, sizeof(uint64_t));
+    uint32_t* rank = (uint32_t*)malloc(BITMAP_WORDS * sizeof(uint32_t));
+    uint32_t* counts = NULL;
+    uint32_t* last = NULL;
+    uint64_t* cursors = NULL;
+    bool ok = present && rank;
+
+    // Pass 1: which trigrams occur, numbered densely in trigram order
+    for (uint32_t document = 0; ok && document < document_count; document++) {
+        const uint32_t* trigrams = NULL;
+        uint32_t count = 0;
+        ok = source(user_data, document, &trigrams, &count);
+        for (uint32_t i = 0; ok && i < count; i++) {
+            present[trigrams[i] >> 6] |= 1ULL << (trigrams[i] & 63);
+        }
+    }
+    uint32_t trigram_count = 0;
+    for (uint32_t w = 0; ok && w < BITMAP_WORDS; w++) {
+        rank[w] = trigram_count;
+        trigram_count += bit_count(present[w]);
+    }
+    if (ok) {
+        size_t slots = trigram_count ? trigram_count : 1;
+        counts = (uint32_t*)calloc(slots, sizeof(uint32_t));
+        last = (uint32_t*)calloc(slots, sizeof(uint32_t));
+        cursors = (uint64_t*)calloc(slots, sizeof(uint64_t));
+        ok = counts && last && cursors;
+    }
+
+    // Pass 2: the size of each list
+    for (uint32_t document = 0; ok && document < document_count; document++) {
+        const uint32_t* trigrams = NULL;
+        uint32_t count = 0;
+        uint32_t value = values ? values[document] : document;
+        ok = source(user_data, document, &trigrams, &count);
+        for (uint32_t i = 0; ok && i < count; i++) {
+            uint32_t id = dense_id(present, rank, trigrams[i]);
+            cursors[id] += varint_length(counts[id] ? value - last[id] : value);
+            counts[id]++;
+            last[id] = value;
+        }
+    }
+
+    // Lay the lists out back to back and write the table
+    uint64_t total = 0;
+    if (ok) {
+        postings->table = (uint8_t*)malloc((size_t)(trigram_count ? trigram_count : 1) * CKG_TRIGRAM_RECORD_SIZE);
+        ok = postings->table != NULL;
+    }
+    if (ok) {
+        uint8_t* out = postings->table;
+        for (uint32_t w = 0; w < BITMAP_WORDS; w++) {
+            for (uint32_t b = 0, id = rank[w]; b < 64; b++) {
+                if (!(present[w] & (1ULL << b))) {
+                    continue;
+                }
+                uint64_t size = cursors[id];
+                cursors[id] = total;
+                out = put_u32(out, w * 64 + b);
+                out = put_u32(out, counts[id]);
+                out = put_u64(out, total);
+                total += size;
+                counts[id] = 0;
+                id++;
+            }
+        }
+        postings->postings = (uint8_t*)malloc(total ? (size_t)total : 1);
+        ok = postings->postings != NULL;
+    }
+
+    // Pass 3: fill the lists
+    for (uint32_t document = 0; ok && document < document_count; document++) {
+        const uint32_t* trigrams = NULL;
+        uint32_t count = 0;
+        uint32_t value = values ? values[document] : document;
+        ok = source(user_data, document, &trigrams, &count);
+        for (uint32_t i = 0; ok && i < count; i++) {
+            uint32_t id = dense_id(present, rank, trigrams[i]);
+            uint8_t* out = postings->postings + cursors[id];
+            cursors[id] = (uint64_t)(put_varint(out, counts[id] ? value - last[id] : value) - postings->postings);
+            counts[id]++;
+            last[id] = value;
+        }
+    }
+
+    if (ok) {
+        postings->trigram_count = trigram_count;
+        postings->postings_size = total;
+    } else {
+        free(postings->table);
+        free(postings->postings);
+        memset(postings, 0, sizeof(*postings));
+    }
+    free(cursors);
+    free(last);
+    free(counts);
+    free(rank);
+    free(present);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Searching
+
+typedef struct {
+    uint64_t offset;
+    uint32_t count;
+} PostingList;
+
+static int compare_lists(const void* a, const void* b) {
+    uint32_t left = ((const PostingList*)a)->count;
+    uint32_t right = ((const PostingList*)b)->count;
+    return left < right ? -1 : left > right ? 1 : 0;
+}
+
+static bool find_list(const CKGTrigramIndex* index, uint32_t trigram, PostingList* list) {
+    uint32_t low = 0;
+    uint32_t high = index->trigram_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        const uint8_t* record = index->table + (uint64_t)middle * CKG_TRIGRAM_RECORD_SIZE;
+        uint32_t found = get_u32(record);
+        if (found == trigram) {
+            list->count = get_u32(record + 4);
+            list->offset = get_u64(record + 8);
+            return true;
+        }
+        if (found < trigram) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+bool ckg_trigram_candidates(const CKGTrigramIndex* index, const char* text, uint64_t length, uint32_t** candidates_out,
+                            uint32_t* count_out, bool* all_out) {
+    *candidates_out = NULL;
+    *count_out = 0;
+    *all_out = length < 3;
+    if (*all_out) {
+        return true;
+    }
+
+    // The text's distinct trigrams, then their lists, shortest first
+    uint64_t trigram_count = length - 2;
+    PostingList* lists = (PostingList*)malloc((size_t)trigram_count * sizeof(PostingList));
+    uint32_t* trigrams = (uint32_t*)malloc((size_t)trigram_count * sizeof(uint32_t));
+    if (!lists || !trigrams) {
+        free(lists);
+        free(trigrams);
+        return false;
+    }
+    const unsigned char* bytes = (const unsigned char*)text;
+    for (uint64_t i = 0; i < trigram_count; i++) {
+        trigrams[i] = (fold(bytes[i]) << 16) | (fold(bytes[i + 1]) << 8) | fold(bytes[i + 2]);
+    }
+    qsort(trigrams, (size_t)trigram_count, sizeof(uint32_t), compare_u32);
+    uint32_t list_count = 0;
+    bool absent = false;
+    for (uint64_t i = 0; i < trigram_count && !absent; i++) {
+        if (i > 0 && trigrams[i] == trigrams[i - 1]) {
+            continue;
+        }
+        absent = !find_list(index, trigrams[i], &lists[list_count]);
+        list_count++;
+    }
+    free(trigrams);
+    if (absent) {
+        free(lists);
+        return true;
+    }
+    qsort(lists, list_count, sizeof(PostingList), compare_lists);
+
+    uint32_t* candidates = (uint32_t*)malloc((size_t)(lists[0].count ? lists[0].count : 1) * sizeof(uint32_t));
+    bool ok = candidates != NULL && lists[0].offset <= index->postings_size;
+    uint32_t count = 0;
+    uint64_t position = lists[0].offset;
+    uint32_t value = 0;
+    for (uint32_t n = 0; ok && n < lists[0].count; n++) {
+        uint32_t delta = 0;
+        ok = get_varint(index->postings, &position, index->postings_size, &delta);
+        if (!ok) {
+            break;
+        }
+        value = n ? value + delta : delta;
+        candidates[count++] = value;
+    }
+
+    // Keep the candidates every other list has, stepping through each list
+    // alongside them
+    for (uint32_t l = 1; ok && l < list_count && count > 0; l++) {
+        ok = lists[l].offset <= index->postings_size;
+        position = lists[l].offset;
+        uint32_t kept = 0;
+        uint32_t next = 0;
+        for (uint32_t n = 0; ok && n < lists[l].count && next < count; n++) {
+            uint32_t delta = 0;
+            ok = get_varint(index->postings, &position, index->postings_size, &delta);
+            if (!ok) {
+                break;
+            }
+            value = n ? value + delta : delta;
+            while (next < count && candidates[next] < value) {
+                next++;
+            }
+            if (next < count && candidates[next] == value) {
+                candidates[kept++] = value;
+                next++;
+            }
+        }
+        count = kept;
+    }
+    free(lists);
+
+    if (!ok || count == 0) {
+        free(candidates);
+        return ok;
+    }
+    *candidates_out = candidates;
+    *count_out = count;
+    return true;
+}
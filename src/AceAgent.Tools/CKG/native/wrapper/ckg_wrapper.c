@@ -9,6 +9,14 @@
 #endif
 #include "tree_sitter/api.h"
 #include "ckg_wrapper.h"
+#include "ckg_internal.h"
+#include "ckg_arena.h"
+#include "ckg_json.h"
+#include "ckg_trace.h"
+#include "ckg_platform.h"
+#include "ckg_fs.h"
+#include "ckg_encoding.h"
+#include "ckg_hash.h"
 
 // External language declarations
 extern const TSLanguage *tree_sitter_c_sharp(void);
@@ -20,37 +28,49 @@ extern const TSLanguage *tree_sitter_java(void);
 extern const TSLanguage *tree_sitter_typescript(void);
 extern const TSLanguage *tree_sitter_go(void);
 
-static TSParser *parser = NULL;
 static bool initialized = false;
 
-// Internal structures for parsing
-typedef struct {
-    char name[256];
-    int start_line;
-    int end_line;
-} ExtractedClass;
+// Context used by the legacy entry points that do not take a context
+static CKGContext* default_context = NULL;
 
-typedef struct {
-    char name[256];
-    char class_name[256];
-    int start_line;
-    int end_line;
-} ExtractedFunction;
+// Create a parsing context
+CKG_API CKGContext* ckg_context_create(void) {
+    CKGContext* ctx = (CKGContext*)calloc(1, sizeof(CKGContext));
+    if (!ctx) {
+        return NULL;
+    }
+    
+    ctx->query_cursor = ts_query_cursor_new();
+    if (!ctx->query_cursor) {
+        ckg_context_destroy(ctx);
+        return NULL;
+    }
+    
+    return ctx;
+}
 
-typedef struct {
-    ExtractedClass* classes;
-    int class_count;
-    int class_capacity;
-    ExtractedFunction* functions;
-    int function_count;
-    int function_capacity;
-} ParsedData;
-
-// Forward declarations
-static char* get_node_text(TSNode node, const char* source_code);
-static void add_class(ParsedData* data, const char* name, int start_line, int end_line);
-static void add_function(ParsedData* data, const char* name, const char* class_name, int start_line, int end_line);
-static void walk_tree(TSNode node, const char* source_code, ParsedData* data, const char* current_class);
+// Destroy a parsing context and its scratch buffers
+CKG_API void ckg_context_destroy(CKGContext* ctx) {
+    if (!ctx) {
+        return;
+    }
+    
+    if (ctx->query_cursor) {
+        ts_query_cursor_delete(ctx->query_cursor);
+    }
+    for (int i = 0; i < CKG_LANGUAGE_COUNT; i++) {
+        if (ctx->parsers[i]) {
+            ts_parser_delete(ctx->parsers[i]);
+        }
+        ckg_symbol_table_free(&ctx->symbol_tables[i]);
+    }
+    ckg_documents_free(ctx);
+    if (ctx->scratch.classes) free(ctx->scratch.classes);
+    if (ctx->scratch.functions) free(ctx->scratch.functions);
+    if (ctx->scratch.scopes) free(ctx->scratch.scopes);
+    if (ctx->scratch.open_classes) free(ctx->scratch.open_classes);
+    free(ctx);
+}
 
 // Initialize the CKG wrapper
 CKG_API int ckg_init(void) {
@@ -58,9 +78,16 @@ CKG_API int ckg_init(void) {
         return 1;
     }
     
-    // Create a real Tree-sitter parser
-    parser = ts_parser_new();
-    if (!parser) {
+    // Compile the extraction queries once; contexts share them read-only
+    ckg_queries_init();
+    if (!ckg_registry_init()) {
+        return 0;
+    }
+    ckg_cache_init();
+    ckg_disk_cache_init();
+    
+    default_context = ckg_context_create();
+    if (!default_context) {
         return 0;
     }
     
@@ -70,10 +97,13 @@ CKG_API int ckg_init(void) {
 
 // Cleanup resources
 CKG_API void ckg_cleanup(void) {
-    if (parser) {
-        ts_parser_delete(parser);
-        parser = NULL;
+    if (default_context) {
+        ckg_context_destroy(default_context);
+        default_context = NULL;
     }
+    ckg_cache_cleanup();
+    ckg_disk_cache_cleanup();
+    ckg_queries_cleanup();
     initialized = false;
 }
 
@@ -100,33 +130,8 @@ CKG_API bool ckg_is_language_supported(CKGLanguage language) {
     }
 }
 
-// Get language parser based on file extension
-static const TSLanguage* get_language_from_extension(const char* extension) {
-    if (!extension) return NULL;
-    
-    if (strcmp(extension, ".cs") == 0) {
-        return tree_sitter_c_sharp();
-    } else if (strcmp(extension, ".js") == 0 || strcmp(extension, ".jsx") == 0) {
-        return tree_sitter_javascript();
-    } else if (strcmp(extension, ".py") == 0) {
-        return tree_sitter_python();
-    } else if (strcmp(extension, ".c") == 0 || strcmp(extension, ".h") == 0) {
-        return tree_sitter_c();
-    } else if (strcmp(extension, ".cpp") == 0 || strcmp(extension, ".cc") == 0 || strcmp(extension, ".cxx") == 0 || strcmp(extension, ".hpp") == 0) {
-        return tree_sitter_cpp();
-    } else if (strcmp(extension, ".java") == 0) {
-        return tree_sitter_java();
-    } else if (strcmp(extension, ".ts") == 0 || strcmp(extension, ".tsx") == 0) {
-        return tree_sitter_typescript();
-    } else if (strcmp(extension, ".go") == 0) {
-        return tree_sitter_go();
-    }
-    
-    return NULL;
-}
-
 // Get tree-sitter language for CKG language
-static const TSLanguage* get_ts_language(CKGLanguage language) {
+const TSLanguage* ckg_ts_language(CKGLanguage language) {
     switch (language) {
         case CKG_LANG_C:
             return tree_sitter_c();
@@ -149,395 +154,872 @@ static const TSLanguage* get_ts_language(CKGLanguage language) {
     }
 }
 
-// Parse source code and return results
+// Parse source code with the default context
 CKG_API CKGParseResult* ckg_parse(CKGLanguage language, const char* source_code, const char* file_path) {
-    if (!initialized || !parser || !source_code) {
+    if (!initialized) {
         return NULL;
     }
     
-    const TSLanguage* ts_language = get_ts_language(language);
-    if (!ts_language) {
-        CKGParseResult* result = (CKGParseResult*)malloc(sizeof(CKGParseResult));
-        if (result) {
-            result->function_count = 0;
-            result->class_count = 0;
-            result->property_count = 0;
-            result->field_count = 0;
-            result->variable_count = 0;
-            result->functions = NULL;
-            result->classes = NULL;
-            result->properties = NULL;
-            result->fields = NULL;
-            result->variables = NULL;
-            result->error_message = strdup("Unsupported language");
-        }
-        return result;
+    return ckg_parse_with_context(default_context, language, source_code, file_path);
+}
+
+// Parse source code using the given context and return results
+CKG_API CKGParseResult* ckg_parse_with_context(CKGContext* ctx, CKGLanguage language, const char* source_code, const char* file_path) {
+    (void)file_path;
+    if (!ctx || !source_code) {
+        return NULL;
     }
     
-    // Set the language for the parser
-    bool set_result = ts_parser_set_language(parser, ts_language);
-    if (!set_result) {
-        CKGParseResult* result = (CKGParseResult*)malloc(sizeof(CKGParseResult));
-        if (result) {
-            result->function_count = 0;
-            result->class_count = 0;
-            result->property_count = 0;
-            result->field_count = 0;
-            result->variable_count = 0;
-            result->functions = NULL;
-            result->classes = NULL;
-            result->properties = NULL;
-            result->fields = NULL;
-            result->variables = NULL;
-            result->error_message = strdup("Failed to set language");
-        }
-        return result;
+    return ckg_parse_source(ctx, language, source_code, (uint32_t)strlen(source_code), true);
+}
+
+// Parse without copying names; results carry spans into source_code
+CKG_API CKGParseResult* ckg_parse_spans(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length) {
+    if (!ctx || !source_code) {
+        return NULL;
     }
     
-    // Parse the source code
-    printf("Parsing source code with length: %zu\n", strlen(source_code));
-    TSTree* tree = ts_parser_parse_string(parser, NULL, source_code, strlen(source_code));
-    if (!tree) {
-        printf("Failed to parse source code\n");
-        CKGParseResult* result = (CKGParseResult*)malloc(sizeof(CKGParseResult));
-        if (result) {
-            result->function_count = 0;
-            result->class_count = 0;
-            result->property_count = 0;
-            result->field_count = 0;
-            result->variable_count = 0;
-            result->functions = NULL;
-            result->classes = NULL;
-            result->properties = NULL;
-            result->fields = NULL;
-            result->variables = NULL;
-            result->error_message = strdup("Failed to parse code");
+    return ckg_parse_source(ctx, language, source_code, length, false);
+}
+
+// Allocate a result carrying only an error message, in a single block
+CKGParseResult* ckg_create_error_result(const char* message) {
+    CKGArena arena;
+    if (!ckg_arena_init(&arena, ckg_arena_footprint(sizeof(CKGParseResult)) + strlen(message) + 1)) {
+        return NULL;
+    }
+    CKGParseResult* result = (CKGParseResult*)ckg_arena_alloc(&arena, sizeof(CKGParseResult));
+    result->error_message = ckg_arena_strdup(&arena, message);
+    result->status = CKG_STATUS_ERROR;
+    return result;
+}
+
+// Build a result that lives in one arena block: the header first, then the
+// arrays, then (when copy_names is set) every name copied out of the
+// source. Consecutive functions of the same class share one copy of the
+// class name.
+static CKGParseResult* build_result(const ParsedData* data, const char* source_code, bool copy_names, size_t* size_out) {
+    size_t size = ckg_arena_footprint(sizeof(CKGParseResult)) +
+                  ckg_arena_footprint((size_t)data->function_count * sizeof(CKGFunction)) +
+                  ckg_arena_footprint((size_t)data->class_count * sizeof(CKGClass));
+    if (copy_names) {
+        for (int i = 0; i < data->function_count; i++) {
+            size += data->functions[i].name.length + 1;
+            size += data->functions[i].class_name.length + 1;
+        }
+        for (int i = 0; i < data->class_count; i++) {
+            size += data->classes[i].name.length + 1;
         }
-        return result;
     }
-    printf("Parse successful, tree created\n");
-    
-    CKGParseResult* result = (CKGParseResult*)malloc(sizeof(CKGParseResult));
-    if (!result) {
-        ts_tree_delete(tree);
+
+    CKGArena arena;
+    if (!ckg_arena_init(&arena, size)) {
+        return NULL;
+    }
+    *size_out = size;
+    CKGParseResult* result = (CKGParseResult*)ckg_arena_alloc(&arena, sizeof(CKGParseResult));
+    if (data->function_count > 0) {
+        result->functions = (CKGFunction*)ckg_arena_alloc(&arena, (size_t)data->function_count * sizeof(CKGFunction));
+        result->function_count = (uint32_t)data->function_count;
+    }
+    if (data->class_count > 0) {
+        result->classes = (CKGClass*)ckg_arena_alloc(&arena, (size_t)data->class_count * sizeof(CKGClass));
+        result->class_count = (uint32_t)data->class_count;
+    }
+
+    // Arrays are zeroed, so only the extracted fields need setting
+    const char* previous_class = NULL;
+    CKGSpan previous_class_span = { 0, 0 };
+    for (int i = 0; i < data->function_count; i++) {
+        const ExtractedFunction* extracted = &data->functions[i];
+        CKGFunction* function = &result->functions[i];
+        function->name_span = extracted->name;
+        function->parent_class_span = extracted->class_name;
+        function->start_line = (uint32_t)extracted->start_line;
+        function->end_line = (uint32_t)extracted->end_line;
+        if (!copy_names) {
+            continue;
+        }
+
+        function->name = ckg_arena_strndup(&arena, source_code + extracted->name.offset, extracted->name.length);
+        if (extracted->class_name.length > 0) {
+            if (!previous_class || previous_class_span.offset != extracted->class_name.offset ||
+                previous_class_span.length != extracted->class_name.length) {
+                previous_class = ckg_arena_strndup(&arena, source_code + extracted->class_name.offset, extracted->class_name.length);
+                previous_class_span = extracted->class_name;
+            }
+            function->parent_class = (char*)previous_class;
+        }
+    }
+
+    for (int i = 0; i < data->class_count; i++) {
+        const ExtractedClass* extracted = &data->classes[i];
+        CKGClass* cls = &result->classes[i];
+        cls->name_span = extracted->name;
+        cls->start_line = (uint32_t)extracted->start_line;
+        cls->end_line = (uint32_t)extracted->end_line;
+        if (copy_names) {
+            cls->name = ckg_arena_strndup(&arena, source_code + extracted->name.offset, extracted->name.length);
+        }
+    }
+
+    return result;
+}
+
+// Extract symbols with the language's query, or with the cursor walker if
+// the language has none. The walker's dispatch table is built on first use
+// in this context.
+void ckg_extract(CKGContext* ctx, CKGLanguage language, const TSLanguage* ts_language, TSNode root,
+                 const CKGByteRange* ranges, uint32_t range_count, ParsedData* data) {
+    if (ckg_query_extract(ctx, language, root, ranges, range_count, data)) {
+        return;
+    }
+
+    CKGSymbolTable* table = &ctx->symbol_tables[language];
+    if (!table->node_kinds && !ckg_symbol_table_init(table, ts_language)) {
+        return;
+    }
+    ckg_extract_symbols(table, root, ranges, range_count, data);
+}
+
+CKG_API void ckg_context_set_timeout(CKGContext* ctx, uint64_t timeout_micros) {
+    if (ctx) {
+        ctx->timeout_micros = timeout_micros;
+    }
+}
+
+CKG_API void ckg_context_cancel(CKGContext* ctx) {
+    if (ctx) {
+        ckg_atomic_store32(&ctx->cancelled, 1);
+    }
+}
+
+CKG_API void ckg_context_reset_cancel(CKGContext* ctx) {
+    if (ctx) {
+        ckg_atomic_store32(&ctx->cancelled, 0);
+    }
+}
+
+CKG_API void ckg_context_set_size_policy(CKGContext* ctx, const CKGSizePolicy* policy) {
+    if (!ctx) {
+        return;
+    }
+    if (policy) {
+        ctx->size_policy = *policy;
+    } else {
+        memset(&ctx->size_policy, 0, sizeof(ctx->size_policy));
+    }
+}
+
+bool ckg_should_stop(CKGContext* ctx) {
+    if (ckg_atomic_load32(&ctx->cancelled) || (ctx->deadline_ns && ckg_now_ns() >= ctx->deadline_ns)) {
+        ctx->stopped = true;
+    }
+    return ctx->stopped;
+}
+
+static bool parse_progress(TSParseState* state) {
+    return ckg_should_stop((CKGContext*)state->payload);
+}
+
+typedef struct {
+    const char* data;
+    uint32_t length;
+} StringInput;
+
+static const char* read_string(void* payload, uint32_t byte_index, TSPoint position, uint32_t* bytes_read) {
+    (void)position;
+    const StringInput* input = (const StringInput*)payload;
+    if (byte_index >= input->length) {
+        *bytes_read = 0;
+        return "";
+    }
+    *bytes_read = input->length - byte_index;
+    return input->data + byte_index;
+}
+
+static TSInput string_input(StringInput* string) {
+    TSInput input = { string, read_string, TSInputEncodingUTF8, NULL };
+    return input;
+}
+
+TSParser* ckg_language_parser(CKGContext* ctx, CKGLanguage language) {
+    if ((int)language < 0 || language >= CKG_LANGUAGE_COUNT) {
+        return NULL;
+    }
+    TSParser* parser = ctx->parsers[language];
+    if (parser) {
+        return parser;
+    }
+    const TSLanguage* ts_language = ckg_ts_language(language);
+    if (!ts_language || !(parser = ts_parser_new())) {
+        return NULL;
+    }
+    if (!ts_parser_set_language(parser, ts_language)) {
+        ts_parser_delete(parser);
         return NULL;
     }
+    ctx->parsers[language] = parser;
+    return parser;
+}
+
+TSTree* ckg_parse_tree(CKGContext* ctx, TSParser* parser, const TSTree* old_tree, TSInput input, uint32_t length) {
+    const CKGSizePolicy* policy = &ctx->size_policy;
+    ctx->skipped = policy->skip_above && length > policy->skip_above;
+    ctx->declarations_only = policy->declarations_only_above && length > policy->declarations_only_above;
+    ctx->stopped = false;
+    ctx->deadline_ns = ctx->timeout_micros ? ckg_now_ns() + ctx->timeout_micros * 1000 : 0;
+    if (ctx->skipped || ckg_should_stop(ctx)) {
+        // Cancelled before starting; small inputs might never reach a progress check
+        return NULL;
+    }
+
+    TSParseOptions options = { ctx, parse_progress };
+    TSTree* tree = ts_parser_parse_with_options(parser, old_tree, input, options);
+    if (!tree && ctx->stopped) {
+        // A halted parser resumes on its next call unless reset
+        ts_parser_reset(parser);
+    }
+    return tree;
+}
+
+uint32_t ckg_parse_status(CKGContext* ctx, CKGStats* delta) {
+    if (ctx->skipped) {
+        delta->files_skipped++;
+        return CKG_STATUS_SKIPPED;
+    }
+    if (!ctx->stopped) {
+        return CKG_STATUS_OK;
+    }
+    if (ckg_atomic_load32(&ctx->cancelled)) {
+        delta->cancellations++;
+        return CKG_STATUS_CANCELLED;
+    }
+    delta->timeouts++;
+    return CKG_STATUS_TIMED_OUT;
+}
+
+void ckg_count_error(CKGStats* delta, CKGLanguage language) {
+    delta->errors++;
+    if (language >= 0 && language < CKG_STATS_MAX_LANGUAGES) {
+        delta->errors_by_language[language]++;
+    }
+}
+
+// Cache key for `length` bytes of contiguous source, in `key`; NULL when
+// both caches are off, so nothing is hashed
+static const CKGCacheKey* source_key(CKGCacheKey* key, CKGLanguage language, const void* source, uint32_t length,
+                                     TSInputEncoding encoding) {
+    if (!ckg_cache_enabled() && !ckg_disk_cache_enabled()) {
+        return NULL;
+    }
+    key->hash = ckg_hash64(source, length, 0);
+    key->length = length;
+    key->language = (uint16_t)language;
+    key->encoding = (uint16_t)encoding;
+    return key;
+}
+
+// Restore the symbols of a cached parse into ctx->scratch, from the tree
+// cache or else the disk cache; disk hits are kept in the tree cache too.
+// Only complete parses are cached, so a hit is an ordinary successful
+// parse. Sources the size policy skips, and cancelled contexts, go through
+// parse_tree to report that instead.
+static bool restore_cached(CKGContext* ctx, const CKGCacheKey* key, CKGStats* delta) {
+    const CKGSizePolicy* policy = &ctx->size_policy;
+    if ((policy->skip_above && key->length > policy->skip_above) || ckg_atomic_load32(&ctx->cancelled)) {
+        return false;
+    }
+    ParsedData data = ctx->scratch;
+    data.class_count = 0;
+    data.function_count = 0;
+    data.node_count = 0;
+    data.match_count = 0;
+    bool hit = false;
+    if (ckg_cache_enabled()) {
+        hit = ckg_cache_lookup(key, &data);
+        if (hit) {
+            delta->cache_hits++;
+        } else {
+            delta->cache_misses++;
+        }
+    }
+    if (!hit && ckg_disk_cache_enabled()) {
+        hit = ckg_disk_cache_lookup(key, &data);
+        if (hit) {
+            delta->disk_cache_hits++;
+            delta->cache_evictions += ckg_cache_store(key, NULL, &data);
+        } else {
+            delta->disk_cache_misses++;
+        }
+    }
+    ctx->scratch = data;
+    if (!hit) {
+        return false;
+    }
+    ctx->skipped = false;
+    ctx->stopped = false;
+    ctx->declarations_only = false;
+    delta->symbols_extracted += (uint64_t)data.function_count + (uint64_t)data.class_count;
+    return true;
+}
+
+// Parse and extract into the context's scratch buffers, recording the work
+// in `delta`. Returns NULL on success, with the symbols in ctx->scratch, or
+// an error message. A parse skipped by the size policy or stopped by the
+// deadline or cancellation also succeeds, with whatever symbols were found.
+// With a cache `key`, a cached parse of the same source is reused and a
+// complete new one is cached.
+static const char* parse_into_scratch(CKGContext* ctx, CKGLanguage language, TSInput input, uint32_t length,
+                                      const CKGCacheKey* key, CKGStats* delta) {
+    const TSLanguage* ts_language = ckg_ts_language(language);
+    if (!ts_language) {
+        ckg_count_error(delta, language);
+        return "Unsupported language";
+    }
+    if (key && restore_cached(ctx, key, delta)) {
+        return NULL;
+    }
+    TSParser* parser = ckg_language_parser(ctx, language);
+    if (!parser) {
+        ckg_count_error(delta, language);
+        return "Failed to set language";
+    }
     
-    // Initialize result structure
-    result->function_count = 0;
-    result->class_count = 0;
-    result->property_count = 0;
-    result->field_count = 0;
-    result->variable_count = 0;
-    result->functions = NULL;
-    result->classes = NULL;
-    result->properties = NULL;
-    result->fields = NULL;
-    result->variables = NULL;
-    result->error_message = NULL;
+    // Parse the source code
+    CKG_TRACE_INFO(CKG_TRACE_PARSE_BEGIN, language, length);
+    uint64_t start = ckg_now_ns();
+    TSTree* tree = ckg_parse_tree(ctx, parser, NULL, input, length);
+    uint64_t parsed = ckg_now_ns();
+    delta->parse_ns += parsed - start;
+
+    // Reuse the context's scratch buffers
+    ParsedData data = ctx->scratch;
+    data.class_count = 0;
+    data.function_count = 0;
+    data.node_count = 0;
+    data.match_count = 0;
+    ctx->scratch = data;
+
+    if (!tree) {
+        if (ctx->skipped || ctx->stopped) {
+            // No tree to extract from: a result with no symbols
+            return NULL;
+        }
+        CKG_TRACE_ERROR(CKG_TRACE_PARSE_FAILED, language, length);
+        ckg_count_error(delta, language);
+        return "Failed to parse code";
+    }
     
     // Get the root node and walk the syntax tree
     TSNode root_node = ts_tree_root_node(tree);
     
-    // Initialize parsed data
-    ParsedData data = {0};
-    
     // Walk the tree to extract functions, classes, etc.
-    printf("Starting tree walk...\n");
-    walk_tree(root_node, source_code, &data, NULL);
-    printf("Tree walk completed. Found %d functions, %d classes\n", data.function_count, data.class_count);
+    ckg_extract(ctx, language, ts_language, root_node, NULL, 0, &data);
+    ctx->scratch = data;
+    CKG_TRACE_INFO(CKG_TRACE_PARSE_END, data.function_count, data.class_count);
     
-    // Convert ParsedData to CKGParseResult
-    if (data.function_count > 0) {
-        result->functions = (CKGFunction*)malloc(data.function_count * sizeof(CKGFunction));
-        result->function_count = data.function_count;
-        
-        for (int i = 0; i < data.function_count; i++) {
-            result->functions[i].name = strdup(data.functions[i].name);
-            result->functions[i].start_line = data.functions[i].start_line;
-            result->functions[i].end_line = data.functions[i].end_line;
-            result->functions[i].return_type = NULL;
-            result->functions[i].parameters = NULL;
-            result->functions[i].start_column = 0;
-            result->functions[i].end_column = 0;
-            result->functions[i].is_public = false;
-            result->functions[i].is_private = false;
-            result->functions[i].is_protected = false;
-            result->functions[i].is_static = false;
-            result->functions[i].is_async = false;
-            result->functions[i].parent_class = NULL;
+    // Symbols are spans of the source, so the tree is only kept for the cache
+    if (key && !ctx->stopped && !ctx->declarations_only) {
+        if (ckg_disk_cache_enabled()) {
+            delta->disk_cache_evictions += ckg_disk_cache_store(key, &data);
         }
+        delta->cache_evictions += ckg_cache_store(key, tree, &data);
+    } else {
+        ts_tree_delete(tree);
     }
-    
-    if (data.class_count > 0) {
-        result->classes = (CKGClass*)malloc(data.class_count * sizeof(CKGClass));
-        result->class_count = data.class_count;
-        
-        for (int i = 0; i < data.class_count; i++) {
-            result->classes[i].name = strdup(data.classes[i].name);
-            result->classes[i].start_line = data.classes[i].start_line;
-            result->classes[i].end_line = data.classes[i].end_line;
-            result->classes[i].namespace_name = NULL;
-            result->classes[i].base_class = NULL;
-            result->classes[i].interfaces = NULL;
-            result->classes[i].start_column = 0;
-            result->classes[i].end_column = 0;
-            result->classes[i].is_public = false;
-            result->classes[i].is_private = false;
-            result->classes[i].is_protected = false;
-            result->classes[i].is_static = false;
-            result->classes[i].is_abstract = false;
-            result->classes[i].is_sealed = false;
+
+    delta->extract_ns += ckg_now_ns() - parsed;
+    delta->files_parsed++;
+    delta->bytes_parsed += length;
+    delta->nodes_visited += data.node_count;
+    delta->query_matches += data.match_count;
+    delta->symbols_extracted += (uint64_t)data.function_count + (uint64_t)data.class_count;
+    return NULL;
+}
+
+CKGParseResult* ckg_parse_source(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length, bool copy_names) {
+    if (!ctx || !source_code) {
+        return NULL;
+    }
+
+    CKGStats delta = {0};
+    CKGParseResult* result;
+    StringInput string = { source_code, length };
+    CKGCacheKey key;
+    const char* error = parse_into_scratch(ctx, language, string_input(&string), length,
+                                           source_key(&key, language, source_code, length, TSInputEncodingUTF8), &delta);
+    if (error) {
+        result = ckg_create_error_result(error);
+    } else {
+        uint64_t start = ckg_now_ns();
+        size_t size = 0;
+        result = build_result(&ctx->scratch, source_code, copy_names, &size);
+        delta.serialize_ns = ckg_now_ns() - start;
+        delta.arena_high_water = size;
+        if (result) {
+            result->status = ckg_parse_status(ctx, &delta);
         }
     }
-    
-    // Clean up parsed data
-    if (data.classes) free(data.classes);
-    if (data.functions) free(data.functions);
-    
-    ts_tree_delete(tree);
+    ckg_stats_add(ctx, &delta);
     return result;
 }
 
-// Parse source code and return JSON result
-// Simple data structures for extracted information
-// Helper function to get node text
-static char* get_node_text(TSNode node, const char* source_code) {
-    uint32_t start_byte = ts_node_start_byte(node);
-    uint32_t end_byte = ts_node_end_byte(node);
-    uint32_t length = end_byte - start_byte;
-    
-    char* text = malloc(length + 1);
-    if (text) {
-        memcpy(text, source_code + start_byte, length);
-        text[length] = '\0';
+CKG_API int ckg_parse_visit(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length, const CKGVisitor* visitor) {
+    if (!ctx || !source_code || !visitor) {
+        return -1;
+    }
+    CKGStats delta = {0};
+    const TSLanguage* ts_language = ckg_ts_language(language);
+    TSParser* parser = ts_language ? ckg_language_parser(ctx, language) : NULL;
+    if (!parser) {
+        ckg_count_error(&delta, language);
+        ckg_stats_add(ctx, &delta);
+        return -1;
+    }
+    uint64_t start = ckg_now_ns();
+    StringInput string = { source_code, length };
+    TSTree* tree = ckg_parse_tree(ctx, parser, NULL, string_input(&string), length);
+    uint64_t parsed = ckg_now_ns();
+    delta.parse_ns = parsed - start;
+    if (!tree) {
+        int status = -1;
+        if (ctx->skipped || ctx->stopped) {
+            ckg_parse_status(ctx, &delta);
+            status = 2;
+        } else {
+            ckg_count_error(&delta, language);
+        }
+        ckg_stats_add(ctx, &delta);
+        return status;
     }
-    return text;
-}
 
-// Add class to parsed data
-static void add_class(ParsedData* data, const char* name, int start_line, int end_line) {
-    if (data->class_count >= data->class_capacity) {
-        data->class_capacity = data->class_capacity == 0 ? 10 : data->class_capacity * 2;
-        data->classes = realloc(data->classes, data->class_capacity * sizeof(ExtractedClass));
+    // Symbols go straight to the visitor; only the scratch scope stack is used
+    TSNode root_node = ts_tree_root_node(tree);
+    ctx->scratch.node_count = 0;
+    ctx->scratch.match_count = 0;
+    int status = ckg_query_visit(ctx, language, root_node, &ctx->scratch, source_code, visitor);
+    if (status < 0) {
+        CKGSymbolTable* table = &ctx->symbol_tables[language];
+        if (table->node_kinds || ckg_symbol_table_init(table, ts_language)) {
+            status = ckg_visit_symbols(table, root_node, &ctx->scratch, source_code, visitor) ? 1 : 0;
+        }
     }
-    
-    if (data->classes && data->class_count < data->class_capacity) {
-        strncpy(data->classes[data->class_count].name, name, 255);
-        data->classes[data->class_count].name[255] = '\0';
-        data->classes[data->class_count].start_line = start_line;
-        data->classes[data->class_count].end_line = end_line;
-        data->class_count++;
+
+    ts_tree_delete(tree);
+    delta.extract_ns = ckg_now_ns() - parsed;
+    delta.files_parsed = 1;
+    delta.bytes_parsed = length;
+    delta.nodes_visited = ctx->scratch.node_count;
+    delta.query_matches = ctx->scratch.match_count;
+    if (status == 1 && ckg_parse_status(ctx, &delta) != CKG_STATUS_OK) {
+        status = 2;
     }
+    ckg_stats_add(ctx, &delta);
+    return status;
 }
 
-// Add function to parsed data
-static void add_function(ParsedData* data, const char* name, const char* class_name, int start_line, int end_line) {
-    if (data->function_count >= data->function_capacity) {
-        data->function_capacity = data->function_capacity == 0 ? 10 : data->function_capacity * 2;
-        data->functions = realloc(data->functions, data->function_capacity * sizeof(ExtractedFunction));
+CKG_API uint8_t* ckg_parse_binary(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length, uint32_t* size_out) {
+    if (!ctx || !source_code || !size_out) {
+        return NULL;
     }
-    
-    if (data->functions && data->function_count < data->function_capacity) {
-        strncpy(data->functions[data->function_count].name, name, 255);
-        data->functions[data->function_count].name[255] = '\0';
-        strncpy(data->functions[data->function_count].class_name, class_name ? class_name : "", 255);
-        data->functions[data->function_count].class_name[255] = '\0';
-        data->functions[data->function_count].start_line = start_line;
-        data->functions[data->function_count].end_line = end_line;
-        data->function_count++;
+
+    CKGStats delta = {0};
+    uint8_t* buffer;
+    StringInput string = { source_code, length };
+    CKGCacheKey key;
+    const char* error = parse_into_scratch(ctx, language, string_input(&string), length,
+                                           source_key(&key, language, source_code, length, TSInputEncodingUTF8), &delta);
+    if (error) {
+        buffer = ckg_binary_error(error, size_out);
+    } else {
+        uint64_t start = ckg_now_ns();
+        uint32_t status = ckg_parse_status(ctx, &delta);
+        buffer = ckg_binary_build(&ctx->scratch, source_code, status, size_out);
+        delta.serialize_ns = ckg_now_ns() - start;
+        delta.arena_high_water = buffer ? *size_out : 0;
     }
+    ckg_stats_add(ctx, &delta);
+    return buffer;
 }
 
-// Recursive function to walk the syntax tree
-static void walk_tree(TSNode node, const char* source_code, ParsedData* data, const char* current_class) {
-    const char* node_type = ts_node_type(node);
-    
-    // Debug: print node type
-    printf("Node type: %s\n", node_type);
-    
-    if (strcmp(node_type, "class_declaration") == 0) {
-        // Find the class name
-        uint32_t child_count = ts_node_child_count(node);
-        for (uint32_t i = 0; i < child_count; i++) {
-            TSNode child = ts_node_child(node, i);
-            const char* child_type = ts_node_type(child);
-            
-            if (strcmp(child_type, "identifier") == 0) {
-                char* class_name = get_node_text(child, source_code);
-                if (class_name) {
-                    TSPoint start_point = ts_node_start_point(node);
-                    TSPoint end_point = ts_node_end_point(node);
-                    add_class(data, class_name, start_point.row + 1, end_point.row + 1);
-                    
-                    // Continue walking with this class as context
-                    for (uint32_t j = 0; j < child_count; j++) {
-                        TSNode class_child = ts_node_child(node, j);
-                        walk_tree(class_child, source_code, data, class_name);
-                    }
-                    
-                    free(class_name);
-                    return;
-                }
-                break;
-            }
+CKG_API void ckg_free_binary(uint8_t* buffer) {
+    free(buffer);
+}
+
+// Writes a name's text as UTF-8 into `destination`; returns the bytes
+// written, or UINT32_MAX if the source could not be read
+typedef uint32_t (*NameReader)(void* source, CKGSpan span, char* destination);
+
+static bool gather_span(NameReader read_name, void* source, CKGSpan* span, char* names, uint32_t* used) {
+    uint32_t written = read_name(source, *span, names + *used);
+    if (written == UINT32_MAX) {
+        return false;
+    }
+    span->offset = *used;
+    span->length = written;
+    *used += written;
+    return true;
+}
+
+// For sources that are not one UTF-8 buffer: copy every name the extraction
+// found into one UTF-8 buffer and repoint the spans at it, so results are
+// built exactly as for contiguous UTF-8 source. The buffer holds only
+// names, a small fraction of the text; `max_growth` bounds the UTF-8 bytes
+// one source byte can become. Consecutive methods of one class keep sharing
+// a single copy of its name.
+static char* gather_names(ParsedData* data, NameReader read_name, void* source, uint32_t max_growth) {
+    uint64_t total = 0;
+    for (int i = 0; i < data->function_count; i++) {
+        total += data->functions[i].name.length + data->functions[i].class_name.length;
+    }
+    for (int i = 0; i < data->class_count; i++) {
+        total += data->classes[i].name.length;
+    }
+    total = total * max_growth + 1;
+    char* names = total <= UINT32_MAX ? (char*)malloc((size_t)total) : NULL;
+    if (!names) {
+        return NULL;
+    }
+
+    uint32_t used = 0;
+    CKGSpan previous_class = { 0, 0 };
+    CKGSpan previous_copy = { 0, 0 };
+    for (int i = 0; i < data->function_count; i++) {
+        ExtractedFunction* function = &data->functions[i];
+        if (!gather_span(read_name, source, &function->name, names, &used)) {
+            free(names);
+            return NULL;
         }
-    } else if (strcmp(node_type, "method_declaration") == 0 || strcmp(node_type, "constructor_declaration") == 0) {
-        // Find the method name
-        uint32_t child_count = ts_node_child_count(node);
-        for (uint32_t i = 0; i < child_count; i++) {
-            TSNode child = ts_node_child(node, i);
-            const char* child_type = ts_node_type(child);
-            
-            if (strcmp(child_type, "identifier") == 0) {
-                char* method_name = get_node_text(child, source_code);
-                if (method_name) {
-                    TSPoint start_point = ts_node_start_point(node);
-                    TSPoint end_point = ts_node_end_point(node);
-                    add_function(data, method_name, current_class, start_point.row + 1, end_point.row + 1);
-                    free(method_name);
-                }
-                break;
-            }
+        if (function->class_name.length == 0) {
+            continue;
         }
-    } else if (strcmp(node_type, "function_definition") == 0) {
-        // C language function definition
-        uint32_t child_count = ts_node_child_count(node);
-        for (uint32_t i = 0; i < child_count; i++) {
-            TSNode child = ts_node_child(node, i);
-            const char* child_type = ts_node_type(child);
-            
-            if (strcmp(child_type, "function_declarator") == 0) {
-                // Look for identifier in function_declarator
-                uint32_t declarator_child_count = ts_node_child_count(child);
-                for (uint32_t j = 0; j < declarator_child_count; j++) {
-                    TSNode declarator_child = ts_node_child(child, j);
-                    const char* declarator_child_type = ts_node_type(declarator_child);
-                    
-                    if (strcmp(declarator_child_type, "identifier") == 0) {
-                        char* function_name = get_node_text(declarator_child, source_code);
-                        if (function_name) {
-                            TSPoint start_point = ts_node_start_point(node);
-                            TSPoint end_point = ts_node_end_point(node);
-                            add_function(data, function_name, current_class, start_point.row + 1, end_point.row + 1);
-                            free(function_name);
-                        }
-                        break;
-                    }
-                }
-                break;
-            }
+        if (function->class_name.offset == previous_class.offset &&
+            function->class_name.length == previous_class.length) {
+            function->class_name = previous_copy;
+            continue;
         }
+        previous_class = function->class_name;
+        if (!gather_span(read_name, source, &function->class_name, names, &used)) {
+            free(names);
+            return NULL;
+        }
+        previous_copy = function->class_name;
     }
-    
-    // Recursively walk all children
-    uint32_t child_count = ts_node_child_count(node);
-    for (uint32_t i = 0; i < child_count; i++) {
-        TSNode child = ts_node_child(node, i);
-        walk_tree(child, source_code, data, current_class);
+    for (int i = 0; i < data->class_count; i++) {
+        if (!gather_span(read_name, source, &data->classes[i].name, names, &used)) {
+            free(names);
+            return NULL;
+        }
     }
+    return names;
 }
 
-CKG_API char* ckg_parse_json(void* parser_ptr, const char* source_code, const char* language, const char* file_path) {
-    if (!initialized || !source_code || !language || !file_path || !parser) {
+// Parse from `input` and encode the result with names gathered through
+// `read_name` (see gather_names)
+static uint8_t* parse_gathered(CKGContext* ctx, CKGLanguage language, TSInput input, uint32_t length,
+                               const CKGCacheKey* key, NameReader read_name, void* source, uint32_t max_growth,
+                               uint32_t* size_out) {
+    CKGStats delta = {0};
+    uint8_t* buffer;
+    const char* error = parse_into_scratch(ctx, language, input, length, key, &delta);
+    if (error) {
+        buffer = ckg_binary_error(error, size_out);
+    } else {
+        uint64_t start = ckg_now_ns();
+        char* names = gather_names(&ctx->scratch, read_name, source, max_growth);
+        if (names) {
+            uint32_t status = ckg_parse_status(ctx, &delta);
+            buffer = ckg_binary_build(&ctx->scratch, names, status, size_out);
+            free(names);
+        } else {
+            ckg_count_error(&delta, language);
+            buffer = ckg_binary_error("Failed to read source", size_out);
+        }
+        delta.serialize_ns = ckg_now_ns() - start;
+        delta.arena_high_water = buffer ? *size_out : 0;
+    }
+    ckg_stats_add(ctx, &delta);
+    return buffer;
+}
+
+// Spans of UTF-16 source count bytes, two per code unit
+static uint32_t read_utf16_name(void* source, CKGSpan span, char* destination) {
+    const StringInput* string = (const StringInput*)source;
+    return (uint32_t)ckg_utf16_to_utf8(string->data + span.offset, span.length / 2, false, destination);
+}
+
+CKG_API uint8_t* ckg_parse_utf16(CKGContext* ctx, CKGLanguage language, const uint16_t* source_code, uint32_t length,
+                                 uint32_t* size_out) {
+    if (!ctx || !source_code || !size_out) {
         return NULL;
     }
-    
-    // Determine language from file extension
-    const TSLanguage* ts_language = NULL;
-    const char* ext = strrchr(file_path, '.');
+    if (length > UINT32_MAX / 2) {
+        return ckg_binary_error("File too large", size_out);
+    }
+
+    StringInput string = { (const char*)source_code, length * 2 };
+    TSInput input = { &string, read_string, TSInputEncodingUTF16LE, NULL };
+    CKGCacheKey key;
+    return parse_gathered(ctx, language, input, string.length,
+                          source_key(&key, language, string.data, string.length, TSInputEncodingUTF16LE),
+                          read_utf16_name, &string, 2, size_out);
+}
 
-    if (ext) {
-        ts_language = get_language_from_extension(ext);
+#define CKG_READ_CHUNK_SIZE 65536
+
+// Source text that is never held in one piece: pieces come from the
+// caller's callback, or from a file descriptor through one chunk buffer
+typedef struct {
+    CKGReadCallback read;
+    void* user_data;
+    int fd;
+    char* chunk;
+    uint32_t length;
+} ChunkedSource;
+
+static const char* read_chunk(void* payload, uint32_t byte_index, TSPoint position, uint32_t* bytes_read) {
+    (void)position;
+    ChunkedSource* source = (ChunkedSource*)payload;
+    *bytes_read = 0;
+    if (byte_index >= source->length) {
+        return "";
     }
 
+    const char* data;
+    uint32_t available = 0;
+    if (source->read) {
+        data = source->read(source->user_data, byte_index, &available);
+    } else {
+        int64_t read = ckg_read_at(source->fd, byte_index, source->chunk, CKG_READ_CHUNK_SIZE);
+        data = source->chunk;
+        available = read > 0 ? (uint32_t)read : 0;
+    }
+    if (!data) {
+        return "";
+    }
+    // Never let a reader run past the length the parse was started with
+    *bytes_read = available < source->length - byte_index ? available : source->length - byte_index;
+    return data;
+}
 
-    if (!ts_language) {
+// Read a span's bytes back out of the source
+static uint32_t read_chunked_name(void* source, CKGSpan span, char* destination) {
+    uint32_t copied = 0;
+    while (copied < span.length) {
+        uint32_t available;
+        const char* data = read_chunk(source, span.offset + copied, (TSPoint){ 0, 0 }, &available);
+        if (available == 0) {
+            return UINT32_MAX;
+        }
+        uint32_t count = available < span.length - copied ? available : span.length - copied;
+        memcpy(destination + copied, data, count);
+        copied += count;
+    }
+    return copied;
+}
+
+static uint8_t* parse_chunked(CKGContext* ctx, CKGLanguage language, ChunkedSource* source, uint32_t* size_out) {
+    TSInput input = { source, read_chunk, TSInputEncodingUTF8, NULL };
+    return parse_gathered(ctx, language, input, source->length, NULL, read_chunked_name, source, 1, size_out);
+}
 
-        // Return empty result for unsupported languages
-        const char* empty_json = 
-            "{"
-            "\"functions\": [],"
-            "\"classes\": [],"
-            "\"properties\": [],"
-            "\"fields\": [],"
-            "\"variables\": []"
-            "}";
-        return strdup(empty_json);
+CKG_API uint8_t* ckg_parse_reader(CKGContext* ctx, CKGLanguage language, uint64_t length, CKGReadCallback read,
+                                  void* user_data, uint32_t* size_out) {
+    if (!ctx || !read || !size_out) {
+        return NULL;
     }
-    
-    // Set the language for the parser
-    if (!ts_parser_set_language(parser, ts_language)) {
+    if (length > UINT32_MAX) {
+        return ckg_binary_error("File too large", size_out);
+    }
+
+    ChunkedSource source = { read, user_data, -1, NULL, (uint32_t)length };
+    return parse_chunked(ctx, language, &source, size_out);
+}
+
+CKG_API uint8_t* ckg_parse_fd(CKGContext* ctx, CKGLanguage language, int fd, uint32_t* size_out) {
+    if (!ctx || fd < 0 || !size_out) {
         return NULL;
     }
-    
-    // Parse the source code
-    TSTree* tree = ts_parser_parse_string(parser, NULL, source_code, strlen(source_code));
-    if (!tree) {
+    int64_t length = ckg_fd_size(fd);
+    if (length < 0) {
+        return ckg_binary_error("Failed to read file", size_out);
+    }
+    if ((uint64_t)length > UINT32_MAX) {
+        return ckg_binary_error("File too large", size_out);
+    }
+
+    ChunkedSource source = { NULL, NULL, fd, (char*)malloc(CKG_READ_CHUNK_SIZE), (uint32_t)length };
+    if (!source.chunk) {
         return NULL;
     }
-    
-    // Initialize parsed data
-    ParsedData data = {0};
-    
-    // Get the root node and walk the tree
-    TSNode root_node = ts_tree_root_node(tree);
+    uint8_t* buffer = parse_chunked(ctx, language, &source, size_out);
+    free(source.chunk);
+    return buffer;
+}
 
-    walk_tree(root_node, source_code, &data, NULL);
+// Map a file and decode it to UTF-8 (see ckg_decode_source). On failure
+// returns the error with nothing left to release.
+static const char* decode_file(const char* data, uint64_t length, CKGDecodedSource* source) {
+    const char* error = ckg_decode_source(data, length, source);
+    if (!error && source->length > UINT32_MAX) {
+        ckg_decoded_source_free(source);
+        error = "File too large";
+    }
+    return error;
+}
 
-    
-    // Build JSON result
-    size_t json_size = 4096; // Start with 4KB
-    char* result_json = malloc(json_size);
-    if (!result_json) {
-        ts_tree_delete(tree);
-        if (data.classes) free(data.classes);
-        if (data.functions) free(data.functions);
+static const char* load_file(const char* path, CKGMappedFile* file, CKGDecodedSource* source) {
+    if (!ckg_map_file(path, file)) {
+        return "Failed to read file";
+    }
+    const char* error = decode_file(file->data, file->length, source);
+    if (error) {
+        ckg_unmap_file(file);
+    }
+    return error;
+}
+
+static void release_file(CKGMappedFile* file, CKGDecodedSource* source) {
+    ckg_decoded_source_free(source);
+    ckg_unmap_file(file);
+}
+
+CKGParseResult* ckg_parse_path(CKGContext* ctx, CKGLanguage language, const char* path) {
+    CKGMappedFile file;
+    CKGDecodedSource source;
+    const char* error = load_file(path, &file, &source);
+    if (error) {
+        return ckg_create_error_result(error);
+    }
+    CKGParseResult* result = ckg_parse_source(ctx, language, source.data, (uint32_t)source.length, true);
+    release_file(&file, &source);
+    return result;
+}
+
+CKGParseResult* ckg_parse_file_bytes(CKGContext* ctx, CKGLanguage language, const char* data, uint64_t length) {
+    CKGDecodedSource source;
+    const char* error = decode_file(data, length, &source);
+    if (error) {
+        return ckg_create_error_result(error);
+    }
+    CKGParseResult* result = ckg_parse_source(ctx, language, source.data, (uint32_t)source.length, true);
+    ckg_decoded_source_free(&source);
+    return result;
+}
+
+CKG_API uint8_t* ckg_parse_file(CKGContext* ctx, CKGLanguage language, const char* path, uint32_t* size_out) {
+    if (!ctx || !path || !size_out) {
         return NULL;
     }
-    
-    // Start building JSON
-    strcpy(result_json, "{\"functions\": [");
-    
-    // Add functions
-    for (int i = 0; i < data.function_count; i++) {
-        char func_json[512];
-        snprintf(func_json, sizeof(func_json),
-            "%s{\"name\": \"%s\", \"class_name\": \"%s\", \"start_line\": %d, \"end_line\": %d}",
-            i > 0 ? ", " : "",
-            data.functions[i].name,
-            data.functions[i].class_name,
-            data.functions[i].start_line,
-            data.functions[i].end_line
-        );
-        strcat(result_json, func_json);
+    CKGMappedFile file;
+    CKGDecodedSource source;
+    const char* error = load_file(path, &file, &source);
+    if (error) {
+        return ckg_binary_error(error, size_out);
     }
-    
-    strcat(result_json, "], \"classes\": [");
-    
-    // Add classes
-    for (int i = 0; i < data.class_count; i++) {
-        char class_json[512];
-        snprintf(class_json, sizeof(class_json),
-            "%s{\"name\": \"%s\", \"start_line\": %d, \"end_line\": %d}",
-            i > 0 ? ", " : "",
-            data.classes[i].name,
-            data.classes[i].start_line,
-            data.classes[i].end_line
-        );
-        strcat(result_json, class_json);
+    uint8_t* buffer = ckg_parse_binary(ctx, language, source.data, (uint32_t)source.length, size_out);
+    release_file(&file, &source);
+    return buffer;
+}
+
+// Write the symbols of `data` as the ckg_parse_json document. Partial
+// results are marked with "partial": true.
+static void write_symbols_json(CKGJsonWriter* writer, const ParsedData* data, const char* source_code, bool partial) {
+    ckg_json_write_cstr(writer, "{\"functions\": [");
+    for (int i = 0; i < data->function_count; i++) {
+        const ExtractedFunction* function = &data->functions[i];
+        ckg_json_write_cstr(writer, i > 0 ? ", {\"name\": " : "{\"name\": ");
+        ckg_json_write_string(writer, source_code + function->name.offset, function->name.length);
+        ckg_json_write_cstr(writer, ", \"class_name\": ");
+        ckg_json_write_string(writer, source_code + function->class_name.offset, function->class_name.length);
+        ckg_json_write_cstr(writer, ", \"start_line\": ");
+        ckg_json_write_int(writer, function->start_line);
+        ckg_json_write_cstr(writer, ", \"end_line\": ");
+        ckg_json_write_int(writer, function->end_line);
+        ckg_json_write_cstr(writer, "}");
     }
-    
-    strcat(result_json, "], \"properties\": [], \"fields\": [], \"variables\": []}");
-    
-    // Cleanup
-    ts_tree_delete(tree);
-    if (data.classes) free(data.classes);
-    if (data.functions) free(data.functions);
-    
+
+    ckg_json_write_cstr(writer, "], \"classes\": [");
+    for (int i = 0; i < data->class_count; i++) {
+        const ExtractedClass* cls = &data->classes[i];
+        ckg_json_write_cstr(writer, i > 0 ? ", {\"name\": " : "{\"name\": ");
+        ckg_json_write_string(writer, source_code + cls->name.offset, cls->name.length);
+        ckg_json_write_cstr(writer, ", \"start_line\": ");
+        ckg_json_write_int(writer, cls->start_line);
+        ckg_json_write_cstr(writer, ", \"end_line\": ");
+        ckg_json_write_int(writer, cls->end_line);
+        ckg_json_write_cstr(writer, "}");
+    }
+
+    ckg_json_write_cstr(writer, "], \"properties\": [], \"fields\": [], \"variables\": []");
+    ckg_json_write_cstr(writer, partial ? ", \"partial\": true}" : "}");
+}
+
+// Parse for the JSON entry points and write the document. The language
+// comes from its name when given one the registry knows, otherwise from
+// the file extension. Unsupported languages produce a document with no
+// symbols.
+static bool parse_to_json(CKGContext* ctx, const char* source_code, const char* language, const char* file_path,
+                          CKGJsonWriter* writer) {
+    int file_language = ckg_language_from_name(language);
+    if (file_language < 0) {
+        file_language = ckg_language_from_path(file_path);
+    }
+    if (file_language < 0 || !ckg_ts_language((CKGLanguage)file_language)) {
+        ParsedData empty = {0};
+        write_symbols_json(writer, &empty, source_code, false);
+        return true;
+    }
+
+    CKGStats delta = {0};
+    StringInput string = { source_code, (uint32_t)strlen(source_code) };
+    CKGCacheKey key;
+    const char* error = parse_into_scratch(ctx, (CKGLanguage)file_language, string_input(&string), string.length,
+                                           source_key(&key, (CKGLanguage)file_language, source_code, string.length,
+                                                      TSInputEncodingUTF8), &delta);
+    if (!error) {
+        uint64_t start = ckg_now_ns();
+        bool partial = ckg_parse_status(ctx, &delta) != CKG_STATUS_OK;
+        write_symbols_json(writer, &ctx->scratch, source_code, partial);
+        delta.serialize_ns = ckg_now_ns() - start;
+        delta.arena_high_water = writer->capacity;
+    }
+    ckg_stats_add(ctx, &delta);
+    return error == NULL;
+}
+
+// Parse source code and return a JSON result. parser_ptr is a CKGContext
+// created with ckg_context_create; NULL selects the default context.
+// `language` is a name such as "csharp"; when it is empty or unknown the
+// file extension decides.
+CKG_API char* ckg_parse_json(void* parser_ptr, const char* source_code, const char* language, const char* file_path) {
+    CKGContext* ctx = parser_ptr ? (CKGContext*)parser_ptr : default_context;
+    if (!ctx || !source_code || !language || !file_path) {
+        return NULL;
+    }
+
+    CKGJsonWriter writer;
+    ckg_json_init(&writer, NULL, NULL);
+    char* result_json = parse_to_json(ctx, source_code, language, file_path, &writer) ? ckg_json_take(&writer) : NULL;
+    ckg_json_free(&writer);
     return result_json;
 }
 
+CKG_API bool ckg_parse_json_stream(void* parser_ptr, const char* source_code, const char* language, const char* file_path,
+                                   CKGJsonChunkCallback callback, void* user_data) {
+    CKGContext* ctx = parser_ptr ? (CKGContext*)parser_ptr : default_context;
+    if (!ctx || !source_code || !language || !file_path || !callback) {
+        return false;
+    }
+
+    CKGJsonWriter writer;
+    ckg_json_init(&writer, callback, user_data);
+    bool ok = parse_to_json(ctx, source_code, language, file_path, &writer) && ckg_json_flush(&writer);
+    ckg_json_free(&writer);
+    return ok;
+}
+
 // Free JSON result
 CKG_API void ckg_free_json_result(char* json_result) {
     if (json_result) {
@@ -551,25 +1033,6 @@ CKG_API void ckg_free_result(CKGParseResult* result) {
         return;
     }
     
-    // Free arrays if they exist
-    if (result->functions) {
-        free(result->functions);
-    }
-    if (result->classes) {
-        free(result->classes);
-    }
-    if (result->properties) {
-        free(result->properties);
-    }
-    if (result->fields) {
-        free(result->fields);
-    }
-    if (result->variables) {
-        free(result->variables);
-    }
-    if (result->error_message) {
-        free((void*)result->error_message);
-    }
-    
+    // Header, arrays and strings share one block
     free(result);
 }
\ No newline at end of file
@@ -2,12 +2,16 @@
 #define CKG_WRAPPER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// File and directory paths, passed in or reported back, are UTF-8 on every
+// platform.
+
 // Language enumeration
 typedef enum {
     CKG_LANG_C = 0,
@@ -23,6 +27,12 @@ typedef enum {
     CKG_LANG_PHP = 10
 } CKGLanguage;
 
+// A range of the source buffer a result was parsed from
+typedef struct {
+    uint32_t offset;    // Byte offset into the source
+    uint32_t length;    // Length in bytes
+} CKGSpan;
+
 // Function element structure
 typedef struct {
     char* name;
@@ -38,6 +48,8 @@ typedef struct {
     bool is_static;
     bool is_async;
     char* parent_class;
+    CKGSpan name_span;
+    CKGSpan parent_class_span;      // Zero length when there is no parent class
 } CKGFunction;
 
 // Class element structure
@@ -56,6 +68,7 @@ typedef struct {
     bool is_static;
     bool is_abstract;
     bool is_sealed;
+    CKGSpan name_span;
 } CKGClass;
 
 // Property element structure
@@ -107,6 +120,33 @@ typedef struct {
     char* parent_function;
 } CKGVariable;
 
+// Opaque parsing context. Each context owns its own parser and scratch
+// buffers; use one context per thread to parse concurrently.
+typedef struct CKGContext CKGContext;
+
+// Outcome of a parse. Timed-out and cancelled parses are partial: they hold
+// whatever symbols were found before the stop, possibly none.
+typedef enum {
+    CKG_STATUS_OK = 0,
+    CKG_STATUS_ERROR = 1,           // error_message says why
+    CKG_STATUS_TIMED_OUT = 2,       // The context's parse timeout expired
+    CKG_STATUS_CANCELLED = 3,       // ckg_context_cancel was called
+    CKG_STATUS_SKIPPED = 4          // Not parsed: larger than the size policy allows
+} CKGParseStatus;
+
+// How much work to spend on a file by its size in bytes. Zero thresholds
+// are never reached, so a zero-initialised policy parses everything fully.
+typedef struct {
+    uint64_t declarations_only_above;   // Larger files: declarations only (see below)
+    uint64_t skip_above;                // Larger files are not parsed at all
+} CKGSizePolicy;
+
+// Declarations-only extraction reports definitions starting within this many
+// levels of the root: top-level and class-member declarations in every
+// supported grammar, but not functions nested deep inside bodies, which is
+// where generated and minified sources multiply.
+#define CKG_DECLARATIONS_MAX_DEPTH 6
+
 // Parse result structure
 typedef struct {
     uint32_t function_count;
@@ -120,8 +160,142 @@ typedef struct {
     CKGField* fields;
     CKGVariable* variables;
     const char* error_message;
+    uint32_t status;                // CKGParseStatus
 } CKGParseResult;
 
+// Options for ckg_parse_batch. A zero-initialised struct selects the defaults.
+typedef struct {
+    uint32_t thread_count;          // Worker threads; 0 = one per CPU
+    bool disable_size_ordering;     // Parse in input order instead of largest files first
+    uint64_t timeout_micros;        // Parse budget per file; 0 = no limit
+    CKGSizePolicy size_policy;
+} CKGBatchOptions;
+
+// What ckg_index_directory knows about a file between runs: enough to tell
+// that it has not changed without reading it (size and modification time),
+// or without parsing it (content hash)
+typedef struct {
+    const char* path;               // As the walk reports it: root joined with '/'
+    uint64_t size;
+    int64_t mtime;                  // Platform file time; only compared for equality
+    uint64_t hash;                  // XXH64 of the raw file bytes, seed 0
+} CKGFileFingerprint;
+
+typedef enum {
+    CKG_FILE_NEW = 0,               // Not among the known files: parsed
+    CKG_FILE_CHANGED = 1,           // Contents differ from the known hash: parsed
+    CKG_FILE_TOUCHED = 2,           // Size or time changed but the hash matched: not parsed
+    CKG_FILE_UNCHANGED = 3          // Size and time match: not read at all
+} CKGFileState;
+
+// Receives the fingerprint of every file ckg_index_directory walks, before
+// the index callback gets the parse result of a new or changed file. Calls
+// are serialised with the index callback. Return false to stop indexing.
+typedef bool (*CKGFileCallback)(void* user_data, const CKGFileFingerprint* file, CKGFileState state);
+
+// Options for ckg_index_directory. A zero-initialised struct selects the defaults.
+typedef struct {
+    uint32_t thread_count;          // Worker threads; 0 = one per CPU
+    bool disable_gitignore;         // Do not read .gitignore files while walking
+    uint64_t timeout_micros;        // Parse budget per file; 0 = no limit
+    CKGSizePolicy size_policy;
+    // Incremental indexing: with on_file set, every file is fingerprinted and
+    // only files whose contents differ from `known_files` are parsed
+    const CKGFileFingerprint* known_files;
+    uint32_t known_file_count;
+    CKGFileCallback on_file;
+    // Write a symbol index of the run to this path (see ckg_index_open).
+    // Files that are not parsed keep the symbols the index already at this
+    // path had for them, as do indexed files whose extension is not among
+    // this run's.
+    const char* index_path;
+    // Write a text index of the walked files to this path (see
+    // ckg_text_index_open). Files that are not read keep the trigrams the
+    // index already at this path had, as do indexed files whose extension
+    // is not among this run's.
+    const char* text_index_path;
+} CKGIndexOptions;
+
+// Receives each file indexed by ckg_index_directory. Calls are serialised
+// (never concurrent) but arrive on worker threads. The result is owned by
+// the library and only valid during the call. Return false to stop indexing.
+typedef bool (*CKGIndexCallback)(void* user_data, const char* file_path, CKGLanguage language, const CKGParseResult* result);
+
+// A symbol reported to a CKGVisitor. Spans locate names in the source passed
+// to ckg_parse_visit; nothing is copied.
+typedef struct {
+    CKGSpan name;
+    CKGSpan parent_class;   // Enclosing or owning class; zero length when there is none
+    uint32_t start_line;
+    uint32_t end_line;
+} CKGSymbol;
+
+// Return false to stop the traversal
+typedef bool (*CKGSymbolCallback)(void* user_data, const char* source_code, const CKGSymbol* symbol);
+
+// Callbacks for ckg_parse_visit, called in document order as symbols are
+// found. Any callback may be NULL.
+typedef struct {
+    CKGSymbolCallback on_class;
+    CKGSymbolCallback on_function;
+    CKGSymbolCallback on_field;     // Member variables; only languages with field patterns report them
+    void* user_data;
+} CKGVisitor;
+
+// Performance counters, kept per context and summed process-wide. Times
+// are wall-clock nanoseconds spent in each phase.
+#define CKG_STATS_MAX_LANGUAGES 16
+typedef struct {
+    uint64_t files_parsed;
+    uint64_t bytes_parsed;
+    uint64_t nodes_visited;         // Nodes stepped over by the cursor walker
+    uint64_t query_matches;         // Matches produced by extraction queries
+    uint64_t symbols_extracted;     // Classes plus functions
+    uint64_t parse_ns;              // Tree-sitter parsing
+    uint64_t extract_ns;            // Symbol extraction (including visitor callbacks)
+    uint64_t serialize_ns;          // Building results, JSON or binary output
+    uint64_t arena_high_water;      // Largest single result block, in bytes
+    uint64_t errors;
+    uint64_t errors_by_language[CKG_STATS_MAX_LANGUAGES];   // Indexed by CKGLanguage
+    uint64_t timeouts;              // Parses stopped by the context's timeout
+    uint64_t cancellations;         // Parses stopped by ckg_context_cancel
+    uint64_t files_skipped;         // Files the size policy kept from parsing
+    uint64_t cache_hits;            // Parses answered from the tree cache
+    uint64_t cache_misses;
+    uint64_t cache_evictions;       // Entries dropped to stay within the cache budget
+    uint64_t disk_cache_hits;       // Parses answered from the disk cache
+    uint64_t disk_cache_misses;
+    uint64_t disk_cache_evictions;  // Entries deleted to stay within the disk cache budget
+} CKGStats;
+
+// Events recorded by the native tracer when built with CKG_TRACE_LEVEL > 0
+typedef enum {
+    CKG_TRACE_PARSE_BEGIN = 1,      // arg0 = language, arg1 = source length
+    CKG_TRACE_PARSE_END,            // arg0 = functions found, arg1 = classes found
+    CKG_TRACE_PARSE_FAILED,         // arg0 = language, arg1 = source length
+    CKG_TRACE_QUERY_FAILED,         // arg0 = language, arg1 = error offset in the query
+    CKG_TRACE_NODE                  // arg0 = node symbol, arg1 = start byte (level 3 only)
+} CKGTraceEventKind;
+
+typedef struct {
+    uint64_t timestamp_ns;          // Monotonic clock
+    uint64_t arg0;
+    uint64_t arg1;
+    uint32_t thread_id;             // Small sequential id of the emitting thread
+    uint16_t level;                 // 1 = error, 2 = info, 3 = debug
+    uint16_t kind;                  // CKGTraceEventKind
+} CKGTraceEvent;
+
+// Supplies source text to ckg_parse_reader in pieces: return the bytes
+// starting at `offset`, with their count in *length_out (0 past the end).
+// Offsets may be requested in any order, and the bytes only need to stay
+// valid until the next call.
+typedef const char* (*CKGReadCallback)(void* user_data, uint32_t offset, uint32_t* length_out);
+
+// Receives ckg_parse_json_stream output in consecutive pieces. The chunk is
+// only valid during the call and is not NUL-terminated. Return false to stop.
+typedef bool (*CKGJsonChunkCallback)(void* user_data, const char* chunk, size_t length);
+
 // API functions
 #ifdef _WIN32
     #ifdef BUILDING_CKG_DLL
@@ -140,8 +314,457 @@ CKG_API bool ckg_is_language_supported(CKGLanguage language);
 CKG_API CKGParseResult* ckg_parse(CKGLanguage language, const char* source_code, const char* file_path);
 CKG_API char* ckg_parse_json(void* parser_ptr, const char* source_code, const char* language, const char* file_path);
 CKG_API void ckg_free_result(CKGParseResult* result);
+CKG_API CKGContext* ckg_context_create(void);
+CKG_API void ckg_context_destroy(CKGContext* ctx);
+CKG_API CKGParseResult* ckg_parse_with_context(CKGContext* ctx, CKGLanguage language, const char* source_code, const char* file_path);
+
+// Limit every later parse in this context to `timeout_micros` of wall time,
+// covering both parsing and symbol extraction; 0 removes the limit. A parse
+// that runs out of time returns a CKG_STATUS_TIMED_OUT result.
+CKG_API void ckg_context_set_timeout(CKGContext* ctx, uint64_t timeout_micros);
+// Stop the parse running in `ctx` as soon as possible; it returns a
+// CKG_STATUS_CANCELLED result. Unlike every other context function this one
+// may be called from any thread. The context stays cancelled, failing each
+// later parse the same way, until ckg_context_reset_cancel.
+CKG_API void ckg_context_cancel(CKGContext* ctx);
+CKG_API void ckg_context_reset_cancel(CKGContext* ctx);
+// Choose how later parses in this context treat large sources; NULL parses
+// everything fully. Skipped sources return a CKG_STATUS_SKIPPED result.
+CKG_API void ckg_context_set_size_policy(CKGContext* ctx, const CKGSizePolicy* policy);
+
+// Parse `length` bytes of source (no NUL terminator required) without
+// copying any names: name and parent_class are NULL, and name_span /
+// parent_class_span locate them in source_code, which the caller keeps alive
+// for as long as it reads them.
+CKG_API CKGParseResult* ckg_parse_spans(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length);
+
+// Parse `length` bytes of source and report symbols to `visitor` as the
+// tree is traversed, without building a result. Returns 1 when the whole
+// tree was visited, 0 when a callback stopped the traversal, 2 when the
+// context's size policy, timeout or cancellation cut it short, or -1 if the
+// source could not be parsed.
+CKG_API int ckg_parse_visit(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length, const CKGVisitor* visitor);
+
+// Binary result format (ckg_parse_binary). All integers are little-endian
+// uint32 unless noted; offsets are from the start of the buffer, string
+// offsets from the start of the string table.
+//
+//   Header (CKG_BINARY_HEADER_SIZE bytes)
+//     0  magic "CKGB" (4 bytes)      4  version (uint16)
+//     6  header size (uint16)        8  status (CKGParseStatus); for
+//                                       CKG_STATUS_ERROR the string table
+//                                       holds the error message instead
+//                                       of names
+//    12  function count             16  function record size
+//    20  class count                24  class record size
+//    28  string table offset        32  string table size
+//    36  total size
+//   Function records: name offset, name length, class name offset, class
+//     name length (0 = none), start line, end line
+//   Class records: name offset, name length, start line, end line
+//   String table: UTF-8 names, not NUL-terminated
+//
+// Readers must check the magic and version and step over records by the
+// sizes in the header, so fields can be appended without a version bump.
+#define CKG_BINARY_MAGIC "CKGB"
+#define CKG_BINARY_VERSION 2
+#define CKG_BINARY_HEADER_SIZE 40
+#define CKG_BINARY_FUNCTION_RECORD_SIZE 24
+#define CKG_BINARY_CLASS_RECORD_SIZE 16
+
+// Parse `length` bytes of source into the binary format above. Returns the
+// buffer, with its size in *size_out, or NULL if out of memory; parse errors
+// are reported through the status field. Release with ckg_free_binary.
+CKG_API uint8_t* ckg_parse_binary(CKGContext* ctx, CKGLanguage language, const char* source_code, uint32_t length, uint32_t* size_out);
+CKG_API void ckg_free_binary(uint8_t* buffer);
+
+// Parse `length` bytes of source that are never held in one piece, into the
+// binary format above. Tree-sitter reads the text a chunk at a time and the
+// names are read back afterwards, so memory is bounded by the syntax tree
+// rather than the text. ckg_parse_reader takes the text from a callback;
+// ckg_parse_fd reads a whole open file descriptor (a C runtime descriptor
+// on Windows) with positioned reads. Both take the text as UTF-8 as it is;
+// ckg_parse_file detects and converts other encodings.
+CKG_API uint8_t* ckg_parse_reader(CKGContext* ctx, CKGLanguage language, uint64_t length, CKGReadCallback read,
+                                  void* user_data, uint32_t* size_out);
+CKG_API uint8_t* ckg_parse_fd(CKGContext* ctx, CKGLanguage language, int fd, uint32_t* size_out);
+
+// Parse `length` UTF-16 code units (little-endian, as .NET strings are on
+// every supported platform) into the binary format above. Tree-sitter reads
+// the UTF-16 directly; only the names are converted to UTF-8, so there is no
+// transcoded copy of the text. Lines are numbered exactly as for UTF-8.
+CKG_API uint8_t* ckg_parse_utf16(CKGContext* ctx, CKGLanguage language, const uint16_t* source_code, uint32_t length,
+                                 uint32_t* size_out);
+
+// Parse the file at `path` into the binary format above. The file is mapped
+// rather than read, and its encoding detected: UTF-8 with or without a byte
+// order mark is parsed in place, while UTF-16 (by BOM or by its zero bytes),
+// and text that is not valid UTF-8, which is read as Latin-1, are first
+// transcoded to UTF-8. Invalid bytes never reach the grammar. Unreadable
+// files return a CKG_STATUS_ERROR result.
+CKG_API uint8_t* ckg_parse_file(CKGContext* ctx, CKGLanguage language, const char* path, uint32_t* size_out);
+
+// Open `length` bytes of UTF-8 source as document `file_id` of this context,
+// replacing any document already open under that id, and return its
+// symbols in the binary format above. The context keeps a copy of the text
+// with its syntax tree and symbols, so that ckg_apply_edit can bring them up
+// to date without a full parse. Only complete parses are kept: a parse that
+// is skipped, stopped or fails returns that status and leaves no document.
+CKG_API uint8_t* ckg_open_document(CKGContext* ctx, uint32_t file_id, CKGLanguage language, const char* source_code,
+                                   uint32_t length, uint32_t* size_out);
+
+// Apply one edit to an open document: bytes [start_byte, old_end_byte) of
+// its text were replaced, giving `new_source` (`new_length` bytes), in which
+// the replacement ends at new_end_byte. The retained tree is edited and
+// reparsed incrementally, reusing everything outside the edit, and symbols
+// are extracted again only where the syntax changed. Returns how the
+// symbols changed, in the edit format below; release it with
+// ckg_free_binary. With any status but CKG_STATUS_OK the document is closed
+// (unless the edit did not match it) and the caller should parse the file
+// in full again.
+CKG_API uint8_t* ckg_apply_edit(CKGContext* ctx, uint32_t file_id, uint32_t start_byte, uint32_t old_end_byte,
+                                uint32_t new_end_byte, const char* new_source, uint32_t new_length, uint32_t* size_out);
+CKG_API void ckg_close_document(CKGContext* ctx, uint32_t file_id);
+
+// Edit result format (ckg_apply_edit), laid out and read like the binary
+// format above.
+//
+//   Header (CKG_EDIT_HEADER_SIZE bytes)
+//     0  magic "CKGE" (4 bytes)      4  version (uint16)
+//     6  header size (uint16)        8  status (CKGParseStatus); for
+//                                       CKG_STATUS_ERROR the string table
+//                                       holds the error message
+//    12  record count               16  record size
+//    20  edit line                  24  line delta (int32)
+//    28  string table offset        32  string table size
+//    36  total size
+//   Records: change (uint8, CKGSymbolChange), kind (uint8: 0 function,
+//     1 class), 2 reserved bytes, name offset, name length, class name
+//     offset, class name length (functions only; 0 = none), start line,
+//     end line, old start line, old end line
+//   String table: UTF-8 names, not NUL-terminated
+//
+// Symbols that are not listed only moved: their line numbers above `edit
+// line`, the old line on which the replaced text ended, shift by `line
+// delta`. Removed and changed symbols are identified by their name, class
+// and old lines; added ones have old lines of 0 and removed ones new lines
+// of 0.
+#define CKG_EDIT_MAGIC "CKGE"
+#define CKG_EDIT_VERSION 1
+#define CKG_EDIT_HEADER_SIZE 40
+#define CKG_EDIT_RECORD_SIZE 36
+
+typedef enum {
+    CKG_SYMBOL_ADDED = 1,
+    CKG_SYMBOL_REMOVED = 2,
+    CKG_SYMBOL_CHANGED = 3          // Same name and class, new lines
+} CKGSymbolChange;
+
+// Parsed trees and their symbols are kept in a process-wide LRU cache
+// keyed by a hash of the source text with its length, encoding and
+// language, so parsing unchanged source again costs a hash and a lookup.
+// Only complete parses are cached; the chunked readers bypass it.
+// `budget_bytes` bounds the memory the cache holds, with trees charged by
+// their source size. The cache is off until given a budget, and a budget of
+// 0 turns it off again and empties it. Hits, misses and evictions are
+// counted in CKGStats.
+CKG_API void ckg_cache_set_budget(uint64_t budget_bytes);
+CKG_API void ckg_cache_clear(void);
+CKG_API void ckg_cache_get_usage(uint64_t* bytes_out, uint32_t* entries_out);
+
+// Symbols of complete parses can also be kept on disk, under the same key
+// plus the grammar's and the wrapper's version, so that they outlive the
+// process and are shared by every process, database and checkout pointed at
+// the same directory: switching branches or indexing a fresh clone finds
+// most files already parsed. Tree cache misses consult it, and its hits go
+// into the tree cache without a tree. Each entry is one small file; the
+// least recently used ones are deleted once the directory exceeds
+// `budget_bytes`. Returns -1 if the directory cannot be created (its parent
+// must exist). A NULL directory or a budget of 0 turns the cache off, which
+// leaves the files in place; ckg_disk_cache_clear deletes them. Usage is
+// estimated from one scan of the directory and this process's writes since.
+CKG_API int ckg_disk_cache_set_directory(const char* directory, uint64_t budget_bytes);
+CKG_API void ckg_disk_cache_clear(void);
+CKG_API void ckg_disk_cache_get_usage(uint64_t* bytes_out, uint32_t* entries_out);
+
+// Symbol index files: every function, class, property and field of a
+// repository in tables laid out to be memory-mapped and searched in place.
+// ckg_index_directory writes one with options->index_path, or a writer
+// collects symbols from any source. ckg_index_open maps a file and checks
+// only its header, so opening costs the same for any size and pages load
+// as lookups touch them; lookups are binary searches over the mapped
+// tables and return pointers into the mapping, with nothing deserialized.
+// Two radix tries over the names answer prefix, fuzzy and camel-hump
+// searches (ckg_index_search) by walking the mapped nodes, and trigram
+// posting lists over the names (see the text index below) substring ones.
+//
+// Index format, little-endian throughout:
+//
+//   Header (CKG_INDEX_HEADER_SIZE bytes)
+//     0  magic "CKGI" (4 bytes)      4  version
+//     8  symbol count               12  file count
+//    16  class member count         20  reserved
+//    24  string pool size (uint64)  32  symbol table offset (uint64)
+//    40  file table offset (uint64) 48  by-file table offset (uint64)
+//    56  by-class table offset      64  string pool offset (uint64)
+//    72  name trie node count       76  hump trie node count
+//    80  hump entry count           84  reserved
+//    88  name trie offset (uint64)  96  hump trie offset (uint64)
+//   104  hump table offset (uint64)
+//   112  name trigram count        116  reserved
+//   120  name trigram table offset (uint64)
+//   128  name postings offset (uint64)
+//   136  name postings size (uint64)
+//   Symbol table, sorted by name, class, file path and line: name offset,
+//     name length, class offset, class length (0 = none), file index,
+//     start line, end line, kind (uint8, CKGSymbolKind), language (uint8),
+//     2 reserved bytes
+//   File table, sorted by path: path offset, path length, first entry in
+//     the by-file table, symbol count
+//   By-file table: symbol rows (uint32) grouped by file in file table
+//     order, by line within a file
+//   By-class table: rows of symbols that have a class (uint32), sorted by
+//     class and then name
+//   Name trie: radix trie over the distinct names, node 0 the root. Nodes
+//     are CKG_INDEX_TRIE_NODE_SIZE bytes: label offset and length (the
+//     edge from the parent, a span of the pool), first child, first value,
+//     value count, child count (uint16), 2 reserved bytes. A node's
+//     children are consecutive and sorted by label. Its values are the
+//     symbol table rows of the name ending there; in a node without a name
+//     the first value is that of its first descendant that has one.
+//   Hump trie: the same over hump keys, the uppercased first letter of
+//     each camel hump of a name (a hump starts at the first letter or
+//     digit, at each uppercase letter and after each separator, so
+//     ParseCodeResult and parse_code_result are both "PCR"). Its values
+//     are entries of the hump table.
+//   Hump table: first row and symbol count (uint32 each) of a name, sorted
+//     by hump key, name length and name
+//   Name trigrams: a trigram table and posting lists, laid out as in text
+//     indexes, that list the first row of each distinct name
+//   String pool: UTF-8 strings, each followed by a NUL; offset 0 is ""
+//
+// Offsets and counts in the tables are 32-bit, which bounds the pool and
+// each table at 4 GB, not the file.
+#define CKG_INDEX_MAGIC "CKGI"
+#define CKG_INDEX_VERSION 3
+#define CKG_INDEX_HEADER_SIZE 144
+#define CKG_INDEX_SYMBOL_RECORD_SIZE 32
+#define CKG_INDEX_FILE_RECORD_SIZE 16
+#define CKG_INDEX_TRIE_NODE_SIZE 24
+#define CKG_INDEX_HUMP_RECORD_SIZE 8
+// Longest query ckg_index_search takes, and the most edits it allows
+#define CKG_INDEX_MAX_QUERY 64
+#define CKG_INDEX_MAX_DISTANCE 3
+
+typedef enum {
+    CKG_SYMBOL_FUNCTION = 1,
+    CKG_SYMBOL_CLASS = 2,
+    CKG_SYMBOL_PROPERTY = 3,
+    CKG_SYMBOL_FIELD = 4
+} CKGSymbolKind;
+
+// The tables a lookup searches, and positions in them refer to
+typedef enum {
+    CKG_INDEX_BY_NAME = 0,          // The symbol table; a position is the symbol's row
+    CKG_INDEX_BY_FILE = 1,          // Symbols of one file, by line
+    CKG_INDEX_BY_CLASS = 2          // Members of one class, by name
+} CKGIndexOrder;
+
+// A symbol as read from an index. The strings point into the mapping and
+// are NUL-terminated; they stay valid until the index is closed.
+typedef struct {
+    const char* name;
+    const char* parent_class;       // "" when there is none
+    const char* file_path;
+    uint32_t name_length;
+    uint32_t parent_class_length;
+    uint32_t file_path_length;
+    uint32_t start_line;
+    uint32_t end_line;
+    uint32_t kind;                  // CKGSymbolKind
+    uint32_t language;              // CKGLanguage
+    uint32_t row;                   // Row in the symbol table (its CKG_INDEX_BY_NAME position)
+} CKGIndexSymbol;
+
+// How ckg_index_search matches names. Every mode ignores ASCII case.
+typedef enum {
+    CKG_SEARCH_PREFIX = 0,          // Names starting with the query; score: extra characters
+    CKG_SEARCH_FUZZY = 1,           // Names within max_distance edits (insertions, deletions,
+                                    // substitutions, adjacent transpositions); score: edits
+    CKG_SEARCH_CAMEL = 2,           // Names whose humps start with the query's humps, in
+                                    // order from the first; score: extra humps
+    CKG_SEARCH_SUBSTRING = 3        // Names containing the query anywhere; score: extra
+                                    // characters
+} CKGSearchMode;
+
+// A name found by ckg_index_search and the symbols that have it
+typedef struct {
+    const char* name;               // Points into the mapping, NUL-terminated
+    uint32_t name_length;
+    uint32_t first;                 // First CKG_INDEX_BY_NAME position of its symbols
+    uint32_t count;                 // How many symbols have the name
+    uint32_t score;                 // Lower is better; see CKGSearchMode
+} CKGIndexMatch;
+
+typedef struct CKGIndex CKGIndex;
+typedef struct CKGIndexWriter CKGIndexWriter;
+
+// Map an index file read-only; NULL if it cannot be read or is not an
+// index. An index may be used from any number of threads.
+CKG_API CKGIndex* ckg_index_open(const char* path);
+CKG_API void ckg_index_close(CKGIndex* index);
+CKG_API void ckg_index_get_info(const CKGIndex* index, uint32_t* symbol_count_out, uint32_t* file_count_out);
+
+// Find the symbols whose name (CKG_INDEX_BY_NAME), file path
+// (CKG_INDEX_BY_FILE) or class (CKG_INDEX_BY_CLASS) is exactly `key`.
+// Returns how many there are; they are the positions *first_out onwards in
+// that order, read with ckg_index_get.
+CKG_API uint32_t ckg_index_find(const CKGIndex* index, CKGIndexOrder order, const char* key, uint32_t* first_out);
+// Read the symbol at `position` in `order`; false if it is out of range or
+// the file is damaged
+CKG_API bool ckg_index_get(const CKGIndex* index, CKGIndexOrder order, uint32_t position, CKGIndexSymbol* symbol);
+
+// Find the best `capacity` distinct names matching `query` in `mode` and
+// return how many were written to `matches`, best first: by score, then
+// length, then name. A camel query splits at uppercase letters and
+// separators like a name does, or into single letters when it is all
+// lowercase ("pcr" and "PCR" both find ParseCodeResult; "PaCoRe" also
+// checks each hump's first letters). Searches walk only the trie nodes
+// that can still match; substring searches check only the names that have
+// every trigram of the query, or every name for queries under 3 bytes. `max_distance` applies to CKG_SEARCH_FUZZY and is capped at
+// CKG_INDEX_MAX_DISTANCE; queries longer than CKG_INDEX_MAX_QUERY find
+// nothing.
+CKG_API uint32_t ckg_index_search(const CKGIndex* index, CKGSearchMode mode, const char* query, uint32_t max_distance,
+                                  CKGIndexMatch* matches, uint32_t capacity);
+
+// Collect symbols and write them as an index. Symbols without a name or a
+// file are rejected. ckg_index_writer_add_file copies a file's symbols from
+// an existing index. Once an add fails (out of memory, or past the 4 GB
+// limits) the writer stays failed and writes nothing. ckg_index_writer_write
+// replaces `path` atomically, so readers that have the old file open keep a
+// consistent view; it returns 0 on success and -1 on failure. A writer may
+// be written more than once.
+CKG_API CKGIndexWriter* ckg_index_writer_create(void);
+CKG_API void ckg_index_writer_destroy(CKGIndexWriter* writer);
+CKG_API bool ckg_index_writer_add(CKGIndexWriter* writer, const char* file_path, CKGLanguage language, CKGSymbolKind kind,
+                                  const char* name, const char* parent_class, uint32_t start_line, uint32_t end_line);
+CKG_API bool ckg_index_writer_add_result(CKGIndexWriter* writer, const char* file_path, CKGLanguage language,
+                                         const CKGParseResult* result);
+CKG_API bool ckg_index_writer_add_file(CKGIndexWriter* writer, const CKGIndex* index, const char* file_path);
+CKG_API int ckg_index_writer_write(CKGIndexWriter* writer, const char* path);
+
+// Text index files: the trigrams (three-byte sequences, ASCII case folded)
+// of every file ckg_index_directory indexed, with options->text_index_path,
+// as posting lists of the files each occurs in. ckg_text_index_search
+// intersects the lists of a literal's trigrams to find the few files that
+// can contain it and then scans only those, mapped, with a vectorised
+// search (SSE2 or NEON), so a search costs little more than reading the
+// files that match. Files are read as they are on disk when searched: one
+// edited since the index was written is still found by its old trigrams
+// only, so a new occurrence of a literal it did not contain before is
+// missed until the next run.
+//
+// Index format, little-endian throughout:
+//
+//   Header (CKG_TEXT_INDEX_HEADER_SIZE bytes)
+//     0  magic "CKGT" (4 bytes)      4  version
+//     8  file count                 12  trigram count
+//    16  file table offset (uint64) 24  trigram table offset (uint64)
+//    32  postings offset (uint64)   40  postings size (uint64)
+//    48  forward offset (uint64)    56  forward size (uint64)
+//    64  string pool offset         72  string pool size (uint64)
+//   File table, sorted by path: path offset, path length, forward offset
+//     (uint64), trigram count, reserved
+//   Trigram table, sorted by trigram: trigram (first byte highest),
+//     file count, postings offset (uint64)
+//   Postings: per trigram, the numbers of the files containing it,
+//     ascending, as LEB128 varints of the difference from the previous one
+//   Forward lists: per file, its trigrams, ascending, encoded the same way,
+//     from which later runs copy the files they do not read
+//   String pool: paths, each followed by a NUL; offset 0 is ""
+#define CKG_TEXT_INDEX_MAGIC "CKGT"
+#define CKG_TEXT_INDEX_VERSION 1
+#define CKG_TEXT_INDEX_HEADER_SIZE 80
+#define CKG_TEXT_INDEX_FILE_RECORD_SIZE 24
+
+// ckg_text_index_search flags
+#define CKG_TEXT_IGNORE_CASE 1          // ASCII letters match either case
+#define CKG_TEXT_FILES_ONLY 2           // One match per file: the first
+
+// An occurrence found by ckg_text_index_search. Strings point into the
+// index and the searched file and are only valid during the callback;
+// line_text is the whole line, without its line break.
+typedef struct {
+    const char* file_path;          // NUL-terminated
+    uint32_t file_path_length;
+    uint32_t line;                  // From 1
+    uint32_t column;                // Byte offset in the line, from 1
+    uint64_t offset;                // Byte offset in the file
+    const char* line_text;
+    uint32_t line_length;
+} CKGTextMatch;
+
+// Return false to stop the search
+typedef bool (*CKGTextMatchCallback)(void* user_data, const CKGTextMatch* match);
+
+typedef struct CKGTextIndex CKGTextIndex;
+
+// Map a text index read-only; NULL if it cannot be read or is not a text
+// index. An index may be used from any number of threads.
+CKG_API CKGTextIndex* ckg_text_index_open(const char* path);
+CKG_API void ckg_text_index_close(CKGTextIndex* index);
+CKG_API void ckg_text_index_get_info(const CKGTextIndex* index, uint32_t* file_count_out, uint32_t* trigram_count_out);
+
+// Report the occurrences of the bytes of `pattern` (NUL-terminated) in the
+// indexed files to `callback`, files in path order and at most one per line,
+// stopping after `max_matches` (0 = no limit). Returns how many were
+// reported, or -1 if the arguments are invalid or out of memory. An empty
+// pattern is only allowed with CKG_TEXT_FILES_ONLY and lists every file,
+// with a line of 0 and no text.
+CKG_API int ckg_text_index_search(const CKGTextIndex* index, const char* pattern, uint32_t flags, uint32_t max_matches,
+                                  CKGTextMatchCallback callback, void* user_data);
+
+// Process-wide counters: every context's activity since the last reset
+CKG_API void ckg_get_stats(CKGStats* stats);
+CKG_API void ckg_reset_stats(void);
+// Counters for one context only
+CKG_API void ckg_context_get_stats(CKGContext* ctx, CKGStats* stats);
+CKG_API void ckg_context_reset_stats(CKGContext* ctx);
+
+// Move up to `capacity` buffered trace events into `events` and return how
+// many were copied. Events are grouped by thread, in order within each
+// thread. Returns 0 when tracing is compiled out (see ckg_trace_level) or
+// another drain is in progress.
+CKG_API uint32_t ckg_trace_drain(CKGTraceEvent* events, uint32_t capacity);
+// Trace level compiled into the library; 0 means tracing is off
+CKG_API int ckg_trace_level(void);
+
+// Parse `count` files on a native thread pool. results_out must hold `count`
+// entries; each receives a result (possibly carrying an error_message) that
+// the caller releases with ckg_free_result. Returns the number of files
+// parsed completely (CKG_STATUS_OK), or -1 on invalid arguments.
+CKG_API int ckg_parse_batch(const char* const* file_paths, uint32_t count, const CKGBatchOptions* options, CKGParseResult** results_out);
+
+// Walk `root`, skipping .git, paths matched by .gitignore files and the
+// gitignore-style `ignore_globs`, and parse every file whose extension is in
+// `include_exts` (e.g. ".cs"; NULL selects every supported extension). Both
+// arrays are NULL-terminated. Files are memory-mapped and parsed on a native
+// thread pool, largest first. With options->on_file, files whose size and
+// modification time match their known fingerprint are skipped unread, and
+// the rest are hashed and parsed only if their contents changed. With
+// options->index_path the run's symbols are also written as an index file.
+// Returns the number of files delivered to the callbacks, or -1 if `root`
+// cannot be opened or the index cannot be written.
+CKG_API int ckg_index_directory(const char* root, const char* const* include_exts, const char* const* ignore_globs,
+                                const CKGIndexOptions* options, CKGIndexCallback callback, void* user_data);
 CKG_API void ckg_free_json_result(char* json_result);
 
+// Same document as ckg_parse_json, delivered to `callback` in chunks of
+// about 16 KB instead of one allocation. Returns false if parsing failed or
+// the callback stopped the output.
+CKG_API bool ckg_parse_json_stream(void* parser_ptr, const char* source_code, const char* language, const char* file_path,
+                                   CKGJsonChunkCallback callback, void* user_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,25 @@
+; Symbol extraction patterns for C.
+;
+; Captures: @class.definition / @class.name for types, @function.definition /
+; @function.name for functions, and optionally @function.class to name the
+; owning type when it is not the enclosing definition. @field.definition /
+; @field.name mark member variables; they are reported to visitors only.
+
+(function_definition
+  declarator: (function_declarator
+    declarator: (identifier) @function.name)) @function.definition
+
+; Functions returning pointers
+(function_definition
+  declarator: (pointer_declarator
+    declarator: (function_declarator
+      declarator: (identifier) @function.name))) @function.definition
+
+(struct_specifier
+  name: (type_identifier) @class.name
+  body: (field_declaration_list)) @class.definition
+
+(field_declaration
+  declarator: [(field_identifier) @field.name
+               (array_declarator declarator: (field_identifier) @field.name)
+               (pointer_declarator declarator: (field_identifier) @field.name)]) @field.definition
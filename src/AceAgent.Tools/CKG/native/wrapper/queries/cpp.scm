@@ -0,0 +1,36 @@
+; Symbol extraction patterns for C++. See c.scm for the capture names.
+
+(function_definition
+  declarator: (function_declarator
+    declarator: [(identifier) (field_identifier) (destructor_name) (operator_name)] @function.name)) @function.definition
+
+; Functions returning pointers or references
+(function_definition
+  declarator: (pointer_declarator
+    declarator: (function_declarator
+      declarator: [(identifier) (field_identifier)] @function.name))) @function.definition
+
+(function_definition
+  declarator: (reference_declarator
+    (function_declarator
+      declarator: [(identifier) (field_identifier)] @function.name))) @function.definition
+
+; Out-of-line member definitions: Type::name
+(function_definition
+  declarator: (function_declarator
+    declarator: (qualified_identifier
+      scope: (namespace_identifier) @function.class
+      name: [(identifier) (destructor_name) (operator_name)] @function.name))) @function.definition
+
+(class_specifier
+  name: (type_identifier) @class.name
+  body: (field_declaration_list)) @class.definition
+
+(struct_specifier
+  name: (type_identifier) @class.name
+  body: (field_declaration_list)) @class.definition
+
+(field_declaration
+  declarator: [(field_identifier) @field.name
+               (array_declarator declarator: (field_identifier) @field.name)
+               (pointer_declarator declarator: (field_identifier) @field.name)]) @field.definition
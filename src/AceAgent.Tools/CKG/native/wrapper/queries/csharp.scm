@@ -0,0 +1,16 @@
+; Symbol extraction patterns for C#. See c.scm for the capture names.
+
+(class_declaration name: (identifier) @class.name) @class.definition
+(struct_declaration name: (identifier) @class.name) @class.definition
+(interface_declaration name: (identifier) @class.name) @class.definition
+(record_declaration name: (identifier) @class.name) @class.definition
+
+(method_declaration name: (identifier) @function.name) @function.definition
+(constructor_declaration name: (identifier) @function.name) @function.definition
+(destructor_declaration name: (identifier) @function.name) @function.definition
+(local_function_statement name: (identifier) @function.name) @function.definition
+
+; The name is the declarator's first child; later children are the initializer
+(field_declaration
+  (variable_declaration
+    (variable_declarator . (identifier) @field.name))) @field.definition
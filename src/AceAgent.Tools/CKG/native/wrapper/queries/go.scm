@@ -0,0 +1,19 @@
+; Symbol extraction patterns for Go. See c.scm for the capture names.
+
+(type_spec
+  name: (type_identifier) @class.name
+  type: [(struct_type) (interface_type)]) @class.definition
+
+(function_declaration name: (identifier) @function.name) @function.definition
+
+; Methods belong to their receiver type, which is not an enclosing node
+(method_declaration
+  receiver: (parameter_list
+    (parameter_declaration
+      type: [(type_identifier) @function.class
+             (pointer_type (type_identifier) @function.class)
+             (generic_type type: (type_identifier) @function.class)
+             (pointer_type (generic_type type: (type_identifier) @function.class))]))
+  name: (field_identifier) @function.name) @function.definition
+
+(field_declaration name: (field_identifier) @field.name) @field.definition
@@ -0,0 +1,12 @@
+; Symbol extraction patterns for Java. See c.scm for the capture names.
+
+(class_declaration name: (identifier) @class.name) @class.definition
+(interface_declaration name: (identifier) @class.name) @class.definition
+(enum_declaration name: (identifier) @class.name) @class.definition
+(record_declaration name: (identifier) @class.name) @class.definition
+
+(method_declaration name: (identifier) @function.name) @function.definition
+(constructor_declaration name: (identifier) @function.name) @function.definition
+
+(field_declaration
+  declarator: (variable_declarator name: (identifier) @field.name)) @field.definition
@@ -0,0 +1,14 @@
+; Symbol extraction patterns for JavaScript. See c.scm for the capture names.
+
+(class_declaration name: (identifier) @class.name) @class.definition
+
+(function_declaration name: (identifier) @function.name) @function.definition
+(generator_function_declaration name: (identifier) @function.name) @function.definition
+(method_definition name: (_) @function.name) @function.definition
+
+; const handler = (...) => { ... }
+(variable_declarator
+  name: (identifier) @function.name
+  value: (arrow_function)) @function.definition
+
+(field_definition property: (property_identifier) @field.name) @field.definition
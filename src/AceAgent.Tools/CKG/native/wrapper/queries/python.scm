@@ -0,0 +1,5 @@
+; Symbol extraction patterns for Python. See c.scm for the capture names.
+
+(class_definition name: (identifier) @class.name) @class.definition
+
+(function_definition name: (identifier) @function.name) @function.definition
@@ -0,0 +1,18 @@
+; Symbol extraction patterns for TypeScript. See c.scm for the capture names.
+
+(class_declaration name: (type_identifier) @class.name) @class.definition
+(abstract_class_declaration name: (type_identifier) @class.name) @class.definition
+(interface_declaration name: (type_identifier) @class.name) @class.definition
+
+(function_declaration name: (identifier) @function.name) @function.definition
+(generator_function_declaration name: (identifier) @function.name) @function.definition
+(method_definition name: (_) @function.name) @function.definition
+(method_signature name: (_) @function.name) @function.definition
+(abstract_method_signature name: (_) @function.name) @function.definition
+
+; const handler = (...) => { ... }
+(variable_declarator
+  name: (identifier) @function.name
+  value: (arrow_function)) @function.definition
+
+(public_field_definition name: (property_identifier) @field.name) @field.definition
@@ -2,6 +2,7 @@ using System.Text.Json;
 using AceAgent.Core.Interfaces;
 using AceAgent.Core.Models;
 using AceAgent.Tools.CKG;
+using AceAgent.Tools.CKG.Models;
 using Microsoft.Extensions.Logging;
 
 namespace AceAgent.Tools;
@@ -38,6 +39,7 @@ public class CKGTool : ITool
             {
                 "analyze" => await ExecuteAnalyzeAsync(commandArgs),
                 "query" => await ExecuteQueryAsync(commandArgs),
+                "grep" => await ExecuteGrepAsync(commandArgs),
                 "export" => await ExecuteExportAsync(commandArgs),
                 "import" => await ExecuteImportAsync(commandArgs),
                 "help" or "-h" or "--help" => GetHelpText(),
@@ -213,9 +215,103 @@ public class CKGTool : ITool
      
      private async Task<string> ExecuteQueryAsync(string[] args)
      {
-         // 实现查询命令
-         await Task.CompletedTask;
-         return "查询命令执行完成";
+         string? query = null;
+         string? path = null;
+         string format = "table";
+         SymbolSearchMode? mode = null;
+         int limit = 20;
+         int distance = 2;
+         for (var i = 0; i < args.Length; i++)
+         {
+             var value = i + 1 < args.Length ? args[i + 1] : null;
+             switch (args[i])
+             {
+                 case "--path" when value != null:
+                     path = value;
+                     i++;
+                     break;
+                 case "--format" when value != null:
+                     format = value;
+                     i++;
+                     break;
+                 case "--mode" when value != null:
+                     if (!Enum.TryParse<SymbolSearchMode>(value, true, out var parsed))
+                     {
+                         return $"错误: 未知的查询模式: {value}（可选 prefix, fuzzy, camel, substring）";
+                     }
+                     mode = parsed;
+                     i++;
+                     break;
+                 case "--limit" when value != null && int.TryParse(value, out var parsedLimit):
+                     limit = parsedLimit;
+                     i++;
+                     break;
+                 case "--distance" when value != null && int.TryParse(value, out var parsedDistance):
+                     distance = parsedDistance;
+                     i++;
+                     break;
+                 default:
+                     query ??= args[i];
+                     break;
+             }
+         }
+         if (string.IsNullOrEmpty(query))
+         {
+             return "错误: 请指定要查询的符号名\n\n" + GetHelpText();
+         }
+
+         var repository = path ?? Directory.GetCurrentDirectory();
+         var matches = await Task.Run(() => _ckgService.SearchSymbols(repository, query, mode, limit, distance));
+         if (matches.Count == 0 && _ckgService.GetSymbolIndex(repository) == null)
+         {
+             return $"错误: 没有 {repository} 的符号索引，请先运行 analyze";
+         }
+         return CKGService.FormatSymbolMatches(matches, format);
+     }
+
+     private async Task<string> ExecuteGrepAsync(string[] args)
+     {
+         string? pattern = null;
+         string? path = null;
+         var regex = false;
+         var ignoreCase = false;
+         int limit = 100;
+         for (var i = 0; i < args.Length; i++)
+         {
+             var value = i + 1 < args.Length ? args[i + 1] : null;
+             switch (args[i])
+             {
+                 case "--path" when value != null:
+                     path = value;
+                     i++;
+                     break;
+                 case "--regex":
+                     regex = true;
+                     break;
+                 case "-i" or "--ignore-case":
+                     ignoreCase = true;
+                     break;
+                 case "--limit" when value != null && int.TryParse(value, out var parsedLimit):
+                     limit = parsedLimit;
+                     i++;
+                     break;
+                 default:
+                     pattern ??= args[i];
+                     break;
+             }
+         }
+         if (string.IsNullOrEmpty(pattern))
+         {
+             return "错误: 请指定要搜索的文本\n\n" + GetHelpText();
+         }
+
+         var repository = path ?? Directory.GetCurrentDirectory();
+         var matches = await Task.Run(() => _ckgService.SearchText(repository, pattern, regex, ignoreCase, limit));
+         if (matches.Count == 0 && _ckgService.GetTextIndex(repository) == null)
+         {
+             return $"错误: 没有 {repository} 的文本索引，请先运行 analyze";
+         }
+         return CKGService.FormatTextMatches(matches);
      }
      
      private async Task<string> ExecuteExportAsync(string[] args)
@@ -240,14 +336,31 @@ public class CKGTool : ITool
   analyze <path> [-v|--verbose]  - 分析代码文件或目录
                                    支持单个文件或整个目录分析
                                    -v, --verbose: 显示详细信息
-  query <query>                  - 执行查询
+  query <name> [options]         - 按名称搜索符号
+                                   name以*结尾时按前缀搜索，否则依次收集
+                                   前缀、驼峰、子串和模糊匹配
+                                   --mode prefix|fuzzy|camel|substring: 只用一种匹配
+                                   --limit N: 最多返回的名称数（默认20）
+                                   --distance N: 模糊匹配的最大编辑距离（默认2，最大3）
+                                   --path <dir>: 仓库目录（默认当前目录）
+                                   --format table|json|csv: 输出格式
+  grep <text> [options]          - 在已分析的文件内容中搜索文本
+                                   用三元组索引筛选文件，只读取可能匹配的文件
+                                   --regex: 按正则表达式搜索（不跨行）
+                                   -i, --ignore-case: 忽略大小写
+                                   --limit N: 最多返回的行数（默认100）
+                                   --path <dir>: 仓库目录（默认当前目录）
   export <path>                  - 导出数据
   import <path>                  - 导入数据
   help                           - 显示帮助信息
 
 示例:
   analyze /path/to/file.cs       - 分析单个C#文件
-  analyze /path/to/project -v    - 分析整个项目目录（详细模式）";
+  analyze /path/to/project -v    - 分析整个项目目录（详细模式）
+  query parseConf*               - 查找以parseConf开头的符号
+  query PCR --mode camel         - 按驼峰缩写查找，如ParseCodeResult
+  grep TODO -i                   - 查找包含todo的行（忽略大小写）
+  grep ckg_\w+_open --regex      - 按正则表达式查找";
     }
 }
 
@@ -5,6 +5,8 @@ using System.Threading;
 using System.Threading.Tasks;
 using AceAgent.Core.Interfaces;
 using AceAgent.Core.Models;
+using AceAgent.Tools.CKG;
+using AceAgent.Tools.CKG.Models;
 
 namespace AceAgent.Tools
 {
@@ -13,6 +15,17 @@ namespace AceAgent.Tools
     /// </summary>
     public class FileEditTool : ITool
     {
+        private readonly CKGService? _ckgService;
+
+        /// <summary>
+        /// 创建文件编辑工具
+        /// </summary>
+        /// <param name="ckgService">代码知识图谱服务；提供时，编辑后增量更新被编辑文件的符号</param>
+        public FileEditTool(CKGService? ckgService = null)
+        {
+            _ckgService = ckgService;
+        }
+
         /// <summary>
         /// 工具名称
         /// </summary>
@@ -84,6 +97,16 @@ namespace AceAgent.Tools
                 // 写入新内容
                 await File.WriteAllTextAsync(filePath, newContent, encodingObj, cancellationToken);
 
+                // 增量更新知识图谱中该文件的符号：变更范围从第一处匹配开始，到最后一处匹配结束
+                SymbolDiff? symbolDiff = null;
+                if (_ckgService != null)
+                {
+                    var editStart = originalContent.IndexOf(searchText, StringComparison.Ordinal);
+                    var editOldEnd = originalContent.LastIndexOf(searchText, StringComparison.Ordinal) + searchText.Length;
+                    var edit = new TextEdit(editStart, editOldEnd, editOldEnd + newContent.Length - originalContent.Length);
+                    symbolDiff = await _ckgService.ApplyEditAsync(filePath, originalContent, newContent, edit);
+                }
+
                 var executionTime = (DateTime.UtcNow - startTime).TotalMilliseconds;
                 
                 var result = ToolResult.CreateSuccess($"文件编辑完成，替换了 {searchCount} 处匹配项", new
@@ -99,6 +122,10 @@ namespace AceAgent.Tools
                 result.ExecutionTimeMs = (long)executionTime;
                 result.Metadata["operation"] = "file_edit";
                 result.Metadata["file_path"] = filePath;
+                if (symbolDiff != null && symbolDiff.IsSuccess)
+                {
+                    result.Metadata["symbol_changes"] = symbolDiff.Changes.Count;
+                }
                 
                 return result;
             }
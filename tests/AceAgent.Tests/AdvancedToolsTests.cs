@@ -6,6 +6,7 @@ using AceAgent.Core.Models;
 using AceAgent.Tools;
 using AceAgent.Tools.CKG;
 using AceAgent.Tools.CKG.Data;
+using AceAgent.Tools.CKG.Models;
 using AceAgent.Tools.CKG.Services;
 using FluentAssertions;
 using Microsoft.Extensions.Logging;
@@ -44,6 +45,66 @@ namespace AceAgent.Tests
 
         #endregion
 
+        #region TextEdit Tests
+
+        [Fact]
+        public void TextEdit_ShouldAcceptAppendAtEndOfFile()
+        {
+            // Arrange
+            var oldContent = "int a;\n";
+            var newContent = oldContent + "int b;\n";
+            var edit = new TextEdit(oldContent.Length, oldContent.Length, newContent.Length);
+
+            // Act
+            var fits = edit.TryAlign(oldContent, newContent, out var aligned);
+
+            // Assert
+            fits.Should().BeTrue();
+            aligned.Should().Be(edit);
+        }
+
+        [Fact]
+        public void TextEdit_ShouldAcceptAppendAfterSurrogatePair()
+        {
+            // Arrange
+            var oldContent = "// 😀";
+            var newContent = oldContent + "\nint b;";
+            var edit = new TextEdit(oldContent.Length, oldContent.Length, newContent.Length);
+
+            // Act
+            var fits = edit.TryAlign(oldContent, newContent, out var aligned);
+
+            // Assert
+            fits.Should().BeTrue();
+            aligned.Should().Be(edit);
+        }
+
+        [Fact]
+        public void TextEdit_ShouldWidenRatherThanSplitSurrogatePair()
+        {
+            // Arrange: only the low surrogate differs
+            var oldContent = "x😀y";
+            var newContent = "x😁y";
+            var edit = new TextEdit(2, 3, 3);
+
+            // Act
+            var fits = edit.TryAlign(oldContent, newContent, out var aligned);
+
+            // Assert
+            fits.Should().BeTrue();
+            aligned.Should().Be(new TextEdit(1, 3, 3));
+        }
+
+        [Fact]
+        public void TextEdit_ShouldRejectEditThatDoesNotFit()
+        {
+            // Act & Assert
+            new TextEdit(0, 5, 2).TryAlign("abc", "abcd", out _).Should().BeFalse();
+            new TextEdit(1, 3, 3).TryAlign("abc", "abcd", out _).Should().BeFalse();
+        }
+
+        #endregion
+
         #region WebSearchTool Tests
 
         [Fact]